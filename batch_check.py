@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""Verifica que um "rb" sobre ligações com tramas agrupadas obtém todos os nomes.
+
+Lança três nós locais em cadeia, C -> M -> P, com as capacidades por
+omissão (tramas binárias, tabela de nomes e tramas agrupadas). P guarda
+os objetos; C pede-os todos num só "rb", juntamente com nomes que não
+existem em lado nenhum. Passa se:
+
+- cada nome existente chega a C (ndn_retrieve_ok_total) e cada nome
+  inexistente termina com NOOBJECT (ndn_retrieve_failed_total), antes de
+  qualquer interesse poder expirar;
+- nenhum nó fica com entradas na tabela de interesses (ndn_pit_entries);
+- os nomes seguiram de facto em tramas agrupadas nas duas ligações.
+
+Os contadores dos nós são lidos do porto de métricas ("stats listen").
+
+Uso:
+    ./batch_check.py
+    ./batch_check.py --names 1000 --missing 100
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+import urllib.request
+
+INTEREST_TIMEOUT = 10       # ndn.h
+METRIC_RE = re.compile(r"^(\w+) (\S+)$")
+
+
+class Node:
+    """Um nó ndn local controlado pelo stdin."""
+
+    def __init__(self, args, port, metrics_port):
+        self.port = port
+        self.metrics_port = metrics_port
+        self.proc = subprocess.Popen(
+            [os.path.join(args.bin_dir, "ndn"), "100", "127.0.0.1", str(port), "127.0.0.1", "59999"],
+            stdin=subprocess.PIPE, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, text=True)
+        self.cmd("stats listen %d" % metrics_port)
+
+    def cmd(self, line, wait=0.2):
+        # O nó lê uma linha do stdin por cada vez que o select() o assinala
+        self.proc.stdin.write(line + "\n")
+        self.proc.stdin.flush()
+        time.sleep(wait)
+
+    def metrics(self):
+        url = "http://127.0.0.1:%d/metrics" % self.metrics_port
+        text = urllib.request.urlopen(url, timeout=5).read().decode()
+        values = {}
+        for line in text.splitlines():
+            m = METRIC_RE.match(line)
+            if m:
+                values[m.group(1)] = float(m.group(2))
+        return values
+
+    def stop(self):
+        # Sem "exit": o nó tentaria anular o registo num servidor que não existe
+        self.proc.kill()
+        self.proc.wait()
+
+
+def wait_for(predicate, timeout):
+    """Espera até predicate() ser verdadeiro; devolve o tempo em ms ou None."""
+    start = time.monotonic()
+    while time.monotonic() - start < timeout:
+        if predicate():
+            return (time.monotonic() - start) * 1000.0
+        time.sleep(0.05)
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check that rb over batched links answers every name")
+    parser.add_argument("--names", type=int, default=400, help="objects held by the producer (default: 400)")
+    parser.add_argument("--missing", type=int, default=50, help="names held by no node (default: 50)")
+    parser.add_argument("--name-size", type=int, default=40, help="characters per name (default: 40)")
+    parser.add_argument("--base-port", type=int, default=58700, help="first TCP port used (default: 58700)")
+    parser.add_argument("--bin-dir", default=".", help="directory with the executables (default: .)")
+    args = parser.parse_args()
+
+    # Os nomes só podem ter letras e algarismos
+    present = [("obj%05d" % i).ljust(args.name_size, "x") for i in range(args.names)]
+    missing = [("none%05d" % i).ljust(args.name_size, "x") for i in range(args.missing)]
+
+    p = Node(args, args.base_port, args.base_port + 20)
+    m = Node(args, args.base_port + 1, args.base_port + 21)
+    c = Node(args, args.base_port + 2, args.base_port + 22)
+    failures = []
+    try:
+        p.cmd("dj 0.0.0.0 0")
+        m.cmd("dj 127.0.0.1 %d" % p.port)
+        c.cmd("dj 127.0.0.1 %d" % m.port)
+        for name in present:
+            p.cmd("c " + name, wait=0.005)
+
+        # Os nomes inexistentes vão espalhados, para as tramas agrupadas levarem os dois tipos de resposta
+        step = max(args.names // max(args.missing, 1), 1)
+        order, rest = [], list(missing)
+        for i, name in enumerate(present):
+            order.append(name)
+            if i % step == 0 and rest:
+                order.append(rest.pop())
+        order += rest
+        with tempfile.NamedTemporaryFile("w", suffix=".names", delete=False) as f:
+            f.write("\n".join(order) + "\n")
+            names_file = f.name
+
+        start = time.monotonic()
+        c.cmd("rb " + names_file, wait=0)
+        done = wait_for(lambda: (lambda v: v.get("ndn_retrieve_ok_total", 0) +
+                                 v.get("ndn_retrieve_failed_total", 0) >= args.names + len(missing))
+                        (c.metrics()), INTEREST_TIMEOUT - 1)
+        os.unlink(names_file)
+
+        values = {"P": p.metrics(), "M": m.metrics(), "C": c.metrics()}
+        ok = values["C"].get("ndn_retrieve_ok_total", 0)
+        failed = values["C"].get("ndn_retrieve_failed_total", 0)
+        print("%d names, %d missing: %d objects, %d NOOBJECT in %s" %
+              (args.names, len(missing), ok, failed,
+               "%.0f ms" % done if done is not None else
+               "more than %.0f s" % (time.monotonic() - start)))
+        if ok != args.names:
+            failures.append("C retrieved %d of %d objects" % (ok, args.names))
+        if failed != len(missing):
+            failures.append("C got %d NOOBJECT for %d missing names" % (failed, len(missing)))
+
+        for label, v in values.items():
+            print("%s: pit entries %d, batch frames in %d / out %d, names in %d / out %d, malformed %d" %
+                  (label, v.get("ndn_pit_entries", 0),
+                   v.get("ndn_wire_batch_frames_received_total", 0), v.get("ndn_wire_batch_frames_sent_total", 0),
+                   v.get("ndn_wire_batch_names_received_total", 0), v.get("ndn_wire_batch_names_sent_total", 0),
+                   v.get("ndn_malformed_total", 0)))
+            if v.get("ndn_pit_entries", 0) != 0:
+                failures.append("%s has %d pending interest table entries" % (label, v["ndn_pit_entries"]))
+            if v.get("ndn_malformed_total", 0) != 0:
+                failures.append("%s counted %d malformed messages" % (label, v["ndn_malformed_total"]))
+        for label in ("M", "P"):
+            if values[label].get("ndn_wire_batch_frames_received_total", 0) == 0:
+                failures.append("%s received no batched frames" % label)
+    finally:
+        for node in (p, m, c):
+            node.stop()
+
+    for failure in failures:
+        print("FAIL: " + failure)
+    if not failures:
+        print("OK")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,194 @@
+/**
+ * @file caps.c
+ * @brief Implementação da negociação de capacidades das ligações
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a tabela das capacidades conhecidas, a escrita e a
+ * leitura dos campos das mensagens ENTRY e SAFE descritos em caps.h e o
+ * comando "caps".
+ */
+
+#include "caps.h"
+#include "ndn.h"
+#include "wire.h"
+
+unsigned caps_enabled = CAPS_ALL;
+
+/**
+ * @brief Descrição de uma capacidade.
+ *
+ * As capacidades com fixed anunciam-se com esse valor; as restantes são
+ * numéricas, anunciam-se com offer e aceitam-se de 1 a max.
+ */
+typedef struct {
+    const char *key;
+    const char *fixed;
+    unsigned offer;
+    unsigned max;
+    unsigned requires;                  /* CAP_BIT das capacidades de que depende */
+    const char *description;
+} CapInfo;
+
+static const CapInfo cap_info[CAP_COUNT] = {
+    [CAP_WIRE_TLV]  = {"wire", "tlv", 0, 0, 0, "binary frames for INTEREST/OBJECT/NOOBJECT"},
+    [CAP_NAME_DICT] = {"dict", NULL, WIRE_DICT_SLOTS, WIRE_DICT_SLOTS, CAP_BIT(CAP_WIRE_TLV),
+                       "name compression in binary frames"},
+    [CAP_BATCH]     = {"batch", NULL, WIRE_BATCH_MAX, WIRE_BATCH_MAX, CAP_BIT(CAP_WIRE_TLV),
+                       "several names per INTEREST/OBJECT/NOOBJECT frame"},
+    [CAP_LIFETIME]  = {"lifetime", "ms", 0, 0, CAP_BIT(CAP_WIRE_TLV), "interest lifetime in binary frames"},
+};
+
+/**
+ * @brief Retira de bits as capacidades cujos requisitos não estão em bits.
+ */
+static unsigned caps_closure(unsigned bits) {
+    for (int c = 0; c < CAP_COUNT; c++) {
+        if ((bits & CAP_BIT(c)) && (bits & cap_info[c].requires) != cap_info[c].requires) {
+            bits &= ~CAP_BIT(c);
+        }
+    }
+    return bits;
+}
+
+char *caps_format(unsigned bits, const CapSet *set, char *out, size_t size) {
+    size_t len = 0;
+    out[0] = '\0';
+    for (int c = 0; c < CAP_COUNT && len < size; c++) {
+        if (!(bits & CAP_BIT(c))) {
+            continue;
+        }
+        int n;
+        if (cap_info[c].fixed != NULL) {
+            n = snprintf(out + len, size - len, "%s%s=%s", len ? " " : "", cap_info[c].key, cap_info[c].fixed);
+        } else {
+            n = snprintf(out + len, size - len, "%s%s=%u", len ? " " : "", cap_info[c].key,
+                         set != NULL ? set->value[c] : cap_info[c].offer);
+        }
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return out;
+}
+
+const char *caps_offer() {
+    static char offer[CAPS_OFFER_SIZE];
+    unsigned bits = caps_closure(caps_enabled);
+    if (bits == 0) {
+        return "";
+    }
+    offer[0] = ' ';
+    caps_format(bits, NULL, offer + 1, sizeof(offer) - 1);
+    return offer;
+}
+
+void caps_parse(const char *message, CapSet *set) {
+    memset(set, 0, sizeof(*set));
+
+    /* Salta "ENTRY <ip> <porto>" */
+    const char *p = message;
+    for (int field = 0; field < 3 && *p != '\0'; field++) {
+        while (*p == ' ') {
+            p++;
+        }
+        while (*p != '\0' && *p != ' ' && *p != '\r' && *p != '\n') {
+            p++;
+        }
+    }
+
+    while (*p != '\0' && *p != '\r' && *p != '\n') {
+        while (*p == ' ') {
+            p++;
+        }
+        const char *token = p;
+        while (*p != '\0' && *p != ' ' && *p != '\r' && *p != '\n') {
+            p++;
+        }
+        const char *equals = memchr(token, '=', (size_t)(p - token));
+        if (equals == NULL) {
+            continue;
+        }
+        size_t key_len = (size_t)(equals - token);
+        size_t value_len = (size_t)(p - equals - 1);
+        for (int c = 0; c < CAP_COUNT; c++) {
+            const CapInfo *info = &cap_info[c];
+            if (strlen(info->key) != key_len || strncmp(token, info->key, key_len) != 0) {
+                continue;
+            }
+            if (info->fixed != NULL) {
+                if (strlen(info->fixed) == value_len && strncmp(equals + 1, info->fixed, value_len) == 0) {
+                    set->bits |= CAP_BIT(c);
+                }
+            } else {
+                unsigned long value = strtoul(equals + 1, NULL, 10);
+                if (value > 0) {
+                    set->bits |= CAP_BIT(c);
+                    set->value[c] = value < info->max ? (unsigned)value : info->max;
+                }
+            }
+            break;
+        }
+    }
+
+    set->bits = caps_closure(set->bits);
+    for (int c = 0; c < CAP_COUNT; c++) {
+        if (!(set->bits & CAP_BIT(c))) {
+            set->value[c] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Procura uma capacidade pela chave.
+ *
+ * @return Capacidade, ou -1 se não existir
+ */
+static int caps_lookup(const char *key) {
+    for (int c = 0; c < CAP_COUNT; c++) {
+        if (strcmp(cap_info[c].key, key) == 0) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Consultar ou ligar e desligar as capacidades oferecidas aos vizinhos.
+ *
+ * Sem argumentos, mostra as capacidades do nó e, para cada vizinho, as que
+ * anunciou e as que estão em uso nos envios.
+ *
+ * @param name Chave da capacidade ("wire", "dict", ...), ou NULL
+ * @param value "on" ou "off"
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_caps(char *name, char *value) {
+    if (name != NULL) {
+        int cap = caps_lookup(name);
+        if (cap < 0 || value == NULL || (strcmp(value, "on") != 0 && strcmp(value, "off") != 0)) {
+            printf("%sUsage: caps [<capability> on|off]%s\n", COLOR_RED, COLOR_RESET);
+            return -1;
+        }
+        if (strcmp(value, "on") == 0) {
+            caps_enabled |= CAP_BIT(cap);
+        } else {
+            caps_enabled &= ~CAP_BIT(cap);
+        }
+    }
+
+    printf("%sCapabilities:%s\n", COLOR_BOLD, COLOR_RESET);
+    for (int c = 0; c < CAP_COUNT; c++) {
+        const char *state = !(caps_enabled & CAP_BIT(c)) ? "off"
+                          : caps_closure(caps_enabled) & CAP_BIT(c) ? "on" : "on (needs another capability)";
+        printf("  %-8s %-3s  %s\n", cap_info[c].key, state, cap_info[c].description);
+    }
+    printf("Offered in ENTRY/SAFE:%s\n", *caps_offer() ? caps_offer() : " (none)");
+
+    char offered[CAPS_OFFER_SIZE], used[CAPS_OFFER_SIZE];
+    for (Neighbor *curr = node.neighbors; curr != NULL; curr = curr->next) {
+        caps_format(curr->caps.bits, &curr->caps, offered, sizeof(offered));
+        caps_format(caps_closure(curr->caps.bits & caps_enabled), &curr->caps, used, sizeof(used));
+        printf("  interface %d %s:%s: offers %s | in use %s\n", curr->interface_id, curr->ip, curr->port,
+               *offered ? offered : "-", *used ? used : "-");
+    }
+    return 0;
+}
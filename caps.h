@@ -0,0 +1,105 @@
+/**
+ * @file caps.h
+ * @brief Capacidades das ligações, negociadas no ENTRY e no SAFE
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Depois de "ENTRY <ip> <porto>" e "SAFE <ip> <porto>", um nó acrescenta um
+ * campo "<chave>=<valor>" por cada capacidade que oferece:
+ *
+ *   ENTRY 193.136.138.142 58001 wire=tlv dict=64 batch=32 lifetime=ms
+ *
+ * Os nós antigos só leem os dois primeiros campos, e os campos com chaves
+ * desconhecidas são ignorados, pelo que se podem acrescentar capacidades
+ * sem mudar as existentes nem o formato das mensagens ENTRY e SAFE.
+ *
+ * Cada vizinho guarda as capacidades que anunciou (CapSet). Os envios só
+ * usam uma variante quando o nó a tem ligada (caps_enabled) e o vizinho a
+ * anunciou, o que permite ligar uma otimização gradualmente numa rede com
+ * nós antigos. Desligar uma capacidade vale logo para os envios do nó; os
+ * vizinhos só a deixam de usar no próximo ENTRY ou SAFE.
+ */
+
+#ifndef CAPS_H
+#define CAPS_H
+
+#include <stddef.h>
+
+/**
+ * @brief Capacidades conhecidas. A ordem é a dos campos nas mensagens.
+ */
+typedef enum {
+    CAP_WIRE_TLV = 0,                   /* wire=tlv: tramas binárias (wire.h) */
+    CAP_NAME_DICT,                      /* dict=<slots>: compressão de nomes; requer wire */
+    CAP_BATCH,                          /* batch=<nomes>: tramas agrupadas; requer wire */
+    CAP_LIFETIME,                       /* lifetime=ms: tempo de vida dos interesses nas tramas; requer wire */
+    CAP_COUNT
+} CapId;
+
+#define CAP_BIT(cap) (1u << (cap))
+#define CAPS_ALL ((1u << CAP_COUNT) - 1)
+#define CAPS_OFFER_SIZE 128             /* Maior texto devolvido por caps_offer */
+
+/**
+ * @brief Capacidades anunciadas por um vizinho.
+ */
+typedef struct cap_set {
+    unsigned bits;                      /* CAP_BIT das capacidades anunciadas */
+    unsigned value[CAP_COUNT];          /* Valor das capacidades numéricas (0 nas restantes) */
+} CapSet;
+
+/**
+ * @brief Capacidades que o nó oferece e usa (CAPS_ALL por omissão).
+ */
+extern unsigned caps_enabled;
+
+/**
+ * @brief Obtém os campos a acrescentar às mensagens ENTRY e SAFE.
+ *
+ * @return " chave=valor ..." das capacidades ligadas, ou "" (buffer estático)
+ */
+const char *caps_offer();
+
+/**
+ * @brief Lê as capacidades de uma mensagem ENTRY ou SAFE.
+ *
+ * Capacidades cujos requisitos não foram anunciados são descartadas, e os
+ * valores numéricos são limitados ao máximo que o nó aceita.
+ *
+ * @param message Mensagem (terminada em '\0' ou '\n')
+ * @param set Capacidades anunciadas
+ */
+void caps_parse(const char *message, CapSet *set);
+
+/**
+ * @brief Indica se uma capacidade está em uso numa ligação.
+ *
+ * @param set Capacidades anunciadas pelo vizinho
+ * @param cap Capacidade
+ * @return 1 se o nó a tiver ligada e o vizinho a tiver anunciado
+ */
+static inline int caps_use(const CapSet *set, CapId cap) {
+    return (caps_enabled & set->bits & CAP_BIT(cap)) != 0;
+}
+
+/**
+ * @brief Escreve as capacidades de um conjunto como na mensagem ("wire=tlv dict=64").
+ *
+ * @param bits Capacidades a escrever
+ * @param set Valores das capacidades numéricas (NULL = valores oferecidos pelo nó)
+ * @param out Destino
+ * @param size Tamanho do destino
+ * @return out
+ */
+char *caps_format(unsigned bits, const CapSet *set, char *out, size_t size);
+
+/**
+ * @brief Processa o comando "caps" para consultar ou ligar e desligar capacidades.
+ *
+ * @param name Nome da capacidade, ou NULL para mostrar o estado
+ * @param value "on" ou "off"
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_caps(char *name, char *value);
+
+#endif /* CAPS_H */
@@ -0,0 +1,259 @@
+/**
+ * @file capture.c
+ * @brief Implementação da captura binária do tráfego de um nó NDN
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém o escritor com buffer usado pelo nó, o leitor
+ * usado pelo ndn-replay e o comando "capture".
+ */
+
+#include "capture.h"
+#include "debug_utils.h"
+#include "latency.h"
+
+int capture_enabled = 0;
+
+static int capture_fd = -1;
+static char capture_path[256];
+static char buffer[CAPTURE_BUFFER_SIZE];
+static size_t buffer_len = 0;
+static uint64_t start_ns = 0;
+static unsigned long frames = 0;
+static unsigned long long bytes = 0;
+
+/**
+ * @brief Escreve um bloco completo no ficheiro de captura.
+ *
+ * Em caso de erro a captura é terminada para não afetar o nó.
+ */
+static int write_all(const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(capture_fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            log_message(LOG_ERROR, "Capture write to %s failed: %s", capture_path, strerror(errno));
+            capture_enabled = 0;
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Escreve o conteúdo do buffer no ficheiro.
+ */
+static void flush_buffer() {
+    if (buffer_len > 0 && capture_fd >= 0) {
+        write_all(buffer, buffer_len);
+    }
+    buffer_len = 0;
+}
+
+/**
+ * @brief Inicia a captura para um ficheiro (substitui o conteúdo existente).
+ *
+ * @param path Caminho do ficheiro
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int capture_start(const char *path) {
+    if (capture_fd >= 0) {
+        capture_stop();
+    }
+
+    capture_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (capture_fd < 0) {
+        return -1;
+    }
+
+    snprintf(capture_path, sizeof(capture_path), "%s", path);
+    buffer_len = 0;
+    frames = 0;
+    bytes = 0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    CaptureFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+    header.record_size = sizeof(CaptureRecord);
+    header.start_realtime_ns = (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+
+    memcpy(buffer, &header, sizeof(header));
+    buffer_len = sizeof(header);
+    start_ns = monotonic_ns();
+    capture_enabled = 1;
+    return 0;
+}
+
+/**
+ * @brief Termina a captura em curso, escrevendo o buffer pendente.
+ */
+void capture_stop() {
+    if (capture_fd < 0) {
+        return;
+    }
+
+    flush_buffer();
+    close(capture_fd);
+    capture_fd = -1;
+    capture_enabled = 0;
+    log_message(LOG_INFO, "Capture to %s stopped: %lu frame(s), %llu byte(s)", capture_path, frames, bytes);
+}
+
+/**
+ * @brief Acrescenta uma mensagem à captura em curso.
+ *
+ * @param face ID de interface
+ * @param direction CAPTURE_IN ou CAPTURE_OUT
+ * @param data Mensagem
+ * @param len Tamanho da mensagem
+ */
+void capture_write(int face, CaptureDirection direction, const char *data, size_t len) {
+    if (len > CAPTURE_MAX_FRAME) {
+        len = CAPTURE_MAX_FRAME;
+    }
+
+    CaptureRecord record;
+    record.ts_ns = monotonic_ns() - start_ns;
+    record.length = (uint32_t)len;
+    record.face = (int16_t)face;
+    record.direction = (uint8_t)direction;
+    record.reserved = 0;
+
+    if (buffer_len + sizeof(record) + len > sizeof(buffer)) {
+        flush_buffer();
+        if (!capture_enabled) {
+            return;
+        }
+    }
+
+    memcpy(buffer + buffer_len, &record, sizeof(record));
+    memcpy(buffer + buffer_len + sizeof(record), data, len);
+    buffer_len += sizeof(record) + len;
+
+    frames++;
+    bytes += len;
+}
+
+/**
+ * @brief Abre um ficheiro de captura para leitura e valida o cabeçalho.
+ *
+ * @param reader Leitor a inicializar
+ * @param path Caminho do ficheiro
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int capture_open(CaptureReader *reader, const char *path) {
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL) {
+        return -1;
+    }
+
+    if (fread(&reader->header, sizeof(reader->header), 1, reader->file) != 1 ||
+        memcmp(reader->header.magic, CAPTURE_MAGIC, sizeof(reader->header.magic)) != 0 ||
+        reader->header.version != CAPTURE_VERSION ||
+        reader->header.record_size != sizeof(CaptureRecord)) {
+        fclose(reader->file);
+        reader->file = NULL;
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Lê a próxima mensagem de um ficheiro de captura.
+ *
+ * @param reader Leitor
+ * @param record Cabeçalho da mensagem lida
+ * @param data Buffer para a mensagem (pelo menos CAPTURE_MAX_FRAME + 1 bytes, terminado em '\0')
+ * @return 1 se leu uma mensagem, 0 no fim do ficheiro, -1 se o ficheiro estiver corrompido
+ */
+int capture_next(CaptureReader *reader, CaptureRecord *record, char *data) {
+    size_t n = fread(record, 1, sizeof(*record), reader->file);
+    if (n == 0 && feof(reader->file)) {
+        return 0;
+    }
+    if (n != sizeof(*record) || record->length > CAPTURE_MAX_FRAME ||
+        record->direction > CAPTURE_OUT) {
+        return -1;
+    }
+    if (fread(data, 1, record->length, reader->file) != record->length) {
+        return -1;
+    }
+    data[record->length] = '\0';
+    return 1;
+}
+
+/**
+ * @brief Volta ao início das mensagens de um ficheiro de captura.
+ *
+ * @param reader Leitor
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int capture_rewind(CaptureReader *reader) {
+    return fseek(reader->file, sizeof(CaptureFileHeader), SEEK_SET);
+}
+
+/**
+ * @brief Fecha um ficheiro de captura aberto para leitura.
+ *
+ * @param reader Leitor
+ */
+void capture_close(CaptureReader *reader) {
+    if (reader->file != NULL) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+}
+
+/**
+ * @brief Processa o comando "capture" para iniciar, terminar ou consultar a captura.
+ *
+ * @param arg Subcomando ("start", "stop" ou NULL)
+ * @param path Ficheiro de destino para "start"
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_capture(char *arg, char *path) {
+    if (arg == NULL) {
+        if (capture_fd >= 0) {
+            printf("Capturing to %s: %lu frame(s), %llu byte(s)\n", capture_path, frames, bytes);
+        } else {
+            printf("No capture in progress\n");
+        }
+        return 0;
+    }
+
+    if (strcmp(arg, "start") == 0) {
+        if (path == NULL) {
+            printf("%sUsage: capture start <file>%s\n", COLOR_RED, COLOR_RESET);
+            return -1;
+        }
+        if (capture_start(path) < 0) {
+            printf("%sCould not open %s: %s%s\n", COLOR_RED, path, strerror(errno), COLOR_RESET);
+            return -1;
+        }
+        printf("Capturing traffic to %s\n", path);
+        return 0;
+    }
+
+    if (strcmp(arg, "stop") == 0) {
+        if (capture_fd < 0) {
+            printf("%sNo capture in progress%s\n", COLOR_YELLOW, COLOR_RESET);
+            return -1;
+        }
+        unsigned long captured = frames;
+        capture_stop();
+        printf("Capture to %s stopped (%lu frame(s))\n", capture_path, captured);
+        return 0;
+    }
+
+    printf("%sUsage: capture [start <file>|stop]%s\n", COLOR_RED, COLOR_RESET);
+    return -1;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file capture.h
+ * @brief Captura binária do tráfego de um nó NDN
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro define o formato dos ficheiros de captura e as funções
+ * para os escrever (no nó) e ler (no ndn-replay).
+ *
+ * Formato (ordem de bytes do anfitrião):
+ * - Cabeçalho CaptureFileHeader, uma vez no início do ficheiro
+ * - Uma sequência de registos, cada um com um CaptureRecord seguido de
+ *   length bytes com a mensagem exatamente como foi lida ou escrita
+ *   (incluindo o '\n' final)
+ *
+ * Os registos são acumulados num buffer em memória e escritos em blocos,
+ * pelo que o custo por mensagem é uma cópia.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include "ndn.h"
+
+#define CAPTURE_MAGIC "NDNTRACE"        /* 8 bytes no início do ficheiro */
+#define CAPTURE_VERSION 1
+#define CAPTURE_BUFFER_SIZE 65536       /* Buffer de escrita */
+#define CAPTURE_MAX_FRAME MAX_BUFFER    /* Tamanho máximo de uma mensagem capturada */
+
+/**
+ * @brief Direção de uma mensagem capturada.
+ */
+typedef enum {
+    CAPTURE_IN = 0,     /* Recebida de um vizinho */
+    CAPTURE_OUT = 1     /* Enviada para um vizinho */
+} CaptureDirection;
+
+/**
+ * @brief Cabeçalho do ficheiro de captura.
+ */
+typedef struct capture_file_header {
+    char magic[8];                      /* CAPTURE_MAGIC */
+    uint32_t version;                   /* CAPTURE_VERSION */
+    uint32_t record_size;               /* sizeof(CaptureRecord) do escritor */
+    uint64_t start_realtime_ns;         /* Início da captura (CLOCK_REALTIME) */
+} CaptureFileHeader;
+
+/**
+ * @brief Cabeçalho de cada mensagem capturada.
+ */
+typedef struct capture_record {
+    uint64_t ts_ns;                     /* Tempo desde o início da captura (CLOCK_MONOTONIC) */
+    uint32_t length;                    /* Bytes da mensagem que se seguem */
+    int16_t face;                       /* ID de interface (-1 se desconhecido) */
+    uint8_t direction;                  /* CaptureDirection */
+    uint8_t reserved;
+} CaptureRecord;
+
+_Static_assert(sizeof(CaptureRecord) == 16, "CaptureRecord deve ter 16 bytes");
+
+/**
+ * @brief Leitor de um ficheiro de captura.
+ */
+typedef struct capture_reader {
+    FILE *file;                         /* Ficheiro aberto */
+    CaptureFileHeader header;           /* Cabeçalho lido */
+} CaptureReader;
+
+/**
+ * @brief 1 enquanto houver uma captura em curso.
+ */
+extern int capture_enabled;
+
+/**
+ * @brief Inicia a captura para um ficheiro (substitui o conteúdo existente).
+ *
+ * @param path Caminho do ficheiro
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int capture_start(const char *path);
+
+/**
+ * @brief Termina a captura em curso, escrevendo o buffer pendente.
+ */
+void capture_stop();
+
+/**
+ * @brief Acrescenta uma mensagem à captura em curso.
+ *
+ * @param face ID de interface
+ * @param direction CAPTURE_IN ou CAPTURE_OUT
+ * @param data Mensagem
+ * @param len Tamanho da mensagem
+ */
+void capture_write(int face, CaptureDirection direction, const char *data, size_t len);
+
+/**
+ * @brief Regista uma mensagem se houver uma captura em curso.
+ *
+ * Sem captura, o custo é apenas uma comparação.
+ */
+static inline void capture_frame(int face, CaptureDirection direction, const char *data, size_t len) {
+    if (capture_enabled) {
+        capture_write(face, direction, data, len);
+    }
+}
+
+/**
+ * @brief Abre um ficheiro de captura para leitura e valida o cabeçalho.
+ *
+ * @param reader Leitor a inicializar
+ * @param path Caminho do ficheiro
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int capture_open(CaptureReader *reader, const char *path);
+
+/**
+ * @brief Lê a próxima mensagem de um ficheiro de captura.
+ *
+ * @param reader Leitor
+ * @param record Cabeçalho da mensagem lida
+ * @param data Buffer para a mensagem (pelo menos CAPTURE_MAX_FRAME + 1 bytes, terminado em '\0')
+ * @return 1 se leu uma mensagem, 0 no fim do ficheiro, -1 se o ficheiro estiver corrompido
+ */
+int capture_next(CaptureReader *reader, CaptureRecord *record, char *data);
+
+/**
+ * @brief Volta ao início das mensagens de um ficheiro de captura.
+ *
+ * @param reader Leitor
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int capture_rewind(CaptureReader *reader);
+
+/**
+ * @brief Fecha um ficheiro de captura aberto para leitura.
+ *
+ * @param reader Leitor
+ */
+void capture_close(CaptureReader *reader);
+
+/**
+ * @brief Processa o comando "capture" para iniciar, terminar ou consultar a captura.
+ *
+ * @param arg Subcomando ("start", "stop" ou NULL)
+ * @param path Ficheiro de destino para "start"
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_capture(char *arg, char *path);
+
+#endif /* CAPTURE_H */
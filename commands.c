@@ -19,8 +19,47 @@
 #include "network.h"
 #include "objects.h"
 #include "debug_utils.h"
+#include "events.h"
+#include "metrics.h"
+#include "latency.h"
+#include "capture.h"
+#include "trace.h"
+#include "probes.h"
+#include "cost.h"
+#include "listing.h"
+#include "wire.h"
+#include "caps.h"
 #include "ndn.h"
 
+/**
+ * @brief Lê o tempo de vida de um pedido: milissegundos, com ou sem "ms", ou segundos com "s".
+ *
+ * @param text Texto a ler ("500", "500ms", "2s")
+ * @param lifetime_ms Tempo de vida lido
+ * @return 0 em caso de sucesso, -1 se o texto for inválido (já mostra o erro)
+ */
+static int parse_lifetime(const char *text, uint32_t *lifetime_ms)
+{
+    char *end;
+    unsigned long value = strtoul(text, &end, 10);
+    if (strcmp(end, "s") == 0)
+    {
+        value = value <= (unsigned long)INTEREST_LIFETIME_MAX ? value * 1000 : 0;
+    }
+    else if (*end != '\0' && strcmp(end, "ms") != 0)
+    {
+        value = 0;
+    }
+    if (end == text || value == 0 || value > (unsigned long)INTEREST_LIFETIME_MAX * 1000)
+    {
+        printf("%sInvalid lifetime '%s': use milliseconds (500, 500ms) or seconds (2s), up to %ds%s\n",
+               COLOR_RED, text, INTEREST_LIFETIME_MAX, COLOR_RESET);
+        return -1;
+    }
+    *lifetime_ms = (uint32_t)value;
+    return 0;
+}
+
 /**
  * @brief Processa um comando do utilizador.
  *
@@ -80,6 +119,21 @@ int process_command(char *cmd) {
         while (*next_param && isspace(*next_param)) {
             next_param++;
         }
+
+        /* O retrieve aceita o tempo de vida do interesse a seguir ao nome */
+        uint32_t lifetime_ms = 0;
+        int is_retrieve = strcmp(cmd_name, "retrieve") == 0 || strcmp(cmd_name, "r") == 0;
+        if (is_retrieve && *next_param && isdigit((unsigned char)*next_param)) {
+            char lifetime[MAX_CMD_SIZE] = {0};
+            sscanf(next_param, "%127s", lifetime);
+            if (parse_lifetime(lifetime, &lifetime_ms) < 0) {
+                return -1;
+            }
+            next_param += strlen(lifetime);
+            while (*next_param && isspace(*next_param)) {
+                next_param++;
+            }
+        }
         
         /* Se houver mais palavras, mostra um erro */
         if (*next_param) {
@@ -89,11 +143,11 @@ int process_command(char *cmd) {
         }
         
         /* Processa o comando com o nome do objeto validado */
-        if (strcmp(cmd_name, "retrieve") == 0 || strcmp(cmd_name, "r") == 0) {
+        if (is_retrieve) {
             if (*object_name) {
-                return cmd_retrieve(object_name);
+                return cmd_retrieve(object_name, lifetime_ms);
             } else {
-                printf("%sUsage: retrieve (r) <name>%s\n", COLOR_RED, COLOR_RESET);
+                printf("%sUsage: retrieve (r) <name> [lifetime]%s\n", COLOR_RED, COLOR_RESET);
                 return -1;
             }
         } else if (strcmp(cmd_name, "create") == 0 || strcmp(cmd_name, "c") == 0) {
@@ -149,15 +203,28 @@ int process_command(char *cmd) {
             if (strcmp(what, "topology") == 0) {
                 return cmd_show_topology();
             } else if (strcmp(what, "names") == 0) {
-                return cmd_show_names();
+                return cmd_show_names(strtok(NULL, " \n"));
             } else if (strcmp(what, "interest") == 0 || strcmp(what, "table") == 0) {
-                return cmd_show_interest_table();
+                char *prefix = strtok(NULL, " \n");
+                if (prefix != NULL && strcmp(what, "interest") == 0 && strcmp(prefix, "table") == 0) {
+                    prefix = strtok(NULL, " \n");
+                }
+                return cmd_show_interest_table(prefix);
+            } else if (strcmp(what, "stats") == 0) {
+                return cmd_show_stats();
+            } else if (strcmp(what, "latency") == 0) {
+                return cmd_show_latency();
+            } else if (strcmp(what, "cost") == 0) {
+                return cmd_show_cost();
+            } else if (strcmp(what, "events") == 0) {
+                char *count = strtok(NULL, " \n");
+                return cmd_show_events(count ? atoi(count) : 0);
             } else {
                 printf("%sUnknown show command: %s%s\n", COLOR_RED, what, COLOR_RESET);
                 return -1;
             }
         } else {
-            printf("%sUsage: show <topology|names|interest>%s\n", COLOR_RED, COLOR_RESET);
+            printf("%sUsage: show <topology|names|interest|events|stats|latency|cost>%s\n", COLOR_RED, COLOR_RESET);
             return -1;
         }
     }
@@ -165,9 +232,39 @@ int process_command(char *cmd) {
     else if (strcmp(cmd_name, "st") == 0) {
         return cmd_show_topology();
     } else if (strcmp(cmd_name, "sn") == 0) {
-        return cmd_show_names();
+        return cmd_show_names(token);
     } else if (strcmp(cmd_name, "si") == 0) {
-        return cmd_show_interest_table();
+        return cmd_show_interest_table(token);
+    } else if (strcmp(cmd_name, "more") == 0) {
+        return cmd_more(token);
+    } else if (strcmp(cmd_name, "se") == 0) {
+        return cmd_show_events(token ? atoi(token) : 0);
+    } else if (strcmp(cmd_name, "ss") == 0) {
+        return cmd_show_stats();
+    } else if (strcmp(cmd_name, "stats") == 0) {
+        return cmd_stats(token, strtok(NULL, " \n"));
+    } else if (strcmp(cmd_name, "sl") == 0) {
+        return cmd_show_latency();
+    } else if (strcmp(cmd_name, "latency") == 0) {
+        return cmd_latency(token);
+    } else if (strcmp(cmd_name, "sc") == 0) {
+        return cmd_show_cost();
+    } else if (strcmp(cmd_name, "cost") == 0) {
+        return cmd_cost(token);
+    } else if (strcmp(cmd_name, "capture") == 0) {
+        return cmd_capture(token, strtok(NULL, " \n"));
+    } else if (strcmp(cmd_name, "trace") == 0) {
+        return cmd_trace(token);
+    } else if (strcmp(cmd_name, "retrieve-batch") == 0 || strcmp(cmd_name, "rb") == 0) {
+        return cmd_retrieve_batch(token, strtok(NULL, " \n"));
+    } else if (strcmp(cmd_name, "caps") == 0) {
+        return cmd_caps(token, strtok(NULL, " \n"));
+    } else if (strcmp(cmd_name, "wire") == 0) {
+        return cmd_wire(token, strtok(NULL, " \n"));
+    } else if (strcmp(cmd_name, "monitor") == 0 || strcmp(cmd_name, "m") == 0) {
+        return cmd_monitor(token);
+    } else if (strcmp(cmd_name, "loglevel") == 0 || strcmp(cmd_name, "ll") == 0) {
+        return cmd_log_level(token);
     } else if (strcmp(cmd_name, "leave") == 0 || strcmp(cmd_name, "l") == 0) {
         return cmd_leave();
     } else if (strcmp(cmd_name, "exit") == 0 || strcmp(cmd_name, "x") == 0) {
@@ -195,10 +292,26 @@ void print_help()
     printf("  direct join (dj) <IP> <TCP>           - Join network directly through node <IP>:<TCP>\n");
     printf("  create (c) <name>                     - Create object with name <name>\n");
     printf("  delete (dl) <name>                    - Delete object with name <name>\n");
-    printf("  retrieve (r) <name>                   - Retrieve object with name <name>\n");
+    printf("  retrieve (r) <name> [lifetime]        - Retrieve object <name>, waiting at most lifetime (500ms, 2s)\n");
+    printf("  retrieve-batch (rb) <file> [lifetime] - Retrieve every object named in <file>, one per line\n");
     printf("  show topology (st)                    - Show network topology\n");
-    printf("  show names (sn)                       - Show objects stored in this node\n");
-    printf("  show interest table (si)              - Show interest table\n");
+    printf("  show names (sn) [prefix]              - Show objects stored in this node, one page at a time\n");
+    printf("  show interest table (si) [prefix]     - Show interest table, one page at a time\n");
+    printf("  more [all]                            - Show the next page (or the rest) of the current listing\n");
+    printf("  show events (se) [count]              - Show recent interest table events\n");
+    printf("  show stats (ss)                       - Show traffic, interest table and cache counters\n");
+    printf("  stats reset|listen <port>|close       - Reset counters or serve them on 127.0.0.1:<port>\n");
+    printf("  show latency (sl)                     - Show retrieve, upstream RTT and processing percentiles\n");
+    printf("  latency reset                         - Clear the latency histograms\n");
+    printf("  show cost (sc)                        - Show cycles and allocations per message by subsystem\n");
+    printf("  cost [on|off|reset]                   - Enable, disable or clear per-message cost accounting\n");
+    printf("  capture [start <file>|stop]           - Record all neighbor traffic to a binary trace\n");
+    printf("  trace [rate|percent%%|on|off]          - Show or set the fraction of retrieves traced hop by hop\n");
+    printf("  wire [on|off]                         - Show or set the binary wire format offered to neighbors\n");
+    printf("  wire dict <on|off>                    - Enable or disable name compression on binary links\n");
+    printf("  caps [<capability> on|off]            - Show or set the capabilities offered in ENTRY/SAFE\n");
+    printf("  monitor (m) [on|off]                  - Toggle live interest table updates\n");
+    printf("  loglevel (ll) [level]                 - Show or set log level (error|warn|info|debug|trace)\n");
     printf("  leave (l)                             - Leave the network\n");
     printf("  exit (x)                              - Exit the application\n");
     printf("  help (h)                              - Show this help message\n");
@@ -330,6 +443,7 @@ int cmd_direct_join(char *connect_ip, char *connect_port)
         /* Define o ID da rede */
         node.network_id = atoi(net);
         node.in_network = 1;
+        METRIC_INC(MET_TOPO_JOINS);
 
         /* Inicialmente, um nó isolado não tem vizinho externo */
         memset(node.ext_neighbor_ip, 0, INET_ADDRSTRLEN);
@@ -366,13 +480,14 @@ int cmd_direct_join(char *connect_ip, char *connect_port)
     if (send_entry_message(fd, node.ip, node.port) < 0)
     {
         printf("Failed to send ENTRY message.\n");
-        close(fd);
+        close_connection(fd);
         return -1;
     }
 
     /* Define o ID da rede */
     node.network_id = atoi(net);
     node.in_network = 1;
+    METRIC_INC(MET_TOPO_JOINS);
 
     printf("Joined network %s through %s:%s\n", net, connect_ip, connect_port);
     return 0;
@@ -453,49 +568,52 @@ int cmd_delete(char *name)
 }
 
 /**
- * @brief Obter um objeto.
- * 
- * Procura um objeto localmente (tanto na lista de objetos como na cache)
- * e, se não encontrar, envia uma mensagem de interesse pela rede.
+ * @brief Procura um objeto localmente e, se não o encontrar, pede-o aos vizinhos.
+ *
+ * Parte comum de cmd_retrieve e cmd_retrieve_batch. Dentro de um lote
+ * (send_batch_begin) os interesses para cada vizinho seguem agrupados.
  *
  * @param name Nome do objeto a obter
- * @return 0 em caso de sucesso, -1 em caso de erro
+ * @param lifetime_ms Tempo de vida do interesse (0 = INTEREST_TIMEOUT, sem o indicar)
+ * @param verbose 1 para mostrar cada passo, 0 para mostrar só os erros
+ * @return 1 se o objeto existir localmente ou na cache, 0 se o interesse
+ *         foi enviado, -1 em caso de erro
  */
-int cmd_retrieve(char *name)
+static int retrieve_name(char *name, uint32_t lifetime_ms, int verbose)
 {
-    if (name == NULL || strlen(name) == 0)
-    {
-        printf("%sError: Object name is required%s\n", COLOR_RED, COLOR_RESET);
-        return -1;
-    }
-
-    /* Verifica se há espaços no nome */
-    if (strchr(name, ' ') != NULL)
-    {
-        printf("%sError: Object name cannot contain spaces%s\n", COLOR_RED, COLOR_RESET);
-        return -1;
-    }
     if (!is_valid_name(name))
     {
-        printf("%sInvalid object name. Must be alphanumeric and up to %d characters.%s\n", 
-               COLOR_RED, MAX_OBJECT_NAME, COLOR_RESET);
+        printf("%sInvalid object name '%s'. Must be alphanumeric and up to %d characters.%s\n",
+               COLOR_RED, name, MAX_OBJECT_NAME, COLOR_RESET);
         return -1;
     }
 
     /* Verifica se o objeto existe localmente */
     if (find_object(name) >= 0)
     {
-        printf("%sObject '%s' found locally%s\n", COLOR_GREEN, name, COLOR_RESET);
-        return 0;
+        if (verbose)
+        {
+            printf("%sObject '%s' found locally%s\n", COLOR_GREEN, name, COLOR_RESET);
+        }
+        METRIC_INC(MET_LOCAL_HITS);
+        return 1;
     }
 
     /* Verifica se o objeto existe na cache */
     if (find_in_cache(name) >= 0)
     {
-        printf("%sObject '%s' found in cache%s\n", COLOR_GREEN, name, COLOR_RESET);
-        return 0;
+        if (verbose)
+        {
+            printf("%sObject '%s' found in cache%s\n", COLOR_GREEN, name, COLOR_RESET);
+        }
+        METRIC_INC(MET_CACHE_HITS);
+        NDN_PROBE1(cache_hit, name);
+        return 1;
     }
 
+    METRIC_INC(MET_CACHE_MISSES);
+    NDN_PROBE1(cache_miss, name);
+
     /* Verifica se está numa rede */
     if (!node.in_network)
     {
@@ -503,10 +621,29 @@ int cmd_retrieve(char *name)
         return -1;
     }
 
-    /* Verifica se tem vizinhos */
-    if (node.neighbors == NULL)
+    /* Verifica se tem vizinhos com IDs de interface válidos e quantos podem responder a tempo */
+    int eligible = 0, in_time = 0;
+    for (Neighbor *curr = node.neighbors; curr != NULL; curr = curr->next)
+    {
+        if (curr->interface_id > 0)
+        {
+            eligible++;
+            in_time += interest_face_in_time(curr, lifetime_ms);
+        }
+    }
+    if (eligible == 0)
     {
         printf("%sNo neighbors to send interest message to%s\n", COLOR_RED, COLOR_RESET);
+        METRIC_INC(MET_NO_ROUTE);
+        return -1;
+    }
+
+    /* Não cria a entrada se nenhum vizinho tiver alguma vez respondido dentro do tempo de vida */
+    if (in_time == 0)
+    {
+        printf("%sNo neighbor has answered within %u ms so far, not sending interest for %s%s\n",
+               COLOR_RED, lifetime_ms, name, COLOR_RESET);
+        METRIC_INC(MET_PIT_TOO_LATE);
         return -1;
     }
 
@@ -518,26 +655,65 @@ int cmd_retrieve(char *name)
         return -1;
     }
 
-    /* Marca um ID de interface especial para a interface local como RESPONSE */
+    /* Marca um ID de interface especial para a interface local como RESPONSE; o pedido local
+       tem o seu próprio prazo, mesmo que a entrada já aguarde com um prazo mais longo */
+    uint64_t deadline_ns = interest_deadline(lifetime_ms);
+    set_interest_deadline(entry, deadline_ns);
+    set_local_deadline(entry, deadline_ns);
     entry->interface_states[MAX_INTERFACE - 1] = RESPONSE;
-    printf("Marked local interface as RESPONSE for %s\n", name);
+    entry->local_request_ns = monotonic_ns();
+    if (entry->trace_id == 0)
+    {
+        entry->trace_id = trace_sample();
+    }
+    trace_span(entry->trace_id, "retrieve", name, MAX_INTERFACE - 1);
+    if (verbose)
+    {
+        printf("Marked local interface as RESPONSE for %s\n", name);
+    }
 
-    /* Envia interesse para vizinhos com IDs de interface válidos */
+    /* Se a entrada já aguarda respostas a montante, o pedido local fica agregado a ela: reenviar
+       o interesse chegaria também aos vizinhos que o pediram e que estão à espera dele */
+    for (int i = 1; i < MAX_INTERFACE - 1; i++)
+    {
+        if (entry->interface_states[i] == WAITING)
+        {
+            METRIC_INC(MET_PIT_AGGREGATED);
+            METRIC_INC(MET_RETRIEVE_REQUESTS);
+            if (verbose)
+            {
+                printf("%sInterest for object '%s' already pending, waiting for its answer%s\n",
+                       COLOR_YELLOW, name, COLOR_RESET);
+            }
+            return 0;
+        }
+    }
+
+    /* Envia interesse para vizinhos com IDs de interface válidos (no formato de cada um) */
     char message[MAX_BUFFER];
-    snprintf(message, MAX_BUFFER, "INTEREST %s\n", name);
+    uint32_t forward_lifetime_ms = lifetime_ms != 0 ? interest_local_lifetime_left(entry) : 0;
 
     int sent_count = 0;
     for (Neighbor *curr = node.neighbors; curr != NULL; curr = curr->next)
     {
-        /* Envia apenas para vizinhos com IDs de interface válidos (maiores que 0) */
-        if (curr->interface_id > 0)
+        /* Envia apenas para vizinhos com IDs de interface válidos (maiores que 0) e que possam responder a tempo */
+        if (curr->interface_id > 0 && interest_face_in_time(curr, forward_lifetime_ms))
         {
-            if (write(curr->fd, message, strlen(message)) > 0)
+            uint64_t sent_ns = monotonic_ns();
+            trace_span(entry->trace_id, "forward", name, curr->interface_id);
+            if (queue_name_message(curr->fd, WIRE_INTEREST, name, entry->trace_id, forward_lifetime_ms) ||
+                send_message(curr->fd, message,
+                             format_name_message(curr->fd, WIRE_INTEREST, name, entry->trace_id,
+                                                 forward_lifetime_ms, message)) > 0)
             {
                 entry->interface_states[curr->interface_id] = WAITING;
+                entry->waiting_since_ns[curr->interface_id] = sent_ns;
                 sent_count++;
-                printf("Sent interest for %s to neighbor at interface %d (marked WAITING)\n",
-                       name, curr->interface_id);
+                if (verbose)
+                {
+                    printf("Sent interest for %s to neighbor at interface %d (marked WAITING)\n",
+                           name, curr->interface_id);
+                }
             }
             else
             {
@@ -552,11 +728,119 @@ int cmd_retrieve(char *name)
         return -1;
     }
 
-    printf("%sInterest for object '%s' sent to %d interfaces%s\n", 
-           COLOR_YELLOW, name, sent_count, COLOR_RESET);
+    METRIC_INC(MET_RETRIEVE_REQUESTS);
+    if (verbose)
+    {
+        printf("%sInterest for object '%s' sent to %d interfaces%s\n",
+               COLOR_YELLOW, name, sent_count, COLOR_RESET);
+    }
     return 0;
 }
 
+/**
+ * @brief Obter um objeto.
+ * 
+ * Procura um objeto localmente (tanto na lista de objetos como na cache)
+ * e, se não encontrar, envia uma mensagem de interesse pela rede.
+ *
+ * @param name Nome do objeto a obter
+ * @param lifetime_ms Tempo de vida do interesse (0 = INTEREST_TIMEOUT)
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_retrieve(char *name, uint32_t lifetime_ms)
+{
+    if (name == NULL || strlen(name) == 0)
+    {
+        printf("%sError: Object name is required%s\n", COLOR_RED, COLOR_RESET);
+        return -1;
+    }
+
+    /* Verifica se há espaços no nome */
+    if (strchr(name, ' ') != NULL)
+    {
+        printf("%sError: Object name cannot contain spaces%s\n", COLOR_RED, COLOR_RESET);
+        return -1;
+    }
+
+    return retrieve_name(name, lifetime_ms, 1) < 0 ? -1 : 0;
+}
+
+/**
+ * @brief Obter todos os objetos cujos nomes estão num ficheiro.
+ *
+ * Lê um nome por linha (linhas vazias e começadas por '#' são ignoradas) e
+ * trata cada um como cmd_retrieve, mas dentro de um único lote: para os
+ * vizinhos com a capacidade "batch", os interesses seguem em poucas tramas
+ * em vez de uma por nome.
+ *
+ * @param file Caminho do ficheiro com os nomes
+ * @param lifetime Tempo de vida dos interesses, ou NULL para INTEREST_TIMEOUT
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_retrieve_batch(char *file, char *lifetime)
+{
+    if (file == NULL)
+    {
+        printf("%sUsage: retrieve-batch (rb) <file> [lifetime]%s\n", COLOR_RED, COLOR_RESET);
+        return -1;
+    }
+    uint32_t lifetime_ms = 0;
+    if (lifetime != NULL && parse_lifetime(lifetime, &lifetime_ms) < 0)
+    {
+        return -1;
+    }
+
+    FILE *fp = fopen(file, "r");
+    if (fp == NULL)
+    {
+        printf("%sCannot open %s: %s%s\n", COLOR_RED, file, strerror(errno), COLOR_RESET);
+        return -1;
+    }
+
+    char line[MAX_BUFFER];
+    int names = 0, found = 0, sent = 0, failed = 0;
+
+    send_batch_begin();
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        char *name = line;
+        while (isspace((unsigned char)*name))
+        {
+            name++;
+        }
+        size_t len = strlen(name);
+        while (len > 0 && isspace((unsigned char)name[len - 1]))
+        {
+            name[--len] = '\0';
+        }
+        if (len == 0 || name[0] == '#')
+        {
+            continue;
+        }
+
+        names++;
+        int result = retrieve_name(name, lifetime_ms, 0);
+        if (result > 0)
+        {
+            found++;
+        }
+        else if (result == 0)
+        {
+            sent++;
+        }
+        else
+        {
+            failed++;
+        }
+    }
+    send_batch_end();
+    fclose(fp);
+
+    printf("%s%d names: %d found locally or in cache, %d interests sent, %d failed%s\n",
+           failed ? COLOR_YELLOW : COLOR_GREEN, names, found, sent, failed, COLOR_RESET);
+    return names > 0 && failed == names ? -1 : 0;
+}
+
 /**
  * @brief Mostrar a topologia da rede.
  *
@@ -660,306 +944,86 @@ int cmd_show_topology()
     return 0;
 }
 
-
 /**
- * @brief Mostrar nomes de objetos armazenados.
+ * @brief Mostrar ou alterar o formato binário oferecido aos vizinhos.
  *
- * Lista todos os objetos locais e em cache armazenados no nó.
- * Apresenta informações de forma organizada com contagens e formatação.
+ * Sem argumento, mostra se o formato está ligado e o formato usado para
+ * enviar a cada vizinho. A alteração vale para os envios seguintes; os
+ * vizinhos só deixam de enviar tramas binárias no próximo ENTRY ou SAFE.
+ * "wire dict on|off" liga ou desliga da mesma forma a compressão de nomes.
+ * São atalhos para "caps wire" e "caps dict" (caps.h).
  *
+ * @param arg "on", "off", "dict" ou NULL para mostrar o estado
+ * @param value "on" ou "off" depois de "dict"
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int cmd_show_names()
+int cmd_wire(char *arg, char *value)
 {
-    int local_count = 0;
-    int cache_count = 0;
-    Object *obj;
-
-    // Count objects first
-    obj = node.objects;
-    while (obj != NULL)
-    {
-        local_count++;
-        obj = obj->next;
-    }
-
-    obj = node.cache;
-    while (obj != NULL)
-    {
-        cache_count++;
-        obj = obj->next;
-    }
-
-    // Print header
-    printf("\n%s%s┌───────────────────────────────────────────────────┐%s\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
-    printf("%s%s│               STORED OBJECTS                       │%s\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
-    printf("%s%s└───────────────────────────────────────────────────┘%s\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
-
-    // Print local objects
-    printf("%s%sLOCAL OBJECTS (%d):%s\n", COLOR_BOLD, COLOR_GREEN, local_count, COLOR_RESET);
-    if (local_count == 0)
-    {
-        printf("  No objects stored locally\n");
-    }
-    else
+    if (arg != NULL)
     {
-        int col = 0;
-        obj = node.objects;
-        while (obj != NULL)
+        if (strcmp(arg, "dict") == 0 && value != NULL &&
+            (strcmp(value, "on") == 0 || strcmp(value, "off") == 0))
         {
-            printf("  %s%-24s%s", COLOR_GREEN, obj->name, COLOR_RESET);
-            col++;
-            if (col == 3)
-            {
-                printf("\n");
-                col = 0;
-            }
-            obj = obj->next;
+            return cmd_caps("dict", value);
+        }
+        else if (strcmp(arg, "on") == 0 || strcmp(arg, "off") == 0)
+        {
+            return cmd_caps("wire", arg);
+        }
+        else
+        {
+            printf("%sUsage: wire [on|off] | wire dict <on|off>%s\n", COLOR_RED, COLOR_RESET);
+            return -1;
         }
-        if (col != 0)
-            printf("\n"); // End the line if not already done
     }
 
-    // Print cache objects
-    printf("\n%s%sCACHED OBJECTS (%d/%d):%s\n", COLOR_BOLD, COLOR_YELLOW, cache_count, node.cache_size, COLOR_RESET);
-    if (cache_count == 0)
-    {
-        printf("  Cache is empty\n");
-    }
-    else
+    printf("Binary wire format %s, name compression %s\n",
+           caps_enabled & CAP_BIT(CAP_WIRE_TLV) ? "offered to neighbors" : "disabled (text only)",
+           caps_enabled & CAP_BIT(CAP_NAME_DICT) ? "on" : "off");
+    for (Neighbor *curr = node.neighbors; curr != NULL; curr = curr->next)
     {
-        int col = 0;
-        obj = node.cache;
-        while (obj != NULL)
+        if (caps_use(&curr->caps, CAP_WIRE_TLV) && caps_use(&curr->caps, CAP_NAME_DICT))
         {
-            printf("  %s%-24s%s", COLOR_YELLOW, obj->name, COLOR_RESET);
-            col++;
-            if (col == 3)
-            {
-                printf("\n");
-                col = 0;
-            }
-            obj = obj->next;
+            printf("  interface %d %s:%s: binary, name table of %u\n", curr->interface_id,
+                   curr->ip, curr->port, curr->caps.value[CAP_NAME_DICT]);
+        }
+        else
+        {
+            printf("  interface %d %s:%s: %s\n", curr->interface_id, curr->ip, curr->port,
+                   caps_use(&curr->caps, CAP_WIRE_TLV) ? "binary" : "text");
         }
-        if (col != 0)
-            printf("\n"); // End the line if not already done
     }
-
-    printf("\n");
     return 0;
 }
 
 /**
- * @brief Mostrar a tabela de interesses.
+ * @brief Mostrar nomes de objetos armazenados.
  *
- * Apresenta informações detalhadas sobre todos os interesses pendentes,
- * incluindo o nome do objeto, interfaces marcadas como RESPONSE, WAITING ou CLOSED,
- * e a idade do interesse.
+ * Começa a listagem paginada dos objetos locais e em cache. A listagem é
+ * escrita de forma incremental pelo ciclo principal (ver listing.h).
  *
+ * @param prefix Prefixo dos nomes a mostrar, ou NULL para todos
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int cmd_show_interest_table()
+int cmd_show_names(char *prefix)
 {
-    InterestEntry *entry = node.interest_table;
-    int entry_count = 0;
-
-    printf("\n%s%s┌───────────────────────────────────────────────────┐%s\n", COLOR_BOLD, COLOR_MAGENTA, COLOR_RESET);
-    printf("%s%s│               INTEREST TABLE                       │%s\n", COLOR_BOLD, COLOR_MAGENTA, COLOR_RESET);
-    printf("%s%s└───────────────────────────────────────────────────┘%s\n", COLOR_BOLD, COLOR_MAGENTA, COLOR_RESET);
-
-    if (entry == NULL)
-    {
-        printf("%sNo active interests%s\n\n", COLOR_YELLOW, COLOR_RESET);
-        return 0;
-    }
-
-    // First, collect information about valid interfaces (connected nodes)
-    int valid_interfaces[MAX_INTERFACE] = {0};
-    Neighbor *n;
-
-    // Mark the local interface as valid
-    valid_interfaces[MAX_INTERFACE - 1] = 1; // The local "interface"
-
-    // Mark interfaces corresponding to actual neighbors as valid
-    for (n = node.neighbors; n != NULL; n = n->next)
-    {
-        if (n->interface_id > 0 && n->interface_id < MAX_INTERFACE)
-        {
-            valid_interfaces[n->interface_id] = 1;
-        }
-    }
-
-    while (entry != NULL)
-    {
-        entry_count++;
-        printf("%s%sINTEREST:%s \"%s%s%s\"\n",
-               COLOR_BOLD, COLOR_BLUE, COLOR_RESET,
-               COLOR_CYAN, entry->name, COLOR_RESET);
-
-        int response_count = 0;
-        int waiting_count = 0;
-        int closed_count = 0;
-
-        // Count states but only for valid interfaces
-        for (int i = 0; i < MAX_INTERFACE; i++)
-        {
-            if (valid_interfaces[i])
-            {
-                if (entry->interface_states[i] == RESPONSE)
-                    response_count++;
-                else if (entry->interface_states[i] == WAITING)
-                    waiting_count++;
-                else if (entry->interface_states[i] == CLOSED)
-                    closed_count++;
-            }
-        }
-
-        printf("  %sSummary:%s %s%d response%s, %s%d waiting%s, %s%d closed%s\n",
-               COLOR_BOLD, COLOR_RESET,
-               COLOR_GREEN, response_count, COLOR_RESET,
-               COLOR_YELLOW, waiting_count, COLOR_RESET,
-               COLOR_RED, closed_count, COLOR_RESET);
-
-        // Then list each interface with a state, but only valid ones
-        printf("  %sInterfaces:%s\n", COLOR_BOLD, COLOR_RESET);
-
-        // First RESPONSE interfaces
-        if (response_count > 0)
-        {
-            printf("    %s%sRESPONSE:%s ", COLOR_BOLD, COLOR_GREEN, COLOR_RESET);
-            int first = 1;
-            for (int i = 0; i < MAX_INTERFACE; i++)
-            {
-                // Only show if it's a valid interface and has RESPONSE state
-                if (valid_interfaces[i] && entry->interface_states[i] == RESPONSE)
-                {
-                    if (!first)
-                        printf(", ");
-
-                    if (i == MAX_INTERFACE - 1)
-                    {
-                        printf("%sLOCAL%s", COLOR_CYAN, COLOR_RESET);
-                    }
-                    else
-                    {
-                        // Find neighbor name for this interface
-                        char neighbor_info[50] = "";
-                        for (n = node.neighbors; n != NULL; n = n->next)
-                        {
-                            if (n->interface_id == i)
-                            {
-                                snprintf(neighbor_info, sizeof(neighbor_info), "%s:%s", n->ip, n->port);
-                                break;
-                            }
-                        }
-
-                        if (strlen(neighbor_info) > 0)
-                        {
-                            printf("%s%d%s (%s)", COLOR_GREEN, i, COLOR_RESET, neighbor_info);
-                        }
-                        else
-                        {
-                            printf("%s%d%s", COLOR_GREEN, i, COLOR_RESET);
-                        }
-                    }
-
-                    first = 0;
-                }
-            }
-            printf("\n");
-        }
-
-        // Then WAITING interfaces
-        if (waiting_count > 0)
-        {
-            printf("    %s%sWAITING: %s ", COLOR_BOLD, COLOR_YELLOW, COLOR_RESET);
-            int first = 1;
-            for (int i = 0; i < MAX_INTERFACE; i++)
-            {
-                // Only show if it's a valid interface and has WAITING state
-                if (valid_interfaces[i] && entry->interface_states[i] == WAITING)
-                {
-                    if (!first)
-                        printf(", ");
-
-                    // Find neighbor name for this interface
-                    char neighbor_info[50] = "";
-                    for (n = node.neighbors; n != NULL; n = n->next)
-                    {
-                        if (n->interface_id == i)
-                        {
-                            snprintf(neighbor_info, sizeof(neighbor_info), "%s:%s", n->ip, n->port);
-                            break;
-                        }
-                    }
-
-                    if (strlen(neighbor_info) > 0)
-                    {
-                        printf("%s%d%s (%s)", COLOR_YELLOW, i, COLOR_RESET, neighbor_info);
-                    }
-                    else
-                    {
-                        printf("%s%d%s", COLOR_YELLOW, i, COLOR_RESET);
-                    }
-
-                    first = 0;
-                }
-            }
-            printf("\n");
-        }
-
-        // Then CLOSED interfaces
-        if (closed_count > 0)
-        {
-            printf("    %s%sCLOSED:  %s ", COLOR_BOLD, COLOR_RED, COLOR_RESET);
-            int first = 1;
-            for (int i = 0; i < MAX_INTERFACE; i++)
-            {
-                // Only show if it's a valid interface and has CLOSED state
-                if (valid_interfaces[i] && entry->interface_states[i] == CLOSED)
-                {
-                    if (!first)
-                        printf(", ");
-
-                    // Find neighbor name for this interface
-                    char neighbor_info[50] = "";
-                    for (n = node.neighbors; n != NULL; n = n->next)
-                    {
-                        if (n->interface_id == i)
-                        {
-                            snprintf(neighbor_info, sizeof(neighbor_info), "%s:%s", n->ip, n->port);
-                            break;
-                        }
-                    }
-
-                    if (strlen(neighbor_info) > 0)
-                    {
-                        printf("%s%d%s (%s)", COLOR_RED, i, COLOR_RESET, neighbor_info);
-                    }
-                    else
-                    {
-                        printf("%s%d%s", COLOR_RED, i, COLOR_RESET);
-                    }
-
-                    first = 0;
-                }
-            }
-            printf("\n");
-        }
-
-        // Show age of interest
-        time_t now = time(NULL);
-        int age = (int)difftime(now, entry->timestamp);
-        printf("  %sAge:%s %s%d seconds%s\n",
-               COLOR_BOLD, COLOR_RESET,
-               (age > 5) ? COLOR_YELLOW : COLOR_GREEN, age, COLOR_RESET);
-
-        printf("\n");
-        entry = entry->next;
-    }
+    return listing_start_names(prefix);
+}
 
-    printf("%s%sTotal entries: %d%s\n\n", COLOR_BOLD, COLOR_BLUE, entry_count, COLOR_RESET);
-    return 0;
+/**
+ * @brief Mostrar a tabela de interesses.
+ *
+ * Começa a listagem paginada dos interesses pendentes, com o nome do
+ * objeto, as interfaces marcadas como RESPONSE, WAITING ou CLOSED e a
+ * idade do interesse. A listagem é escrita de forma incremental pelo
+ * ciclo principal (ver listing.h).
+ *
+ * @param prefix Prefixo dos nomes a mostrar, ou NULL para todos
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_show_interest_table(char *prefix)
+{
+    return listing_start_interests(prefix);
 }
 
 /**
@@ -989,7 +1053,7 @@ int cmd_leave()
     while (curr != NULL)
     {
         Neighbor *next = curr->next;
-        Neighbor *new_copy = malloc(sizeof(Neighbor));
+        Neighbor *new_copy = cost_malloc(sizeof(Neighbor));
         if (new_copy != NULL)
         {
             memcpy(new_copy, curr, sizeof(Neighbor));
@@ -999,8 +1063,8 @@ int cmd_leave()
         curr = next;
     }
 
-    /* Envia mensagem de cancelamento de registo ao servidor */
-    if (send_unreg_message(net_str, node.ip, node.port) < 0)
+    /* Envia mensagem de cancelamento de registo ao servidor (um nó que entrou com dj não está registado) */
+    if (node.registered && send_unreg_message(net_str, node.ip, node.port) < 0)
     {
         printf("Failed to unregister from the network.\n");
 
@@ -1026,11 +1090,11 @@ int cmd_leave()
         {
             if (actual_neighbor->fd == neighbor_copy->fd)
             {
-                /* Fecha o socket com verificação de erros */
-                if (close(neighbor_copy->fd) < 0)
-                {
-                    perror("close");
-                }
+                /* Fecha a ligação (close_connection assinala os erros) */
+                release_interface(neighbor_copy->interface_id);
+                NDN_PROBE2(face_down, neighbor_copy->interface_id, neighbor_copy->fd);
+                close_connection(neighbor_copy->fd);
+                METRIC_INC(MET_TOPO_NEIGHBOR_DOWN);
                 break;
             }
             actual_neighbor = actual_neighbor->next;
@@ -1045,6 +1109,8 @@ int cmd_leave()
     while (curr != NULL)
     {
         Neighbor *next = curr->next;
+        free(curr->dict_tx);
+        free(curr->dict_rx);
         free(curr);
         curr = next;
     }
@@ -1068,6 +1134,8 @@ int cmd_leave()
     memset(node.safe_node_port, 0, 6);
 
     node.in_network = 0;
+    node.registered = 0;
+    METRIC_INC(MET_TOPO_LEAVES);
     printf("Left network %03d\n", node.network_id);
     
     /* Reinicializa a interface de usuário após sair da rede */
@@ -1152,7 +1220,7 @@ int cmd_leave_no_UI()
     while (curr != NULL)
     {
         Neighbor *next = curr->next;
-        Neighbor *new_copy = malloc(sizeof(Neighbor));
+        Neighbor *new_copy = cost_malloc(sizeof(Neighbor));
         if (new_copy != NULL)
         {
             memcpy(new_copy, curr, sizeof(Neighbor));
@@ -1162,8 +1230,8 @@ int cmd_leave_no_UI()
         curr = next;
     }
 
-    /* Envia mensagem de cancelamento de registo ao servidor */
-    if (send_unreg_message(net_str, node.ip, node.port) < 0)
+    /* Envia mensagem de cancelamento de registo ao servidor (um nó que entrou com dj não está registado) */
+    if (node.registered && send_unreg_message(net_str, node.ip, node.port) < 0)
     {
         printf("Failed to unregister from the network.\n");
 
@@ -1189,11 +1257,11 @@ int cmd_leave_no_UI()
         {
             if (actual_neighbor->fd == neighbor_copy->fd)
             {
-                /* Fecha o socket com verificação de erros */
-                if (close(neighbor_copy->fd) < 0)
-                {
-                    perror("close");
-                }
+                /* Fecha a ligação (close_connection assinala os erros) */
+                release_interface(neighbor_copy->interface_id);
+                NDN_PROBE2(face_down, neighbor_copy->interface_id, neighbor_copy->fd);
+                close_connection(neighbor_copy->fd);
+                METRIC_INC(MET_TOPO_NEIGHBOR_DOWN);
                 break;
             }
             actual_neighbor = actual_neighbor->next;
@@ -1208,6 +1276,8 @@ int cmd_leave_no_UI()
     while (curr != NULL)
     {
         Neighbor *next = curr->next;
+        free(curr->dict_tx);
+        free(curr->dict_rx);
         free(curr);
         curr = next;
     }
@@ -1231,6 +1301,8 @@ int cmd_leave_no_UI()
     memset(node.safe_node_port, 0, 6);
 
     node.in_network = 0;
+    node.registered = 0;
+    METRIC_INC(MET_TOPO_LEAVES);
     printf("Left network %03d\n", node.network_id);
     return 0;
 }
@@ -68,9 +68,22 @@ int cmd_delete(char *name);
  * de interesse na rede para localizar o objeto.
  * 
  * @param name Nome do objeto a obter
+ * @param lifetime_ms Tempo de vida do interesse (0 = INTEREST_TIMEOUT)
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int cmd_retrieve(char *name);
+int cmd_retrieve(char *name, uint32_t lifetime_ms);
+
+/**
+ * @brief Processa o comando "retrieve-batch" (rb) para obter vários objetos.
+ * 
+ * Obtém cada objeto nomeado no ficheiro (um nome por linha), agrupando os
+ * interesses enviados a cada vizinho.
+ * 
+ * @param file Ficheiro com os nomes dos objetos
+ * @param lifetime Tempo de vida dos interesses ("500", "500ms", "2s"), ou NULL
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_retrieve_batch(char *file, char *lifetime);
 
 /**
  * @brief Processa o comando "show topology" (st) para mostrar a topologia da rede.
@@ -84,21 +97,23 @@ int cmd_show_topology();
 /**
  * @brief Processa o comando "show names" (sn) para mostrar os objetos armazenados.
  * 
- * Lista todos os objetos locais e em cache armazenados no nó.
+ * Lista, uma página de cada vez, os objetos locais e em cache armazenados no nó.
  * 
+ * @param prefix Prefixo dos nomes a mostrar, ou NULL para todos
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int cmd_show_names();
+int cmd_show_names(char *prefix);
 
 /**
  * @brief Processa o comando "show interest table" (si) para mostrar a tabela de interesses.
  * 
  * Mostra a tabela de interesses pendentes, incluindo informações sobre
- * as interfaces e seus estados para cada objeto solicitado.
+ * as interfaces e seus estados para cada objeto solicitado, uma página de cada vez.
  * 
+ * @param prefix Prefixo dos nomes a mostrar, ou NULL para todos
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int cmd_show_interest_table();
+int cmd_show_interest_table(char *prefix);
 
 /**
  * @brief Processa o comando "leave" (l) para sair da rede.
@@ -119,6 +134,15 @@ int cmd_leave();
  */
 int cmd_leave_no_UI();
 
+/**
+ * @brief Processa o comando "wire" para mostrar ou alterar o formato binário.
+ *
+ * @param arg "on", "off", "dict" ou NULL para mostrar o estado
+ * @param value "on" ou "off" depois de "dict"
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_wire(char *arg, char *value);
+
 /**
  * @brief Processa o comando "exit" (x) para sair da aplicação.
  * 
@@ -0,0 +1,162 @@
+/**
+ * @file cost.c
+ * @brief Implementação da contabilização de ciclos e alocações por mensagem
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a acumulação do custo de cada mensagem por tipo e
+ * os comandos "show cost" e "cost".
+ */
+
+#include "cost.h"
+
+int cost_enabled = 0;
+CostState cost_state;
+CostCounters cost_totals[MSG_TYPE_COUNT];
+uint64_t cost_messages[MSG_TYPE_COUNT];
+
+/* Instantes do início da contabilização, para estimar a frequência do TSC */
+static uint64_t start_ticks = 0;
+static uint64_t start_ns = 0;
+
+static const char *subsystem_names[COST_SUBSYSTEM_COUNT] = {
+    "parse", "pit", "cache", "send", "log", "other"
+};
+
+/**
+ * @brief Termina a mensagem atual e soma o seu custo ao tipo indicado.
+ *
+ * @param type Tipo da mensagem processada
+ */
+void cost_message_end(MsgType type) {
+    if (!cost_state.active) {
+        return;
+    }
+    cost_charge();
+    cost_state.active = 0;
+
+    CostCounters *total = &cost_totals[type];
+    for (int s = 0; s < COST_SUBSYSTEM_COUNT; s++) {
+        total->ticks[s] += cost_state.current.ticks[s];
+        total->allocs[s] += cost_state.current.allocs[s];
+        total->alloc_bytes[s] += cost_state.current.alloc_bytes[s];
+    }
+    cost_messages[type]++;
+}
+
+/**
+ * @brief Limpa os custos acumulados.
+ */
+void cost_reset() {
+    memset(cost_totals, 0, sizeof(cost_totals));
+    memset(cost_messages, 0, sizeof(cost_messages));
+    start_ticks = cost_ticks();
+    start_ns = monotonic_ns();
+}
+
+/**
+ * @brief Processa o comando "show cost" para mostrar ciclos e alocações por mensagem.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_show_cost() {
+    printf("\n%s%s┌───────────────────────────────────────────────────┐%s\n", COLOR_BOLD, COLOR_BLUE, COLOR_RESET);
+    printf("%s%s│                COST PER MESSAGE TYPE              │%s\n", COLOR_BOLD, COLOR_BLUE, COLOR_RESET);
+    printf("%s%s└───────────────────────────────────────────────────┘%s\n", COLOR_BOLD, COLOR_BLUE, COLOR_RESET);
+
+    printf("Accounting: %s%s%s\n", cost_enabled ? COLOR_GREEN : COLOR_YELLOW,
+           cost_enabled ? "on" : "off (enable with 'cost on')", COLOR_RESET);
+
+    uint64_t total_messages = 0;
+    for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+        total_messages += cost_messages[t];
+    }
+    if (total_messages == 0) {
+        printf("%sNo messages accounted%s\n\n", COLOR_YELLOW, COLOR_RESET);
+        return 0;
+    }
+
+#ifdef COST_HAVE_TSC
+    const char *unit = "cycles";
+    uint64_t elapsed_ns = monotonic_ns() - start_ns;
+    if (elapsed_ns > 0) {
+        printf("TSC frequency: ~%.2f GHz\n", (double)(cost_ticks() - start_ticks) / elapsed_ns);
+    }
+#else
+    const char *unit = "ns";
+#endif
+
+    printf("%sTime per message (%s):%s\n", COLOR_CYAN, unit, COLOR_RESET);
+    printf("%s  %-9s %9s", COLOR_BOLD, "type", "msgs");
+    for (int s = 0; s < COST_SUBSYSTEM_COUNT; s++) {
+        printf(" %8s", subsystem_names[s]);
+    }
+    printf(" %9s%s\n", "total", COLOR_RESET);
+
+    for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+        if (cost_messages[t] == 0) {
+            continue;
+        }
+        double n = (double)cost_messages[t];
+        uint64_t sum = 0;
+        printf("  %-9s %9llu", metrics_type_name(t), (unsigned long long)cost_messages[t]);
+        for (int s = 0; s < COST_SUBSYSTEM_COUNT; s++) {
+            printf(" %8.0f", cost_totals[t].ticks[s] / n);
+            sum += cost_totals[t].ticks[s];
+        }
+        printf(" %9.0f\n", sum / n);
+    }
+
+    printf("%sAllocations per message:%s\n", COLOR_CYAN, COLOR_RESET);
+    printf("%s  %-9s %9s", COLOR_BOLD, "type", "msgs");
+    for (int s = 0; s < COST_SUBSYSTEM_COUNT; s++) {
+        printf(" %8s", subsystem_names[s]);
+    }
+    printf(" %9s%s\n", "bytes", COLOR_RESET);
+
+    for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+        if (cost_messages[t] == 0) {
+            continue;
+        }
+        double n = (double)cost_messages[t];
+        uint64_t bytes = 0;
+        printf("  %-9s %9llu", metrics_type_name(t), (unsigned long long)cost_messages[t]);
+        for (int s = 0; s < COST_SUBSYSTEM_COUNT; s++) {
+            printf(" %8.2f", cost_totals[t].allocs[s] / n);
+            bytes += cost_totals[t].alloc_bytes[s];
+        }
+        printf(" %9.1f\n", bytes / n);
+    }
+    printf("\n");
+    return 0;
+}
+
+/**
+ * @brief Processa o comando "cost" para ligar, desligar ou limpar a contabilização.
+ *
+ * @param arg Subcomando (on, off ou reset), ou NULL para mostrar o estado
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_cost(char *arg) {
+    if (arg == NULL) {
+        return cmd_show_cost();
+    }
+
+    if (strcmp(arg, "on") == 0) {
+        if (!cost_enabled) {
+            cost_reset();
+            cost_enabled = 1;
+        }
+        printf("Cost accounting enabled\n");
+    } else if (strcmp(arg, "off") == 0) {
+        cost_enabled = 0;
+        printf("Cost accounting disabled\n");
+    } else if (strcmp(arg, "reset") == 0) {
+        cost_reset();
+        printf("Cost counters reset\n");
+    } else {
+        printf("%sUsage: cost [on|off|reset]%s\n", COLOR_RED, COLOR_RESET);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,224 @@
+/**
+ * @file cost.h
+ * @brief Contabilização de ciclos e alocações por subsistema e tipo de mensagem
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém as declarações da contabilização opcional do custo
+ * de cada mensagem recebida. Enquanto uma mensagem é processada em
+ * handle_network_events, o tempo (ciclos do TSC em x86, nanossegundos
+ * nas outras arquiteturas) é atribuído ao subsistema ativo:
+ *
+ * - parse: classificação e leitura da mensagem
+ * - pit: funções da tabela de interesses
+ * - cache: procura e inserção em objetos e cache
+ * - send: escrita nos sockets
+ * - log: registos
+ * - other: restante lógica de encaminhamento
+ *
+ * Os subsistemas formam uma pilha (a PIT pode chamar o registo, por
+ * exemplo) e cada intervalo é atribuído apenas ao subsistema do topo,
+ * pelo que os valores são exclusivos e somam o total. As alocações feitas
+ * com cost_malloc são contadas no subsistema do topo. Desligada, cada
+ * ponto de medida custa apenas uma comparação.
+ */
+
+#ifndef COST_H
+#define COST_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "metrics.h"
+#include "latency.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define COST_HAVE_TSC 1
+#endif
+
+#define COST_STACK_DEPTH 8
+
+/**
+ * @brief Subsistemas a que o custo de uma mensagem é atribuído.
+ */
+typedef enum cost_subsystem {
+    COST_PARSE = 0,
+    COST_PIT,
+    COST_CACHE,
+    COST_SEND,
+    COST_LOG,
+    COST_OTHER,
+    COST_SUBSYSTEM_COUNT
+} CostSubsystem;
+
+/**
+ * @brief Custo acumulado por subsistema.
+ */
+typedef struct cost_counters {
+    uint64_t ticks[COST_SUBSYSTEM_COUNT];           /* Ciclos (ou ns) exclusivos */
+    uint64_t allocs[COST_SUBSYSTEM_COUNT];          /* Número de alocações */
+    uint64_t alloc_bytes[COST_SUBSYSTEM_COUNT];     /* Bytes alocados */
+} CostCounters;
+
+/**
+ * @brief Estado da mensagem em processamento.
+ */
+typedef struct cost_state {
+    int active;                                     /* 1 enquanto se processa uma mensagem */
+    int depth;                                      /* Topo da pilha de subsistemas */
+    CostSubsystem stack[COST_STACK_DEPTH];          /* Pilha de subsistemas ativos */
+    uint64_t mark;                                  /* Instante da última atribuição */
+    CostCounters current;                           /* Custo da mensagem atual */
+} CostState;
+
+/**
+ * @brief Contabilização ligada (comando "cost on").
+ */
+extern int cost_enabled;
+
+/**
+ * @brief Estado da mensagem atual, escrito apenas pelo ciclo principal.
+ */
+extern CostState cost_state;
+
+/**
+ * @brief Custo acumulado por tipo de mensagem.
+ */
+extern CostCounters cost_totals[MSG_TYPE_COUNT];
+
+/**
+ * @brief Número de mensagens contabilizadas por tipo.
+ */
+extern uint64_t cost_messages[MSG_TYPE_COUNT];
+
+/**
+ * @brief Lê o contador de tempo usado na contabilização.
+ *
+ * @return Ciclos do TSC em x86, nanossegundos monotónicos nas outras arquiteturas
+ */
+static inline uint64_t cost_ticks() {
+#ifdef COST_HAVE_TSC
+    return __rdtsc();
+#else
+    return monotonic_ns();
+#endif
+}
+
+/**
+ * @brief Atribui o tempo decorrido desde a última marca ao subsistema do topo.
+ */
+static inline void cost_charge() {
+    uint64_t now = cost_ticks();
+    cost_state.current.ticks[cost_state.stack[cost_state.depth]] += now - cost_state.mark;
+    cost_state.mark = now;
+}
+
+/**
+ * @brief Começa a contabilizar uma mensagem recebida (subsistema parse).
+ */
+static inline void cost_message_begin() {
+    if (!cost_enabled) {
+        return;
+    }
+    memset(&cost_state.current, 0, sizeof(cost_state.current));
+    cost_state.active = 1;
+    cost_state.depth = 0;
+    cost_state.stack[0] = COST_PARSE;
+    cost_state.mark = cost_ticks();
+}
+
+/**
+ * @brief Marca o fim da leitura da mensagem; o resto conta como other.
+ */
+static inline void cost_message_parsed() {
+    if (cost_state.active && cost_state.depth == 0) {
+        cost_charge();
+        cost_state.stack[0] = COST_OTHER;
+    }
+}
+
+/**
+ * @brief Termina a mensagem atual e soma o seu custo ao tipo indicado.
+ *
+ * @param type Tipo da mensagem processada
+ */
+void cost_message_end(MsgType type);
+
+/**
+ * @brief Entra num subsistema.
+ *
+ * @param subsystem Subsistema que passa a receber o tempo
+ * @return 1 se foi empilhado (e deve ser retirado com cost_exit), 0 caso contrário
+ */
+static inline int cost_enter(CostSubsystem subsystem) {
+    if (!cost_state.active || cost_state.depth >= COST_STACK_DEPTH - 1) {
+        return 0;
+    }
+    cost_charge();
+    cost_state.stack[++cost_state.depth] = subsystem;
+    return 1;
+}
+
+/**
+ * @brief Sai do subsistema do topo.
+ */
+static inline void cost_exit() {
+    if (cost_state.active && cost_state.depth > 0) {
+        cost_charge();
+        cost_state.depth--;
+    }
+}
+
+/**
+ * @brief Função de limpeza usada por COST_SCOPE.
+ */
+static inline void cost_scope_exit(int *pushed) {
+    if (*pushed) {
+        cost_exit();
+    }
+}
+
+/**
+ * @brief Atribui o resto do bloco atual (até qualquer return) a um subsistema.
+ */
+#define COST_SCOPE(subsystem) \
+    int cost_scope_ __attribute__((cleanup(cost_scope_exit), unused)) = cost_enter(subsystem)
+
+/**
+ * @brief Aloca memória e conta a alocação no subsistema do topo.
+ *
+ * @param size Número de bytes
+ * @return Memória alocada, ou NULL em caso de erro
+ */
+static inline void *cost_malloc(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr != NULL && cost_state.active) {
+        CostSubsystem top = cost_state.stack[cost_state.depth];
+        cost_state.current.allocs[top]++;
+        cost_state.current.alloc_bytes[top] += size;
+    }
+    return ptr;
+}
+
+/**
+ * @brief Limpa os custos acumulados.
+ */
+void cost_reset();
+
+/**
+ * @brief Processa o comando "show cost" para mostrar ciclos e alocações por mensagem.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_show_cost();
+
+/**
+ * @brief Processa o comando "cost" para ligar, desligar ou limpar a contabilização.
+ *
+ * @param arg Subcomando (on, off ou reset), ou NULL para mostrar o estado
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_cost(char *arg);
+
+#endif /* COST_H */
@@ -9,13 +9,18 @@
  * 
  * Inclui:
  * - Funções para mostrar informações detalhadas sobre estado do nó
- * - Funções para registar mensagens com níveis de importância
+ * - Funções para registar mensagens com níveis de importância, escritas
+ *   de forma assíncrona a partir de um buffer circular por thread
  * - Utilitários para validação de estruturas de dados
  * - Conversores entre estados e suas representações em string
  */
 
 #include "debug_utils.h"
+#include "cost.h"
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <strings.h>
 
 /* Nível de registo predefinido */
 LogLevel current_log_level = LOG_INFO;
@@ -24,44 +29,418 @@ LogLevel current_log_level = LOG_INFO;
 int debug_mode = 0;
 
 /**
- * @brief Regista uma mensagem se o nível de registo atual for >= ao nível especificado.
- * 
- * Gera um registo formatado com data/hora e prefixo indicando o nível de importância.
- * 
+ * @brief Registo guardado no buffer circular, já formatado.
+ */
+typedef struct log_record {
+    struct timespec ts;                  /* Momento em que a mensagem foi gerada */
+    int level;                           /* Nível de registo */
+    char text[LOG_RECORD_SIZE];          /* Mensagem formatada */
+} LogRecord;
+
+/**
+ * @brief Estado de limitação de uma mensagem repetida (por formato).
+ */
+typedef struct log_rate_slot {
+    const char *format;                  /* Formato associado à entrada */
+    long long window_start_ms;           /* Início da janela atual */
+    unsigned int count;                  /* Mensagens nesta janela */
+    unsigned int suppressed;             /* Mensagens suprimidas nesta janela */
+} LogRateSlot;
+
+/**
+ * @brief Buffer circular de um único produtor (a thread dona) e um único consumidor.
+ *
+ * Os índices do produtor e do consumidor ficam em linhas de cache
+ * diferentes para evitar partilha falsa entre as duas threads.
+ */
+typedef struct log_ring {
+    _Atomic unsigned long head;          /* Próxima posição a escrever (produtor) */
+    char pad_head[64 - sizeof(unsigned long)];
+    _Atomic unsigned long tail;          /* Próxima posição a ler (consumidor) */
+    char pad_tail[64 - sizeof(unsigned long)];
+    _Atomic unsigned long dropped;       /* Registos descartados por buffer cheio */
+    unsigned long dropped_reported;      /* Descartes já reportados (consumidor) */
+    LogRateSlot rate[LOG_RATE_SLOTS];    /* Limitação de repetições (produtor) */
+    LogRecord records[LOG_RING_SIZE];
+} LogRing;
+
+/* Buffers registados, lidos pela thread de fundo */
+static LogRing *log_rings[LOG_MAX_THREADS];
+static _Atomic int log_ring_count = 0;
+
+/* Buffer da thread atual */
+static __thread LogRing *thread_ring = NULL;
+
+/* Thread de fundo */
+static pthread_t log_thread;
+static _Atomic int log_thread_running = 0;
+static pthread_mutex_t log_drain_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Obtém o prefixo textual de um nível de registo.
+ *
+ * @param level Nível de registo
+ * @return String com o prefixo
+ */
+static const char *log_prefix(int level) {
+    switch (level) {
+        case LOG_ERROR: return "ERROR";
+        case LOG_WARN:  return "WARN ";
+        case LOG_INFO:  return "INFO ";
+        case LOG_DEBUG: return "DEBUG";
+        case LOG_TRACE: return "TRACE";
+        default:        return "?????";
+    }
+}
+
+/**
+ * @brief Obtém (criando se necessário) o buffer circular da thread atual.
+ *
+ * @return Apontador para o buffer, NULL se não for possível criá-lo
+ */
+static LogRing *get_thread_ring() {
+    if (thread_ring != NULL) {
+        return thread_ring;
+    }
+
+    int slot = atomic_fetch_add(&log_ring_count, 1);
+    if (slot >= LOG_MAX_THREADS) {
+        atomic_fetch_sub(&log_ring_count, 1);
+        return NULL;
+    }
+
+    LogRing *ring = calloc(1, sizeof(LogRing));
+    if (ring == NULL) {
+        /* Deixa a posição vazia; o consumidor ignora entradas NULL */
+        return NULL;
+    }
+
+    log_rings[slot] = ring;
+    atomic_thread_fence(memory_order_release);
+    thread_ring = ring;
+    return ring;
+}
+
+/**
+ * @brief Escreve em stderr todos os registos pendentes de um buffer.
+ *
+ * Deve ser chamada com log_drain_lock adquirido.
+ *
+ * @param ring Buffer a esvaziar
+ * @return Número de registos escritos
+ */
+static int drain_ring(LogRing *ring) {
+    static time_t cached_second = 0;
+    static char cached_stamp[20];
+    char out[LOG_RECORD_SIZE + 48];
+    int written = 0;
+
+    unsigned long tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned long head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    while (tail != head) {
+        LogRecord *rec = &ring->records[tail % LOG_RING_SIZE];
+
+        /* localtime é chamado no máximo uma vez por segundo */
+        if (rec->ts.tv_sec != cached_second) {
+            struct tm tm_info;
+            cached_second = rec->ts.tv_sec;
+            localtime_r(&cached_second, &tm_info);
+            strftime(cached_stamp, sizeof(cached_stamp), "%Y-%m-%d %H:%M:%S", &tm_info);
+        }
+
+        int len = snprintf(out, sizeof(out), "[%s] [%s] %s\n",
+                           cached_stamp, log_prefix(rec->level), rec->text);
+        if (len > (int)sizeof(out) - 1) {
+            len = sizeof(out) - 1;
+        }
+        fwrite(out, 1, len, stderr);
+
+        tail++;
+        written++;
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    }
+
+    unsigned long dropped = atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+    if (dropped != ring->dropped_reported) {
+        fprintf(stderr, "[%s] [WARN ] %lu log record(s) dropped (ring full)\n",
+                cached_stamp, dropped - ring->dropped_reported);
+        ring->dropped_reported = dropped;
+    }
+
+    return written;
+}
+
+/**
+ * @brief Esvazia todos os buffers registados.
+ *
+ * @return Número de registos escritos
+ */
+static int drain_all_rings() {
+    int written = 0;
+    int count = atomic_load_explicit(&log_ring_count, memory_order_acquire);
+    if (count > LOG_MAX_THREADS) {
+        count = LOG_MAX_THREADS;
+    }
+
+    pthread_mutex_lock(&log_drain_lock);
+    for (int i = 0; i < count; i++) {
+        if (log_rings[i] != NULL) {
+            written += drain_ring(log_rings[i]);
+        }
+    }
+    if (written > 0) {
+        fflush(stderr);
+    }
+    pthread_mutex_unlock(&log_drain_lock);
+
+    return written;
+}
+
+/**
+ * @brief Ciclo da thread de fundo: esvazia os buffers e dorme quando não há trabalho.
+ *
+ * @param arg Não utilizado
+ * @return NULL
+ */
+static void *log_thread_main(void *arg) {
+    (void)arg;
+    struct timespec idle = {0, 5 * 1000 * 1000};  /* 5 ms */
+
+    while (atomic_load(&log_thread_running)) {
+        if (drain_all_rings() == 0) {
+            nanosleep(&idle, NULL);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Coloca um registo já formatado no buffer da thread.
+ *
+ * @param ring Buffer da thread atual
+ * @param level Nível de registo
+ * @param now Momento da mensagem
+ * @param format Formato (estilo printf)
+ * @param args Argumentos do formato
+ */
+static void ring_push(LogRing *ring, int level, const struct timespec *now,
+                      const char *format, va_list args) {
+    unsigned long head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned long tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail >= LOG_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    LogRecord *rec = &ring->records[head % LOG_RING_SIZE];
+    rec->ts = *now;
+    rec->level = level;
+    vsnprintf(rec->text, sizeof(rec->text), format, args);
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/**
+ * @brief Coloca um registo no buffer a partir de argumentos variáveis.
+ */
+static void ring_pushf(LogRing *ring, int level, const struct timespec *now,
+                       const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    ring_push(ring, level, now, format, args);
+    va_end(args);
+}
+
+/**
+ * @brief Escreve um registo no buffer circular da thread atual.
+ *
  * @param level Nível de registo da mensagem
+ * @param rate_limited 1 para aplicar a limitação de mensagens repetidas
  * @param format Formato da mensagem (estilo printf)
- * @param ... Argumentos variáveis para o formato
+ * @param args Argumentos do formato
  */
-void log_message(LogLevel level, const char *format, ...) {
-    if (level > current_log_level) {
+static void log_emit(LogLevel level, int rate_limited, const char *format, va_list args) {
+    COST_SCOPE(COST_LOG);
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME_COARSE, &now);
+
+    LogRing *ring = get_thread_ring();
+    if (ring == NULL) {
+        /* Sem buffer disponível: escrita síncrona */
+        fprintf(stderr, "[%s] ", log_prefix(level));
+        vfprintf(stderr, format, args);
+        fprintf(stderr, "\n");
         return;
     }
-    
-    /* Obtém a hora atual para o timestamp */
-    time_t now = time(NULL);
-    struct tm *tm_info = localtime(&now);
-    char timestamp[20];
-    strftime(timestamp, 20, "%Y-%m-%d %H:%M:%S", tm_info);
-    
-    /* Prefixo baseado no nível de registo */
-    const char *prefix;
-    switch (level) {
-        case LOG_ERROR: prefix = "ERROR"; break;
-        case LOG_WARN:  prefix = "WARN "; break;
-        case LOG_INFO:  prefix = "INFO "; break;
-        case LOG_DEBUG: prefix = "DEBUG"; break;
-        case LOG_TRACE: prefix = "TRACE"; break;
-        default:        prefix = "?????"; break;
+
+    if (rate_limited) {
+        /* Limitação de mensagens repetidas, indexada pelo endereço do formato */
+        long long now_ms = (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+        LogRateSlot *slot = &ring->rate[((unsigned long)format >> 4) % LOG_RATE_SLOTS];
+
+        if (slot->format != format || now_ms - slot->window_start_ms >= LOG_RATE_WINDOW_MS) {
+            if (slot->suppressed > 0) {
+                ring_pushf(ring, LOG_WARN, &now, "(suppressed %u repeats of \"%.160s\")",
+                           slot->suppressed, slot->format);
+            }
+            slot->format = format;
+            slot->window_start_ms = now_ms;
+            slot->count = 0;
+            slot->suppressed = 0;
+        }
+
+        if (++slot->count > LOG_RATE_BURST) {
+            slot->suppressed++;
+            return;
+        }
     }
-    
-    fprintf(stderr, "[%s] [%s] ", timestamp, prefix);
-    
+
+    ring_push(ring, level, &now, format, args);
+
+    /* Sem thread de fundo, escreve imediatamente */
+    if (!atomic_load_explicit(&log_thread_running, memory_order_relaxed)) {
+        drain_all_rings();
+    }
+}
+
+/**
+ * @brief Escreve um registo no buffer circular da thread atual.
+ * 
+ * @param level Nível de registo da mensagem
+ * @param format Formato da mensagem (estilo printf)
+ * @param ... Argumentos variáveis para o formato
+ */
+void log_write(LogLevel level, const char *format, ...) {
     va_list args;
     va_start(args, format);
-    vfprintf(stderr, format, args);
+    log_emit(level, 1, format, args);
     va_end(args);
-    
-    fprintf(stderr, "\n");
+}
+
+/**
+ * @brief Escreve um registo sem limitação de repetições nem verificação de nível.
+ *
+ * @param level Nível de registo mostrado no prefixo
+ * @param format Formato da mensagem (estilo printf)
+ * @param ... Argumentos variáveis para o formato
+ */
+void log_write_always(LogLevel level, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    log_emit(level, 0, format, args);
+    va_end(args);
+}
+
+/**
+ * @brief Inicia a thread de fundo que escreve os registos em stderr.
+ */
+void log_init() {
+    if (atomic_load(&log_thread_running)) {
+        return;
+    }
+
+    atomic_store(&log_thread_running, 1);
+    if (pthread_create(&log_thread, NULL, log_thread_main, NULL) != 0) {
+        perror("pthread_create");
+        atomic_store(&log_thread_running, 0);
+    }
+}
+
+/**
+ * @brief Aguarda até todos os registos pendentes terem sido escritos.
+ */
+void log_flush() {
+    drain_all_rings();
+}
+
+/**
+ * @brief Termina a thread de fundo, escrevendo os registos pendentes.
+ */
+void log_shutdown() {
+    if (atomic_exchange(&log_thread_running, 0)) {
+        pthread_join(log_thread, NULL);
+    }
+
+    /* Reporta repetições ainda suprimidas na thread atual */
+    LogRing *ring = thread_ring;
+    if (ring != NULL) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME_COARSE, &now);
+        for (int i = 0; i < LOG_RATE_SLOTS; i++) {
+            if (ring->rate[i].suppressed > 0) {
+                ring_pushf(ring, LOG_WARN, &now, "(suppressed %u repeats of \"%.160s\")",
+                           ring->rate[i].suppressed, ring->rate[i].format);
+                ring->rate[i].suppressed = 0;
+            }
+        }
+    }
+
+    drain_all_rings();
+}
+
+/**
+ * @brief Converte o nome de um nível de registo no valor correspondente.
+ * 
+ * @param name Nome do nível (error, warn, info, debug, trace) ou número
+ * @param level Apontador onde guardar o nível
+ * @return 0 em caso de sucesso, -1 se o nome não for reconhecido
+ */
+int parse_log_level(const char *name, LogLevel *level) {
+    static const char *names[] = {"error", "warn", "info", "debug", "trace"};
+
+    if (name == NULL) {
+        return -1;
+    }
+
+    for (int i = 0; i <= LOG_TRACE; i++) {
+        if (strcasecmp(name, names[i]) == 0) {
+            *level = (LogLevel)i;
+            return 0;
+        }
+    }
+
+    if (isdigit((unsigned char)name[0]) && name[1] == '\0' && name[0] - '0' <= LOG_TRACE) {
+        *level = (LogLevel)(name[0] - '0');
+        return 0;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Processa o comando "loglevel" (ll) para consultar ou alterar o nível de registo.
+ * 
+ * @param arg Nome do novo nível, ou NULL para mostrar o nível atual
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_log_level(char *arg) {
+    static const char *names[] = {"error", "warn", "info", "debug", "trace"};
+    LogLevel level;
+
+    if (arg == NULL) {
+        printf("Log level: %s (compiled up to %s)\n",
+               names[current_log_level], names[LOG_COMPILE_LEVEL]);
+        return 0;
+    }
+
+    if (parse_log_level(arg, &level) != 0) {
+        printf("%sUsage: loglevel (ll) [error|warn|info|debug|trace]%s\n", COLOR_RED, COLOR_RESET);
+        return -1;
+    }
+
+    if ((int)level > LOG_COMPILE_LEVEL) {
+        printf("%sWarning: messages above %s were compiled out%s\n",
+               COLOR_YELLOW, names[LOG_COMPILE_LEVEL], COLOR_RESET);
+    }
+
+    current_log_level = level;
+    debug_mode = (level >= LOG_DEBUG);
+    printf("Log level set to %s\n", names[level]);
+    return 0;
 }
 
 /**
@@ -78,7 +457,7 @@ void dump_interest_table() {
     while (entry != NULL) {
         log_message(LOG_DEBUG, "Entry %d: %s", count, entry->name);
         log_message(LOG_DEBUG, "  Timestamp: %ld (now: %ld, age: %ld secs)", 
-                   entry->timestamp, time(NULL), time(NULL) - entry->timestamp);
+                   entry->timestamp, monotonic_seconds(), monotonic_seconds() - entry->timestamp);
         
         for (int i = 0; i < MAX_INTERFACE; i++) {
             if (entry->interface_states[i] != 0) {
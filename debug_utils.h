@@ -30,11 +30,44 @@ typedef enum {
     LOG_TRACE = 4    /* Informação muito detalhada de rastreio */
 } LogLevel;
 
+/**
+ * @brief Nível máximo de registo compilado no programa.
+ *
+ * Mensagens acima deste nível são eliminadas em tempo de compilação
+ * (ex.: make LOG_COMPILE_LEVEL=2 para manter apenas ERROR, WARN e INFO).
+ */
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 4
+#endif
+
+#define LOG_RING_SIZE 1024       /* Registos por buffer circular (um por thread) */
+#define LOG_RECORD_SIZE 256      /* Tamanho máximo de um registo formatado */
+#define LOG_MAX_THREADS 16       /* Número máximo de threads com buffer próprio */
+#define LOG_RATE_SLOTS 64        /* Entradas da tabela de limitação de repetições */
+#define LOG_RATE_WINDOW_MS 1000  /* Janela de limitação de mensagens repetidas */
+#define LOG_RATE_BURST 20        /* Repetições permitidas por janela antes de suprimir */
+
 /**
  * @brief Nível de registo atual - pode ser alterado em tempo de execução
  */
 extern LogLevel current_log_level;
 
+/**
+ * @brief Regista uma mensagem com nível de importância.
+ *
+ * Mensagens acima de LOG_COMPILE_LEVEL não geram código; mensagens acima
+ * do nível atual custam apenas uma comparação. As restantes são escritas
+ * no buffer circular da thread e impressas por uma thread de fundo.
+ *
+ * @param level Nível de registo da mensagem
+ * @param ... Formato (estilo printf) e argumentos
+ */
+#define log_message(level, ...)                                              \
+    do {                                                                     \
+        if ((int)(level) <= LOG_COMPILE_LEVEL && (level) <= current_log_level) \
+            log_write((level), __VA_ARGS__);                                 \
+    } while (0)
+
 /**
  * @brief Imprime informação sobre a tabela de interesses.
  * 
@@ -43,16 +76,64 @@ extern LogLevel current_log_level;
 void debug_interest_table(void);
 
 /**
- * @brief Regista uma mensagem com nível de importância.
+ * @brief Escreve um registo no buffer circular da thread atual.
  * 
- * Gera um registo com timestamp e prefixo de nível apenas se
- * o nível de registo atual for >= ao nível especificado.
+ * Não deve ser chamada diretamente: usar log_message(), que verifica o
+ * nível antes de avaliar os argumentos. Mensagens repetidas com o mesmo
+ * formato são limitadas a LOG_RATE_BURST por LOG_RATE_WINDOW_MS. Se o
+ * buffer estiver cheio o registo é descartado e contabilizado.
  * 
  * @param level Nível de registo da mensagem
  * @param format Formato da mensagem (estilo printf)
  * @param ... Argumentos variáveis para o formato
  */
-void log_message(LogLevel level, const char *format, ...);
+void log_write(LogLevel level, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Escreve um registo sem limitação de repetições nem verificação de nível.
+ * 
+ * Usada para registos cuja frequência já é controlada por quem os gera
+ * (ex.: os spans de rastreio, limitados pela taxa de amostragem).
+ * 
+ * @param level Nível de registo mostrado no prefixo
+ * @param format Formato da mensagem (estilo printf)
+ * @param ... Argumentos variáveis para o formato
+ */
+void log_write_always(LogLevel level, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Inicia a thread de fundo que escreve os registos em stderr.
+ * 
+ * Sem esta thread os registos são escritos de forma síncrona.
+ */
+void log_init();
+
+/**
+ * @brief Aguarda até todos os registos pendentes terem sido escritos.
+ */
+void log_flush();
+
+/**
+ * @brief Termina a thread de fundo, escrevendo os registos pendentes.
+ */
+void log_shutdown();
+
+/**
+ * @brief Converte o nome de um nível de registo no valor correspondente.
+ * 
+ * @param name Nome do nível (error, warn, info, debug, trace) ou número
+ * @param level Apontador onde guardar o nível
+ * @return 0 em caso de sucesso, -1 se o nome não for reconhecido
+ */
+int parse_log_level(const char *name, LogLevel *level);
+
+/**
+ * @brief Processa o comando "loglevel" (ll) para consultar ou alterar o nível de registo.
+ * 
+ * @param arg Nome do novo nível, ou NULL para mostrar o nível atual
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_log_level(char *arg);
 
 /**
  * @brief Imprime informação detalhada sobre a tabela de interesses.
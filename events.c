@@ -0,0 +1,223 @@
+/**
+ * @file events.c
+ * @brief Implementação do fluxo de eventos da tabela de interesses
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a implementação do buffer circular de eventos da
+ * tabela de interesses e da sua apresentação no terminal. Os handlers de
+ * mensagens apenas chamam record_interest_event(); o desenho acontece no
+ * ciclo principal com frequência limitada, ou a pedido do utilizador.
+ */
+
+#include "events.h"
+
+/* Vista ao vivo ativa por omissão */
+int ui_live_view = 1;
+
+/* Buffer circular de eventos */
+static PitEvent event_ring[PIT_EVENT_RING_SIZE];
+static unsigned long events_recorded = 0;   /* Total de eventos registados */
+static unsigned long events_rendered = 0;   /* Total de eventos já considerados pela vista ao vivo */
+static long long last_frame_ms = 0;         /* Momento da última atualização da vista ao vivo */
+
+/* Descrição e cor de cada tipo de evento, indexadas por PitEventType */
+static const struct {
+    const char *label;
+    const char *color;
+} event_info[PIT_EV_COUNT] = {
+    [PIT_EV_ENTRY_ADDED]        = {"Entry Added",            COLOR_MAGENTA},
+    [PIT_EV_STATE_UPDATED]      = {"State Updated",          COLOR_MAGENTA},
+    [PIT_EV_UPDATE_ERROR]       = {"Update Error",           COLOR_RED},
+    [PIT_EV_ENTRY_REMOVED]      = {"Entry Removed",          COLOR_RED},
+    [PIT_EV_REMOVE_NOT_FOUND]   = {"Entry Not Found",        COLOR_RED},
+    [PIT_EV_FOUND_LOCAL]        = {"Object Found Locally",   COLOR_GREEN},
+    [PIT_EV_FOUND_CACHE]        = {"Object Found In Cache",  COLOR_GREEN},
+    [PIT_EV_INTEREST]           = {"INTEREST",               COLOR_CYAN},
+    [PIT_EV_INTEREST_FORWARDED] = {"INTEREST Forwarded",     COLOR_CYAN},
+    [PIT_EV_OBJECT]             = {"OBJECT",                 COLOR_GREEN},
+    [PIT_EV_OBJECT_NO_ENTRY]    = {"OBJECT - No Entry",      COLOR_RED},
+    [PIT_EV_NOOBJECT]           = {"NOOBJECT",               COLOR_MAGENTA},
+    [PIT_EV_NOOBJECT_NO_ENTRY]  = {"NOOBJECT - No Entry",    COLOR_RED},
+    [PIT_EV_ALL_CLOSED]         = {"All Paths Closed",       COLOR_RED},
+    [PIT_EV_TIMEOUT]            = {"INTEREST TIMEOUT",       COLOR_RED},
+    [PIT_EV_TOO_LATE]           = {"INTEREST Too Late",      COLOR_RED},
+};
+
+/**
+ * @brief Obtém o tempo monotónico atual em milissegundos.
+ *
+ * @return Milissegundos desde um instante arbitrário fixo
+ */
+static long long monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Regista um evento da tabela de interesses.
+ *
+ * @param type Tipo de evento
+ * @param name Nome do objeto associado
+ * @param interface_id Interface associada, -1 se não aplicável
+ * @param value Valor auxiliar dependente do tipo
+ */
+void record_interest_event(PitEventType type, const char *name, int interface_id, int value) {
+    PitEvent *ev = &event_ring[events_recorded % PIT_EVENT_RING_SIZE];
+
+    ev->type = type;
+    ev->timestamp = time(NULL);
+    ev->interface_id = interface_id;
+    ev->value = value;
+    if (name != NULL) {
+        strncpy(ev->name, name, MAX_OBJECT_NAME);
+        ev->name[MAX_OBJECT_NAME] = '\0';
+    } else {
+        ev->name[0] = '\0';
+    }
+
+    events_recorded++;
+}
+
+/**
+ * @brief Imprime uma linha com a descrição de um evento.
+ *
+ * @param ev Evento a imprimir
+ */
+static void print_event(const PitEvent *ev) {
+    char when[16];
+    struct tm *tm_info = localtime(&ev->timestamp);
+    strftime(when, sizeof(when), "%H:%M:%S", tm_info);
+
+    const char *label = (ev->type < PIT_EV_COUNT) ? event_info[ev->type].label : "?";
+    const char *color = (ev->type < PIT_EV_COUNT) ? event_info[ev->type].color : COLOR_RESET;
+
+    printf("  %s %s%-22s%s %s%s%s", when, color, label, COLOR_RESET,
+           COLOR_CYAN, ev->name, COLOR_RESET);
+
+    if (ev->interface_id >= 0) {
+        printf(" (if:%d)", ev->interface_id);
+    }
+
+    switch (ev->type) {
+        case PIT_EV_INTEREST_FORWARDED: printf(" fwd: %d", ev->value); break;
+        case PIT_EV_OBJECT:             printf(" fwd: %d", ev->value); break;
+        case PIT_EV_TIMEOUT:            printf(" waiting ifs: %d", ev->value); break;
+        case PIT_EV_TOO_LATE:           printf(" lifetime left: %d ms", ev->value); break;
+        default: break;
+    }
+
+    printf("\n");
+}
+
+/**
+ * @brief Desenha a vista ao vivo se houver eventos novos e o intervalo mínimo tiver passado.
+ */
+void render_interest_events() {
+    if (!ui_live_view || events_rendered == events_recorded) {
+        return;
+    }
+
+    long long now = monotonic_ms();
+    if (now - last_frame_ms < UI_FRAME_INTERVAL_MS) {
+        return;
+    }
+    last_frame_ms = now;
+
+    unsigned long pending = events_recorded - events_rendered;
+    unsigned long shown = pending;
+    if (shown > UI_MAX_EVENTS_PER_FRAME) {
+        shown = UI_MAX_EVENTS_PER_FRAME;
+    }
+
+    printf("\n%s%s── INTEREST TABLE UPDATES: %lu event(s), %d active entr%s ──%s\n",
+           COLOR_BOLD, COLOR_MAGENTA, pending, node.interest_count,
+           node.interest_count == 1 ? "y" : "ies", COLOR_RESET);
+
+    if (pending > shown) {
+        printf("  %s... %lu earlier event(s) omitted (use 'se' to list)%s\n",
+               COLOR_YELLOW, pending - shown, COLOR_RESET);
+    }
+
+    for (unsigned long seq = events_recorded - shown; seq < events_recorded; seq++) {
+        print_event(&event_ring[seq % PIT_EVENT_RING_SIZE]);
+    }
+
+    fflush(stdout);
+    events_rendered = events_recorded;
+}
+
+/**
+ * @brief Obtém o tempo até à próxima atualização da vista ao vivo.
+ *
+ * @return Milissegundos até à próxima atualização, -1 se não houver nada por desenhar
+ */
+int ui_next_frame_timeout_ms() {
+    if (!ui_live_view || events_rendered == events_recorded) {
+        return -1;
+    }
+
+    long long remaining = UI_FRAME_INTERVAL_MS - (monotonic_ms() - last_frame_ms);
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+/**
+ * @brief Mostra os eventos recentes da tabela de interesses.
+ *
+ * @param count Número máximo de eventos a mostrar (0 para todos os guardados)
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_show_events(int count) {
+    unsigned long available = events_recorded < PIT_EVENT_RING_SIZE ?
+                              events_recorded : PIT_EVENT_RING_SIZE;
+
+    if (count <= 0 || (unsigned long)count > available) {
+        count = (int)available;
+    }
+
+    printf("\n%s%s┌───────────────────────────────────────────────────┐%s\n", COLOR_BOLD, COLOR_MAGENTA, COLOR_RESET);
+    printf("%s%s│               INTEREST TABLE EVENTS                │%s\n", COLOR_BOLD, COLOR_MAGENTA, COLOR_RESET);
+    printf("%s%s└───────────────────────────────────────────────────┘%s\n", COLOR_BOLD, COLOR_MAGENTA, COLOR_RESET);
+
+    if (count == 0) {
+        printf("%sNo events recorded%s\n\n", COLOR_YELLOW, COLOR_RESET);
+        return 0;
+    }
+
+    for (unsigned long seq = events_recorded - count; seq < events_recorded; seq++) {
+        print_event(&event_ring[seq % PIT_EVENT_RING_SIZE]);
+    }
+
+    printf("\n%s%sShowing %d of %lu event(s) recorded%s\n\n",
+           COLOR_BOLD, COLOR_BLUE, count, events_recorded, COLOR_RESET);
+
+    /* Os eventos listados já não precisam de aparecer na vista ao vivo */
+    events_rendered = events_recorded;
+    return 0;
+}
+
+/**
+ * @brief Ativa ou desativa a vista ao vivo.
+ *
+ * @param arg "on", "off" ou NULL para alternar
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_monitor(char *arg) {
+    if (arg == NULL) {
+        ui_live_view = !ui_live_view;
+    } else if (strcmp(arg, "on") == 0) {
+        ui_live_view = 1;
+    } else if (strcmp(arg, "off") == 0) {
+        ui_live_view = 0;
+    } else {
+        printf("%sUsage: monitor (m) [on|off]%s\n", COLOR_RED, COLOR_RESET);
+        return -1;
+    }
+
+    /* Não despeja eventos acumulados enquanto a vista estava desativada */
+    events_rendered = events_recorded;
+
+    printf("Live interest table view %s\n", ui_live_view ? "enabled" : "disabled");
+    return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file events.h
+ * @brief Fluxo de eventos da tabela de interesses e vista de monitorização
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém as declarações do fluxo de eventos da tabela de
+ * interesses. O processamento de mensagens apenas regista eventos num
+ * buffer circular de tamanho fixo (custo constante por pacote); a
+ * apresentação no terminal é feita fora do caminho crítico:
+ *
+ * - Vista ao vivo: um resumo dos eventos novos, desenhado no máximo
+ *   uma vez por UI_FRAME_INTERVAL_MS a partir do ciclo principal
+ * - A pedido: o comando "show events" (se) mostra os eventos recentes e
+ *   o comando "show interest table" (si) mostra o estado atual da tabela
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "ndn.h"
+
+#define PIT_EVENT_RING_SIZE 256      /* Número de eventos guardados no buffer circular */
+#define UI_FRAME_INTERVAL_MS 1000    /* Intervalo mínimo entre atualizações da vista ao vivo */
+#define UI_MAX_EVENTS_PER_FRAME 8    /* Número máximo de eventos desenhados por atualização */
+
+/**
+ * @brief Tipos de eventos registados sobre a tabela de interesses.
+ */
+typedef enum {
+    PIT_EV_ENTRY_ADDED = 0,      /* Nova entrada criada na tabela */
+    PIT_EV_STATE_UPDATED,        /* Estado de uma interface alterado */
+    PIT_EV_UPDATE_ERROR,         /* Atualização de uma entrada a ser removida */
+    PIT_EV_ENTRY_REMOVED,        /* Entrada removida da tabela */
+    PIT_EV_REMOVE_NOT_FOUND,     /* Remoção de uma entrada inexistente */
+    PIT_EV_FOUND_LOCAL,          /* Interesse satisfeito por um objeto local */
+    PIT_EV_FOUND_CACHE,          /* Interesse satisfeito pela cache */
+    PIT_EV_INTEREST,             /* Interesse recebido e registado */
+    PIT_EV_INTEREST_FORWARDED,   /* Interesse encaminhado (valor = número de interfaces) */
+    PIT_EV_OBJECT,               /* Objeto recebido (valor = número de reencaminhamentos) */
+    PIT_EV_OBJECT_NO_ENTRY,      /* Objeto recebido sem entrada correspondente */
+    PIT_EV_NOOBJECT,             /* NOOBJECT recebido */
+    PIT_EV_NOOBJECT_NO_ENTRY,    /* NOOBJECT recebido sem entrada correspondente */
+    PIT_EV_ALL_CLOSED,           /* Todas as interfaces fechadas, entrada removida */
+    PIT_EV_TIMEOUT,              /* Interesse expirado (valor = interfaces em WAITING) */
+    PIT_EV_TOO_LATE,             /* Interesse sem tempo de vida para ser respondido (valor = ms restantes) */
+    PIT_EV_COUNT
+} PitEventType;
+
+/**
+ * @brief Evento registado no buffer circular.
+ */
+typedef struct pit_event {
+    PitEventType type;                  /* Tipo de evento */
+    time_t timestamp;                   /* Momento em que o evento ocorreu */
+    int interface_id;                   /* Interface associada, -1 se não aplicável */
+    int value;                          /* Valor auxiliar dependente do tipo */
+    char name[MAX_OBJECT_NAME + 1];     /* Nome do objeto */
+} PitEvent;
+
+/**
+ * @brief Sinalizador da vista ao vivo (1 ativa, 0 desativada).
+ */
+extern int ui_live_view;
+
+/**
+ * @brief Regista um evento da tabela de interesses.
+ *
+ * Operação de custo constante: copia o evento para o buffer circular,
+ * substituindo o mais antigo quando este está cheio. Não escreve nada
+ * no terminal.
+ *
+ * @param type Tipo de evento
+ * @param name Nome do objeto associado
+ * @param interface_id Interface associada, -1 se não aplicável
+ * @param value Valor auxiliar dependente do tipo
+ */
+void record_interest_event(PitEventType type, const char *name, int interface_id, int value);
+
+/**
+ * @brief Desenha a vista ao vivo se houver eventos novos e o intervalo mínimo tiver passado.
+ *
+ * Chamada uma vez por iteração do ciclo principal. O custo de cada
+ * atualização é limitado por UI_MAX_EVENTS_PER_FRAME e não depende do
+ * tamanho da tabela de interesses.
+ */
+void render_interest_events();
+
+/**
+ * @brief Obtém o tempo até à próxima atualização da vista ao vivo.
+ *
+ * Permite ao ciclo principal reduzir o timeout do select() quando há
+ * eventos por desenhar.
+ *
+ * @return Milissegundos até à próxima atualização, -1 se não houver nada por desenhar
+ */
+int ui_next_frame_timeout_ms();
+
+/**
+ * @brief Processa o comando "show events" (se) para mostrar os eventos recentes.
+ *
+ * @param count Número máximo de eventos a mostrar (0 para todos os guardados)
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_show_events(int count);
+
+/**
+ * @brief Processa o comando "monitor" (m) para ativar ou desativar a vista ao vivo.
+ *
+ * @param arg "on", "off" ou NULL para alternar
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_monitor(char *arg);
+
+#endif /* EVENTS_H */
@@ -0,0 +1,350 @@
+/**
+ * @file latency.c
+ * @brief Implementação dos histogramas de latência do nó NDN
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém o registo e a consulta dos histogramas
+ * log-lineares, o comando "show latency" e a exportação no formato do
+ * Prometheus.
+ */
+
+#include "latency.h"
+#include <stdarg.h>
+
+LatencySet node_latency;
+
+/* Relógio alternativo (relógio virtual do simulador), NULL = CLOCK_MONOTONIC */
+static uint64_t (*clock_source)() = NULL;
+
+/* Percentis mostrados e exportados */
+static const double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+#define PERCENTILE_COUNT (int)(sizeof(percentiles) / sizeof(percentiles[0]))
+
+/**
+ * @brief Obtém o tempo monotónico atual em nanossegundos.
+ *
+ * @return Nanossegundos desde um instante arbitrário fixo
+ */
+uint64_t monotonic_ns() {
+    if (clock_source != NULL) {
+        return clock_source();
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Obtém o tempo monotónico atual em segundos.
+ *
+ * @return Segundos desde um instante arbitrário fixo
+ */
+time_t monotonic_seconds() {
+    return (time_t)(monotonic_ns() / 1000000000ull);
+}
+
+/**
+ * @brief Substitui o relógio usado por monotonic_ns.
+ *
+ * @param source Função que devolve o tempo em nanossegundos, ou NULL para CLOCK_MONOTONIC
+ */
+void latency_set_clock(uint64_t (*source)()) {
+    clock_source = source;
+}
+
+/**
+ * @brief Calcula o intervalo de um valor.
+ *
+ * Valores abaixo de 2 * LATENCY_SUB_BUCKETS têm um intervalo cada; acima
+ * disso, cada potência de 2 é dividida em LATENCY_SUB_BUCKETS intervalos.
+ */
+static int bucket_index(uint64_t ns) {
+    if (ns < 2 * LATENCY_SUB_BUCKETS) {
+        return (int)ns;
+    }
+
+    int msb = 63 - __builtin_clzll(ns);
+    if (msb >= LATENCY_MAX_BITS) {
+        return LATENCY_BUCKETS - 1;
+    }
+
+    int shift = msb - LATENCY_SUB_BITS;
+    return shift * LATENCY_SUB_BUCKETS + (int)(ns >> shift);
+}
+
+/**
+ * @brief Obtém o maior valor pertencente a um intervalo.
+ */
+static uint64_t bucket_highest(int index) {
+    if (index < 2 * LATENCY_SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+
+    int shift = index / LATENCY_SUB_BUCKETS - 1;
+    uint64_t top = (uint64_t)(index - shift * LATENCY_SUB_BUCKETS);
+    return (top << shift) + ((1ull << shift) - 1);
+}
+
+/**
+ * @brief Regista uma amostra num histograma.
+ *
+ * @param hist Histograma
+ * @param ns Latência em nanossegundos
+ */
+void latency_record(LatencyHistogram *hist, uint64_t ns) {
+    hist->counts[bucket_index(ns)]++;
+    if (hist->count == 0 || ns < hist->min_ns) {
+        hist->min_ns = ns;
+    }
+    if (ns > hist->max_ns) {
+        hist->max_ns = ns;
+    }
+    hist->count++;
+    hist->sum_ns += ns;
+}
+
+/**
+ * @brief Calcula um percentil de um histograma.
+ *
+ * @param hist Histograma
+ * @param percentile Percentil entre 0 e 100
+ * @return Maior valor equivalente ao intervalo do percentil, em nanossegundos (0 se vazio)
+ */
+uint64_t latency_percentile(const LatencyHistogram *hist, double percentile) {
+    if (hist->count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * hist->count + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            uint64_t value = bucket_highest(i);
+            return value < hist->max_ns ? value : hist->max_ns;
+        }
+    }
+    return hist->max_ns;
+}
+
+/**
+ * @brief Limpa todos os histogramas do nó.
+ */
+void latency_reset() {
+    memset(&node_latency, 0, sizeof(node_latency));
+}
+
+/**
+ * @brief Acrescenta texto formatado a um buffer, sem ultrapassar o tamanho.
+ */
+static size_t append(char *buffer, size_t size, size_t len, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static size_t append(char *buffer, size_t size, size_t len, const char *format, ...) {
+    if (len >= size) {
+        return len;
+    }
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + len, size - len, format, args);
+    va_end(args);
+
+    if (written < 0) {
+        return len;
+    }
+    len += (size_t)written;
+    return len < size ? len : size - 1;
+}
+
+/**
+ * @brief Acrescenta um histograma como sumário do Prometheus.
+ */
+static size_t append_summary(char *buffer, size_t size, size_t len, const char *name,
+                             const char *labels, const LatencyHistogram *hist) {
+    const char *sep = labels[0] ? "," : "";
+
+    for (int p = 0; p < PERCENTILE_COUNT; p++) {
+        len = append(buffer, size, len, "%s{%s%squantile=\"%g\"} %.9f\n", name, labels, sep,
+                     percentiles[p] / 100.0, latency_percentile(hist, percentiles[p]) / 1e9);
+    }
+    len = append(buffer, size, len, "%s_sum%s%s%s %.9f\n%s_count%s%s%s %lu\n",
+                 name, labels[0] ? "{" : "", labels, labels[0] ? "}" : "", hist->sum_ns / 1e9,
+                 name, labels[0] ? "{" : "", labels, labels[0] ? "}" : "", (unsigned long)hist->count);
+    return len;
+}
+
+/**
+ * @brief Acrescenta os histogramas no formato de texto do Prometheus (sumários).
+ *
+ * Só os histogramas com amostras são exportados.
+ *
+ * @param buffer Buffer de destino
+ * @param size Tamanho do buffer
+ * @param len Bytes já usados no buffer
+ * @return Novo número de bytes usados
+ */
+size_t latency_format_prometheus(char *buffer, size_t size, size_t len) {
+    char labels[64];
+
+    len = append(buffer, size, len,
+                 "# HELP ndn_retrieve_latency_seconds Local retrieve time, interest sent to OBJECT\n"
+                 "# TYPE ndn_retrieve_latency_seconds summary\n");
+    len = append_summary(buffer, size, len, "ndn_retrieve_latency_seconds", "", &node_latency.retrieve);
+
+    len = append(buffer, size, len,
+                 "# HELP ndn_face_rtt_seconds Upstream RTT per face, WAITING to OBJECT or NOOBJECT\n"
+                 "# TYPE ndn_face_rtt_seconds summary\n");
+    for (int f = 0; f < METRICS_FACE_SLOTS; f++) {
+        if (node_latency.face_rtt[f].count == 0) {
+            continue;
+        }
+        if (f == MAX_INTERFACE) {
+            snprintf(labels, sizeof(labels), "face=\"other\"");
+        } else {
+            snprintf(labels, sizeof(labels), "face=\"%d\"", f);
+        }
+        len = append_summary(buffer, size, len, "ndn_face_rtt_seconds", labels, &node_latency.face_rtt[f]);
+    }
+
+    len = append(buffer, size, len,
+                 "# HELP ndn_processing_seconds Time to process one received message, by type\n"
+                 "# TYPE ndn_processing_seconds summary\n");
+    for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+        if (node_latency.processing[t].count == 0) {
+            continue;
+        }
+        snprintf(labels, sizeof(labels), "type=\"%s\"", metrics_type_name(t));
+        len = append_summary(buffer, size, len, "ndn_processing_seconds", labels, &node_latency.processing[t]);
+    }
+
+    return len;
+}
+
+/**
+ * @brief Formata uma duração com a unidade mais adequada.
+ */
+static const char *format_ns(uint64_t ns, char *out, size_t size) {
+    if (ns < 1000) {
+        snprintf(out, size, "%luns", (unsigned long)ns);
+    } else if (ns < 1000000) {
+        snprintf(out, size, "%.1fus", ns / 1e3);
+    } else if (ns < 1000000000) {
+        snprintf(out, size, "%.2fms", ns / 1e6);
+    } else {
+        snprintf(out, size, "%.2fs", ns / 1e9);
+    }
+    return out;
+}
+
+/**
+ * @brief Imprime o cabeçalho das linhas de percentis.
+ */
+void latency_print_header() {
+    printf("%s  %-16s %8s %9s %9s %9s %9s %9s %9s %9s%s\n", COLOR_BOLD, "", "count",
+           "min", "p50", "p90", "p99", "p99.9", "max", "mean", COLOR_RESET);
+}
+
+/**
+ * @brief Imprime uma linha com os percentis de um histograma.
+ *
+ * @param label Nome da linha
+ * @param hist Histograma (nada é impresso se estiver vazio)
+ */
+void latency_print_row(const char *label, const LatencyHistogram *hist) {
+    char buf[7][16];
+
+    if (hist->count == 0) {
+        return;
+    }
+
+    printf("  %-16s %8lu %9s %9s %9s %9s %9s %9s %9s\n", label, (unsigned long)hist->count,
+           format_ns(hist->min_ns, buf[0], sizeof(buf[0])),
+           format_ns(latency_percentile(hist, 50.0), buf[1], sizeof(buf[1])),
+           format_ns(latency_percentile(hist, 90.0), buf[2], sizeof(buf[2])),
+           format_ns(latency_percentile(hist, 99.0), buf[3], sizeof(buf[3])),
+           format_ns(latency_percentile(hist, 99.9), buf[4], sizeof(buf[4])),
+           format_ns(hist->max_ns, buf[5], sizeof(buf[5])),
+           format_ns(hist->sum_ns / hist->count, buf[6], sizeof(buf[6])));
+}
+
+/**
+ * @brief Processa o comando "show latency" (sl) para mostrar os percentis de latência.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_show_latency() {
+    char label[32];
+    int shown = 0;
+
+    printf("\n%s%s┌───────────────────────────────────────────────────┐%s\n", COLOR_BOLD, COLOR_BLUE, COLOR_RESET);
+    printf("%s%s│                 LATENCY HISTOGRAMS                │%s\n", COLOR_BOLD, COLOR_BLUE, COLOR_RESET);
+    printf("%s%s└───────────────────────────────────────────────────┘%s\n", COLOR_BOLD, COLOR_BLUE, COLOR_RESET);
+
+    latency_print_header();
+
+    if (node_latency.retrieve.count > 0) {
+        printf("%sRetrieve (interest sent to OBJECT):%s\n", COLOR_CYAN, COLOR_RESET);
+        latency_print_row("local", &node_latency.retrieve);
+        shown++;
+    }
+
+    int rtt_header = 0;
+    for (int f = 0; f < METRICS_FACE_SLOTS; f++) {
+        if (node_latency.face_rtt[f].count == 0) {
+            continue;
+        }
+        if (!rtt_header) {
+            printf("%sUpstream RTT (WAITING to OBJECT/NOOBJECT):%s\n", COLOR_CYAN, COLOR_RESET);
+            rtt_header = 1;
+        }
+        if (f == MAX_INTERFACE) {
+            snprintf(label, sizeof(label), "other");
+        } else {
+            snprintf(label, sizeof(label), "if:%d", f);
+        }
+        latency_print_row(label, &node_latency.face_rtt[f]);
+        shown++;
+    }
+
+    int proc_header = 0;
+    for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+        if (node_latency.processing[t].count == 0) {
+            continue;
+        }
+        if (!proc_header) {
+            printf("%sMessage processing:%s\n", COLOR_CYAN, COLOR_RESET);
+            proc_header = 1;
+        }
+        latency_print_row(metrics_type_name(t), &node_latency.processing[t]);
+        shown++;
+    }
+
+    if (shown == 0) {
+        printf("%sNo samples recorded%s\n", COLOR_YELLOW, COLOR_RESET);
+    }
+    printf("\n");
+    return 0;
+}
+
+/**
+ * @brief Processa o comando "latency reset" para limpar os histogramas.
+ *
+ * @param arg Subcomando ("reset")
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_latency(char *arg) {
+    if (arg != NULL && strcmp(arg, "reset") == 0) {
+        latency_reset();
+        printf("Latency histograms reset\n");
+        return 0;
+    }
+
+    printf("%sUsage: latency reset%s\n", COLOR_RED, COLOR_RESET);
+    return -1;
+}
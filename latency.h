@@ -0,0 +1,141 @@
+/**
+ * @file latency.h
+ * @brief Histogramas de latência do nó NDN
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém as declarações dos histogramas de latência
+ * log-lineares (estilo HDR) usados para medir:
+ *
+ * - O tempo de um pedido local (cmd_retrieve), do envio do interesse à
+ *   chegada do OBJECT
+ * - O RTT de cada interface a montante, desde que a interface passa a
+ *   WAITING até chegar OBJECT ou NOOBJECT por essa interface
+ * - O tempo de processamento de cada mensagem em handle_network_events,
+ *   por tipo de mensagem
+ *
+ * Cada potência de 2 é dividida em LATENCY_SUB_BUCKETS intervalos iguais,
+ * o que dá um erro relativo máximo de 1/LATENCY_SUB_BUCKETS em qualquer
+ * percentil, com memória fixa e registo de custo constante.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include "metrics.h"
+
+#define LATENCY_SUB_BITS 5                              /* 2^5 = 32 intervalos por potência de 2 (~3%) */
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_BITS 40                             /* Valores até 2^40 ns (~18 minutos) */
+#define LATENCY_BUCKETS ((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+/**
+ * @brief Histograma log-linear de latências em nanossegundos.
+ */
+typedef struct latency_histogram {
+    uint64_t counts[LATENCY_BUCKETS];   /* Contagem por intervalo */
+    uint64_t count;                     /* Número de amostras */
+    uint64_t sum_ns;                    /* Soma das amostras */
+    uint64_t min_ns;                    /* Menor amostra */
+    uint64_t max_ns;                    /* Maior amostra */
+} LatencyHistogram;
+
+/**
+ * @brief Conjunto de histogramas do nó.
+ */
+typedef struct latency_set {
+    LatencyHistogram retrieve;                          /* Pedidos locais satisfeitos */
+    LatencyHistogram face_rtt[METRICS_FACE_SLOTS];      /* RTT por interface a montante */
+    LatencyHistogram processing[MSG_TYPE_COUNT];        /* Processamento por tipo de mensagem */
+} LatencySet;
+
+/**
+ * @brief Histogramas do nó, escritos apenas pelo ciclo principal.
+ */
+extern LatencySet node_latency;
+
+/**
+ * @brief Obtém o tempo monotónico atual em nanossegundos.
+ *
+ * @return Nanossegundos desde um instante arbitrário fixo
+ */
+uint64_t monotonic_ns();
+
+/**
+ * @brief Obtém o tempo monotónico atual em segundos.
+ *
+ * Usado nas idades das entradas da tabela de interesses, que assim não
+ * dependem de acertos ao relógio do sistema.
+ *
+ * @return Segundos desde um instante arbitrário fixo
+ */
+time_t monotonic_seconds();
+
+/**
+ * @brief Substitui o relógio usado por monotonic_ns (relógio virtual do ndn-sim).
+ *
+ * @param source Função que devolve o tempo em nanossegundos, ou NULL para CLOCK_MONOTONIC
+ */
+void latency_set_clock(uint64_t (*source)());
+
+/**
+ * @brief Regista uma amostra num histograma.
+ *
+ * @param hist Histograma
+ * @param ns Latência em nanossegundos
+ */
+void latency_record(LatencyHistogram *hist, uint64_t ns);
+
+/**
+ * @brief Calcula um percentil de um histograma.
+ *
+ * @param hist Histograma
+ * @param percentile Percentil entre 0 e 100
+ * @return Maior valor equivalente ao intervalo do percentil, em nanossegundos (0 se vazio)
+ */
+uint64_t latency_percentile(const LatencyHistogram *hist, double percentile);
+
+/**
+ * @brief Limpa todos os histogramas do nó.
+ */
+void latency_reset();
+
+/**
+ * @brief Imprime o cabeçalho das linhas de percentis.
+ */
+void latency_print_header();
+
+/**
+ * @brief Imprime uma linha com os percentis de um histograma.
+ * @param label Nome da linha
+ * @param hist Histograma (nada é impresso se estiver vazio)
+ */
+void latency_print_row(const char *label, const LatencyHistogram *hist);
+
+/**
+ * @brief Acrescenta os histogramas no formato de texto do Prometheus (sumários).
+ *
+ * @param buffer Buffer de destino
+ * @param size Tamanho do buffer
+ * @param len Bytes já usados no buffer
+ * @return Novo número de bytes usados
+ */
+size_t latency_format_prometheus(char *buffer, size_t size, size_t len);
+
+/**
+ * @brief Processa o comando "show latency" (sl) para mostrar os percentis de latência.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_show_latency();
+
+/**
+ * @brief Processa o comando "latency reset" para limpar os histogramas.
+ *
+ * @param arg Subcomando ("reset")
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_latency(char *arg);
+
+#endif /* LATENCY_H */
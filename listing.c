@@ -0,0 +1,375 @@
+/**
+ * @file listing.c
+ * @brief Implementação das listagens paginadas de objetos e da tabela de interesses
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém o cursor da listagem em curso, o avanço limitado a
+ * partir do ciclo principal, a apresentação dos objetos e das entradas da
+ * tabela de interesses e o comando "more".
+ */
+
+#include "listing.h"
+#include "latency.h"
+
+/**
+ * @brief Tipo da listagem em curso.
+ */
+typedef enum {
+    LISTING_IDLE = 0,
+    LISTING_NAMES,
+    LISTING_INTERESTS
+} ListingKind;
+
+/**
+ * @brief Estado da listagem em curso.
+ */
+static struct {
+    ListingKind kind;
+    int section;                        /* Nomes: 0 = objetos locais, 1 = cache */
+    int section_started;                /* Cabeçalho da secção já escrito */
+    void *cursor;                       /* Próximo elemento a visitar */
+    char prefix[MAX_OBJECT_NAME + 1];   /* Filtro por prefixo ("" = todos) */
+    size_t prefix_len;
+    int page_size;
+    int page_left;                      /* Elementos que ainda cabem na página */
+    int unlimited;                      /* "more all": sem paginação */
+    int prompted;                       /* Aviso de fim de página já escrito */
+    int column;                         /* Coluna atual (nomes em 3 colunas) */
+    unsigned long section_matches;
+    unsigned long matches;
+    unsigned long scanned;
+} listing;
+
+/**
+ * @brief Prepara uma nova listagem, substituindo a que estiver em curso.
+ */
+static void listing_begin(ListingKind kind, const char *prefix, int page_size) {
+    memset(&listing, 0, sizeof(listing));
+    listing.kind = kind;
+    listing.page_size = page_size;
+    listing.page_left = page_size;
+    if (prefix != NULL) {
+        strncpy(listing.prefix, prefix, MAX_OBJECT_NAME);
+        listing.prefix[MAX_OBJECT_NAME] = '\0';
+        listing.prefix_len = strlen(listing.prefix);
+    }
+}
+
+/**
+ * @brief Verifica se um nome passa o filtro da listagem.
+ */
+static int listing_matches(const char *name) {
+    return strncmp(name, listing.prefix, listing.prefix_len) == 0;
+}
+
+/**
+ * @brief Termina a linha de nomes em curso, se houver.
+ */
+static void end_column_line() {
+    if (listing.column != 0) {
+        printf("\n");
+        listing.column = 0;
+    }
+}
+
+/**
+ * @brief Escreve o resumo final e termina a listagem.
+ */
+static void listing_finish(const char *what) {
+    end_column_line();
+    if (listing.prefix_len > 0) {
+        printf("%s%s%lu matching %s for prefix \"%s\" (%lu scanned)%s\n\n", COLOR_BOLD, COLOR_BLUE,
+               listing.matches, what, listing.prefix, listing.scanned, COLOR_RESET);
+    } else {
+        printf("%s%sTotal %s: %lu%s\n\n", COLOR_BOLD, COLOR_BLUE, what, listing.matches, COLOR_RESET);
+    }
+    listing.kind = LISTING_IDLE;
+}
+
+/**
+ * @brief Começa a listagem dos objetos locais e em cache.
+ *
+ * @param prefix Prefixo dos nomes a mostrar, ou NULL para todos
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int listing_start_names(const char *prefix) {
+    listing_begin(LISTING_NAMES, prefix, LISTING_PAGE_NAMES);
+
+    printf("\n%s%s┌───────────────────────────────────────────────────┐%s\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s│               STORED OBJECTS                       │%s\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s└───────────────────────────────────────────────────┘%s\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    return 0;
+}
+
+/**
+ * @brief Começa a listagem da tabela de interesses.
+ *
+ * @param prefix Prefixo dos nomes a mostrar, ou NULL para todos
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int listing_start_interests(const char *prefix) {
+    listing_begin(LISTING_INTERESTS, prefix, LISTING_PAGE_INTERESTS);
+    listing.cursor = node.interest_table;
+
+    printf("\n%s%s┌───────────────────────────────────────────────────┐%s\n", COLOR_BOLD, COLOR_MAGENTA, COLOR_RESET);
+    printf("%s%s│               INTEREST TABLE                       │%s\n", COLOR_BOLD, COLOR_MAGENTA, COLOR_RESET);
+    printf("%s%s└───────────────────────────────────────────────────┘%s\n", COLOR_BOLD, COLOR_MAGENTA, COLOR_RESET);
+    return 0;
+}
+
+/**
+ * @brief Avança a listagem de nomes até esgotar o orçamento ou a página.
+ */
+static void step_names(int budget) {
+    while (budget > 0 && (listing.unlimited || listing.page_left > 0)) {
+        if (!listing.section_started) {
+            if (listing.section == 0) {
+                printf("%s%sLOCAL OBJECTS:%s\n", COLOR_BOLD, COLOR_GREEN, COLOR_RESET);
+                listing.cursor = node.objects;
+            } else {
+                printf("\n%s%sCACHED OBJECTS (%d/%d):%s\n", COLOR_BOLD, COLOR_YELLOW,
+                       node.current_cache_size, node.cache_size, COLOR_RESET);
+                listing.cursor = node.cache;
+            }
+            listing.section_started = 1;
+            listing.section_matches = 0;
+            listing.column = 0;
+        }
+
+        if (listing.cursor == NULL) {
+            /* Fim da secção atual */
+            end_column_line();
+            if (listing.section_matches == 0) {
+                if (listing.prefix_len > 0) {
+                    printf("  No matching objects\n");
+                } else {
+                    printf(listing.section == 0 ? "  No objects stored locally\n" : "  Cache is empty\n");
+                }
+            }
+            listing.section_started = 0;
+            if (++listing.section == 2) {
+                printf("\n");
+                listing_finish("objects");
+                return;
+            }
+            continue;
+        }
+
+        Object *obj = listing.cursor;
+        listing.cursor = obj->next;
+        listing.scanned++;
+        budget--;
+
+        if (!listing_matches(obj->name)) {
+            continue;
+        }
+
+        const char *color = listing.section == 0 ? COLOR_GREEN : COLOR_YELLOW;
+        printf("  %s%-24s%s", color, obj->name, COLOR_RESET);
+        if (++listing.column == 3) {
+            end_column_line();
+        }
+        listing.section_matches++;
+        listing.matches++;
+        listing.page_left--;
+    }
+}
+
+/**
+ * @brief Escreve as interfaces de uma entrada que estão num dado estado.
+ */
+static void print_state_interfaces(InterestEntry *entry, const int *valid_interfaces,
+                                   enum interface_state state, const char *label, const char *color) {
+    printf("    %s%s%s%s ", COLOR_BOLD, color, label, COLOR_RESET);
+    int first = 1;
+    for (int i = 0; i < MAX_INTERFACE; i++) {
+        if (!valid_interfaces[i] || entry->interface_states[i] != (int)state) {
+            continue;
+        }
+        if (!first) {
+            printf(", ");
+        }
+        first = 0;
+
+        if (i == MAX_INTERFACE - 1) {
+            printf("%sLOCAL%s", COLOR_CYAN, COLOR_RESET);
+            continue;
+        }
+
+        /* Procura o vizinho desta interface */
+        Neighbor *n;
+        for (n = node.neighbors; n != NULL; n = n->next) {
+            if (n->interface_id == i) {
+                break;
+            }
+        }
+        if (n != NULL) {
+            printf("%s%d%s (%s:%s)", color, i, COLOR_RESET, n->ip, n->port);
+        } else {
+            printf("%s%d%s", color, i, COLOR_RESET);
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Escreve uma entrada da tabela de interesses.
+ *
+ * Apenas são consideradas as interfaces válidas: a interface local e as
+ * que correspondem a vizinhos ligados.
+ */
+static void print_interest_entry(InterestEntry *entry) {
+    int valid_interfaces[MAX_INTERFACE] = {0};
+    valid_interfaces[MAX_INTERFACE - 1] = 1;
+    for (Neighbor *n = node.neighbors; n != NULL; n = n->next) {
+        if (n->interface_id > 0 && n->interface_id < MAX_INTERFACE) {
+            valid_interfaces[n->interface_id] = 1;
+        }
+    }
+
+    printf("%s%sINTEREST:%s \"%s%s%s\"\n",
+           COLOR_BOLD, COLOR_BLUE, COLOR_RESET,
+           COLOR_CYAN, entry->name, COLOR_RESET);
+
+    int response_count = 0;
+    int waiting_count = 0;
+    int closed_count = 0;
+    for (int i = 0; i < MAX_INTERFACE; i++) {
+        if (valid_interfaces[i]) {
+            if (entry->interface_states[i] == RESPONSE)
+                response_count++;
+            else if (entry->interface_states[i] == WAITING)
+                waiting_count++;
+            else if (entry->interface_states[i] == CLOSED)
+                closed_count++;
+        }
+    }
+
+    printf("  %sSummary:%s %s%d response%s, %s%d waiting%s, %s%d closed%s\n",
+           COLOR_BOLD, COLOR_RESET,
+           COLOR_GREEN, response_count, COLOR_RESET,
+           COLOR_YELLOW, waiting_count, COLOR_RESET,
+           COLOR_RED, closed_count, COLOR_RESET);
+
+    printf("  %sInterfaces:%s\n", COLOR_BOLD, COLOR_RESET);
+    if (response_count > 0) {
+        print_state_interfaces(entry, valid_interfaces, RESPONSE, "RESPONSE:", COLOR_GREEN);
+    }
+    if (waiting_count > 0) {
+        print_state_interfaces(entry, valid_interfaces, WAITING, "WAITING: ", COLOR_YELLOW);
+    }
+    if (closed_count > 0) {
+        print_state_interfaces(entry, valid_interfaces, CLOSED, "CLOSED:  ", COLOR_RED);
+    }
+
+    int age = (int)difftime(monotonic_seconds(), entry->timestamp);
+    uint64_t now = monotonic_ns();
+    long expires_ms = entry->expires_ns > now ? (long)((entry->expires_ns - now) / 1000000) : 0;
+    printf("  %sAge:%s %s%d seconds%s | %sExpires in:%s %ld ms\n\n",
+           COLOR_BOLD, COLOR_RESET,
+           (age > 5) ? COLOR_YELLOW : COLOR_GREEN, age, COLOR_RESET,
+           COLOR_BOLD, COLOR_RESET, expires_ms);
+}
+
+/**
+ * @brief Avança a listagem da tabela de interesses até esgotar o orçamento ou a página.
+ */
+static void step_interests(int budget) {
+    while (budget > 0 && (listing.unlimited || listing.page_left > 0)) {
+        if (listing.cursor == NULL) {
+            if (listing.matches == 0) {
+                printf("%s%s%s\n\n", COLOR_YELLOW,
+                       listing.prefix_len > 0 ? "No matching interests" : "No active interests", COLOR_RESET);
+            }
+            listing_finish("entries");
+            return;
+        }
+
+        InterestEntry *entry = listing.cursor;
+        listing.cursor = entry->next;
+        listing.scanned++;
+        budget--;
+
+        if (entry->marked_for_removal || !listing_matches(entry->name)) {
+            continue;
+        }
+
+        print_interest_entry(entry);
+        listing.matches++;
+        listing.page_left--;
+    }
+}
+
+/**
+ * @brief Avança a listagem em curso, com trabalho limitado.
+ *
+ * Chamada uma vez por iteração do ciclo principal.
+ */
+void listing_step() {
+    if (listing.kind == LISTING_IDLE) {
+        return;
+    }
+
+    if (listing.kind == LISTING_NAMES) {
+        step_names(LISTING_SCAN_BUDGET);
+    } else {
+        step_interests(LISTING_SCAN_BUDGET);
+    }
+
+    if (listing.kind != LISTING_IDLE && !listing.unlimited && listing.page_left == 0 && !listing.prompted) {
+        end_column_line();
+        printf("%s-- %lu shown, 'more' for the next page, 'more all' for the rest --%s\n",
+               COLOR_BOLD, listing.matches, COLOR_RESET);
+        listing.prompted = 1;
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief Obtém o tempo até à próxima chamada necessária de listing_step.
+ *
+ * @return 0 se a listagem tiver trabalho pendente, -1 caso contrário
+ */
+int listing_next_timeout_ms() {
+    if (listing.kind != LISTING_IDLE && (listing.unlimited || listing.page_left > 0)) {
+        return 0;
+    }
+    return -1;
+}
+
+/**
+ * @brief Avança o cursor se estiver a apontar para um elemento que vai ser libertado.
+ *
+ * @param element Elemento (Object ou InterestEntry) prestes a ser libertado
+ * @param next Elemento seguinte na mesma lista
+ */
+void listing_forget(const void *element, void *next) {
+    if (listing.kind != LISTING_IDLE && listing.cursor == element) {
+        listing.cursor = next;
+    }
+}
+
+/**
+ * @brief Processa o comando "more" para continuar a listagem em curso.
+ *
+ * @param arg "all" para mostrar o resto sem paginação, ou NULL para a próxima página
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_more(char *arg) {
+    if (arg != NULL && strcmp(arg, "all") != 0) {
+        printf("%sUsage: more [all]%s\n", COLOR_RED, COLOR_RESET);
+        return -1;
+    }
+    if (listing.kind == LISTING_IDLE) {
+        printf("%sNo listing in progress (use 'sn' or 'si')%s\n", COLOR_YELLOW, COLOR_RESET);
+        return 0;
+    }
+
+    if (arg != NULL) {
+        listing.unlimited = 1;
+    }
+    listing.page_left = listing.page_size;
+    listing.prompted = 0;
+    return 0;
+}
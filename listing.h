@@ -0,0 +1,78 @@
+/**
+ * @file listing.h
+ * @brief Listagens paginadas e incrementais de objetos e da tabela de interesses
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém as declarações das listagens dos comandos
+ * "show names" (sn) e "show interest table" (si). Em vez de percorrer e
+ * escrever a lista inteira de uma vez, cada listagem guarda um cursor e
+ * avança a partir do ciclo principal:
+ *
+ * - Em cada iteração visita no máximo LISTING_SCAN_BUDGET elementos, pelo
+ *   que o encaminhamento continua enquanto se consulta o estado do nó
+ * - Pára ao fim de uma página; "more" mostra a página seguinte e
+ *   "more all" escreve o resto, sempre de forma incremental
+ * - Pode ser filtrada por prefixo do nome
+ *
+ * O cursor aponta para o próximo elemento a visitar. Quem remove
+ * elementos das listas chama listing_forget antes de os libertar, para
+ * que o cursor avance em vez de ficar a apontar para memória libertada.
+ */
+
+#ifndef LISTING_H
+#define LISTING_H
+
+#include "ndn.h"
+
+#define LISTING_SCAN_BUDGET 512     /* Elementos visitados por iteração do ciclo principal */
+#define LISTING_PAGE_NAMES 60       /* Nomes por página (20 linhas de 3 colunas) */
+#define LISTING_PAGE_INTERESTS 10   /* Entradas da tabela de interesses por página */
+
+/**
+ * @brief Começa a listagem dos objetos locais e em cache.
+ *
+ * @param prefix Prefixo dos nomes a mostrar, ou NULL para todos
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int listing_start_names(const char *prefix);
+
+/**
+ * @brief Começa a listagem da tabela de interesses.
+ *
+ * @param prefix Prefixo dos nomes a mostrar, ou NULL para todos
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int listing_start_interests(const char *prefix);
+
+/**
+ * @brief Avança a listagem em curso, com trabalho limitado.
+ *
+ * Chamada uma vez por iteração do ciclo principal.
+ */
+void listing_step();
+
+/**
+ * @brief Obtém o tempo até à próxima chamada necessária de listing_step.
+ *
+ * @return 0 se a listagem tiver trabalho pendente, -1 caso contrário
+ */
+int listing_next_timeout_ms();
+
+/**
+ * @brief Avança o cursor se estiver a apontar para um elemento que vai ser libertado.
+ *
+ * @param element Elemento (Object ou InterestEntry) prestes a ser libertado
+ * @param next Elemento seguinte na mesma lista
+ */
+void listing_forget(const void *element, void *next);
+
+/**
+ * @brief Processa o comando "more" para continuar a listagem em curso.
+ *
+ * @param arg "all" para mostrar o resto sem paginação, ou NULL para a próxima página
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_more(char *arg);
+
+#endif /* LISTING_H */
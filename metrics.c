@@ -0,0 +1,766 @@
+/**
+ * @file metrics.c
+ * @brief Implementação do registo de métricas do nó NDN
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a gestão dos fragmentos de métricas por thread, a
+ * agregação para leitura, o comando "show stats" e o porto local de
+ * recolha no formato de texto do Prometheus.
+ */
+
+#include "metrics.h"
+#include "latency.h"
+#include "wire.h"
+#include <stdarg.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <malloc.h>
+
+__thread MetricsShard *metrics_shard = NULL;
+int metrics_listen_fd = -1;
+
+/* Fragmentos registados; o primeiro é estático para a thread principal */
+static MetricsShard main_shard;
+static MetricsShard *shards[METRICS_MAX_SHARDS] = {&main_shard};
+static int shard_count = 0;
+static pthread_mutex_t shard_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Fragmento partilhado para threads além de METRICS_MAX_SHARDS */
+static MetricsShard overflow_shard;
+
+/* Estado de uma ligação ao porto de recolha */
+enum {
+    SCRAPE_READING,                     /* À espera do pedido */
+    SCRAPE_WRITING,                     /* A escrever a resposta */
+    SCRAPE_CLOSING                      /* Resposta enviada, a consumir o resto até o cliente fechar */
+};
+
+typedef struct scrape_client {
+    int fd;                             /* -1 se a entrada estiver livre */
+    int state;
+    char *response;                     /* Cabeçalho e corpo, enquanto houver por enviar */
+    size_t len;
+    size_t sent;
+    uint64_t since_ns;                  /* Última atividade */
+} ScrapeClient;
+
+static ScrapeClient scrape_clients[METRICS_MAX_CLIENTS] = {
+    [0 ... METRICS_MAX_CLIENTS - 1] = {.fd = -1}
+};
+
+/* Valores no último "stats reset", subtraídos em "show stats" */
+static MetricsSnapshot baseline;
+
+/* Acertos por interface de vizinhos removidos, somados em metrics_snapshot() */
+static MetricsSnapshot retired;
+
+/* Nome e descrição de cada contador global para exportação */
+static const struct {
+    const char *name;
+    const char *help;
+} metric_info[MET_COUNT] = {
+    [MET_PIT_INSERTS]        = {"ndn_pit_inserts_total",          "Interest table entries created"},
+    [MET_PIT_SATISFIED]      = {"ndn_pit_satisfied_total",        "Interest table entries satisfied by an OBJECT"},
+    [MET_PIT_CLOSED]         = {"ndn_pit_closed_total",           "Interest table entries closed by NOOBJECT on every path"},
+    [MET_PIT_EXPIRED]        = {"ndn_pit_expired_total",          "Interest table entries expired by timeout"},
+    [MET_PIT_AGGREGATED]     = {"ndn_pit_aggregated_total",       "Interests aggregated into an entry already forwarded"},
+    [MET_CACHE_HITS]         = {"ndn_cache_hits_total",           "Interests answered from the cache"},
+    [MET_CACHE_MISSES]       = {"ndn_cache_misses_total",         "Interests not answered locally"},
+    [MET_CACHE_INSERTS]      = {"ndn_cache_inserts_total",        "Objects inserted in the cache"},
+    [MET_CACHE_EVICTIONS]    = {"ndn_cache_evictions_total",      "Objects evicted from the cache"},
+    [MET_LOCAL_HITS]         = {"ndn_local_hits_total",           "Interests answered from local objects"},
+    [MET_NO_ROUTE]           = {"ndn_no_route_total",             "Interests answered with NOOBJECT, or local retrieves refused, for lack of neighbors"},
+    [MET_UNSOLICITED]        = {"ndn_unsolicited_total",          "OBJECT or NOOBJECT received without a matching entry"},
+    [MET_MALFORMED]          = {"ndn_malformed_total",            "Malformed or unknown messages"},
+    [MET_SEND_ERRORS]        = {"ndn_send_errors_total",          "Failed writes to neighbor sockets"},
+    [MET_TOPO_NEIGHBOR_UP]   = {"ndn_topology_neighbor_up_total", "Neighbors added"},
+    [MET_TOPO_NEIGHBOR_DOWN] = {"ndn_topology_neighbor_down_total", "Neighbors removed"},
+    [MET_TOPO_EXTERNAL_LOST] = {"ndn_topology_external_lost_total", "External neighbor losses"},
+    [MET_TOPO_SAFE_UPDATES]  = {"ndn_topology_safe_updates_total", "SAFE messages applied"},
+    [MET_TOPO_JOINS]         = {"ndn_topology_joins_total",       "Network joins"},
+    [MET_TOPO_LEAVES]        = {"ndn_topology_leaves_total",      "Network leaves"},
+    [MET_RETRIEVE_REQUESTS]  = {"ndn_retrieve_requests_total",    "Local retrieve requests sent to the network"},
+    [MET_RETRIEVE_OK]        = {"ndn_retrieve_ok_total",          "Local retrieve requests satisfied by the network"},
+    [MET_RETRIEVE_FAILED]    = {"ndn_retrieve_failed_total",      "Local retrieve requests ended by NOOBJECT or timeout"},
+    [MET_NAMES_LITERAL]      = {"ndn_wire_names_literal_total",   "Names sent in full in binary frames"},
+    [MET_NAMES_INDEXED]      = {"ndn_wire_names_indexed_total",   "Names sent as a reference to the name table"},
+    [MET_NAMES_PREFIX]       = {"ndn_wire_names_prefix_total",    "Names sent as a name table prefix plus a suffix"},
+    [MET_NAMES_RESYNC]       = {"ndn_wire_name_table_resets_total", "Name table resets asked of neighbors after a mismatch"},
+    [MET_BATCH_FRAMES_IN]    = {"ndn_wire_batch_frames_received_total", "Batched frames received"},
+    [MET_BATCH_NAMES_IN]     = {"ndn_wire_batch_names_received_total", "Names received in batched frames"},
+    [MET_BATCH_FRAMES_OUT]   = {"ndn_wire_batch_frames_sent_total", "Batched frames sent"},
+    [MET_BATCH_NAMES_OUT]    = {"ndn_wire_batch_names_sent_total", "Names sent in batched frames"},
+    [MET_PIT_TOO_LATE]       = {"ndn_pit_too_late_total",         "Interests answered with NOOBJECT because no neighbor could answer within their lifetime"},
+};
+
+static const char *type_names[MSG_TYPE_COUNT] = {
+    [MSG_INTEREST] = "interest",
+    [MSG_OBJECT]   = "object",
+    [MSG_NOOBJECT] = "noobject",
+    [MSG_ENTRY]    = "entry",
+    [MSG_SAFE]     = "safe",
+    [MSG_UNKNOWN]  = "unknown",
+};
+
+/**
+ * @brief Regista um fragmento para a thread atual.
+ *
+ * A primeira thread a registar-se (a principal) usa o fragmento estático.
+ *
+ * @return Fragmento da thread
+ */
+MetricsShard *metrics_register_thread() {
+    MetricsShard *shard = &overflow_shard;
+
+    pthread_mutex_lock(&shard_lock);
+    if (shard_count == 0) {
+        shard = &main_shard;
+        shard_count = 1;
+    } else if (shard_count < METRICS_MAX_SHARDS) {
+        MetricsShard *fresh = aligned_alloc(METRICS_CACHE_LINE, sizeof(MetricsShard));
+        if (fresh != NULL) {
+            memset(fresh, 0, sizeof(MetricsShard));
+            shards[shard_count++] = fresh;
+            shard = fresh;
+        }
+    }
+    pthread_mutex_unlock(&shard_lock);
+
+    metrics_shard = shard;
+    return shard;
+}
+
+/**
+ * @brief Determina o tipo de uma mensagem a partir do seu início.
+ *
+ * Reconhece as mensagens de texto e as tramas binárias (wire.h).
+ *
+ * @param message Mensagem de protocolo
+ * @return Tipo de mensagem, MSG_UNKNOWN se não for reconhecida
+ */
+MsgType metrics_classify(const char *message) {
+    switch (message[0]) {
+        case 'I': if (strncmp(message, "INTEREST ", 9) == 0) return MSG_INTEREST; break;
+        case 'O': if (strncmp(message, "OBJECT ", 7) == 0) return MSG_OBJECT; break;
+        case 'N': if (strncmp(message, "NOOBJECT ", 9) == 0) return MSG_NOOBJECT; break;
+        case 'E': if (strncmp(message, "ENTRY ", 6) == 0) return MSG_ENTRY; break;
+        case 'S': if (strncmp(message, "SAFE ", 5) == 0) return MSG_SAFE; break;
+        case WIRE_INTEREST: return MSG_INTEREST;
+        case WIRE_OBJECT: return MSG_OBJECT;
+        case WIRE_NOOBJECT: return MSG_NOOBJECT;
+        case WIRE_INTEREST_BATCH: return MSG_INTEREST;
+        case WIRE_OBJECT_BATCH: return MSG_OBJECT;
+        case WIRE_NOOBJECT_BATCH: return MSG_NOOBJECT;
+        default: break;
+    }
+    return MSG_UNKNOWN;
+}
+
+/**
+ * @brief Obtém o nome de um tipo de mensagem.
+ *
+ * @param type Tipo de mensagem
+ * @return Nome em minúsculas
+ */
+const char *metrics_type_name(MsgType type) {
+    return (type >= 0 && type < MSG_TYPE_COUNT) ? type_names[type] : "unknown";
+}
+
+/**
+ * @brief Soma um fragmento a uma estrutura agregada.
+ */
+static void add_shard(MetricsSnapshot *snap, MetricsShard *shard) {
+    for (int i = 0; i < MET_COUNT; i++) {
+        snap->counters[i] += atomic_load_explicit(&shard->counters[i], memory_order_relaxed);
+    }
+    for (int f = 0; f < METRICS_FACE_SLOTS; f++) {
+        FaceCounters *face = &shard->faces[f];
+        for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+            snap->packets_in[f][t] += atomic_load_explicit(&face->packets_in[t], memory_order_relaxed);
+            snap->bytes_in[f][t] += atomic_load_explicit(&face->bytes_in[t], memory_order_relaxed);
+            snap->packets_out[f][t] += atomic_load_explicit(&face->packets_out[t], memory_order_relaxed);
+            snap->bytes_out[f][t] += atomic_load_explicit(&face->bytes_out[t], memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Soma todos os fragmentos e lê as medidas instantâneas do nó.
+ *
+ * As medidas instantâneas vêm da estrutura global do nó, pelo que esta
+ * função deve ser chamada a partir do ciclo principal.
+ *
+ * @param snap Estrutura a preencher
+ */
+void metrics_snapshot(MetricsSnapshot *snap) {
+    memset(snap, 0, sizeof(*snap));
+
+    pthread_mutex_lock(&shard_lock);
+    for (int i = 0; i < shard_count; i++) {
+        add_shard(snap, shards[i]);
+    }
+    pthread_mutex_unlock(&shard_lock);
+    add_shard(snap, &overflow_shard);
+    for (int f = 0; f < METRICS_FACE_SLOTS; f++) {
+        for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+            snap->packets_in[f][t] += retired.packets_in[f][t];
+            snap->bytes_in[f][t] += retired.bytes_in[f][t];
+            snap->packets_out[f][t] += retired.packets_out[f][t];
+            snap->bytes_out[f][t] += retired.bytes_out[f][t];
+        }
+    }
+
+    snap->pit_entries = node.interest_count;
+    snap->cache_entries = node.current_cache_size;
+    snap->cache_capacity = node.cache_size;
+    snap->in_network = node.in_network;
+    for (Neighbor *n = node.neighbors; n != NULL; n = n->next) {
+        snap->neighbors++;
+    }
+    for (Neighbor *n = node.internal_neighbors; n != NULL; n = n->next) {
+        snap->internal_neighbors++;
+    }
+}
+
+/**
+ * @brief Passa as contagens de uma linha por interface para a entrada "other".
+ */
+static void retire_row(unsigned long (*table)[MSG_TYPE_COUNT], unsigned long (*offset)[MSG_TYPE_COUNT],
+                       unsigned long (*base)[MSG_TYPE_COUNT], int slot) {
+    for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+        offset[slot][t] -= table[slot][t];
+        offset[MAX_INTERFACE][t] += table[slot][t];
+        base[MAX_INTERFACE][t] += base[slot][t];
+        base[slot][t] = 0;
+    }
+}
+
+/**
+ * @brief Liberta a entrada de uma interface cujo vizinho foi removido.
+ *
+ * As contagens acumuladas passam para a entrada dos IDs fora do intervalo,
+ * pelo que os totais do nó se mantêm e um vizinho que reutilize o ID
+ * começa do zero. Os fragmentos das threads não são escritos, apenas
+ * compensados; deve ser chamada a partir do ciclo principal.
+ *
+ * @param interface_id Interface do vizinho removido
+ */
+void metrics_retire_face(int interface_id) {
+    int slot = metrics_face_slot(interface_id);
+    if (slot == MAX_INTERFACE) {
+        return;
+    }
+
+    MetricsSnapshot now;
+    metrics_snapshot(&now);
+    retire_row(now.packets_in, retired.packets_in, baseline.packets_in, slot);
+    retire_row(now.bytes_in, retired.bytes_in, baseline.bytes_in, slot);
+    retire_row(now.packets_out, retired.packets_out, baseline.packets_out, slot);
+    retire_row(now.bytes_out, retired.bytes_out, baseline.bytes_out, slot);
+}
+
+/**
+ * @brief Lê a memória residente do processo e as estatísticas do alocador.
+ *
+ * A memória residente vem de /proc/self/statm; as estatísticas do alocador
+ * de mallinfo2() (glibc 2.33 ou posterior), que cobre todas as arenas.
+ *
+ * @param mem Estrutura a preencher
+ */
+void metrics_memory(MetricsMemory *mem) {
+    memset(mem, 0, sizeof(*mem));
+
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm != NULL) {
+        unsigned long size, resident;
+        if (fscanf(statm, "%lu %lu", &size, &resident) == 2) {
+            mem->resident_bytes = resident * (unsigned long)sysconf(_SC_PAGESIZE);
+        }
+        fclose(statm);
+    }
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    mem->heap_in_use = info.uordblks + info.hblkhd;
+    mem->heap_free = info.fordblks;
+    mem->heap_mapped = info.hblkhd;
+#endif
+}
+
+/**
+ * @brief Acrescenta texto formatado a um buffer, sem ultrapassar o tamanho.
+ */
+static size_t append(char *buffer, size_t size, size_t len, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static size_t append(char *buffer, size_t size, size_t len, const char *format, ...) {
+    if (len >= size) {
+        return len;
+    }
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + len, size - len, format, args);
+    va_end(args);
+
+    if (written < 0) {
+        return len;
+    }
+    len += (size_t)written;
+    return len < size ? len : size - 1;
+}
+
+/**
+ * @brief Acrescenta uma série por interface, direção e tipo.
+ */
+static size_t append_face_series(char *buffer, size_t size, size_t len, const char *name,
+                                 const char *dir, unsigned long values[METRICS_FACE_SLOTS][MSG_TYPE_COUNT]) {
+    for (int f = 0; f < METRICS_FACE_SLOTS; f++) {
+        for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+            if (values[f][t] == 0) {
+                continue;
+            }
+            if (f == MAX_INTERFACE) {
+                len = append(buffer, size, len, "%s{face=\"other\",dir=\"%s\",type=\"%s\"} %lu\n",
+                             name, dir, type_names[t], values[f][t]);
+            } else {
+                len = append(buffer, size, len, "%s{face=\"%d\",dir=\"%s\",type=\"%s\"} %lu\n",
+                             name, f, dir, type_names[t], values[f][t]);
+            }
+        }
+    }
+    return len;
+}
+
+/**
+ * @brief Formata as métricas no formato de texto do Prometheus.
+ *
+ * Os contadores são exportados desde o arranque (não são afetados por
+ * "stats reset"); só as séries com valor diferente de zero são listadas
+ * por interface.
+ *
+ * @param buffer Buffer de destino
+ * @param size Tamanho do buffer
+ * @return Número de bytes escritos
+ */
+size_t metrics_format_prometheus(char *buffer, size_t size) {
+    MetricsSnapshot snap;
+    MetricsMemory mem;
+    size_t len = 0;
+
+    if (size == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    metrics_snapshot(&snap);
+    metrics_memory(&mem);
+
+    len = append(buffer, size, len, "# HELP ndn_packets_total Messages by face, direction and type\n"
+                                    "# TYPE ndn_packets_total counter\n");
+    len = append_face_series(buffer, size, len, "ndn_packets_total", "in", snap.packets_in);
+    len = append_face_series(buffer, size, len, "ndn_packets_total", "out", snap.packets_out);
+
+    len = append(buffer, size, len, "# HELP ndn_bytes_total Bytes by face, direction and message type\n"
+                                    "# TYPE ndn_bytes_total counter\n");
+    len = append_face_series(buffer, size, len, "ndn_bytes_total", "in", snap.bytes_in);
+    len = append_face_series(buffer, size, len, "ndn_bytes_total", "out", snap.bytes_out);
+
+    for (int i = 0; i < MET_COUNT; i++) {
+        len = append(buffer, size, len, "# HELP %s %s\n# TYPE %s counter\n%s %lu\n",
+                     metric_info[i].name, metric_info[i].help,
+                     metric_info[i].name, metric_info[i].name, snap.counters[i]);
+    }
+
+    len = append(buffer, size, len,
+                 "# HELP ndn_pit_entries Current interest table entries\n"
+                 "# TYPE ndn_pit_entries gauge\nndn_pit_entries %d\n"
+                 "# HELP ndn_cache_entries Objects currently cached\n"
+                 "# TYPE ndn_cache_entries gauge\nndn_cache_entries %d\n"
+                 "# HELP ndn_cache_capacity Cache capacity\n"
+                 "# TYPE ndn_cache_capacity gauge\nndn_cache_capacity %d\n"
+                 "# HELP ndn_neighbors Connected neighbors\n"
+                 "# TYPE ndn_neighbors gauge\nndn_neighbors %d\n"
+                 "# HELP ndn_internal_neighbors Internal neighbors\n"
+                 "# TYPE ndn_internal_neighbors gauge\nndn_internal_neighbors %d\n"
+                 "# HELP ndn_in_network Whether the node is in a network\n"
+                 "# TYPE ndn_in_network gauge\nndn_in_network %d\n"
+                 "# HELP ndn_resident_bytes Resident memory of the process\n"
+                 "# TYPE ndn_resident_bytes gauge\nndn_resident_bytes %lu\n"
+                 "# HELP ndn_heap_in_use_bytes Bytes allocated by malloc\n"
+                 "# TYPE ndn_heap_in_use_bytes gauge\nndn_heap_in_use_bytes %lu\n"
+                 "# HELP ndn_heap_free_bytes Free bytes held by the allocator\n"
+                 "# TYPE ndn_heap_free_bytes gauge\nndn_heap_free_bytes %lu\n",
+                 snap.pit_entries, snap.cache_entries, snap.cache_capacity,
+                 snap.neighbors, snap.internal_neighbors, snap.in_network,
+                 mem.resident_bytes, mem.heap_in_use, mem.heap_free);
+
+    return latency_format_prometheus(buffer, size, len);
+}
+
+/**
+ * @brief Abre o porto local de recolha de métricas.
+ *
+ * @param port Porto TCP em 127.0.0.1
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int metrics_listen(const char *port) {
+    int port_num = atoi(port);
+    if (port_num <= 0 || port_num > 65535) {
+        printf("%sInvalid port: %s%s\n", COLOR_RED, port, COLOR_RESET);
+        return -1;
+    }
+
+    metrics_close();
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1) {
+        perror("socket");
+        return -1;
+    }
+
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port_num);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, 8) == -1) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    metrics_listen_fd = fd;
+    if (fd > node.max_fd) {
+        node.max_fd = fd;
+    }
+    return 0;
+}
+
+/**
+ * @brief Fecha uma ligação ao porto de recolha e liberta a sua entrada.
+ */
+static void scrape_client_close(ScrapeClient *client) {
+    close(client->fd);
+    free(client->response);
+    client->fd = -1;
+    client->response = NULL;
+}
+
+/**
+ * @brief Fecha o porto de recolha de métricas, se estiver aberto.
+ */
+void metrics_close() {
+    if (metrics_listen_fd >= 0) {
+        close(metrics_listen_fd);
+        metrics_listen_fd = -1;
+    }
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+        if (scrape_clients[i].fd >= 0) {
+            scrape_client_close(&scrape_clients[i]);
+        }
+    }
+}
+
+/**
+ * @brief Lê e descarta o que já chegou numa ligação não bloqueante.
+ *
+ * @param fd Ligação
+ * @param open Fica a 0 se o cliente fechou a ligação ou houve erro, 1 caso contrário
+ * @return Número de bytes lidos
+ */
+static size_t metrics_drain(int fd, int *open) {
+    char request[512];
+    size_t total = 0;
+    ssize_t n;
+    while ((n = read(fd, request, sizeof(request))) > 0) {
+        total += (size_t)n;
+    }
+    *open = n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    return total;
+}
+
+/**
+ * @brief Prepara a resposta HTTP com as métricas atuais para uma ligação.
+ *
+ * @return 0 em caso de sucesso, -1 se não houver memória
+ */
+static int scrape_client_respond(ScrapeClient *client) {
+    static char body[METRICS_SCRAPE_BUFFER];
+    char header[128];
+
+    size_t body_len = metrics_format_prometheus(body, sizeof(body));
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.0 200 OK\r\n"
+                              "Content-Type: text/plain; version=0.0.4\r\n"
+                              "Content-Length: %zu\r\n\r\n", body_len);
+
+    client->response = malloc((size_t)header_len + body_len);
+    if (client->response == NULL) {
+        return -1;
+    }
+    memcpy(client->response, header, (size_t)header_len);
+    memcpy(client->response + header_len, body, body_len);
+    client->len = (size_t)header_len + body_len;
+    client->sent = 0;
+    client->state = SCRAPE_WRITING;
+    return 0;
+}
+
+/**
+ * @brief Acrescenta as ligações do porto de recolha aos conjuntos do select().
+ *
+ * @param read_fds Conjunto de leitura
+ * @param write_fds Conjunto de escrita
+ * @param max_fd Maior descritor já no conjunto
+ * @return Maior descritor depois de acrescentar os do porto de recolha
+ */
+int metrics_fill_fds(fd_set *read_fds, fd_set *write_fds, int max_fd) {
+    if (metrics_listen_fd >= 0) {
+        FD_SET(metrics_listen_fd, read_fds);
+        if (metrics_listen_fd > max_fd) {
+            max_fd = metrics_listen_fd;
+        }
+    }
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+        ScrapeClient *client = &scrape_clients[i];
+        if (client->fd < 0) {
+            continue;
+        }
+        FD_SET(client->fd, client->state == SCRAPE_WRITING ? write_fds : read_fds);
+        if (client->fd > max_fd) {
+            max_fd = client->fd;
+        }
+    }
+    return max_fd;
+}
+
+/**
+ * @brief Aceita ligações e avança as respostas pendentes no porto de recolha.
+ *
+ * O pedido não é interpretado: qualquer ligação recebe as métricas atuais.
+ * Nada bloqueia o ciclo principal: a resposta só é preparada quando o
+ * pedido chega e é escrita à medida que o socket a aceita. Fechar a ligação
+ * com dados por ler enviaria RST, e o cliente podia perder a resposta; por
+ * isso, depois da resposta, a ligação é fechada para escrita (FIN) e o resto
+ * do pedido é consumido até o cliente fechar. Ligações paradas há mais de
+ * METRICS_CLIENT_TIMEOUT_MS são fechadas, e com todas as entradas ocupadas
+ * uma ligação nova substitui a mais antiga que ainda não enviou o pedido.
+ */
+void metrics_handle_scrape(fd_set *read_fds, fd_set *write_fds) {
+    uint64_t now = monotonic_ns();
+
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+        ScrapeClient *client = &scrape_clients[i];
+        if (client->fd < 0) {
+            continue;
+        }
+
+        if (client->state == SCRAPE_WRITING && FD_ISSET(client->fd, write_fds)) {
+            ssize_t n = write(client->fd, client->response + client->sent, client->len - client->sent);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                /* O cliente fechou a ligação; nada a fazer */
+                scrape_client_close(client);
+                continue;
+            }
+            if (n > 0) {
+                client->sent += (size_t)n;
+                client->since_ns = now;
+            }
+            if (client->sent == client->len) {
+                free(client->response);
+                client->response = NULL;
+                shutdown(client->fd, SHUT_WR);
+                client->state = SCRAPE_CLOSING;
+            }
+        } else if (client->state != SCRAPE_WRITING && FD_ISSET(client->fd, read_fds)) {
+            int open;
+            size_t got = metrics_drain(client->fd, &open);
+            client->since_ns = now;
+            /* Um cliente que fecha a escrita depois do pedido ainda recebe a resposta */
+            if (client->state == SCRAPE_READING && got > 0) {
+                if (scrape_client_respond(client) < 0) {
+                    scrape_client_close(client);
+                }
+                continue;
+            }
+            if (!open) {
+                scrape_client_close(client);
+                continue;
+            }
+        }
+
+        if (client->fd >= 0 && now - client->since_ns > (uint64_t)METRICS_CLIENT_TIMEOUT_MS * 1000000ull) {
+            scrape_client_close(client);
+        }
+    }
+
+    if (metrics_listen_fd < 0 || !FD_ISSET(metrics_listen_fd, read_fds)) {
+        return;
+    }
+    int fd;
+    while ((fd = accept(metrics_listen_fd, NULL, NULL)) != -1) {
+        /* Sem entrada livre, a ligação mais antiga que ainda não enviou o pedido dá lugar à nova */
+        ScrapeClient *slot = NULL;
+        for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+            ScrapeClient *client = &scrape_clients[i];
+            if (client->fd < 0) {
+                slot = client;
+                break;
+            }
+            if (client->state == SCRAPE_READING && (slot == NULL || client->since_ns < slot->since_ns)) {
+                slot = client;
+            }
+        }
+        if (slot == NULL) {
+            close(fd);
+            continue;
+        }
+        if (slot->fd >= 0) {
+            scrape_client_close(slot);
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        slot->fd = fd;
+        slot->state = SCRAPE_READING;
+        slot->since_ns = now;
+    }
+}
+
+/**
+ * @brief Soma os valores de um tipo de mensagem em todas as interfaces.
+ */
+static unsigned long sum_type(unsigned long values[METRICS_FACE_SLOTS][MSG_TYPE_COUNT],
+                              unsigned long base[METRICS_FACE_SLOTS][MSG_TYPE_COUNT], int type) {
+    unsigned long total = 0;
+    for (int f = 0; f < METRICS_FACE_SLOTS; f++) {
+        total += values[f][type] - base[f][type];
+    }
+    return total;
+}
+
+/**
+ * @brief Processa o comando "show stats" (ss) para mostrar as métricas do nó.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_show_stats() {
+    MetricsSnapshot snap;
+    metrics_snapshot(&snap);
+
+    unsigned long c[MET_COUNT];
+    for (int i = 0; i < MET_COUNT; i++) {
+        c[i] = snap.counters[i] - baseline.counters[i];
+    }
+
+    printf("\n%s%s┌───────────────────────────────────────────────────┐%s\n", COLOR_BOLD, COLOR_BLUE, COLOR_RESET);
+    printf("%s%s│                   NODE STATISTICS                  │%s\n", COLOR_BOLD, COLOR_BLUE, COLOR_RESET);
+    printf("%s%s└───────────────────────────────────────────────────┘%s\n", COLOR_BOLD, COLOR_BLUE, COLOR_RESET);
+
+    printf("\n%sMessages by type (in / out):%s\n", COLOR_BOLD, COLOR_RESET);
+    for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+        printf("  %-10s %10lu / %-10lu (%lu / %lu bytes)\n", type_names[t],
+               sum_type(snap.packets_in, baseline.packets_in, t),
+               sum_type(snap.packets_out, baseline.packets_out, t),
+               sum_type(snap.bytes_in, baseline.bytes_in, t),
+               sum_type(snap.bytes_out, baseline.bytes_out, t));
+    }
+
+    printf("\n%sPer interface (packets in / out):%s\n", COLOR_BOLD, COLOR_RESET);
+    int shown = 0;
+    for (int f = 0; f < METRICS_FACE_SLOTS; f++) {
+        unsigned long in = 0, out = 0, bytes_in = 0, bytes_out = 0;
+        for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+            in += snap.packets_in[f][t] - baseline.packets_in[f][t];
+            out += snap.packets_out[f][t] - baseline.packets_out[f][t];
+            bytes_in += snap.bytes_in[f][t] - baseline.bytes_in[f][t];
+            bytes_out += snap.bytes_out[f][t] - baseline.bytes_out[f][t];
+        }
+        if (in == 0 && out == 0) {
+            continue;
+        }
+        if (f == MAX_INTERFACE) {
+            printf("  %sother%s      %10lu / %-10lu (%lu / %lu bytes)\n",
+                   COLOR_CYAN, COLOR_RESET, in, out, bytes_in, bytes_out);
+        } else {
+            printf("  %sif:%-2d%s      %10lu / %-10lu (%lu / %lu bytes)\n",
+                   COLOR_CYAN, f, COLOR_RESET, in, out, bytes_in, bytes_out);
+        }
+        shown++;
+    }
+    if (shown == 0) {
+        printf("  %sNo traffic%s\n", COLOR_YELLOW, COLOR_RESET);
+    }
+
+    unsigned long lookups = c[MET_CACHE_HITS] + c[MET_LOCAL_HITS] + c[MET_CACHE_MISSES];
+    printf("\n%sInterest table:%s %d entr%s | inserts %lu | satisfied %lu | closed %lu | expired %lu | too late %lu | aggregated %lu\n",
+           COLOR_BOLD, COLOR_RESET, snap.pit_entries, snap.pit_entries == 1 ? "y" : "ies",
+           c[MET_PIT_INSERTS], c[MET_PIT_SATISFIED], c[MET_PIT_CLOSED],
+           c[MET_PIT_EXPIRED], c[MET_PIT_TOO_LATE], c[MET_PIT_AGGREGATED]);
+    printf("%sCache:%s %d/%d | hits %lu | local %lu | misses %lu (hit ratio %.1f%%) | inserts %lu | evictions %lu\n",
+           COLOR_BOLD, COLOR_RESET, snap.cache_entries, snap.cache_capacity,
+           c[MET_CACHE_HITS], c[MET_LOCAL_HITS], c[MET_CACHE_MISSES],
+           lookups ? 100.0 * (c[MET_CACHE_HITS] + c[MET_LOCAL_HITS]) / lookups : 0.0,
+           c[MET_CACHE_INSERTS], c[MET_CACHE_EVICTIONS]);
+    printf("%sForwarding:%s no route %lu | unsolicited %lu | malformed %lu | send errors %lu\n",
+           COLOR_BOLD, COLOR_RESET, c[MET_NO_ROUTE], c[MET_UNSOLICITED],
+           c[MET_MALFORMED], c[MET_SEND_ERRORS]);
+    printf("%sRetrieve:%s requests %lu | ok %lu | failed %lu\n",
+           COLOR_BOLD, COLOR_RESET, c[MET_RETRIEVE_REQUESTS], c[MET_RETRIEVE_OK], c[MET_RETRIEVE_FAILED]);
+    printf("%sTopology:%s %d neighbor(s), %d internal | up %lu | down %lu | external lost %lu | safe updates %lu | joins %lu | leaves %lu\n",
+           COLOR_BOLD, COLOR_RESET, snap.neighbors, snap.internal_neighbors,
+           c[MET_TOPO_NEIGHBOR_UP], c[MET_TOPO_NEIGHBOR_DOWN], c[MET_TOPO_EXTERNAL_LOST],
+           c[MET_TOPO_SAFE_UPDATES], c[MET_TOPO_JOINS], c[MET_TOPO_LEAVES]);
+    unsigned long names = c[MET_NAMES_LITERAL] + c[MET_NAMES_INDEXED] + c[MET_NAMES_PREFIX];
+    printf("%sWire names:%s literal %lu | indexed %lu | prefix %lu (%.1f%% from the name tables) | resets %lu\n",
+           COLOR_BOLD, COLOR_RESET, c[MET_NAMES_LITERAL], c[MET_NAMES_INDEXED], c[MET_NAMES_PREFIX],
+           names ? 100.0 * (c[MET_NAMES_INDEXED] + c[MET_NAMES_PREFIX]) / names : 0.0, c[MET_NAMES_RESYNC]);
+    printf("%sBatches:%s in %lu frames, %lu names | out %lu frames, %lu names\n",
+           COLOR_BOLD, COLOR_RESET, c[MET_BATCH_FRAMES_IN], c[MET_BATCH_NAMES_IN],
+           c[MET_BATCH_FRAMES_OUT], c[MET_BATCH_NAMES_OUT]);
+
+    MetricsMemory mem;
+    metrics_memory(&mem);
+    printf("%sMemory:%s resident %.1f MB | heap in use %.1f MB | free in heap %.1f MB | mmap %.1f MB\n",
+           COLOR_BOLD, COLOR_RESET, mem.resident_bytes / 1048576.0, mem.heap_in_use / 1048576.0,
+           mem.heap_free / 1048576.0, mem.heap_mapped / 1048576.0);
+
+    if (metrics_listen_fd >= 0) {
+        printf("\n%sScrape endpoint open (fd %d)%s\n", COLOR_GREEN, metrics_listen_fd, COLOR_RESET);
+    }
+    printf("\n");
+    return 0;
+}
+
+/**
+ * @brief Processa o comando "stats" para gerir as métricas.
+ *
+ * @param arg Subcomando ("reset", "listen" ou "close")
+ * @param value Argumento do subcomando, ou NULL
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_stats(char *arg, char *value) {
+    if (arg != NULL && strcmp(arg, "reset") == 0) {
+        metrics_snapshot(&baseline);
+        printf("Statistics reset\n");
+        return 0;
+    } else if (arg != NULL && strcmp(arg, "listen") == 0 && value != NULL) {
+        if (metrics_listen(value) < 0) {
+            return -1;
+        }
+        printf("Serving metrics on http://127.0.0.1:%s/metrics\n", value);
+        return 0;
+    } else if (arg != NULL && strcmp(arg, "close") == 0) {
+        metrics_close();
+        printf("Metrics endpoint closed\n");
+        return 0;
+    }
+
+    printf("%sUsage: stats <reset|listen <port>|close>%s\n", COLOR_RED, COLOR_RESET);
+    return -1;
+}
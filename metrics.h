@@ -0,0 +1,315 @@
+/**
+ * @file metrics.h
+ * @brief Contadores de desempenho do nó NDN
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém as declarações do registo de métricas do nó:
+ *
+ * - Pacotes e bytes recebidos e enviados por interface e tipo de mensagem
+ * - Inserções, satisfações e expirações da tabela de interesses
+ * - Acertos, falhas, inserções e remoções da cache
+ * - Eventos de topologia e resultados dos pedidos locais
+ *
+ * Cada thread escreve num fragmento próprio, alinhado à linha de cache,
+ * pelo que incrementar um contador custa uma leitura e uma escrita sem
+ * instruções atómicas com lock. Os fragmentos são somados apenas quando
+ * alguém lê as métricas (comando "show stats" ou porto de recolha).
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "ndn.h"
+#include <stdatomic.h>
+
+#define METRICS_CACHE_LINE 64                  /* Tamanho da linha de cache */
+#define METRICS_MAX_SHARDS 16                  /* Número máximo de threads com fragmento próprio */
+#define METRICS_FACE_SLOTS (MAX_INTERFACE + 1) /* Interfaces 0..MAX_INTERFACE-1 e uma entrada para IDs fora do intervalo e vizinhos removidos */
+#define METRICS_SCRAPE_BUFFER 65536            /* Tamanho máximo de uma resposta do porto de recolha */
+#define METRICS_MAX_CLIENTS 8                  /* Ligações simultâneas ao porto de recolha */
+#define METRICS_CLIENT_TIMEOUT_MS 5000         /* Ligações paradas ao porto de recolha são fechadas */
+
+/**
+ * @brief Tipos de mensagem do protocolo, para contagem por tipo.
+ */
+typedef enum {
+    MSG_INTEREST = 0,
+    MSG_OBJECT,
+    MSG_NOOBJECT,
+    MSG_ENTRY,
+    MSG_SAFE,
+    MSG_UNKNOWN,
+    MSG_TYPE_COUNT
+} MsgType;
+
+/**
+ * @brief Contadores globais do nó.
+ */
+typedef enum {
+    MET_PIT_INSERTS = 0,        /* Entradas criadas na tabela de interesses */
+    MET_PIT_SATISFIED,          /* Entradas satisfeitas por um OBJECT */
+    MET_PIT_CLOSED,             /* Entradas removidas por todas as interfaces responderem NOOBJECT */
+    MET_PIT_EXPIRED,            /* Entradas expiradas por timeout */
+    MET_PIT_AGGREGATED,         /* Interesses agregados numa entrada já encaminhada */
+    MET_CACHE_HITS,             /* Interesses satisfeitos pela cache */
+    MET_CACHE_MISSES,           /* Interesses não satisfeitos localmente */
+    MET_CACHE_INSERTS,          /* Objetos inseridos na cache */
+    MET_CACHE_EVICTIONS,        /* Objetos removidos da cache por falta de espaço */
+    MET_LOCAL_HITS,             /* Interesses satisfeitos por objetos locais */
+    MET_NO_ROUTE,               /* Interesses respondidos com NOOBJECT por falta de vizinhos */
+    MET_UNSOLICITED,            /* OBJECT ou NOOBJECT recebido sem entrada correspondente */
+    MET_MALFORMED,              /* Mensagens mal formadas ou desconhecidas */
+    MET_SEND_ERRORS,            /* Falhas de escrita em sockets de vizinhos */
+    MET_TOPO_NEIGHBOR_UP,       /* Vizinhos adicionados */
+    MET_TOPO_NEIGHBOR_DOWN,     /* Vizinhos removidos */
+    MET_TOPO_EXTERNAL_LOST,     /* Perdas do vizinho externo */
+    MET_TOPO_SAFE_UPDATES,      /* Mensagens SAFE aplicadas */
+    MET_TOPO_JOINS,             /* Entradas numa rede */
+    MET_TOPO_LEAVES,            /* Saídas de uma rede */
+    MET_RETRIEVE_REQUESTS,      /* Pedidos locais enviados para a rede */
+    MET_RETRIEVE_OK,            /* Pedidos locais satisfeitos pela rede */
+    MET_RETRIEVE_FAILED,        /* Pedidos locais terminados com NOOBJECT ou timeout */
+    MET_NAMES_LITERAL,          /* Nomes enviados completos em tramas binárias */
+    MET_NAMES_INDEXED,          /* Nomes enviados como referência à tabela de nomes */
+    MET_NAMES_PREFIX,           /* Nomes enviados como prefixo da tabela mais um sufixo */
+    MET_NAMES_RESYNC,           /* Pedidos a vizinhos para recomeçarem a tabela de nomes */
+    MET_BATCH_FRAMES_IN,        /* Tramas agrupadas recebidas */
+    MET_BATCH_NAMES_IN,         /* Nomes recebidos em tramas agrupadas */
+    MET_BATCH_FRAMES_OUT,       /* Tramas agrupadas enviadas */
+    MET_BATCH_NAMES_OUT,        /* Nomes enviados em tramas agrupadas */
+    MET_PIT_TOO_LATE,           /* Interesses respondidos com NOOBJECT por o tempo de vida não chegar */
+    MET_COUNT
+} MetricId;
+
+/**
+ * @brief Contadores de uma interface, numa linha de cache própria.
+ */
+typedef struct face_counters {
+    _Atomic unsigned long packets_in[MSG_TYPE_COUNT];
+    _Atomic unsigned long bytes_in[MSG_TYPE_COUNT];
+    _Atomic unsigned long packets_out[MSG_TYPE_COUNT];
+    _Atomic unsigned long bytes_out[MSG_TYPE_COUNT];
+} __attribute__((aligned(METRICS_CACHE_LINE))) FaceCounters;
+
+/**
+ * @brief Fragmento de métricas de uma thread.
+ *
+ * Só a thread dona escreve no fragmento; os leitores somam todos os
+ * fragmentos com leituras relaxadas.
+ */
+typedef struct metrics_shard {
+    _Atomic unsigned long counters[MET_COUNT] __attribute__((aligned(METRICS_CACHE_LINE)));
+    FaceCounters faces[METRICS_FACE_SLOTS];
+} __attribute__((aligned(METRICS_CACHE_LINE))) MetricsShard;
+
+/**
+ * @brief Valores agregados de todos os fragmentos e medidas instantâneas do nó.
+ */
+typedef struct metrics_snapshot {
+    unsigned long counters[MET_COUNT];
+    unsigned long packets_in[METRICS_FACE_SLOTS][MSG_TYPE_COUNT];
+    unsigned long bytes_in[METRICS_FACE_SLOTS][MSG_TYPE_COUNT];
+    unsigned long packets_out[METRICS_FACE_SLOTS][MSG_TYPE_COUNT];
+    unsigned long bytes_out[METRICS_FACE_SLOTS][MSG_TYPE_COUNT];
+    int pit_entries;            /* Entradas atuais da tabela de interesses */
+    int cache_entries;          /* Objetos atualmente em cache */
+    int cache_capacity;         /* Capacidade da cache */
+    int neighbors;              /* Número de vizinhos ligados */
+    int internal_neighbors;     /* Número de vizinhos internos */
+    int in_network;             /* 1 se o nó está numa rede */
+} MetricsSnapshot;
+
+/**
+ * @brief Uso de memória do processo (residente e do alocador).
+ *
+ * Lido à parte de metrics_snapshot(), que é chamada com frequência: ler o
+ * /proc e percorrer as arenas do malloc custa mais do que somar contadores.
+ */
+typedef struct metrics_memory {
+    unsigned long resident_bytes;   /* Memória residente (RSS) */
+    unsigned long heap_in_use;      /* Bytes alocados pelo malloc, incluindo blocos mmap */
+    unsigned long heap_free;        /* Bytes livres retidos nas arenas (fragmentação) */
+    unsigned long heap_mapped;      /* Bytes em blocos alocados com mmap */
+} MetricsMemory;
+
+/**
+ * @brief Fragmento da thread atual (NULL até ao primeiro uso).
+ */
+extern __thread MetricsShard *metrics_shard;
+
+/**
+ * @brief Socket do porto de recolha de métricas, -1 se desativado.
+ */
+extern int metrics_listen_fd;
+
+/**
+ * @brief Regista um fragmento para a thread atual.
+ *
+ * @return Fragmento da thread (um fragmento partilhado de reserva se não houver espaço)
+ */
+MetricsShard *metrics_register_thread();
+
+/**
+ * @brief Obtém o fragmento da thread atual, criando-o se necessário.
+ */
+static inline MetricsShard *metrics_local() {
+    MetricsShard *shard = metrics_shard;
+    return shard != NULL ? shard : metrics_register_thread();
+}
+
+/**
+ * @brief Soma um valor a um contador de um fragmento (apenas a thread dona escreve).
+ */
+static inline void metrics_add(_Atomic unsigned long *counter, unsigned long value) {
+    atomic_store_explicit(counter,
+                          atomic_load_explicit(counter, memory_order_relaxed) + value,
+                          memory_order_relaxed);
+}
+
+/**
+ * @brief Incrementa um contador global.
+ */
+#define METRIC_INC(id) metrics_add(&metrics_local()->counters[(id)], 1)
+
+/**
+ * @brief Converte um ID de interface no índice correspondente nas tabelas por interface.
+ */
+static inline int metrics_face_slot(int interface_id) {
+    return (interface_id >= 0 && interface_id < MAX_INTERFACE) ? interface_id : MAX_INTERFACE;
+}
+
+/**
+ * @brief Contabiliza uma mensagem recebida numa interface.
+ *
+ * @param interface_id Interface de origem
+ * @param type Tipo de mensagem
+ * @param bytes Tamanho da mensagem, incluindo o terminador
+ */
+static inline void metrics_count_in(int interface_id, MsgType type, size_t bytes) {
+    FaceCounters *face = &metrics_local()->faces[metrics_face_slot(interface_id)];
+    metrics_add(&face->packets_in[type], 1);
+    metrics_add(&face->bytes_in[type], bytes);
+}
+
+/**
+ * @brief Contabiliza uma mensagem enviada numa interface.
+ *
+ * @param interface_id Interface de destino
+ * @param type Tipo de mensagem
+ * @param bytes Número de bytes escritos
+ */
+static inline void metrics_count_out(int interface_id, MsgType type, size_t bytes) {
+    FaceCounters *face = &metrics_local()->faces[metrics_face_slot(interface_id)];
+    metrics_add(&face->packets_out[type], 1);
+    metrics_add(&face->bytes_out[type], bytes);
+}
+
+/**
+ * @brief Determina o tipo de uma mensagem a partir do seu início.
+ *
+ * Reconhece as mensagens de texto e as tramas binárias (wire.h).
+ *
+ * @param message Mensagem de protocolo
+ * @return Tipo de mensagem, MSG_UNKNOWN se não for reconhecida
+ */
+MsgType metrics_classify(const char *message);
+
+/**
+ * @brief Obtém o nome de um tipo de mensagem.
+ *
+ * @param type Tipo de mensagem
+ * @return Nome em minúsculas
+ */
+const char *metrics_type_name(MsgType type);
+
+/**
+ * @brief Soma todos os fragmentos e lê as medidas instantâneas do nó.
+ *
+ * @param snap Estrutura a preencher
+ */
+void metrics_snapshot(MetricsSnapshot *snap);
+
+/**
+ * @brief Liberta a entrada de uma interface cujo vizinho foi removido.
+ *
+ * As contagens passam para a entrada dos IDs fora do intervalo.
+ *
+ * @param interface_id Interface do vizinho removido
+ */
+void metrics_retire_face(int interface_id);
+
+/**
+ * @brief Lê a memória residente do processo e as estatísticas do alocador.
+ *
+ * Os campos que não se conseguem obter ficam a 0.
+ *
+ * @param mem Estrutura a preencher
+ */
+void metrics_memory(MetricsMemory *mem);
+
+/**
+ * @brief Formata as métricas no formato de texto do Prometheus.
+ *
+ * @param buffer Buffer de destino
+ * @param size Tamanho do buffer
+ * @return Número de bytes escritos
+ */
+size_t metrics_format_prometheus(char *buffer, size_t size);
+
+/**
+ * @brief Abre o porto local de recolha de métricas.
+ *
+ * @param port Porto TCP em 127.0.0.1
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int metrics_listen(const char *port);
+
+/**
+ * @brief Fecha o porto de recolha de métricas, se estiver aberto.
+ */
+void metrics_close();
+
+/**
+ * @brief Acrescenta as ligações do porto de recolha aos conjuntos do select().
+ *
+ * @param read_fds Conjunto de leitura
+ * @param write_fds Conjunto de escrita
+ * @param max_fd Maior descritor já no conjunto
+ * @return Maior descritor depois de acrescentar os do porto de recolha
+ */
+int metrics_fill_fds(fd_set *read_fds, fd_set *write_fds, int max_fd);
+
+/**
+ * @brief Aceita ligações e avança as respostas pendentes no porto de recolha.
+ *
+ * Chamada pelo ciclo principal depois do select() com os conjuntos
+ * preenchidos por metrics_fill_fds. Responde com HTTP/1.0 quando o pedido
+ * chega e fecha a ligação depois de a resposta ter sido toda escrita.
+ *
+ * @param read_fds Descritores prontos para leitura
+ * @param write_fds Descritores prontos para escrita
+ */
+void metrics_handle_scrape(fd_set *read_fds, fd_set *write_fds);
+
+/**
+ * @brief Processa o comando "show stats" (ss) para mostrar as métricas do nó.
+ *
+ * Os contadores são mostrados desde o último "stats reset".
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_show_stats();
+
+/**
+ * @brief Processa o comando "stats" para gerir as métricas.
+ *
+ * Subcomandos: "reset", "listen <port>" e "close".
+ *
+ * @param arg Subcomando
+ * @param value Argumento do subcomando, ou NULL
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_stats(char *arg, char *value);
+
+#endif /* METRICS_H */
@@ -30,7 +30,9 @@
 #include <signal.h>
 #include <ctype.h>
 #include <time.h>
+#include <stdint.h>
 #include <fcntl.h>  /* Para suporte a sockets não bloqueantes */
+#include "caps.h"
 
 /* Cores para saída formatada no terminal */
 #define COLOR_RESET   "\x1B[0m"
@@ -53,7 +55,8 @@
 #define MAX_CMD_SIZE 128       /* Tamanho máximo de comandos */
 #define DEFAULT_REG_IP "193.136.138.142"  /* IP padrão do servidor de registo */
 #define DEFAULT_REG_UDP 59000  /* Porto UDP padrão do servidor de registo */
-#define INTEREST_TIMEOUT 10    /* Tempo limite para mensagens de interesse (em segundos) */
+#define INTEREST_TIMEOUT 10    /* Tempo de vida dos interesses que não o indicam (em segundos) */
+#define INTEREST_LIFETIME_MAX 60  /* Maior tempo de vida aceite num interesse (em segundos) */
 
 /**
  * @brief Enumeração de estados possíveis para cada interface na tabela de interesses.
@@ -84,7 +87,12 @@ typedef struct object {
 typedef struct interest_entry {
     char name[MAX_OBJECT_NAME + 1];  /* Nome do objeto pretendido */
     int interface_states[MAX_INTERFACE];  /* Estado de cada interface para este interesse */
+    uint64_t waiting_since_ns[MAX_INTERFACE];  /* Momento em que cada interface passou a WAITING */
+    uint64_t local_request_ns;       /* Momento do pedido local (retrieve), 0 se não houver */
+    uint64_t local_expires_ns;       /* Prazo do pedido local, nunca depois de expires_ns; 0 se não houver */
+    uint64_t trace_id;               /* Identificador de rastreio do pedido, 0 se não for rastreado */
     time_t timestamp;                /* Momento em que o interesse foi criado */
+    uint64_t expires_ns;             /* Prazo da entrada (monotonic_ns), do tempo de vida dos pedidos */
     int marked_for_removal;          /* Sinalizador que indica se a entrada está a ser removida */
     struct interest_entry *next;     /* Apontador para a próxima entrada na tabela */
 } InterestEntry;
@@ -103,6 +111,11 @@ typedef struct neighbor {
     struct neighbor *next;     /* Apontador para o próximo vizinho na lista */
     char buffer[MAX_BUFFER];   /* Buffer for partial messages */
     int buffer_len;            /* Current length of data in buffer */
+    CapSet caps;               /* Capacidades anunciadas pelo vizinho no ENTRY ou SAFE (caps.h) */
+    struct wire_dict *dict_tx; /* Tabela dos nomes enviados (alocada no primeiro uso) */
+    struct wire_dict *dict_rx; /* Tabela dos nomes recebidos (alocada no primeiro uso) */
+    uint64_t dict_resync_ns;   /* Último pedido para recomeçar a tabela dos nomes recebidos */
+    uint64_t min_rtt_ns;       /* RTT mais curto observado a montante, 0 sem amostras */
 } Neighbor;
 
 /**
@@ -126,12 +139,14 @@ typedef struct node {
     int current_cache_size;          /* Tamanho atual da cache */
     int in_network;                  /* 1 se estiver numa rede, 0 caso contrário */
     int network_id;                  /* ID da rede */
+    int registered;                  /* 1 se estiver registado no servidor (join), 0 com dj */
     fd_set read_fds;                 /* Conjunto de descritores de ficheiro para select() */
     Neighbor *neighbors;             /* Lista de todos os vizinhos */
     Neighbor *internal_neighbors;    /* Lista de vizinhos internos */
     Object *objects;                 /* Lista de objetos locais */
     Object *cache;                   /* Lista de objetos em cache */
     InterestEntry *interest_table;   /* Tabela de interesses */
+    int interest_count;              /* Número de entradas na tabela de interesses */
 } Node;
 
 /* Variável global que representa o estado do nó atual */
@@ -0,0 +1,692 @@
+/**
+ * @file ndn_bench.c
+ * @brief Microbenchmarks das estruturas de dados e do processamento de mensagens (ndn-bench)
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a ferramenta ndn-bench, executada por "make bench",
+ * que mede o custo por operação das funções de objects.c e do ciclo de
+ * processamento de mensagens de handle_network_events, para tamanhos de
+ * 10 a 1 000 000 elementos:
+ *
+ * - Objetos locais: add_object, find_object (nome existente e inexistente)
+ * - Cache: add_to_cache (com remoção do mais antigo), find_in_cache
+ * - Tabela de interesses: find_or_create_interest_entry (existente e nova),
+ *   remove_interest_entry e check_interest_timeouts (sem expirações)
+ * - Mensagens: SAFE (só análise) e INTEREST por um objeto local, em texto
+ *   e em trama binária (wire.h), entregues por um transporte em memória,
+ *   sem chamadas ao sistema
+ *
+ * As estruturas são construídas diretamente (sem O(n^2) inserções) antes
+ * de cada caso. Cada caso é aquecido, calibrado e medido em várias
+ * amostras, com o processo fixo num CPU; o resultado é escrito em JSON no
+ * stdout (mediana, mínimo e máximo de ns por operação) e o progresso no stderr.
+ *
+ * Utilização:
+ *   ndn-bench [-n <tamanho máx.>] [-s <t1,t2,...>] [-b <ms>] [-w <ms>] [-r <amostras>]
+ *             [-c <cpu>] [-f <filtro>]
+ */
+
+#define _GNU_SOURCE
+#include "network.h"
+#include "objects.h"
+#include "debug_utils.h"
+#include "latency.h"
+#include "wire.h"
+#include <sched.h>
+
+#define BENCH_MAX_SIZES 16
+#define BENCH_MAX_SAMPLES 64
+#define BENCH_POOL 65536            /* Operações por execução cronometrada, no máximo */
+#define BENCH_NAME_SIZE 24
+#define BENCH_FD 3                  /* Descritor virtual do vizinho nos casos de mensagens */
+#define BENCH_REPLY_PEER "10.0.0.2"
+
+/**
+ * @brief Caso de benchmark.
+ *
+ * run executa ops operações e devolve apenas o tempo cronometrado; o
+ * trabalho de reposição entre execuções (retirar o que foi inserido,
+ * gerar nomes) fica fora da medição.
+ */
+typedef struct bench_case {
+    const char *name;
+    int sized;                              /* 0 se o tamanho não se aplicar (corre uma vez) */
+    int bounded;                            /* 1 se cada execução fizer no máximo n operações */
+    void (*setup)(size_t n);
+    uint64_t (*run)(size_t n, size_t ops);
+    void (*teardown)();
+} BenchCase;
+
+/* Configuração */
+static size_t sizes[BENCH_MAX_SIZES] = {10, 100, 1000, 10000, 100000, 1000000};
+static int size_count = 6;
+static uint64_t budget_ns = 200000000ull;
+static uint64_t warmup_ns = 20000000ull;
+static int samples = 5;
+static int cpu = 0;
+static const char *filter = NULL;
+
+/* Nomes usados pelas operações cronometradas */
+static char (*pool)[BENCH_NAME_SIZE];
+static size_t *indices;                     /* Permutação parcial para escolhas sem repetição */
+static size_t fresh_counter = 0;            /* Gera nomes nunca usados */
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+/* Entrada simulada para os casos de mensagens */
+static char feed[MAX_BUFFER];
+static size_t feed_len = 0;
+static size_t feed_messages = 0;
+static WireDict feed_dict;      /* Tabela de nomes do emissor simulado (igual à dict_rx do nó) */
+
+static uint64_t next_random() {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+static void existing_name(char *name, size_t index) {
+    snprintf(name, BENCH_NAME_SIZE, "obj%zu", index);
+}
+
+/**
+ * @brief Preenche o conjunto de nomes com nomes existentes escolhidos ao acaso.
+ */
+static void pool_existing(size_t n, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        existing_name(pool[i], (size_t)(next_random() % n));
+    }
+}
+
+/**
+ * @brief Preenche o conjunto de nomes com nomes existentes distintos (sem repetição).
+ */
+static void pool_distinct(size_t n, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        size_t j = i + (size_t)(next_random() % (n - i));
+        size_t tmp = indices[i];
+        indices[i] = indices[j];
+        indices[j] = tmp;
+        existing_name(pool[i], indices[i]);
+    }
+}
+
+static void pool_missing(size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        snprintf(pool[i], BENCH_NAME_SIZE, "miss%zu", (size_t)(next_random() % 1000000));
+    }
+}
+
+static void pool_fresh(size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        snprintf(pool[i], BENCH_NAME_SIZE, "new%zu", fresh_counter++);
+    }
+}
+
+/* ----- Construção direta das estruturas ----- */
+
+static Object *build_list(size_t n) {
+    Object *head = NULL;
+    for (size_t i = n; i-- > 0;) {
+        Object *obj = malloc(sizeof(Object));
+        if (obj == NULL) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        existing_name(obj->name, i);
+        obj->next = head;
+        head = obj;
+    }
+    return head;
+}
+
+static void free_list(Object *head) {
+    while (head != NULL) {
+        Object *next = head->next;
+        free(head);
+        head = next;
+    }
+}
+
+static InterestEntry *new_entry(const char *name) {
+    InterestEntry *entry = calloc(1, sizeof(InterestEntry));
+    if (entry == NULL) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(entry->name, name);
+    entry->interface_states[1] = WAITING;
+    entry->interface_states[2] = RESPONSE;
+    entry->timestamp = monotonic_seconds();
+    entry->expires_ns = monotonic_ns() + (uint64_t)INTEREST_TIMEOUT * 1000000000ull;
+    return entry;
+}
+
+static void push_entry(InterestEntry *entry) {
+    entry->next = node.interest_table;
+    node.interest_table = entry;
+    node.interest_count++;
+}
+
+static void build_pit(size_t n) {
+    char name[BENCH_NAME_SIZE];
+    for (size_t i = n; i-- > 0;) {
+        existing_name(name, i);
+        push_entry(new_entry(name));
+    }
+}
+
+static void free_pit() {
+    InterestEntry *entry = node.interest_table;
+    while (entry != NULL) {
+        InterestEntry *next = entry->next;
+        free(entry);
+        entry = next;
+    }
+    node.interest_table = NULL;
+    node.interest_count = 0;
+}
+
+static void setup_objects(size_t n) {
+    node.objects = build_list(n);
+}
+
+static void teardown_objects() {
+    free_list(node.objects);
+    node.objects = NULL;
+}
+
+static void setup_cache(size_t n) {
+    node.cache = build_list(n);
+    node.cache_size = (int)n;
+    node.current_cache_size = (int)n;
+}
+
+static void teardown_cache() {
+    free_list(node.cache);
+    node.cache = NULL;
+    node.current_cache_size = 0;
+}
+
+static void setup_pit(size_t n) {
+    build_pit(n);
+    for (size_t i = 0; i < n; i++) {
+        indices[i] = i;
+    }
+}
+
+/* ----- Operações ----- */
+
+static uint64_t run_add_object(size_t n, size_t ops) {
+    (void)n;
+    pool_fresh(ops);
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < ops; i++) {
+        add_object(pool[i]);
+    }
+    uint64_t elapsed = monotonic_ns() - start;
+    /* Os novos objetos estão no início da lista */
+    for (size_t i = 0; i < ops; i++) {
+        Object *head = node.objects;
+        node.objects = head->next;
+        free(head);
+    }
+    return elapsed;
+}
+
+static uint64_t run_find_object_hit(size_t n, size_t ops) {
+    pool_existing(n, ops);
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < ops; i++) {
+        find_object(pool[i]);
+    }
+    return monotonic_ns() - start;
+}
+
+static uint64_t run_find_object_miss(size_t n, size_t ops) {
+    (void)n;
+    pool_missing(ops);
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < ops; i++) {
+        find_object(pool[i]);
+    }
+    return monotonic_ns() - start;
+}
+
+static uint64_t run_add_to_cache(size_t n, size_t ops) {
+    (void)n;
+    pool_fresh(ops);
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < ops; i++) {
+        add_to_cache(pool[i]);
+    }
+    return monotonic_ns() - start;
+}
+
+static uint64_t run_find_in_cache_hit(size_t n, size_t ops) {
+    pool_existing(n, ops);
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < ops; i++) {
+        find_in_cache(pool[i]);
+    }
+    return monotonic_ns() - start;
+}
+
+static uint64_t run_find_in_cache_miss(size_t n, size_t ops) {
+    (void)n;
+    pool_missing(ops);
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < ops; i++) {
+        find_in_cache(pool[i]);
+    }
+    return monotonic_ns() - start;
+}
+
+static uint64_t run_pit_lookup(size_t n, size_t ops) {
+    pool_existing(n, ops);
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < ops; i++) {
+        find_or_create_interest_entry(pool[i]);
+    }
+    return monotonic_ns() - start;
+}
+
+static uint64_t run_pit_insert(size_t n, size_t ops) {
+    (void)n;
+    pool_fresh(ops);
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < ops; i++) {
+        find_or_create_interest_entry(pool[i]);
+    }
+    uint64_t elapsed = monotonic_ns() - start;
+    /* As novas entradas estão no início da tabela */
+    for (size_t i = 0; i < ops; i++) {
+        InterestEntry *head = node.interest_table;
+        node.interest_table = head->next;
+        node.interest_count--;
+        free(head);
+    }
+    return elapsed;
+}
+
+static uint64_t run_pit_remove(size_t n, size_t ops) {
+    pool_distinct(n, ops);
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < ops; i++) {
+        remove_interest_entry(pool[i]);
+    }
+    uint64_t elapsed = monotonic_ns() - start;
+    for (size_t i = 0; i < ops; i++) {
+        push_entry(new_entry(pool[i]));
+    }
+    return elapsed;
+}
+
+static uint64_t run_pit_timeouts(size_t n, size_t ops) {
+    (void)n;
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < ops; i++) {
+        check_interest_timeouts();
+    }
+    return monotonic_ns() - start;
+}
+
+/* ----- Mensagens, por um transporte em memória ----- */
+
+static int bench_connect(const char *ip, const char *port) {
+    (void)ip;
+    (void)port;
+    errno = ECONNREFUSED;
+    return -1;
+}
+
+static ssize_t bench_send(int fd, const char *message, size_t len) {
+    (void)fd;
+    (void)message;
+    return (ssize_t)len;
+}
+
+static ssize_t bench_recv(int fd, char *buffer, size_t len) {
+    (void)fd;
+    size_t n = feed_len < len ? feed_len : len;
+    memcpy(buffer, feed, n);
+    return (ssize_t)n;
+}
+
+static void bench_close(int fd) {
+    (void)fd;
+}
+
+static const NodeTransport bench_transport = {bench_connect, bench_send, bench_recv, bench_close};
+
+/**
+ * @brief Enche a entrada simulada com mensagens completas, até MAX_BUFFER - 1 bytes.
+ *
+ * Com binary, as mensagens INTEREST são tramas binárias (wire.h); com 2,
+ * os nomes são comprimidos com feed_dict. Nesse caso a entrada para antes
+ * de uma trama poder não caber, porque cada trama codificada altera a
+ * tabela e tem de chegar ao nó. Com 3, seguem WIRE_BATCH_MAX nomes por
+ * trama agrupada e feed_messages conta nomes.
+ */
+static void fill_feed(const char *type, size_t n, int binary) {
+    char line[MAX_BUFFER];
+    feed_len = 0;
+    feed_messages = 0;
+    for (;;) {
+        int len;
+        if (binary == 2 && feed_len + BENCH_NAME_SIZE + 2 * WIRE_VARINT_MAX + 4 > MAX_BUFFER - 1) {
+            break;
+        }
+        if (binary == 3) {
+            /* Trama agrupada: conta um pedido por nome */
+            static char names[WIRE_BATCH_MAX][BENCH_NAME_SIZE];
+            const char *list[WIRE_BATCH_MAX];
+            size_t encoded = 0;
+            for (size_t i = 0; i < WIRE_BATCH_MAX; i++) {
+                existing_name(names[i], (size_t)(next_random() % n));
+                list[i] = names[i];
+            }
+            len = (int)wire_encode_batch(line, sizeof(line), WIRE_INTEREST, list, WIRE_BATCH_MAX, 0, 0, NULL,
+                                         &encoded, NULL);
+            if (len <= 0 || feed_len + (size_t)len > MAX_BUFFER - 1) {
+                break;
+            }
+            memcpy(feed + feed_len, line, (size_t)len);
+            feed_len += (size_t)len;
+            feed_messages += encoded;
+            continue;
+        }
+        if (n > 0) {
+            char name[BENCH_NAME_SIZE];
+            existing_name(name, (size_t)(next_random() % n));
+            len = binary ? (int)wire_encode(line, sizeof(line), WIRE_INTEREST, name, 0, 0, NULL, 0,
+                                            binary == 2 ? &feed_dict : NULL, NULL)
+                         : snprintf(line, sizeof(line), "%s %s\n", type, name);
+        } else {
+            len = snprintf(line, sizeof(line), "%s 10.0.0.%d 58001\n", type, (int)(next_random() % 200) + 1);
+        }
+        if (feed_len + (size_t)len > MAX_BUFFER - 1) {
+            break;
+        }
+        memcpy(feed + feed_len, line, (size_t)len);
+        feed_len += (size_t)len;
+        feed_messages++;
+    }
+}
+
+static void setup_neighbor() {
+    node_transport = &bench_transport;
+    add_neighbor(BENCH_REPLY_PEER, "58001", BENCH_FD, 0);
+}
+
+static void teardown_neighbor() {
+    remove_neighbor(BENCH_FD);
+    node_transport = NULL;
+}
+
+static void setup_parse_safe(size_t n) {
+    (void)n;
+    setup_neighbor();
+}
+
+static void setup_parse_interest(size_t n) {
+    setup_objects(n);
+    setup_neighbor();
+}
+
+static void setup_parse_interest_tlv(size_t n) {
+    setup_parse_interest(n);
+    node.neighbors->caps.bits |= CAP_BIT(CAP_WIRE_TLV);     /* Respostas também em trama binária */
+}
+
+static void setup_parse_interest_dict(size_t n) {
+    setup_parse_interest_tlv(n);
+    node.neighbors->caps.bits |= CAP_BIT(CAP_NAME_DICT);
+    node.neighbors->caps.value[CAP_NAME_DICT] = WIRE_DICT_SLOTS;
+    wire_dict_reset(&feed_dict, WIRE_DICT_SLOTS);
+}
+
+static void setup_parse_interest_batch(size_t n) {
+    setup_parse_interest_tlv(n);
+    node.neighbors->caps.bits |= CAP_BIT(CAP_BATCH);        /* Respostas também agrupadas */
+    node.neighbors->caps.value[CAP_BATCH] = WIRE_BATCH_MAX;
+}
+
+static void teardown_parse_interest() {
+    teardown_neighbor();
+    teardown_objects();
+}
+
+/**
+ * @brief Entrega leituras completas ao nó; ops conta mensagens, não leituras.
+ */
+static uint64_t run_messages(const char *type, size_t n, int binary, size_t ops) {
+    uint64_t elapsed = 0;
+    size_t done = 0;
+    while (done < ops) {
+        fill_feed(type, n, binary);
+        FD_ZERO(&node.read_fds);
+        FD_SET(BENCH_FD, &node.read_fds);
+        uint64_t start = monotonic_ns();
+        handle_network_events();
+        elapsed += monotonic_ns() - start;
+        done += feed_messages;
+    }
+    return elapsed * ops / done;    /* Normaliza para ops mensagens */
+}
+
+static uint64_t run_parse_safe(size_t n, size_t ops) {
+    (void)n;
+    return run_messages("SAFE", 0, 0, ops);
+}
+
+static uint64_t run_parse_interest(size_t n, size_t ops) {
+    return run_messages("INTEREST", n, 0, ops);
+}
+
+static uint64_t run_parse_interest_tlv(size_t n, size_t ops) {
+    return run_messages("INTEREST", n, 1, ops);
+}
+
+static uint64_t run_parse_interest_dict(size_t n, size_t ops) {
+    return run_messages("INTEREST", n, 2, ops);
+}
+
+static uint64_t run_parse_interest_batch(size_t n, size_t ops) {
+    return run_messages("INTEREST", n, 3, ops);
+}
+
+static const BenchCase cases[] = {
+    {"add_object",            1, 0, setup_objects,        run_add_object,         teardown_objects},
+    {"find_object_hit",       1, 0, setup_objects,        run_find_object_hit,    teardown_objects},
+    {"find_object_miss",      1, 0, setup_objects,        run_find_object_miss,   teardown_objects},
+    {"add_to_cache",          1, 0, setup_cache,          run_add_to_cache,       teardown_cache},
+    {"find_in_cache_hit",     1, 0, setup_cache,          run_find_in_cache_hit,  teardown_cache},
+    {"find_in_cache_miss",    1, 0, setup_cache,          run_find_in_cache_miss, teardown_cache},
+    {"pit_find_existing",     1, 0, setup_pit,            run_pit_lookup,         free_pit},
+    {"pit_create",            1, 0, setup_pit,            run_pit_insert,         free_pit},
+    {"pit_remove",            1, 1, setup_pit,            run_pit_remove,         free_pit},
+    {"pit_check_timeouts",    1, 0, setup_pit,            run_pit_timeouts,       free_pit},
+    {"parse_safe",            0, 0, setup_parse_safe,     run_parse_safe,         teardown_neighbor},
+    {"parse_interest_local",  1, 0, setup_parse_interest, run_parse_interest,     teardown_parse_interest},
+    {"parse_interest_tlv",    1, 0, setup_parse_interest_tlv, run_parse_interest_tlv, teardown_parse_interest},
+    {"parse_interest_dict",   1, 0, setup_parse_interest_dict, run_parse_interest_dict, teardown_parse_interest},
+    {"parse_interest_batch",  1, 0, setup_parse_interest_batch, run_parse_interest_batch, teardown_parse_interest},
+};
+#define CASE_COUNT (int)(sizeof(cases) / sizeof(cases[0]))
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Executa operações até somar pelo menos target_ns de tempo cronometrado.
+ */
+static void run_for(const BenchCase *bc, size_t n, size_t ops, uint64_t target_ns,
+                    uint64_t *total_ns, uint64_t *total_ops) {
+    *total_ns = 0;
+    *total_ops = 0;
+    do {
+        *total_ns += bc->run(n, ops);
+        *total_ops += ops;
+    } while (*total_ns < target_ns);
+}
+
+/**
+ * @brief Aquece, calibra e mede um caso para um tamanho, escrevendo o resultado em JSON.
+ */
+static void measure(const BenchCase *bc, size_t n, int first) {
+    fprintf(stderr, "%-22s %8zu ...", bc->name, n);
+    bc->setup(n);
+
+    /* Calibração: operações por execução para ~1/16 do tempo de uma amostra */
+    uint64_t sample_ns = budget_ns / (uint64_t)samples;
+    size_t max_ops = bc->bounded && n < BENCH_POOL ? n : BENCH_POOL;
+    size_t ops = 1;
+    for (;;) {
+        uint64_t elapsed = bc->run(n, ops);
+        if (elapsed >= sample_ns / 16 || ops >= max_ops) {
+            break;
+        }
+        ops = ops * 2 > max_ops ? max_ops : ops * 2;
+    }
+
+    uint64_t total_ns, total_ops;
+    run_for(bc, n, ops, warmup_ns, &total_ns, &total_ops);
+
+    double per_op[BENCH_MAX_SAMPLES];
+    uint64_t measured_ops = 0;
+    for (int s = 0; s < samples; s++) {
+        run_for(bc, n, ops, sample_ns, &total_ns, &total_ops);
+        per_op[s] = (double)total_ns / (double)total_ops;
+        measured_ops += total_ops;
+    }
+    bc->teardown();
+
+    qsort(per_op, (size_t)samples, sizeof(double), compare_double);
+    double median = samples % 2 ? per_op[samples / 2]
+                                : (per_op[samples / 2 - 1] + per_op[samples / 2]) / 2.0;
+    fprintf(stderr, " %12.1f ns/op\n", median);
+    printf("%s    {\"name\": \"%s\", \"size\": %zu, \"ops\": %llu, \"ns_per_op\": "
+           "{\"median\": %.2f, \"min\": %.2f, \"max\": %.2f}}",
+           first ? "" : ",\n", bc->name, n, (unsigned long long)measured_ops,
+           median, per_op[0], per_op[samples - 1]);
+    fflush(stdout);
+}
+
+static int parse_sizes(char *list) {
+    size_count = 0;
+    for (char *tok = strtok(list, ","); tok != NULL; tok = strtok(NULL, ",")) {
+        if (size_count == BENCH_MAX_SIZES || atol(tok) <= 0) {
+            return -1;
+        }
+        sizes[size_count++] = (size_t)atol(tok);
+    }
+    return size_count > 0 ? 0 : -1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n  largest size to run (default 1000000)\n"
+            "  -s  comma-separated sizes (default 10,100,1000,10000,100000,1000000)\n"
+            "  -b  measured time per case and size, in ms (default 200)\n"
+            "  -w  warm-up time per case and size, in ms (default 20)\n"
+            "  -r  samples per case and size, 1 to %d (default 5)\n"
+            "  -c  CPU to pin to, -1 to leave unpinned (default 0)\n"
+            "  -f  only run cases whose name contains this text\n",
+            prog, BENCH_MAX_SAMPLES);
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_size = 1000000;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:b:w:r:c:f:h")) != -1) {
+        switch (opt) {
+            case 'n': max_size = (size_t)atol(optarg); break;
+            case 's':
+                if (parse_sizes(optarg) < 0) {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'b': budget_ns = (uint64_t)atol(optarg) * 1000000ull; break;
+            case 'w': warmup_ns = (uint64_t)atol(optarg) * 1000000ull; break;
+            case 'r': samples = atoi(optarg); break;
+            case 'c': cpu = atoi(optarg); break;
+            case 'f': filter = optarg; break;
+            default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (optind != argc || samples < 1 || samples > BENCH_MAX_SAMPLES || budget_ns == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Fixa o processo num CPU para evitar migrações durante as medições */
+    int pinned = 0;
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) == 0) {
+            pinned = 1;
+        } else {
+            fprintf(stderr, "Could not pin to CPU %d: %s\n", cpu, strerror(errno));
+        }
+    }
+
+    size_t largest = 1;
+    for (int i = 0; i < size_count; i++) {
+        if (sizes[i] <= max_size && sizes[i] > largest) {
+            largest = sizes[i];
+        }
+    }
+    pool = malloc(BENCH_POOL * sizeof(*pool));
+    indices = malloc(largest * sizeof(size_t));
+    if (pool == NULL || indices == NULL) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+
+    /* Estado mínimo do nó, sem sockets; os registos ficam só para erros */
+    log_init();
+    current_log_level = LOG_ERROR;
+    memset(&node, 0, sizeof(node));
+    strcpy(node.ip, "10.0.0.1");
+    strcpy(node.port, "58000");
+    node.cache_size = MAX_CACHE_SIZE;
+    node.in_network = 1;
+
+    printf("{\n  \"tool\": \"ndn-bench\",\n  \"cpu\": %d,\n  \"pinned\": %s,\n"
+           "  \"samples\": %d,\n  \"budget_ms\": %llu,\n  \"warmup_ms\": %llu,\n  \"results\": [\n",
+           cpu, pinned ? "true" : "false", samples,
+           (unsigned long long)(budget_ns / 1000000ull), (unsigned long long)(warmup_ns / 1000000ull));
+
+    int first = 1;
+    for (int c = 0; c < CASE_COUNT; c++) {
+        const BenchCase *bc = &cases[c];
+        if (filter != NULL && strstr(bc->name, filter) == NULL) {
+            continue;
+        }
+        if (!bc->sized) {
+            measure(bc, 1, first);
+            first = 0;
+            continue;
+        }
+        for (int i = 0; i < size_count; i++) {
+            if (sizes[i] <= max_size) {
+                measure(bc, sizes[i], first);
+                first = 0;
+            }
+        }
+    }
+    printf("\n  ]\n}\n");
+
+    free(pool);
+    free(indices);
+    log_shutdown();
+    return EXIT_SUCCESS;
+}
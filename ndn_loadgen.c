@@ -0,0 +1,887 @@
+/**
+ * @file ndn_loadgen.c
+ * @brief Gerador de carga sintética para um nó NDN (ndn-loadgen)
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a ferramenta ndn-loadgen, que se liga a um nó em
+ * execução por M ligações TCP (interfaces), apresentando-se em cada uma
+ * com ENTRY como se fosse um vizinho interno:
+ *
+ * - As primeiras P interfaces são produtoras: respondem com OBJECT aos
+ *   interesses que o nó lhes encaminha (ou NOOBJECT, para a fração de
+ *   nomes definida com -m)
+ * - As restantes são consumidoras: enviam INTEREST ao nó, a um ritmo
+ *   fixo (-r) ou com um número fixo de pedidos pendentes (-c), e
+ *   respondem NOOBJECT aos interesses encaminhados para elas
+ *
+ * Os nomes são "<prefixo><k>", com k entre 0 e N-1 dado por um gerador de
+ * workload.c (-D): uniforme, Zipf (k = 0 é o mais popular), sequencial,
+ * popularidade variável, varrimentos, segmentos ou um ficheiro de pedidos. No
+ * fim é mostrado o débito e os percentis da latência de OBJECT e NOOBJECT
+ * medidos desde o envio do interesse (ou, com -j, um objeto JSON com os
+ * mesmos valores, para ser lido por scripts).
+ *
+ * Com -S a ferramenta corre em modo de resistência (soak), pensado para
+ * durar horas: de -S em -S segundos lê o porto de métricas do nó (-M) e
+ * mostra a memória residente, as estatísticas do alocador e os tamanhos
+ * da tabela de interesses e da cache. Com -C as interfaces são fechadas e
+ * religadas à vez (o nó vê um vizinho interno a sair e a voltar a entrar)
+ * e com -z uma fração dos nomes nunca recebe resposta dos produtores, para
+ * as entradas da tabela de interesses do nó expirarem. Com -G a execução
+ * falha (código 3) se a memória crescer mais do que o limite desde a
+ * primeira amostra.
+ *
+ * Utilização:
+ *   ndn-loadgen [-f <faces>] [-P <produtoras>] [-r <int/s> | -c <pendentes>]
+ *               [-d <s>] [-W <s>] [-n <nomes>] [-D <gerador>] [-a <alfa>]
+ *               [-m <fração>] [-T <ms>] [-o <máx. pendentes>] [-x <prefixo>] [-j]
+ *               [-S <s> -M <porto> [-C <s>] [-z <fração>] [-G <MB>]] <IP> <TCP>
+ */
+
+#include "latency.h"
+#include "metrics.h"
+#include "workload.h"
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define LG_MAX_FACES (MAX_INTERFACE - 2)    /* O nó usa as interfaces 1 a 8 para vizinhos */
+#define LG_IN_BUFFER 65536
+#define LG_OUT_BUFFER 65536
+#define LG_MAX_BURST 1024                   /* Interesses enviados por iteração no modo -r */
+#define LG_ENTRY_PORT_BASE 61000            /* Portos anunciados nas mensagens ENTRY */
+#define LG_SCRAPE_TIMEOUT_S 2               /* Tempo máximo de uma leitura do porto de métricas */
+
+/**
+ * @brief Uma ligação ao nó.
+ */
+typedef struct lg_face {
+    int fd;
+    int producer;                   /* 1 se responde com OBJECT */
+    char in[LG_IN_BUFFER];          /* Dados recebidos ainda sem '\n' */
+    size_t in_len;
+    char out[LG_OUT_BUFFER];        /* Dados por enviar */
+    size_t out_len;
+} LgFace;
+
+/**
+ * @brief Pedido pendente, indexado por (interface, nome).
+ */
+typedef struct lg_pending {
+    uint64_t key;                   /* 0 = vazio */
+    uint64_t sent_ns;
+} LgPending;
+
+/**
+ * @brief Contadores da medição.
+ */
+typedef struct lg_stats {
+    unsigned long sent;
+    unsigned long objects;
+    unsigned long noobjects;
+    unsigned long timeouts;
+    unsigned long skipped;          /* Pedidos não enviados (limite de pendentes ou buffer cheio) */
+    unsigned long unexpected;       /* Respostas sem pedido pendente */
+    unsigned long answered_object;  /* Interesses respondidos pelas interfaces produtoras */
+    unsigned long answered_noobject;
+    unsigned long silenced;         /* Interesses a que as produtoras não responderam (-z) */
+    unsigned long reconnects;       /* Interfaces fechadas e religadas (-C) */
+    unsigned long dropped;          /* Pedidos pendentes perdidos ao fechar uma interface */
+    LatencyHistogram object_latency;
+    LatencyHistogram noobject_latency;
+} LgStats;
+
+/**
+ * @brief Uma amostra do nó no modo de resistência.
+ */
+typedef struct lg_sample {
+    double seconds;                 /* Desde o início da medição */
+    unsigned long resident;
+    unsigned long heap_in_use;
+    unsigned long heap_free;
+    unsigned long pit_entries;
+    unsigned long cache_entries;
+    unsigned long neighbors;
+    unsigned long internal_neighbors;
+    unsigned long pit_expired;
+} LgSample;
+
+/**
+ * @brief Resumo das amostras do modo de resistência.
+ */
+typedef struct lg_soak {
+    unsigned long samples;
+    LgSample first;
+    LgSample last;
+    unsigned long peak_resident;
+    unsigned long peak_heap;
+    double sum_t, sum_tt, sum_heap, sum_t_heap;     /* Regressão linear da memória do alocador */
+} LgSoak;
+
+/* Configuração */
+static int face_count = 4;
+static int producer_count = 1;
+static double rate = 0.0;
+static int concurrency = 0;
+static double duration_s = 10.0;
+static double warmup_s = 0.0;
+static unsigned long name_count = 1000;
+static const char *workload_spec = "zipf";   /* -D: descrição do gerador de nomes (workload.h) */
+static double zipf_alpha = 1.0;
+static double miss_fraction = 0.0;
+static int timeout_ms = 3000;
+static size_t max_outstanding = 10000;
+static const char *prefix = "obj";
+static int json_output = 0;             /* -j: resultado numa linha JSON em vez das tabelas */
+static double sample_s = 0.0;           /* -S: intervalo entre amostras; > 0 ativa o modo de resistência */
+static int metrics_port = 0;            /* -M: porto de métricas do nó ("stats listen") */
+static double churn_s = 0.0;            /* -C: intervalo entre religações de interfaces */
+static double silent_fraction = 0.0;    /* -z: fração dos nomes sem resposta das produtoras */
+static double growth_limit_mb = 0.0;    /* -G: crescimento máximo da memória do nó */
+
+/* Estado */
+static LgFace faces[LG_MAX_FACES];
+static LgPending *pending;
+static size_t pending_size;          /* Potência de 2 */
+static size_t outstanding = 0;
+static Workload workload;
+static int next_consumer = 0;
+static LgStats stats;
+static LgSoak soak;
+static int next_churn = 0;
+
+/**
+ * @brief Indica se um nome não existe no produtor (fração -m dos nomes).
+ */
+static int is_missing(unsigned long id) {
+    uint64_t h = (id + 1) * 0x9e3779b97f4a7c15ull;
+    return (double)(h >> 40) / (double)(1ull << 24) < miss_fraction;
+}
+
+/**
+ * @brief Indica se as produtoras nunca respondem a um nome (fração -z dos nomes).
+ *
+ * Usa uma dispersão diferente da de is_missing() para as duas frações serem
+ * independentes.
+ */
+static int is_silent(unsigned long id) {
+    uint64_t h = (id + 1) * 0xc2b2ae3d27d4eb4full;
+    return (double)(h >> 40) / (double)(1ull << 24) < silent_fraction;
+}
+
+/**
+ * @brief Obtém o número de um nome gerado por esta ferramenta.
+ *
+ * @return Número do nome, ou -1 se o nome não tiver o prefixo configurado
+ */
+static long parse_name(const char *name) {
+    size_t len = strlen(prefix);
+    if (strncmp(name, prefix, len) != 0 || !isdigit((unsigned char)name[len])) {
+        return -1;
+    }
+    return strtol(name + len, NULL, 10);
+}
+
+/**
+ * @brief Procura a posição de um pedido na tabela de pendentes.
+ */
+static size_t pending_slot(uint64_t key) {
+    size_t mask = pending_size - 1;
+    size_t slot = (size_t)((key * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+    while (pending[slot].key != 0 && pending[slot].key != key) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Remove a entrada de uma posição da tabela de pendentes (deslocamento para trás).
+ */
+static void pending_remove(size_t slot) {
+    size_t mask = pending_size - 1;
+    size_t hole = slot;
+    size_t next = (hole + 1) & mask;
+    while (pending[next].key != 0) {
+        size_t home = (size_t)((pending[next].key * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            pending[hole] = pending[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    pending[hole].key = 0;
+    outstanding--;
+}
+
+static uint64_t pending_key(int face, unsigned long id) {
+    return ((uint64_t)face << 40 | id) + 1;
+}
+
+/**
+ * @brief Acrescenta uma mensagem ao buffer de saída de uma interface.
+ *
+ * @return 0 em caso de sucesso, -1 se o buffer estiver cheio
+ */
+static int queue_message(LgFace *face, const char *type, const char *name) {
+    size_t avail = LG_OUT_BUFFER - face->out_len;
+    int len = snprintf(face->out + face->out_len, avail, "%s %s\n", type, name);
+    if (len < 0 || (size_t)len >= avail) {
+        return -1;
+    }
+    face->out_len += (size_t)len;
+    return 0;
+}
+
+/**
+ * @brief Envia o que for possível do buffer de saída de uma interface.
+ */
+static void flush_face(LgFace *face) {
+    size_t done = 0;
+    while (done < face->out_len) {
+        ssize_t n = write(face->fd, face->out + done, face->out_len - done);
+        if (n <= 0) {
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("write");
+                exit(EXIT_FAILURE);
+            }
+            break;
+        }
+        done += (size_t)n;
+    }
+    memmove(face->out, face->out + done, face->out_len - done);
+    face->out_len -= done;
+}
+
+/**
+ * @brief Envia um novo interesse por uma interface consumidora.
+ *
+ * @return 0 em caso de sucesso, -1 se o pedido não puder ser enviado
+ */
+static int issue_interest(uint64_t now) {
+    if (outstanding >= max_outstanding) {
+        stats.skipped++;
+        return -1;
+    }
+
+    int face = producer_count + next_consumer;
+    next_consumer = (next_consumer + 1) % (face_count - producer_count);
+
+    /* Não repete um nome já pendente na mesma interface: o nó juntaria os dois pedidos */
+    for (int attempt = 0; attempt < 4; attempt++) {
+        unsigned long id = workload_next(&workload);
+        size_t slot = pending_slot(pending_key(face, id));
+        if (pending[slot].key != 0) {
+            continue;
+        }
+
+        char name[MAX_OBJECT_NAME + 1];
+        snprintf(name, sizeof(name), "%s%lu", prefix, id);
+        if (queue_message(&faces[face], "INTEREST", name) < 0) {
+            break;
+        }
+        pending[slot].key = pending_key(face, id);
+        pending[slot].sent_ns = now;
+        outstanding++;
+        stats.sent++;
+        return 0;
+    }
+
+    stats.skipped++;
+    return -1;
+}
+
+/**
+ * @brief Processa uma mensagem recebida do nó numa interface.
+ */
+static void handle_line(int face, char *line, uint64_t now) {
+    char type[16], name[MAX_OBJECT_NAME + 1];
+    if (sscanf(line, "%15s %100s", type, name) != 2) {
+        return;
+    }
+    long id = parse_name(name);
+
+    if (strcmp(type, "INTEREST") == 0) {
+        /* Interesse encaminhado pelo nó: só as produtoras têm os objetos */
+        if (faces[face].producer && id >= 0 && is_silent((unsigned long)id)) {
+            stats.silenced++;
+        } else if (faces[face].producer && id >= 0 && !is_missing((unsigned long)id)) {
+            queue_message(&faces[face], "OBJECT", name);
+            stats.answered_object++;
+        } else {
+            queue_message(&faces[face], "NOOBJECT", name);
+            stats.answered_noobject++;
+        }
+    } else if (strcmp(type, "OBJECT") == 0 || strcmp(type, "NOOBJECT") == 0) {
+        size_t slot = id >= 0 ? pending_slot(pending_key(face, (unsigned long)id)) : 0;
+        if (id < 0 || pending[slot].key == 0) {
+            stats.unexpected++;
+            return;
+        }
+        if (type[0] == 'O') {
+            stats.objects++;
+            latency_record(&stats.object_latency, now - pending[slot].sent_ns);
+        } else {
+            stats.noobjects++;
+            latency_record(&stats.noobject_latency, now - pending[slot].sent_ns);
+        }
+        pending_remove(slot);
+    }
+    /* ENTRY e SAFE são ignorados */
+}
+
+/**
+ * @brief Lê os dados disponíveis numa interface e processa as linhas completas.
+ */
+static void read_face(int face) {
+    LgFace *f = &faces[face];
+    ssize_t n = read(f->fd, f->in + f->in_len, LG_IN_BUFFER - 1 - f->in_len);
+    if (n <= 0) {
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        fprintf(stderr, "Connection %d closed by the node\n", face);
+        exit(EXIT_FAILURE);
+    }
+    f->in_len += (size_t)n;
+    f->in[f->in_len] = '\0';
+
+    uint64_t now = monotonic_ns();
+    char *start = f->in;
+    char *end;
+    while ((end = strchr(start, '\n')) != NULL) {
+        *end = '\0';
+        handle_line(face, start, now);
+        start = end + 1;
+    }
+    f->in_len -= (size_t)(start - f->in);
+    memmove(f->in, start, f->in_len);
+}
+
+/**
+ * @brief Conta como perdidos os pedidos pendentes há mais de timeout_ms.
+ */
+static void expire_pending(uint64_t now) {
+    uint64_t limit = (uint64_t)timeout_ms * 1000000ull;
+    size_t slot = 0;
+    while (slot < pending_size) {
+        if (pending[slot].key != 0 && now - pending[slot].sent_ns > limit) {
+            stats.timeouts++;
+            pending_remove(slot);   /* Pode trazer outra entrada para esta posição */
+            continue;
+        }
+        slot++;
+    }
+}
+
+/**
+ * @brief Liga uma interface ao nó e envia ENTRY.
+ */
+static int connect_face(int face, const char *ip, const char *port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(atoi(port));
+    if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid address: %s\n", ip);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        perror("connect");
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    faces[face].fd = fd;
+    faces[face].producer = face < producer_count;
+
+    char entry[64];
+    snprintf(entry, sizeof(entry), "127.0.0.1 %d", LG_ENTRY_PORT_BASE + face);
+    queue_message(&faces[face], "ENTRY", entry);
+    flush_face(&faces[face]);
+    return 0;
+}
+
+/**
+ * @brief Espera por dados do nó e processa-os.
+ *
+ * @param wait_ms Tempo máximo de espera
+ */
+static void poll_faces(int wait_ms) {
+    struct pollfd fds[LG_MAX_FACES];
+    for (int i = 0; i < face_count; i++) {
+        fds[i].fd = faces[i].fd;
+        fds[i].events = POLLIN | (faces[i].out_len > 0 ? POLLOUT : 0);
+        fds[i].revents = 0;
+    }
+    if (poll(fds, face_count, wait_ms) <= 0) {
+        return;
+    }
+    for (int i = 0; i < face_count; i++) {
+        if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            read_face(i);
+        }
+    }
+}
+
+static void flush_all() {
+    for (int i = 0; i < face_count; i++) {
+        if (faces[i].out_len > 0) {
+            flush_face(&faces[i]);
+        }
+    }
+}
+
+/**
+ * @brief Fecha uma interface e volta a ligá-la ao nó (opção -C).
+ *
+ * As interfaces são religadas à vez. Os pedidos pendentes da interface
+ * fechada deixam de ter resposta possível e são descartados.
+ */
+static void churn_face(const char *ip, const char *port) {
+    int face = next_churn;
+    next_churn = (next_churn + 1) % face_count;
+
+    close(faces[face].fd);
+    faces[face].in_len = 0;
+    faces[face].out_len = 0;
+    size_t slot = 0;
+    while (slot < pending_size) {
+        if (pending[slot].key != 0 && (int)((pending[slot].key - 1) >> 40) == face) {
+            stats.dropped++;
+            pending_remove(slot);   /* Pode trazer outra entrada para esta posição */
+            continue;
+        }
+        slot++;
+    }
+
+    if (connect_face(face, ip, port) < 0) {
+        exit(EXIT_FAILURE);
+    }
+    stats.reconnects++;
+}
+
+/**
+ * @brief Lê o porto de métricas do nó.
+ *
+ * @param sample Amostra a preencher com os valores lidos
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+static int scrape_metrics(LgSample *sample) {
+    static char response[METRICS_SCRAPE_BUFFER + 1024];
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(metrics_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    struct timeval tv = {LG_SCRAPE_TIMEOUT_S, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    const char *request = "GET /metrics HTTP/1.0\r\n\r\n";
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        write(fd, request, strlen(request)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    size_t len = 0;
+    ssize_t n;
+    while (len < sizeof(response) - 1 && (n = read(fd, response + len, sizeof(response) - 1 - len)) > 0) {
+        len += (size_t)n;
+    }
+    close(fd);
+    response[len] = '\0';
+
+    char *body = strstr(response, "\r\n\r\n");
+    if (body == NULL) {
+        return -1;
+    }
+    memset(sample, 0, sizeof(*sample));
+    for (char *line = strtok(body + 4, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+        char key[64];
+        double value;
+        if (line[0] == '#' || sscanf(line, "%63s %lf", key, &value) != 2) {
+            continue;
+        }
+        unsigned long v = (unsigned long)value;
+        if (strcmp(key, "ndn_resident_bytes") == 0) {
+            sample->resident = v;
+        } else if (strcmp(key, "ndn_heap_in_use_bytes") == 0) {
+            sample->heap_in_use = v;
+        } else if (strcmp(key, "ndn_heap_free_bytes") == 0) {
+            sample->heap_free = v;
+        } else if (strcmp(key, "ndn_pit_entries") == 0) {
+            sample->pit_entries = v;
+        } else if (strcmp(key, "ndn_cache_entries") == 0) {
+            sample->cache_entries = v;
+        } else if (strcmp(key, "ndn_neighbors") == 0) {
+            sample->neighbors = v;
+        } else if (strcmp(key, "ndn_internal_neighbors") == 0) {
+            sample->internal_neighbors = v;
+        } else if (strcmp(key, "ndn_pit_expired_total") == 0) {
+            sample->pit_expired = v;
+        }
+    }
+    return 0;
+}
+
+static double mb(unsigned long bytes) {
+    return bytes / 1048576.0;
+}
+
+/**
+ * @brief Lê e mostra uma amostra do nó no modo de resistência.
+ *
+ * As linhas vão para o stderr com -j, para o stdout ficar só com o JSON.
+ *
+ * @param seconds Tempo desde o início da medição
+ */
+static void take_sample(double seconds) {
+    FILE *out = json_output ? stderr : stdout;
+    LgSample sample;
+    if (scrape_metrics(&sample) < 0) {
+        fprintf(stderr, "Cannot read the node metrics on port %d (is \"stats listen %d\" enabled?)\n",
+                metrics_port, metrics_port);
+        exit(EXIT_FAILURE);
+    }
+    sample.seconds = seconds;
+
+    if (soak.samples == 0) {
+        soak.first = sample;
+        fprintf(out, "%9s %9s %9s %9s %6s %7s %7s %6s %9s %10s %6s\n", "time s", "rss MB", "heap MB",
+                "free MB", "frag%", "pit", "cache", "nbrs", "pit exp", "sent", "churn");
+    }
+    soak.last = sample;
+    soak.samples++;
+    if (sample.resident > soak.peak_resident) {
+        soak.peak_resident = sample.resident;
+    }
+    if (sample.heap_in_use > soak.peak_heap) {
+        soak.peak_heap = sample.heap_in_use;
+    }
+    soak.sum_t += seconds;
+    soak.sum_tt += seconds * seconds;
+    soak.sum_heap += (double)sample.heap_in_use;
+    soak.sum_t_heap += seconds * (double)sample.heap_in_use;
+
+    unsigned long heap_total = sample.heap_in_use + sample.heap_free;
+    fprintf(out, "%9.0f %9.2f %9.2f %9.2f %6.1f %7lu %7lu %3lu+%-2lu %9lu %10lu %6lu\n",
+            seconds, mb(sample.resident), mb(sample.heap_in_use), mb(sample.heap_free),
+            heap_total ? 100.0 * sample.heap_free / heap_total : 0.0,
+            sample.pit_entries, sample.cache_entries, sample.neighbors, sample.internal_neighbors,
+            sample.pit_expired, stats.sent, stats.reconnects);
+    fflush(out);
+}
+
+/**
+ * @brief Crescimento da memória do alocador em MB por hora (mínimos quadrados).
+ */
+static double heap_slope() {
+    double n = (double)soak.samples;
+    double den = n * soak.sum_tt - soak.sum_t * soak.sum_t;
+    if (soak.samples < 2 || den <= 0) {
+        return 0.0;
+    }
+    return (n * soak.sum_t_heap - soak.sum_t * soak.sum_heap) / den * 3600.0 / 1048576.0;
+}
+
+/**
+ * @brief Indica se a memória do nó cresceu mais do que o limite -G.
+ */
+static int soak_failed() {
+    double limit = growth_limit_mb * 1048576.0;
+    return growth_limit_mb > 0 &&
+           ((double)soak.peak_resident - soak.first.resident > limit ||
+            (double)soak.peak_heap - soak.first.heap_in_use > limit);
+}
+
+/**
+ * @brief Mostra o resumo da medição: contadores, débito e percentis da latência.
+ */
+static void print_report(double seconds) {
+    unsigned long completed = stats.objects + stats.noobjects;
+    printf("sent %lu  object %lu  noobject %lu  timeout %lu  skipped %lu  unexpected %lu\n",
+           stats.sent, stats.objects, stats.noobjects, stats.timeouts, stats.skipped, stats.unexpected);
+    printf("throughput %.1f interests/s (%.1f objects/s) over %.2f s\n",
+           completed / seconds, stats.objects / seconds, seconds);
+    printf("producers answered %lu OBJECT, consumers/producers answered %lu NOOBJECT\n",
+           stats.answered_object, stats.answered_noobject);
+    latency_print_header();
+    latency_print_row("object", &stats.object_latency);
+    latency_print_row("noobject", &stats.noobject_latency);
+
+    if (soak.samples > 0) {
+        printf("soak: %lu samples, %lu reconnects (%lu pending dropped), %lu silenced interests\n",
+               soak.samples, stats.reconnects, stats.dropped, stats.silenced);
+        printf("rss %.2f -> %.2f MB (peak %+.2f MB), heap in use %.2f -> %.2f MB (peak %+.2f MB, trend %+.2f MB/h)\n",
+               mb(soak.first.resident), mb(soak.last.resident),
+               mb(soak.peak_resident) - mb(soak.first.resident),
+               mb(soak.first.heap_in_use), mb(soak.last.heap_in_use),
+               mb(soak.peak_heap) - mb(soak.first.heap_in_use), heap_slope());
+        if (growth_limit_mb > 0) {
+            printf("%s: memory growth limit %.2f MB\n", soak_failed() ? "FAIL" : "PASS", growth_limit_mb);
+        }
+    }
+}
+
+/**
+ * @brief Escreve os percentis de um histograma como objeto JSON (em ns).
+ */
+static void print_json_latency(const char *label, const LatencyHistogram *hist) {
+    printf("\"%s\": {\"count\": %lu, \"min\": %lu, \"p50\": %lu, \"p90\": %lu, "
+           "\"p99\": %lu, \"p999\": %lu, \"max\": %lu}", label,
+           (unsigned long)hist->count, (unsigned long)(hist->count ? hist->min_ns : 0),
+           (unsigned long)latency_percentile(hist, 50.0),
+           (unsigned long)latency_percentile(hist, 90.0),
+           (unsigned long)latency_percentile(hist, 99.0),
+           (unsigned long)latency_percentile(hist, 99.9),
+           (unsigned long)hist->max_ns);
+}
+
+/**
+ * @brief Escreve o resumo da medição numa linha JSON (opção -j).
+ */
+static void print_json(double seconds) {
+    unsigned long completed = stats.objects + stats.noobjects;
+    printf("{\"tool\": \"ndn-loadgen\", \"seconds\": %.3f, \"sent\": %lu, \"object\": %lu, "
+           "\"noobject\": %lu, \"timeout\": %lu, \"skipped\": %lu, \"unexpected\": %lu, "
+           "\"throughput\": %.1f, ",
+           seconds, stats.sent, stats.objects, stats.noobjects, stats.timeouts, stats.skipped,
+           stats.unexpected, completed / seconds);
+    print_json_latency("object_latency_ns", &stats.object_latency);
+    printf(", ");
+    print_json_latency("noobject_latency_ns", &stats.noobject_latency);
+    if (soak.samples > 0) {
+        printf(", \"soak\": {\"samples\": %lu, \"reconnects\": %lu, \"dropped\": %lu, \"silenced\": %lu, "
+               "\"resident_first\": %lu, \"resident_last\": %lu, \"resident_peak\": %lu, "
+               "\"heap_first\": %lu, \"heap_last\": %lu, \"heap_peak\": %lu, \"heap_free_last\": %lu, "
+               "\"heap_trend_mb_per_hour\": %.3f, \"pit_entries_last\": %lu, \"cache_entries_last\": %lu, "
+               "\"growth_limit_mb\": %.3f, \"passed\": %s}",
+               soak.samples, stats.reconnects, stats.dropped, stats.silenced,
+               soak.first.resident, soak.last.resident, soak.peak_resident,
+               soak.first.heap_in_use, soak.last.heap_in_use, soak.peak_heap, soak.last.heap_free,
+               heap_slope(), soak.last.pit_entries, soak.last.cache_entries,
+               growth_limit_mb, soak_failed() ? "false" : "true");
+    }
+    printf("}\n");
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] <IP> <TCP>\n"
+            "  -f  connections (faces) to the node, 2 to %d (default 4)\n"
+            "  -P  producer faces answering OBJECT (default 1)\n"
+            "  -r  open loop: interests per second across consumer faces\n"
+            "  -c  closed loop: interests kept outstanding (default 16 if -r is not given)\n"
+            "  -d  measured duration in seconds (default 10)\n"
+            "  -W  warm-up seconds before measuring (default 0)\n"
+            "  -n  number of distinct names if -D has no n= (default 1000)\n"
+            "  -D  name workload: uniform, zipf, shift, scan, segments, seq or trace:file=F,\n"
+            "      with options as in ndn-workload (default zipf)\n"
+            "  -a  Zipf exponent if -D has no a= (default 1.0)\n"
+            "  -m  fraction of names the producers do not have (default 0)\n"
+            "  -T  request timeout in ms (default 3000)\n"
+            "  -o  maximum outstanding interests in open loop (default 10000)\n"
+            "  -x  name prefix (default \"obj\")\n"
+            "  -j  print the result as one JSON object\n"
+            "soak mode:\n"
+            "  -S  sample the node every this many seconds (enables soak mode)\n"
+            "  -M  metrics port of the node (\"stats listen <port>\"), required with -S\n"
+            "  -C  close and reconnect one face every this many seconds\n"
+            "  -z  fraction of names the producers never answer\n"
+            "  -G  fail (exit code 3) if resident or heap memory grows more than this many MB\n",
+            prog, LG_MAX_FACES);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "f:P:r:c:d:W:n:D:a:m:T:o:x:jS:M:C:z:G:h")) != -1) {
+        switch (opt) {
+            case 'f': face_count = atoi(optarg); break;
+            case 'P': producer_count = atoi(optarg); break;
+            case 'r': rate = atof(optarg); break;
+            case 'c': concurrency = atoi(optarg); break;
+            case 'd': duration_s = atof(optarg); break;
+            case 'W': warmup_s = atof(optarg); break;
+            case 'n': name_count = strtoul(optarg, NULL, 10); break;
+            case 'D': workload_spec = optarg; break;
+            case 'a': zipf_alpha = atof(optarg); break;
+            case 'm': miss_fraction = atof(optarg); break;
+            case 'T': timeout_ms = atoi(optarg); break;
+            case 'o': max_outstanding = strtoul(optarg, NULL, 10); break;
+            case 'x': prefix = optarg; break;
+            case 'j': json_output = 1; break;
+            case 'S': sample_s = atof(optarg); break;
+            case 'M': metrics_port = atoi(optarg); break;
+            case 'C': churn_s = atof(optarg); break;
+            case 'z': silent_fraction = atof(optarg); break;
+            case 'G': growth_limit_mb = atof(optarg); break;
+            default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind < 2 || face_count < 2 || face_count > LG_MAX_FACES ||
+        producer_count < 0 || producer_count >= face_count || name_count == 0 ||
+        duration_s <= 0 || timeout_ms <= 0 || max_outstanding == 0 ||
+        strlen(prefix) > MAX_OBJECT_NAME - 20 ||
+        (sample_s > 0 && (metrics_port <= 0 || metrics_port > 65535))) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (rate <= 0 && concurrency <= 0) {
+        concurrency = 16;
+    }
+    if (concurrency > 0 && (size_t)concurrency < max_outstanding) {
+        max_outstanding = (size_t)concurrency;
+    }
+
+    pending_size = 16;
+    while (pending_size < max_outstanding * 2) {
+        pending_size <<= 1;
+    }
+    pending = calloc(pending_size, sizeof(LgPending));
+    if (pending == NULL) {
+        perror("calloc");
+        return EXIT_FAILURE;
+    }
+    if (workload_init(&workload, workload_spec, name_count, zipf_alpha) < 0) {
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    for (int i = 0; i < face_count; i++) {
+        if (connect_face(i, argv[optind], argv[optind + 1]) < 0) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* Deixa o nó processar as mensagens ENTRY (e responder com SAFE) */
+    uint64_t settle = monotonic_ns() + 200000000ull;
+    while (monotonic_ns() < settle) {
+        poll_faces(50);
+    }
+
+    char description[512];
+    workload_describe(&workload, description, sizeof(description));
+    FILE *banner = json_output ? stderr : stdout;
+    fprintf(banner, "ndn-loadgen: %d face(s) (%d producer), %s, ", face_count, producer_count, description);
+    if (rate > 0) {
+        fprintf(banner, "open loop at %.0f interests/s", rate);
+    } else {
+        fprintf(banner, "closed loop with %d outstanding", concurrency);
+    }
+    fprintf(banner, ", %.1f s", duration_s);
+    if (warmup_s > 0) {
+        fprintf(banner, " after %.1f s warm-up", warmup_s);
+    }
+    fprintf(banner, "\n");
+    if (sample_s > 0) {
+        fprintf(banner, "soak: sampling every %.0f s", sample_s);
+        if (churn_s > 0) {
+            fprintf(banner, ", reconnecting a face every %.1f s", churn_s);
+        }
+        if (silent_fraction > 0) {
+            fprintf(banner, ", %.0f%% silent names", silent_fraction * 100.0);
+        }
+        if (growth_limit_mb > 0) {
+            fprintf(banner, ", growth limit %.1f MB", growth_limit_mb);
+        }
+        fprintf(banner, "\n");
+    }
+    fflush(stdout);
+
+    uint64_t start = monotonic_ns();
+    uint64_t measure_start = start + (uint64_t)(warmup_s * 1e9);
+    uint64_t end = measure_start + (uint64_t)(duration_s * 1e9);
+    uint64_t interval = rate > 0 ? (uint64_t)(1e9 / rate) : 0;
+    uint64_t next_send = start;
+    uint64_t next_expire = start + 100000000ull;
+    uint64_t next_sample = measure_start;
+    uint64_t next_churn_ns = start + (uint64_t)(churn_s * 1e9);
+    int measuring = (warmup_s <= 0);
+
+    for (uint64_t now = start; now < end; now = monotonic_ns()) {
+        if (!measuring && now >= measure_start) {
+            memset(&stats, 0, sizeof(stats));
+            measuring = 1;
+        }
+
+        if (rate > 0) {
+            int burst = 0;
+            while (next_send <= now && burst < LG_MAX_BURST) {
+                issue_interest(now);
+                next_send += interval;
+                burst++;
+            }
+            /* Mais de um segundo atrasado: conta os pedidos em falta e recomeça */
+            if (now > next_send + 1000000000ull) {
+                stats.skipped += (now - next_send) / interval;
+                next_send = now;
+            }
+        } else {
+            while (outstanding < (size_t)concurrency && issue_interest(now) == 0) {
+            }
+        }
+        flush_all();
+
+        int wait_ms = 100;
+        if (rate > 0) {
+            now = monotonic_ns();
+            wait_ms = next_send > now ? (int)((next_send - now) / 1000000) : 0;
+        }
+        poll_faces(wait_ms);
+        flush_all();
+
+        now = monotonic_ns();
+        if (now >= next_expire) {
+            expire_pending(now);
+            next_expire = now + 100000000ull;
+        }
+        if (churn_s > 0 && now >= next_churn_ns) {
+            churn_face(argv[optind], argv[optind + 1]);
+            next_churn_ns = now + (uint64_t)(churn_s * 1e9);
+        }
+        if (sample_s > 0 && measuring && now >= next_sample) {
+            take_sample((now - measure_start) / 1e9);
+            next_sample += (uint64_t)(sample_s * 1e9);
+        }
+    }
+    uint64_t elapsed = monotonic_ns() - measure_start;
+
+    /* Espera pelas respostas dos pedidos ainda pendentes (no máximo o timeout) */
+    uint64_t drain_end = monotonic_ns() + (uint64_t)timeout_ms * 1000000ull;
+    while (outstanding > 0 && monotonic_ns() < drain_end) {
+        poll_faces(10);
+        flush_all();
+    }
+    expire_pending(monotonic_ns() + (uint64_t)timeout_ms * 1000000ull + 1);
+    if (sample_s > 0) {
+        take_sample((monotonic_ns() - measure_start) / 1e9);
+    }
+
+    if (json_output) {
+        print_json(elapsed / 1e9);
+    } else {
+        print_report(elapsed / 1e9);
+    }
+
+    for (int i = 0; i < face_count; i++) {
+        close(faces[i].fd);
+    }
+    free(pending);
+    workload_free(&workload);
+    /* No modo de resistência há timeouts esperados (-z, -C): só a memória decide */
+    if (sample_s > 0) {
+        return soak_failed() ? 3 : EXIT_SUCCESS;
+    }
+    return stats.timeouts > 0 ? 2 : EXIT_SUCCESS;
+}
@@ -0,0 +1,611 @@
+/**
+ * @file ndn_netem.c
+ * @brief Relé TCP com degradação configurável da ligação (ndn-netem)
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a ferramenta ndn-netem, um relé em espaço de
+ * utilizador (sem root nem tc/netem) que se coloca entre dois nós: aceita
+ * ligações num porto local e, por cada uma, abre uma ligação ao destino e
+ * copia os dados nos dois sentidos, aplicando:
+ *
+ * - Atraso fixo (-d) mais uma variação aleatória uniforme (-j), sem nunca
+ *   reordenar os dados de um sentido
+ * - Limite de débito por sentido (-B), com fila de serialização
+ * - Perda de mensagens (-l): como o TCP não perde bytes, descarta-se a
+ *   mensagem completa (linha de texto ou trama binária de wire.h), para o
+ *   nó nunca ver mensagens truncadas
+ * - Paragens (-s/-S): de tempos a tempos a ligação deixa de entregar dados
+ *   durante -s ms (os dados ficam retidos e seguem no fim da paragem)
+ * - Quebras (-X): cada ligação é fechada ao fim de um tempo aleatório; o
+ *   sinal SIGUSR1 fecha de imediato todas as ligações abertas
+ *
+ * Os intervalos entre paragens e a duração das ligações seguem uma
+ * distribuição exponencial com a média indicada. Com -r a sequência
+ * aleatória é reprodutível. Os eventos são escritos no stderr e, no fim
+ * (SIGINT/SIGTERM), é mostrado um resumo por ligação.
+ *
+ * Os nós só passam pelo relé nas ligações abertas para o seu endereço:
+ * ligações de recuperação feitas para o endereço real de um nó (vindo de
+ * ENTRY ou SAFE) não são afetadas.
+ *
+ * Utilização:
+ *   ndn-netem [-d <ms>] [-j <ms>] [-B <kbit/s>] [-l <fração>] [-s <ms>] [-S <s>]
+ *             [-X <s>] [-r <semente>] [-q] <porto local> <IP destino> <TCP destino>
+ */
+
+#include "ndn.h"
+#include "wire.h"
+#include <poll.h>
+#include <stdarg.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define NETEM_MAX_LINKS 64
+#define NETEM_READ_SIZE 16384
+#define NETEM_MAX_QUEUED (4 * 1024 * 1024)  /* Bytes retidos por sentido antes de parar de ler */
+#define NETEM_LINE_MAX 4096                 /* Linha maior do que isto segue sem ser descartável */
+
+/**
+ * @brief Bloco de dados à espera da sua hora de entrega.
+ */
+typedef struct netem_chunk {
+    uint64_t due_ns;                /* Instante a partir do qual pode ser escrito */
+    size_t len;
+    size_t sent;                    /* Bytes já escritos (escrita parcial) */
+    struct netem_chunk *next;
+    char data[];
+} NetemChunk;
+
+/**
+ * @brief Um sentido de uma ligação (origem -> destino).
+ */
+typedef struct netem_flow {
+    int from_fd;
+    int to_fd;
+    NetemChunk *head;
+    NetemChunk *tail;
+    size_t queued;                  /* Bytes retidos */
+    uint64_t tx_free_ns;            /* Fim da serialização do último bloco */
+    char line[NETEM_LINE_MAX];      /* Linha incompleta (só com perda de mensagens) */
+    size_t line_len;
+    unsigned long bytes;            /* Bytes entregues */
+    unsigned long lines_dropped;
+    int eof;                        /* Origem fechou: fechar o destino quando a fila esvaziar */
+} NetemFlow;
+
+/**
+ * @brief Ligação reencaminhada: cliente <-> destino.
+ */
+typedef struct netem_link {
+    int id;
+    int active;
+    char peer[INET_ADDRSTRLEN + 8];
+    NetemFlow flow[2];              /* 0: cliente -> destino, 1: destino -> cliente */
+    uint64_t opened_ns;
+    uint64_t close_at_ns;           /* 0 = sem quebra programada */
+    uint64_t next_stall_ns;         /* 0 = sem paragens */
+    uint64_t stall_until_ns;
+    unsigned long stalls;
+} NetemLink;
+
+/* Configuração */
+static double delay_ms = 0.0;
+static double jitter_ms = 0.0;
+static double bandwidth_kbps = 0.0;     /* 0 = sem limite */
+static double loss = 0.0;
+static double stall_ms = 0.0;
+static double stall_interval_s = 0.0;
+static double lifetime_s = 0.0;
+static int quiet = 0;
+static struct sockaddr_in target;
+
+/* Estado */
+static NetemLink links[NETEM_MAX_LINKS];
+static int next_link_id = 1;
+static uint64_t rng_state = 0x2545f4914f6cdd1dull;
+static volatile sig_atomic_t stop_requested = 0;
+static volatile sig_atomic_t break_requested = 0;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Gera um número pseudoaleatório de 64 bits (xorshift64*).
+ */
+static uint64_t next_random() {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+/**
+ * @brief Gera um número uniforme em [0, 1).
+ */
+static double next_uniform() {
+    return (next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Sorteia um intervalo exponencial com a média indicada, em ns.
+ */
+static uint64_t next_exponential_ns(double mean_s) {
+    return (uint64_t)(-log(1.0 - next_uniform()) * mean_s * 1e9);
+}
+
+static void log_event(const NetemLink *link, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Escreve um evento de uma ligação no stderr (exceto com -q).
+ */
+static void log_event(const NetemLink *link, const char *fmt, ...) {
+    if (quiet) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[link %d %s] ", link->id, link->peer);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+/**
+ * @brief Coloca dados na fila de um sentido, calculando a hora de entrega.
+ *
+ * A hora de entrega é o fim da serialização (com -B) mais o atraso e a
+ * variação, e nunca é anterior à do bloco anterior, para não reordenar.
+ */
+static int enqueue(NetemFlow *flow, const char *data, size_t len, uint64_t now) {
+    NetemChunk *chunk = malloc(sizeof(NetemChunk) + len);
+    if (chunk == NULL) {
+        return -1;
+    }
+    memcpy(chunk->data, data, len);
+    chunk->len = len;
+    chunk->sent = 0;
+    chunk->next = NULL;
+
+    uint64_t depart = now;
+    if (bandwidth_kbps > 0) {
+        uint64_t start = flow->tx_free_ns > now ? flow->tx_free_ns : now;
+        depart = start + (uint64_t)((double)len * 8.0 * 1e6 / bandwidth_kbps);
+        flow->tx_free_ns = depart;
+    }
+    chunk->due_ns = depart + (uint64_t)((delay_ms + jitter_ms * next_uniform()) * 1e6);
+    if (flow->tail != NULL && chunk->due_ns < flow->tail->due_ns) {
+        chunk->due_ns = flow->tail->due_ns;
+    }
+
+    if (flow->tail == NULL) {
+        flow->head = chunk;
+    } else {
+        flow->tail->next = chunk;
+    }
+    flow->tail = chunk;
+    flow->queued += len;
+    return 0;
+}
+
+/**
+ * @brief Separa os dados lidos em mensagens, descartando cada uma com probabilidade -l.
+ *
+ * As mensagens são linhas de texto ou tramas binárias (wire.h), que
+ * terminam ao fim do comprimento do cabeçalho e podem conter '\n'.
+ */
+static int enqueue_lines(NetemFlow *flow, const char *data, size_t len, uint64_t now) {
+    for (size_t i = 0; i < len; i++) {
+        flow->line[flow->line_len++] = data[i];
+        int complete;
+        if (wire_is_frame((unsigned char)flow->line[0])) {
+            ssize_t frame_len = wire_frame_size(flow->line, flow->line_len, NETEM_LINE_MAX);
+            if (frame_len == 0 || (frame_len > 0 && (size_t)frame_len > flow->line_len)) {
+                continue;
+            }
+            complete = frame_len > 0;   /* Cabeçalho inválido: segue sem ser descartável */
+        } else {
+            if (data[i] != '\n' && flow->line_len < NETEM_LINE_MAX) {
+                continue;
+            }
+            complete = data[i] == '\n';
+        }
+        if (complete && next_uniform() < loss) {
+            flow->lines_dropped++;
+        } else if (enqueue(flow, flow->line, flow->line_len, now) < 0) {
+            return -1;
+        }
+        flow->line_len = 0;
+    }
+    return 0;
+}
+
+static void free_flow(NetemFlow *flow) {
+    while (flow->head != NULL) {
+        NetemChunk *next = flow->head->next;
+        free(flow->head);
+        flow->head = next;
+    }
+    flow->tail = NULL;
+    flow->queued = 0;
+}
+
+/**
+ * @brief Fecha os dois lados de uma ligação e descarta os dados retidos.
+ */
+static void close_link(NetemLink *link, const char *reason) {
+    uint64_t age_ms = (now_ns() - link->opened_ns) / 1000000;
+    log_event(link, "closed (%s) after %lu ms: %lu bytes ->, %lu bytes <-, %lu+%lu lines dropped, %lu stalls",
+              reason, (unsigned long)age_ms, link->flow[0].bytes, link->flow[1].bytes,
+              link->flow[0].lines_dropped, link->flow[1].lines_dropped, link->stalls);
+    close(link->flow[0].from_fd);
+    close(link->flow[0].to_fd);
+    free_flow(&link->flow[0]);
+    free_flow(&link->flow[1]);
+    link->active = 0;
+}
+
+/**
+ * @brief Aceita uma ligação e abre a ligação correspondente ao destino.
+ */
+static void accept_link(int listen_fd) {
+    struct sockaddr_in peer;
+    socklen_t peer_len = sizeof(peer);
+    int client = accept(listen_fd, (struct sockaddr *)&peer, &peer_len);
+    if (client == -1) {
+        return;
+    }
+
+    NetemLink *link = NULL;
+    for (int i = 0; i < NETEM_MAX_LINKS; i++) {
+        if (!links[i].active) {
+            link = &links[i];
+            break;
+        }
+    }
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    if (link == NULL || server == -1 ||
+        connect(server, (struct sockaddr *)&target, sizeof(target)) == -1) {
+        fprintf(stderr, "Cannot relay connection: %s\n", link == NULL ? "too many links" : strerror(errno));
+        if (server != -1) {
+            close(server);
+        }
+        close(client);
+        return;
+    }
+
+    int one = 1;
+    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+    fcntl(server, F_SETFL, fcntl(server, F_GETFL) | O_NONBLOCK);
+
+    memset(link, 0, sizeof(*link));
+    link->id = next_link_id++;
+    link->active = 1;
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &peer.sin_addr, ip, sizeof(ip));
+    snprintf(link->peer, sizeof(link->peer), "%s:%d", ip, ntohs(peer.sin_port));
+    link->flow[0].from_fd = client;
+    link->flow[0].to_fd = server;
+    link->flow[1].from_fd = server;
+    link->flow[1].to_fd = client;
+
+    uint64_t now = now_ns();
+    link->opened_ns = now;
+    if (lifetime_s > 0) {
+        link->close_at_ns = now + next_exponential_ns(lifetime_s);
+    }
+    if (stall_ms > 0 && stall_interval_s > 0) {
+        link->next_stall_ns = now + next_exponential_ns(stall_interval_s);
+    }
+    log_event(link, "connected");
+}
+
+/**
+ * @brief Lê os dados disponíveis num sentido e coloca-os na fila.
+ *
+ * @return 0 em caso de sucesso, -1 se a ligação tiver de ser fechada
+ */
+static int read_flow(NetemFlow *flow, uint64_t now) {
+    char buffer[NETEM_READ_SIZE];
+    ssize_t n = read(flow->from_fd, buffer, sizeof(buffer));
+    if (n < 0) {
+        return errno == EAGAIN || errno == EINTR ? 0 : -1;
+    }
+    if (n == 0) {
+        flow->eof = 1;
+        return 0;
+    }
+    return loss > 0 ? enqueue_lines(flow, buffer, (size_t)n, now)
+                    : enqueue(flow, buffer, (size_t)n, now);
+}
+
+/**
+ * @brief Escreve os blocos cuja hora de entrega já passou.
+ *
+ * @return 0 em caso de sucesso, -1 se a ligação tiver de ser fechada
+ */
+static int write_flow(NetemFlow *flow, uint64_t now) {
+    while (flow->head != NULL && flow->head->due_ns <= now) {
+        NetemChunk *chunk = flow->head;
+        ssize_t n = write(flow->to_fd, chunk->data + chunk->sent, chunk->len - chunk->sent);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EINTR ? 0 : -1;
+        }
+        chunk->sent += (size_t)n;
+        flow->bytes += (unsigned long)n;
+        if (chunk->sent < chunk->len) {
+            return 0;
+        }
+        flow->head = chunk->next;
+        if (flow->head == NULL) {
+            flow->tail = NULL;
+        }
+        flow->queued -= chunk->len;
+        free(chunk);
+    }
+    return 0;
+}
+
+/**
+ * @brief Avança as paragens e quebras programadas de uma ligação.
+ *
+ * @return 0 se a ligação continuar aberta, -1 se tiver sido fechada
+ */
+static int update_link(NetemLink *link, uint64_t now) {
+    if (link->close_at_ns != 0 && now >= link->close_at_ns) {
+        close_link(link, "lifetime");
+        return -1;
+    }
+    if (link->next_stall_ns != 0 && now >= link->next_stall_ns) {
+        link->stall_until_ns = now + (uint64_t)(stall_ms * 1e6);
+        link->next_stall_ns = link->stall_until_ns + next_exponential_ns(stall_interval_s);
+        link->stalls++;
+        log_event(link, "stalled for %.0f ms", stall_ms);
+    }
+    return 0;
+}
+
+/**
+ * @brief Indica se um sentido tem dados prontos a escrever (à espera de POLLOUT).
+ */
+static int flow_ready(const NetemLink *link, const NetemFlow *flow, uint64_t now) {
+    return flow->head != NULL && flow->head->due_ns <= now && link->stall_until_ns <= now;
+}
+
+/**
+ * @brief Próximo instante em que algo tem de acontecer numa ligação.
+ *
+ * Os dados já prontos não contam: esperam que o destino aceite escrita.
+ */
+static uint64_t link_deadline(const NetemLink *link, uint64_t now) {
+    uint64_t deadline = UINT64_MAX;
+    for (int d = 0; d < 2; d++) {
+        if (link->flow[d].head != NULL && !flow_ready(link, &link->flow[d], now)) {
+            uint64_t due = link->flow[d].head->due_ns;
+            if (link->stall_until_ns > due) {
+                due = link->stall_until_ns;
+            }
+            deadline = due < deadline ? due : deadline;
+        }
+    }
+    if (link->close_at_ns != 0 && link->close_at_ns < deadline) {
+        deadline = link->close_at_ns;
+    }
+    if (link->next_stall_ns != 0 && link->next_stall_ns < deadline) {
+        deadline = link->next_stall_ns;
+    }
+    return deadline > now ? deadline : now;
+}
+
+/**
+ * @brief Pede o fim do ciclo principal (SIGINT/SIGTERM).
+ */
+static void handle_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+/**
+ * @brief Pede a quebra de todas as ligações abertas (SIGUSR1).
+ */
+static void handle_break(int sig) {
+    (void)sig;
+    break_requested = 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] <local TCP> <target IP> <target TCP>\n"
+            "  -d  one-way delay in ms (default 0)\n"
+            "  -j  extra random delay in ms, uniform in [0, j] (default 0)\n"
+            "  -B  bandwidth per direction in kbit/s (default unlimited)\n"
+            "  -l  fraction of protocol lines (messages) to drop (default 0)\n"
+            "  -s  stall duration in ms\n"
+            "  -S  mean seconds between stalls of a link\n"
+            "  -X  mean link lifetime in seconds before a forced disconnect\n"
+            "  -r  random seed\n"
+            "  -q  do not log link events\n"
+            "SIGUSR1 disconnects every open link.\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "d:j:B:l:s:S:X:r:qh")) != -1) {
+        switch (opt) {
+            case 'd': delay_ms = atof(optarg); break;
+            case 'j': jitter_ms = atof(optarg); break;
+            case 'B': bandwidth_kbps = atof(optarg); break;
+            case 'l': loss = atof(optarg); break;
+            case 's': stall_ms = atof(optarg); break;
+            case 'S': stall_interval_s = atof(optarg); break;
+            case 'X': lifetime_s = atof(optarg); break;
+            case 'r': rng_state = strtoull(optarg, NULL, 0) | 1; break;
+            case 'q': quiet = 1; break;
+            default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (argc - optind != 3 || delay_ms < 0 || jitter_ms < 0 || bandwidth_kbps < 0 ||
+        loss < 0 || loss >= 1 || stall_ms < 0 || stall_interval_s < 0 || lifetime_s < 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&target, 0, sizeof(target));
+    target.sin_family = AF_INET;
+    target.sin_port = htons(atoi(argv[optind + 2]));
+    if (inet_pton(AF_INET, argv[optind + 1], &target.sin_addr) != 1) {
+        fprintf(stderr, "Invalid address: %s\n", argv[optind + 1]);
+        return EXIT_FAILURE;
+    }
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(atoi(argv[optind]));
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (listen_fd == -1 || bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        listen(listen_fd, 16) == -1) {
+        perror("bind");
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction act;
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = handle_stop;
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+    act.sa_handler = handle_break;
+    sigaction(SIGUSR1, &act, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("ndn-netem relaying :%s -> %s:%s (delay %.1f+%.1f ms", argv[optind],
+           argv[optind + 1], argv[optind + 2], delay_ms, jitter_ms);
+    if (bandwidth_kbps > 0) {
+        printf(", %.0f kbit/s", bandwidth_kbps);
+    }
+    if (loss > 0) {
+        printf(", %.1f%% lines lost", loss * 100.0);
+    }
+    if (stall_ms > 0 && stall_interval_s > 0) {
+        printf(", %.0f ms stalls every %.1f s", stall_ms, stall_interval_s);
+    }
+    if (lifetime_s > 0) {
+        printf(", links live %.1f s", lifetime_s);
+    }
+    printf(")\n");
+    fflush(stdout);
+
+    struct pollfd fds[1 + 2 * NETEM_MAX_LINKS];
+    NetemFlow *fd_flow[1 + 2 * NETEM_MAX_LINKS];
+
+    while (!stop_requested) {
+        uint64_t now = now_ns();
+        if (break_requested) {
+            break_requested = 0;
+            for (int i = 0; i < NETEM_MAX_LINKS; i++) {
+                if (links[i].active) {
+                    close_link(&links[i], "SIGUSR1");
+                }
+            }
+        }
+
+        /* Entrega o que já passou da hora e fecha as ligações terminadas */
+        uint64_t deadline = UINT64_MAX;
+        for (int i = 0; i < NETEM_MAX_LINKS; i++) {
+            NetemLink *link = &links[i];
+            if (!link->active || update_link(link, now) < 0) {
+                continue;
+            }
+            if (now >= link->stall_until_ns &&
+                (write_flow(&link->flow[0], now) < 0 || write_flow(&link->flow[1], now) < 0)) {
+                close_link(link, "write error");
+                continue;
+            }
+            if (link->flow[0].eof && link->flow[0].head == NULL) {
+                close_link(link, "client closed");
+                continue;
+            }
+            if (link->flow[1].eof && link->flow[1].head == NULL) {
+                close_link(link, "target closed");
+                continue;
+            }
+            uint64_t due = link_deadline(link, now);
+            deadline = due < deadline ? due : deadline;
+        }
+
+        int count = 0;
+        fds[count].fd = listen_fd;
+        fds[count].events = POLLIN;
+        fd_flow[count++] = NULL;
+        for (int i = 0; i < NETEM_MAX_LINKS; i++) {
+            if (!links[i].active) {
+                continue;
+            }
+            for (int d = 0; d < 2; d++) {
+                NetemFlow *flow = &links[i].flow[d];
+                NetemFlow *reverse = &links[i].flow[1 - d];
+                short events = 0;
+                if (!flow->eof && flow->queued < NETEM_MAX_QUEUED) {
+                    events |= POLLIN;
+                }
+                /* O sentido inverso escreve neste descritor */
+                if (flow_ready(&links[i], reverse, now)) {
+                    events |= POLLOUT;
+                }
+                fds[count].fd = flow->from_fd;
+                fds[count].events = events;
+                fd_flow[count++] = flow;
+            }
+        }
+
+        int timeout = -1;
+        if (deadline != UINT64_MAX) {
+            timeout = (int)((deadline - now + 999999) / 1000000);
+        }
+        if (poll(fds, count, timeout) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            break;
+        }
+
+        now = now_ns();
+        if (fds[0].revents & POLLIN) {
+            accept_link(listen_fd);
+        }
+        for (int i = 1; i < count; i++) {
+            NetemFlow *flow = fd_flow[i];
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)) || !(fds[i].events & POLLIN)) {
+                continue;
+            }
+            NetemLink *link = NULL;
+            for (int l = 0; l < NETEM_MAX_LINKS && link == NULL; l++) {
+                if (flow == &links[l].flow[0] || flow == &links[l].flow[1]) {
+                    link = &links[l];
+                }
+            }
+            if (link->active && read_flow(flow, now) < 0) {
+                close_link(link, "read error");
+            }
+        }
+    }
+
+    for (int i = 0; i < NETEM_MAX_LINKS; i++) {
+        if (links[i].active) {
+            close_link(&links[i], "exit");
+        }
+    }
+    close(listen_fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,442 @@
+/**
+ * @file ndn_regserver.c
+ * @brief Servidor de registo local para redes NDN (ndn-regserver)
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém um substituto local do servidor de registo da
+ * unidade curricular, para testes sem acesso à rede e com muitos nós.
+ * Implementa o protocolo de registo (UDP):
+ *
+ *   NODES <net>                 -> NODESLIST <net>\n<IP> <TCP>\n...
+ *   REG <net> <IP> <TCP>        -> OKREG
+ *   UNREG <net> <IP> <TCP>      -> OKUNREG
+ *   RST <net>                   -> OKRST (remove todos os nós da rede)
+ *
+ * Cada rede (000 a 999) é indexada diretamente e guarda os nós num vetor
+ * denso (para construir NODESLIST) e numa tabela de dispersão com sondagem
+ * linear (para REG e UNREG em tempo constante). Os pedidos são lidos e as
+ * respostas enviadas em lotes com recvmmsg/sendmmsg, o que permite servir
+ * milhares de nós a entrar ao mesmo tempo em localhost.
+ *
+ * Uma resposta NODESLIST tem no máximo MAX_BUFFER - 1 bytes (o que os nós
+ * leem); em redes maiores, cada resposta mostra uma janela diferente dos
+ * nós registados, para espalhar as entradas pela árvore.
+ *
+ * Utilização: ndn-regserver [-a <IP>] [-p <UDP>] [-v]
+ */
+
+#define _GNU_SOURCE
+#include "ndn.h"
+#include <sys/uio.h>
+
+#define REG_NETWORKS 1000           /* Redes 000 a 999 */
+#define REG_BATCH 64                /* Datagramas por chamada a recvmmsg/sendmmsg */
+#define REG_INITIAL_CAPACITY 16     /* Capacidade inicial de cada rede */
+#define REG_RCVBUF (4 * 1024 * 1024)
+
+/**
+ * @brief Nó registado numa rede.
+ */
+typedef struct reg_node {
+    uint32_t ip;                    /* Endereço IPv4 (ordem da rede) */
+    uint16_t port;                  /* Porto TCP */
+    char text[INET_ADDRSTRLEN + 8]; /* Linha "IP TCP" pronta a enviar */
+    uint8_t text_len;
+} RegNode;
+
+/**
+ * @brief Nós registados numa rede.
+ */
+typedef struct reg_network {
+    RegNode *nodes;                 /* Vetor denso dos nós */
+    size_t count;
+    size_t capacity;
+    uint32_t *index;                /* Tabela de dispersão: posição + 1 em nodes, 0 = vazia */
+    size_t index_size;              /* Potência de 2, pelo menos 2 * capacity */
+    size_t rotor;                   /* Início da próxima janela de NODESLIST */
+} RegNetwork;
+
+/**
+ * @brief Contadores de pedidos.
+ */
+typedef struct reg_stats {
+    unsigned long nodes;
+    unsigned long reg;
+    unsigned long unreg;
+    unsigned long rst;
+    unsigned long malformed;
+    unsigned long batches;
+} RegStats;
+
+static RegNetwork networks[REG_NETWORKS];
+static RegStats stats;
+static int verbose = 0;
+static volatile sig_atomic_t stop_requested = 0;
+
+/**
+ * @brief Calcula a posição inicial de um nó na tabela de dispersão.
+ */
+static size_t hash_node(uint32_t ip, uint16_t port, size_t size) {
+    uint64_t h = ((uint64_t)ip << 16 | port) * 0x9e3779b97f4a7c15ull;
+    return (size_t)(h >> 32) & (size - 1);
+}
+
+/**
+ * @brief Procura a posição de um nó na tabela de dispersão.
+ *
+ * @return Posição na tabela (ocupada pelo nó, ou a primeira vazia se não existir)
+ */
+static size_t find_slot(const RegNetwork *net, uint32_t ip, uint16_t port) {
+    size_t mask = net->index_size - 1;
+    size_t slot = hash_node(ip, port, net->index_size);
+    while (net->index[slot] != 0) {
+        const RegNode *n = &net->nodes[net->index[slot] - 1];
+        if (n->ip == ip && n->port == port) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Reconstrói a tabela de dispersão de uma rede com um novo tamanho.
+ */
+static int rebuild_index(RegNetwork *net, size_t index_size) {
+    uint32_t *index = calloc(index_size, sizeof(uint32_t));
+    if (index == NULL) {
+        return -1;
+    }
+    free(net->index);
+    net->index = index;
+    net->index_size = index_size;
+    for (size_t i = 0; i < net->count; i++) {
+        net->index[find_slot(net, net->nodes[i].ip, net->nodes[i].port)] = (uint32_t)(i + 1);
+    }
+    return 0;
+}
+
+/**
+ * @brief Regista um nó numa rede (sem efeito se já estiver registado).
+ */
+static int register_node(RegNetwork *net, uint32_t ip, uint16_t port, const char *ip_text) {
+    if (net->count == net->capacity) {
+        size_t capacity = net->capacity ? net->capacity * 2 : REG_INITIAL_CAPACITY;
+        RegNode *nodes = realloc(net->nodes, capacity * sizeof(RegNode));
+        if (nodes == NULL) {
+            return -1;
+        }
+        net->nodes = nodes;
+        net->capacity = capacity;
+        if (rebuild_index(net, capacity * 2) < 0) {
+            return -1;
+        }
+    }
+
+    size_t slot = find_slot(net, ip, port);
+    if (net->index[slot] != 0) {
+        return 0;
+    }
+
+    RegNode *n = &net->nodes[net->count];
+    n->ip = ip;
+    n->port = port;
+    n->text_len = (uint8_t)snprintf(n->text, sizeof(n->text), "%s %u\n", ip_text, port);
+    net->index[slot] = (uint32_t)(++net->count);
+    return 0;
+}
+
+/**
+ * @brief Remove um nó de uma rede (sem efeito se não estiver registado).
+ *
+ * O último nó do vetor ocupa o lugar do removido; a tabela de dispersão
+ * usa remoção com deslocamento para trás, sem marcas de remoção.
+ */
+static void unregister_node(RegNetwork *net, uint32_t ip, uint16_t port) {
+    if (net->count == 0) {
+        return;
+    }
+    size_t slot = find_slot(net, ip, port);
+    if (net->index[slot] == 0) {
+        return;
+    }
+
+    size_t pos = net->index[slot] - 1;
+    size_t last = net->count - 1;
+
+    /* Remoção com deslocamento para trás (sondagem linear) */
+    size_t mask = net->index_size - 1;
+    size_t hole = slot;
+    size_t next = (hole + 1) & mask;
+    while (net->index[next] != 0) {
+        const RegNode *n = &net->nodes[net->index[next] - 1];
+        size_t home = hash_node(n->ip, n->port, net->index_size);
+        /* Move a entrada para o buraco se o buraco estiver entre a posição inicial e a atual */
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            net->index[hole] = net->index[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    net->index[hole] = 0;
+
+    /* O último nó passa para a posição libertada */
+    if (pos != last) {
+        net->index[find_slot(net, net->nodes[last].ip, net->nodes[last].port)] = (uint32_t)(pos + 1);
+        net->nodes[pos] = net->nodes[last];
+    }
+    net->count--;
+}
+
+/**
+ * @brief Remove todos os nós de uma rede.
+ */
+static void reset_network(RegNetwork *net) {
+    net->count = 0;
+    net->rotor = 0;
+    if (net->index != NULL) {
+        memset(net->index, 0, net->index_size * sizeof(uint32_t));
+    }
+}
+
+/**
+ * @brief Obtém a rede a partir de um identificador de três dígitos.
+ *
+ * @return Rede, ou NULL se o identificador for inválido
+ */
+static RegNetwork *parse_network(const char *net) {
+    if (strlen(net) != 3 || !isdigit((unsigned char)net[0]) ||
+        !isdigit((unsigned char)net[1]) || !isdigit((unsigned char)net[2])) {
+        return NULL;
+    }
+    return &networks[atoi(net)];
+}
+
+/**
+ * @brief Constrói a resposta NODESLIST de uma rede.
+ *
+ * @return Comprimento da resposta
+ */
+static size_t build_nodeslist(RegNetwork *net, const char *net_id, char *reply, size_t size) {
+    size_t len = (size_t)snprintf(reply, size, "NODESLIST %s\n", net_id);
+    if (net->count == 0) {
+        return len;
+    }
+
+    size_t start = net->rotor % net->count;
+    size_t listed = 0;
+    for (size_t i = 0; i < net->count; i++) {
+        const RegNode *n = &net->nodes[(start + i) % net->count];
+        if (len + n->text_len >= size) {
+            break;
+        }
+        memcpy(reply + len, n->text, n->text_len);
+        len += n->text_len;
+        listed++;
+    }
+    net->rotor = start + listed;
+    return len;
+}
+
+/**
+ * @brief Processa um pedido e escreve a resposta.
+ *
+ * @param request Pedido (terminado em '\0')
+ * @param reply Buffer da resposta
+ * @param size Tamanho do buffer da resposta
+ * @return Comprimento da resposta, 0 se não houver resposta
+ */
+static size_t handle_request(char *request, char *reply, size_t size) {
+    char cmd[8], net_id[8], ip_text[INET_ADDRSTRLEN], port_text[8];
+    int fields = sscanf(request, "%7s %7s %15s %7s", cmd, net_id, ip_text, port_text);
+    RegNetwork *net = fields >= 2 ? parse_network(net_id) : NULL;
+
+    if (net != NULL && fields == 2 && strcmp(cmd, "NODES") == 0) {
+        stats.nodes++;
+        return build_nodeslist(net, net_id, reply, size);
+    }
+    if (net != NULL && fields == 2 && strcmp(cmd, "RST") == 0) {
+        stats.rst++;
+        reset_network(net);
+        return (size_t)snprintf(reply, size, "OKRST");
+    }
+
+    if (net != NULL && fields == 4 && (strcmp(cmd, "REG") == 0 || strcmp(cmd, "UNREG") == 0)) {
+        struct in_addr addr;
+        char *end;
+        long port = strtol(port_text, &end, 10);
+        if (inet_pton(AF_INET, ip_text, &addr) == 1 && *end == '\0' && port > 0 && port <= 65535) {
+            if (cmd[0] == 'R') {
+                stats.reg++;
+                if (register_node(net, addr.s_addr, (uint16_t)port, ip_text) < 0) {
+                    return 0;
+                }
+                return (size_t)snprintf(reply, size, "OKREG");
+            }
+            stats.unreg++;
+            unregister_node(net, addr.s_addr, (uint16_t)port);
+            return (size_t)snprintf(reply, size, "OKUNREG");
+        }
+    }
+
+    stats.malformed++;
+    if (verbose) {
+        fprintf(stderr, "Malformed request: %s\n", request);
+    }
+    return 0;
+}
+
+/**
+ * @brief Pede o fim do ciclo principal (SIGINT/SIGTERM).
+ */
+static void handle_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-a <IP>] [-p <UDP>] [-v]\n"
+            "  -a  address to bind (default 127.0.0.1)\n"
+            "  -p  UDP port (default %d)\n"
+            "  -v  print every request and malformed datagram\n",
+            prog, DEFAULT_REG_UDP);
+}
+
+int main(int argc, char *argv[]) {
+    const char *bind_ip = "127.0.0.1";
+    int port = DEFAULT_REG_UDP;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:p:vh")) != -1) {
+        switch (opt) {
+            case 'a': bind_ip = optarg; break;
+            case 'p': port = atoi(optarg); break;
+            case 'v': verbose = 1; break;
+            default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1) {
+        perror("socket");
+        return EXIT_FAILURE;
+    }
+
+    int rcvbuf = REG_RCVBUF;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, bind_ip, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid address: %s\n", bind_ip);
+        return EXIT_FAILURE;
+    }
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        perror("bind");
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction act;
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = handle_stop;
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+
+    printf("ndn-regserver listening on %s:%d (UDP)\n", bind_ip, port);
+    fflush(stdout);
+
+    static char requests[REG_BATCH][MAX_BUFFER];
+    static char replies[REG_BATCH][MAX_BUFFER];
+    struct sockaddr_in peers[REG_BATCH];
+    struct iovec rx_iov[REG_BATCH], tx_iov[REG_BATCH];
+    struct mmsghdr rx[REG_BATCH], tx[REG_BATCH];
+
+    for (int i = 0; i < REG_BATCH; i++) {
+        rx_iov[i].iov_base = requests[i];
+        rx_iov[i].iov_len = MAX_BUFFER - 1;
+        memset(&rx[i], 0, sizeof(rx[i]));
+        rx[i].msg_hdr.msg_iov = &rx_iov[i];
+        rx[i].msg_hdr.msg_iovlen = 1;
+        rx[i].msg_hdr.msg_name = &peers[i];
+    }
+
+    while (!stop_requested) {
+        for (int i = 0; i < REG_BATCH; i++) {
+            rx[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+        }
+
+        /* Bloqueia até ao primeiro datagrama e lê os que já estiverem na fila */
+        int received = recvmmsg(fd, rx, REG_BATCH, MSG_WAITFORONE, NULL);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("recvmmsg");
+            break;
+        }
+        stats.batches++;
+
+        int replies_ready = 0;
+        for (int i = 0; i < received; i++) {
+            char *request = requests[i];
+            size_t len = rx[i].msg_len;
+            while (len > 0 && (request[len - 1] == '\n' || request[len - 1] == '\r')) {
+                len--;
+            }
+            request[len] = '\0';
+
+            size_t reply_len = handle_request(request, replies[replies_ready], MAX_BUFFER);
+            if (reply_len == 0) {
+                continue;
+            }
+            if (verbose) {
+                char peer[INET_ADDRSTRLEN];
+                inet_ntop(AF_INET, &peers[i].sin_addr, peer, sizeof(peer));
+                fprintf(stderr, "%s:%d  %s -> %.*s\n", peer, ntohs(peers[i].sin_port), request,
+                        (int)strcspn(replies[replies_ready], "\n"), replies[replies_ready]);
+            }
+
+            tx_iov[replies_ready].iov_base = replies[replies_ready];
+            tx_iov[replies_ready].iov_len = reply_len;
+            memset(&tx[replies_ready], 0, sizeof(tx[replies_ready]));
+            tx[replies_ready].msg_hdr.msg_iov = &tx_iov[replies_ready];
+            tx[replies_ready].msg_hdr.msg_iovlen = 1;
+            tx[replies_ready].msg_hdr.msg_name = &peers[i];
+            tx[replies_ready].msg_hdr.msg_namelen = rx[i].msg_hdr.msg_namelen;
+            replies_ready++;
+        }
+
+        /* Envia as respostas do lote; sendmmsg pode enviar só parte */
+        int sent = 0;
+        while (sent < replies_ready) {
+            int n = sendmmsg(fd, tx + sent, replies_ready - sent, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("sendmmsg");
+                sent++;  /* Descarta a resposta que falhou e continua */
+                continue;
+            }
+            sent += n;
+        }
+    }
+
+    unsigned long registered = 0;
+    int active = 0;
+    for (int i = 0; i < REG_NETWORKS; i++) {
+        registered += networks[i].count;
+        active += networks[i].count > 0;
+        free(networks[i].nodes);
+        free(networks[i].index);
+    }
+    printf("\nRequests: %lu NODES, %lu REG, %lu UNREG, %lu RST, %lu malformed (%lu batches)\n",
+           stats.nodes, stats.reg, stats.unreg, stats.rst, stats.malformed, stats.batches);
+    printf("%lu node(s) registered in %d network(s)\n", registered, active);
+    close(fd);
+    return EXIT_SUCCESS;
+}
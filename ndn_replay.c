@@ -0,0 +1,548 @@
+/**
+ * @file ndn_replay.c
+ * @brief Reprodução de capturas de tráfego num nó NDN (ndn-replay)
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a ferramenta ndn-replay, que lê um ficheiro criado
+ * com "capture start" e volta a enviar as mensagens recebidas pelo nó
+ * original, respeitando os intervalos entre mensagens (ou acelerando-os):
+ *
+ * - Para um nó em execução: abre uma ligação TCP por cada interface da
+ *   captura, apresenta-se com ENTRY (sem capacidades) e envia por ela as
+ *   mensagens dessa interface
+ * - Para um nó no próprio processo (-p): cria um nó sem registo, liga
+ *   cada interface por um par de sockets locais e chama diretamente o
+ *   processamento de mensagens do nó, sem select nem rede; no fim mostra
+ *   os histogramas de latência e o custo por tipo de mensagem
+ * - Para o ecrã (-d): mostra a captura em texto
+ *
+ * Utilização:
+ *   ndn-replay [-s <velocidade>] [-l <repetições>] [-w <ms>] <captura> <IP> <TCP>
+ *   ndn-replay -p [-c <cache>] [-s <velocidade>] [-l <repetições>] <captura>
+ *   ndn-replay -d <captura>
+ */
+
+#include "capture.h"
+#include "network.h"
+#include "debug_utils.h"
+#include "latency.h"
+#include "cost.h"
+#include "trace.h"
+#include "wire.h"
+#include <poll.h>
+#include <netinet/in.h>
+
+#define REPLAY_MAX_FACES 64             /* Interfaces distintas numa captura */
+#define REPLAY_DEFAULT_WAIT_MS 500      /* Espera final por respostas (modo TCP) */
+#define REPLAY_DICT_FACES 16            /* Interfaces com tabela de nomes (ID + 1) */
+#define REPLAY_ENTRY_PORT_BASE 62000    /* Portos anunciados nas mensagens ENTRY (modo TCP) */
+#define REPLAY_EXPANDED_MAX (CAPTURE_MAX_FRAME * 4)     /* Tramas de uma mensagem com nomes expandidos */
+
+/**
+ * @brief Ligação usada para reproduzir as mensagens de uma interface capturada.
+ */
+typedef struct replay_face {
+    int face;                           /* ID de interface na captura */
+    int fd;                             /* Lado do ndn-replay */
+    int node_fd;                        /* Lado do nó (só no modo -p) */
+} ReplayFace;
+
+static ReplayFace faces[REPLAY_MAX_FACES];
+static int face_count = 0;
+
+static int in_process = 0;
+static const char *target_ip = NULL;
+static const char *target_port = NULL;
+static int cache_size = 100;
+
+/* Tabelas de nomes de cada interface capturada, por sentido, como no nó original */
+static WireDict dicts[REPLAY_DICT_FACES][2];
+
+static unsigned long frames_sent = 0;
+static unsigned long frames_skipped = 0;
+static unsigned long long bytes_sent = 0;
+static unsigned long frames_received = 0;
+static unsigned long long bytes_received = 0;
+static uint64_t node_busy_ns = 0;
+
+/**
+ * @brief Abre uma ligação TCP ao nó alvo.
+ *
+ * @return Descritor da ligação, -1 em caso de erro
+ */
+static int connect_target() {
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    int errcode = getaddrinfo(target_ip, target_port, &hints, &res);
+    if (errcode != 0) {
+        fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(errcode));
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd != -1 && connect(fd, res->ai_addr, res->ai_addrlen) == -1) {
+        perror("connect");
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+/**
+ * @brief Obtém (ou cria) a ligação de uma interface da captura.
+ *
+ * @param face ID de interface na captura
+ * @return Ligação, NULL em caso de erro
+ */
+static ReplayFace *get_face(int face) {
+    for (int i = 0; i < face_count; i++) {
+        if (faces[i].face == face) {
+            return &faces[i];
+        }
+    }
+    if (face_count >= REPLAY_MAX_FACES) {
+        fprintf(stderr, "Too many faces in trace (max %d)\n", REPLAY_MAX_FACES);
+        return NULL;
+    }
+
+    ReplayFace *f = &faces[face_count];
+    f->face = face;
+    f->node_fd = -1;
+
+    if (in_process) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1) {
+            perror("socketpair");
+            return NULL;
+        }
+        f->fd = sv[0];
+        f->node_fd = sv[1];
+        char port[12];  /* Porto fictício: identifica a ligação nos registos do nó */
+        snprintf(port, sizeof(port), "%d", face_count + 1);
+        add_neighbor("127.0.0.1", port, f->node_fd, 0);
+        if (f->node_fd > node.max_fd) {
+            node.max_fd = f->node_fd;
+        }
+    } else {
+        f->fd = connect_target();
+        if (f->fd == -1) {
+            return NULL;
+        }
+        /* Sem ENTRY o nó não regista as capacidades da ligação; sem capacidades
+         * envia texto, e as mensagens da captura seguem como foram gravadas */
+        char entry[64];
+        int len = snprintf(entry, sizeof(entry), "ENTRY 127.0.0.1 %d\n", REPLAY_ENTRY_PORT_BASE + face_count);
+        if (write(f->fd, entry, (size_t)len) != len) {
+            perror("write");
+            close(f->fd);
+            return NULL;
+        }
+    }
+
+    fcntl(f->fd, F_SETFL, fcntl(f->fd, F_GETFL, 0) | O_NONBLOCK);
+    face_count++;
+    return f;
+}
+
+/**
+ * @brief Lê e descarta as respostas pendentes do nó, contando as mensagens.
+ */
+static void drain_responses() {
+    char buffer[MAX_BUFFER];
+
+    for (int i = 0; i < face_count; i++) {
+        ssize_t n;
+        while ((n = read(faces[i].fd, buffer, sizeof(buffer))) > 0) {
+            bytes_received += (size_t)n;
+            for (ssize_t j = 0; j < n; j++) {
+                frames_received += (buffer[j] == '\n');
+            }
+        }
+    }
+}
+
+/**
+ * @brief Espera até um instante, continuando a ler as respostas do nó.
+ *
+ * @param deadline_ns Instante (CLOCK_MONOTONIC) até ao qual esperar
+ */
+static void wait_until(uint64_t deadline_ns) {
+    struct pollfd pfds[REPLAY_MAX_FACES];
+
+    for (;;) {
+        uint64_t now = monotonic_ns();
+        if (now >= deadline_ns) {
+            return;
+        }
+        int timeout_ms = (int)((deadline_ns - now + 999999) / 1000000);
+
+        if (in_process) {
+            /* O nó só trabalha quando é chamado: basta dormir */
+            struct timespec ts = {0, (long)(deadline_ns - now)};
+            if (deadline_ns - now >= 1000000000ull) {
+                ts.tv_sec = (time_t)((deadline_ns - now) / 1000000000ull);
+                ts.tv_nsec = (long)((deadline_ns - now) % 1000000000ull);
+            }
+            nanosleep(&ts, NULL);
+            continue;
+        }
+
+        for (int i = 0; i < face_count; i++) {
+            pfds[i].fd = faces[i].fd;
+            pfds[i].events = POLLIN;
+        }
+        if (poll(pfds, face_count, timeout_ms) > 0) {
+            drain_responses();
+        }
+    }
+}
+
+/**
+ * @brief Entrega uma mensagem ao nó e, no modo -p, processa-a de imediato.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+static int deliver(ReplayFace *f, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(f->fd, data, len);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                /* O nó ainda não leu o suficiente: esvazia as respostas e tenta de novo */
+                drain_responses();
+                if (!in_process) {
+                    struct pollfd pfd = {f->fd, POLLOUT, 0};
+                    poll(&pfd, 1, 100);
+                    continue;
+                }
+            } else {
+                perror("write");
+                return -1;
+            }
+        } else {
+            data += n;
+            len -= (size_t)n;
+            bytes_sent += (size_t)n;
+        }
+
+        if (in_process) {
+            FD_ZERO(&node.read_fds);
+            FD_SET(f->node_fd, &node.read_fds);
+            uint64_t start = monotonic_ns();
+            handle_network_events();
+            check_interest_timeouts();
+            node_busy_ns += monotonic_ns() - start;
+        }
+    }
+
+    frames_sent++;
+    drain_responses();
+    return 0;
+}
+
+/**
+ * @brief Esvazia as tabelas de nomes de todas as interfaces.
+ */
+static void reset_dicts() {
+    for (int f = 0; f < REPLAY_DICT_FACES; f++) {
+        wire_dict_reset(&dicts[f][CAPTURE_IN], WIRE_DICT_SLOTS);
+        wire_dict_reset(&dicts[f][CAPTURE_OUT], WIRE_DICT_SLOTS);
+    }
+}
+
+/**
+ * @brief Obtém a tabela de nomes de uma mensagem capturada.
+ *
+ * Uma mensagem "DICT" esvazia a tabela do sentido oposto, como no nó.
+ *
+ * @return Tabela, ou NULL se a interface não tiver tabela
+ */
+static WireDict *record_dict(const CaptureRecord *rec, const char *data) {
+    if (rec->face + 1 < 0 || rec->face + 1 >= REPLAY_DICT_FACES) {
+        return NULL;
+    }
+    if (rec->length > strlen(WIRE_DICT_RESET) &&
+        strncmp(data, WIRE_DICT_RESET " ", strlen(WIRE_DICT_RESET) + 1) == 0) {
+        /* Pedido para recomeçar a tabela do sentido oposto */
+        wire_dict_reset(&dicts[rec->face + 1][!rec->direction], WIRE_DICT_SLOTS);
+    }
+    return &dicts[rec->face + 1][rec->direction];
+}
+
+/**
+ * @brief Prepara uma mensagem capturada para ser reproduzida.
+ *
+ * As tramas com nomes comprimidos referem a tabela da ligação original,
+ * que o nó alvo não tem: os nomes são reconstruídos com a tabela da
+ * captura e as tramas codificadas de novo com os nomes completos (uma
+ * trama agrupada pode dar várias). Às mensagens ENTRY e SAFE são
+ * retiradas as capacidades, para o nó continuar a tratar a ligação como
+ * a de um nó sem capacidades.
+ *
+ * @param data Mensagem capturada (terminada em '\0')
+ * @param len Bytes da mensagem
+ * @param dict Tabela de nomes do sentido da mensagem (pode ser NULL)
+ * @param out Destino
+ * @param size Tamanho do destino
+ * @return Bytes a enviar, 0 se a mensagem não puder ser reproduzida
+ */
+static size_t prepare(const char *data, size_t len, WireDict *dict, char *out, size_t size) {
+    if (len > 0 && wire_is_frame((unsigned char)data[0])) {
+        static WireBatch batch;
+        WireFrame frame;
+        if (wire_is_batch((unsigned char)data[0])) {
+            if (wire_decode_batch(data, len, CAPTURE_MAX_FRAME, &batch, dict) <= 0) {
+                return 0;
+            }
+            const char *names[WIRE_BATCH_MAX];
+            for (size_t i = 0; i < batch.count; i++) {
+                names[i] = batch.names[i];
+            }
+            size_t total = 0, done = 0;
+            while (done < batch.count) {
+                /* Cada trama tem de caber numa leitura do nó */
+                size_t room = size - total < MAX_BUFFER - 1 ? size - total : MAX_BUFFER - 1;
+                size_t encoded;
+                ssize_t n = wire_encode_batch(out + total, room, batch.type,
+                                              names + done, batch.count - done, batch.trace_id,
+                                              batch.lifetime_ms, NULL, &encoded, NULL);
+                if (n < 0) {
+                    return 0;
+                }
+                total += (size_t)n;
+                done += encoded;
+            }
+            return total;
+        }
+        if (wire_decode(data, len, CAPTURE_MAX_FRAME, &frame, dict) <= 0) {
+            return 0;
+        }
+        char name[WIRE_DICT_NAME];
+        snprintf(name, sizeof(name), "%.*s", (int)frame.name_len, frame.name);
+        ssize_t n = wire_encode(out, size, frame.type, name, frame.trace_id,
+                                frame.lifetime_ms, frame.payload, frame.payload_len, NULL, NULL);
+        return n > 0 ? (size_t)n : 0;
+    }
+
+    if (strncmp(data, "ENTRY ", 6) == 0 || strncmp(data, "SAFE ", 5) == 0) {
+        /* Só "<tipo> <IP> <porto>" */
+        char type[8], ip[INET_ADDRSTRLEN], port[8];
+        if (sscanf(data, "%7s %15s %7s", type, ip, port) == 3) {
+            int n = snprintf(out, size, "%s %s %s\n", type, ip, port);
+            return n > 0 && (size_t)n < size ? (size_t)n : 0;
+        }
+    }
+
+    memcpy(out, data, len);
+    return len;
+}
+
+/**
+ * @brief Mostra uma captura em texto.
+ *
+ * As tramas binárias (wire.h) são mostradas como a mensagem de texto
+ * equivalente, seguida de "[tlv]", e as agrupadas como uma mensagem com
+ * todos os nomes, seguida de "[tlv batch <nomes>]". Os nomes comprimidos são reconstruídos
+ * com uma tabela por interface e sentido, como no nó; só se reconstroem
+ * se a captura tiver começado com a ligação.
+ */
+static int dump(CaptureReader *reader) {
+    CaptureRecord rec;
+    static char data[CAPTURE_MAX_FRAME + 1];
+    int rc;
+
+    reset_dicts();
+    while ((rc = capture_next(reader, &rec, data)) == 1) {
+        WireFrame frame;
+        WireDict *dict = record_dict(&rec, data);
+        if (rec.length > 0 && wire_is_frame((unsigned char)data[0]) &&
+            wire_decode(data, rec.length, CAPTURE_MAX_FRAME, &frame, dict) > 0) {
+            char trace[TRACE_TOKEN_SIZE];
+            printf("%12.6f %4d %-3s %5u  %s %.*s%s", rec.ts_ns / 1e9, rec.face,
+                   rec.direction == CAPTURE_IN ? "in" : "out", rec.length, wire_type_name(frame.type),
+                   (int)frame.name_len, frame.name, trace_token(frame.trace_id, trace));
+            if (frame.lifetime_ms != 0) {
+                printf(" lifetime=%u", frame.lifetime_ms);
+            }
+            printf(" [tlv]\n");
+            continue;
+        }
+        static WireBatch batch;
+        if (rec.length > 0 && wire_is_batch((unsigned char)data[0]) &&
+            wire_decode_batch(data, rec.length, CAPTURE_MAX_FRAME, &batch, dict) > 0) {
+            char trace[TRACE_TOKEN_SIZE];
+            printf("%12.6f %4d %-3s %5u  %s", rec.ts_ns / 1e9, rec.face,
+                   rec.direction == CAPTURE_IN ? "in" : "out", rec.length, wire_type_name(batch.type));
+            for (size_t i = 0; i < batch.count; i++) {
+                printf(" %s", batch.names[i]);
+            }
+            printf("%s", trace_token(batch.trace_id, trace));
+            if (batch.lifetime_ms != 0) {
+                printf(" lifetime=%u", batch.lifetime_ms);
+            }
+            printf(" [tlv batch %zu]\n", batch.count);
+            continue;
+        }
+        size_t len = rec.length;
+        while (len > 0 && (data[len - 1] == '\n' || data[len - 1] == '\r')) {
+            data[--len] = '\0';
+        }
+        printf("%12.6f %4d %-3s %5u  %s\n", rec.ts_ns / 1e9, rec.face,
+               rec.direction == CAPTURE_IN ? "in" : "out", rec.length, data);
+    }
+    return rc < 0 ? -1 : 0;
+}
+
+/**
+ * @brief Reproduz as mensagens recebidas de uma captura.
+ *
+ * As mensagens que não podem ser preparadas (prepare), como as tramas com
+ * nomes comprimidos de uma captura que começou a meio da ligação, são
+ * contadas e ignoradas.
+ *
+ * @param speed Fator de aceleração (0 = sem esperas)
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+static int replay(CaptureReader *reader, double speed) {
+    CaptureRecord rec;
+    static char data[CAPTURE_MAX_FRAME + 1];
+    static char out[REPLAY_EXPANDED_MAX];
+    uint64_t start = monotonic_ns();
+    int rc;
+
+    reset_dicts();
+    while ((rc = capture_next(reader, &rec, data)) == 1) {
+        /* As mensagens enviadas pelo nó original também mudam as tabelas (DICT) */
+        WireDict *dict = record_dict(&rec, data);
+        if (rec.direction != CAPTURE_IN) {
+            continue;
+        }
+        size_t len = prepare(data, rec.length, dict, out, sizeof(out));
+        if (len == 0) {
+            frames_skipped++;
+            continue;
+        }
+        if (speed > 0) {
+            wait_until(start + (uint64_t)(rec.ts_ns / speed));
+        }
+
+        ReplayFace *f = get_face(rec.face);
+        if (f == NULL || deliver(f, out, len) < 0) {
+            return -1;
+        }
+    }
+
+    if (rc < 0) {
+        fprintf(stderr, "Trace is truncated or corrupted\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Mostra a forma de utilização.
+ */
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-s <speed>] [-l <loops>] [-w <ms>] <trace> <IP> <TCP>\n"
+            "       %s -p [-c <cache>] [-s <speed>] [-l <loops>] <trace>\n"
+            "       %s -d <trace>\n"
+            "  -s  speed factor (1 = original timing, 10 = ten times faster, 0 = no waits)\n"
+            "  -l  number of times to replay the trace\n"
+            "  -w  time to keep reading responses after the last frame (TCP mode)\n"
+            "  -p  replay into a node hosted in this process\n"
+            "  -c  cache size of the in-process node\n"
+            "  -d  print the trace as text\n",
+            prog, prog, prog);
+}
+
+int main(int argc, char *argv[]) {
+    double speed = 1.0;
+    int loops = 1;
+    int wait_ms = REPLAY_DEFAULT_WAIT_MS;
+    int dump_only = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:l:w:c:pdh")) != -1) {
+        switch (opt) {
+            case 's': speed = atof(optarg); break;
+            case 'l': loops = atoi(optarg); break;
+            case 'w': wait_ms = atoi(optarg); break;
+            case 'c': cache_size = atoi(optarg); break;
+            case 'p': in_process = 1; break;
+            case 'd': dump_only = 1; break;
+            default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    int needed = (dump_only || in_process) ? 1 : 3;
+    if (argc - optind != needed || loops < 1 || speed < 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    CaptureReader reader;
+    if (capture_open(&reader, argv[optind]) < 0) {
+        fprintf(stderr, "Could not open trace %s: %s\n", argv[optind], strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    if (dump_only) {
+        int rc = dump(&reader);
+        capture_close(&reader);
+        return rc < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    if (in_process) {
+        log_init();
+        initialize_node(cache_size, "127.0.0.1", "0", DEFAULT_REG_IP, DEFAULT_REG_UDP);
+        cost_reset();
+        cost_enabled = 1;
+    } else {
+        target_ip = argv[optind + 1];
+        target_port = argv[optind + 2];
+    }
+
+    uint64_t start = monotonic_ns();
+    int rc = 0;
+    for (int loop = 0; loop < loops && rc == 0; loop++) {
+        if (loop > 0 && capture_rewind(&reader) < 0) {
+            rc = -1;
+            break;
+        }
+        rc = replay(&reader, speed);
+    }
+    uint64_t elapsed = monotonic_ns() - start;
+
+    if (!in_process) {
+        wait_until(monotonic_ns() + (uint64_t)wait_ms * 1000000ull);
+    }
+    capture_close(&reader);
+
+    printf("Replayed %lu frame(s), %llu byte(s) on %d face(s) in %.3f s (%.0f frames/s)\n",
+           frames_sent, bytes_sent, face_count, elapsed / 1e9,
+           elapsed > 0 ? frames_sent / (elapsed / 1e9) : 0.0);
+    printf("Received %lu frame(s), %llu byte(s) from the node\n", frames_received, bytes_received);
+    if (frames_skipped > 0) {
+        printf("Skipped %lu frame(s) whose compressed names could not be expanded\n", frames_skipped);
+    }
+
+    if (in_process) {
+        printf("Node busy %.3f s (%.0f ns per frame)\n", node_busy_ns / 1e9,
+               frames_sent > 0 ? (double)node_busy_ns / frames_sent : 0.0);
+        cmd_show_latency();
+        cmd_show_cost();
+        cleanup_and_exit();
+    } else {
+        for (int i = 0; i < face_count; i++) {
+            close(faces[i].fd);
+        }
+    }
+
+    return rc < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,1066 @@
+/**
+ * @file ndn_sim.c
+ * @brief Simulador de redes NDN com muitos nós num só processo (ndn-sim)
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a ferramenta ndn-sim, que executa o código real do
+ * nó (node.c, network.c, objects.c, commands.c) para milhares de nós no
+ * mesmo processo, sem sockets nem tempo real:
+ *
+ * - Cada nó guarda o seu próprio Node; antes de tratar um evento de um nó
+ *   o estado é copiado para a variável global node e no fim copiado de volta
+ * - As ligações usam o transporte em memória (NodeTransport): os
+ *   descritores são números virtuais de cada nó e cada mensagem enviada é
+ *   um evento entregue ao outro extremo ao fim da latência da ligação
+ * - O tempo é virtual (latency_set_clock): latências de pedidos, timeouts
+ *   da tabela de interesses e tempos de convergência são medidos nesse relógio
+ *
+ * A simulação constrói uma árvore (aleatória, k-ária ou em linha) com
+ * "dj", coloca os objetos em nós aleatórios, faz pedidos "retrieve" com um
+ * gerador de workload.c (Zipf por omissão, -D para os outros, incluindo a
+ * repetição de um ficheiro de pedidos) e pode provocar a falha abrupta de nós a
+ * meio da carga. No fim mostra as mensagens por tipo e por ligação, a
+ * taxa de acertos nas caches, as latências dos pedidos e o tempo de
+ * convergência da topologia.
+ *
+ * Com -e, a carga é dividida em janelas de -g segundos: a primeira aquece
+ * as caches e não é mostrada, a segunda serve de referência e no início de
+ * cada uma das seguintes é removido um nó
+ * (falha abrupta ou saída com "leave"), escolhido por papel na topologia
+ * atual (raiz, folha, nó interior, aleatório) ou por índice. Para cada
+ * remoção é mostrado o tempo até a topologia estabilizar, as componentes
+ * resultantes, os pedidos falhados e as mensagens a mais face à referência.
+ *
+ * Utilização:
+ *   ndn-sim [-n <nós>] [-t random|kary|line] [-b <filhos>] [-l <ms>] [-c <cache>]
+ *           [-o <objetos>] [-r <pedidos>] [-q <pedidos/s>] [-a <alfa>] [-D <gerador>]
+ *           [-f <falhas>] [-F <s>] [-e <remoções>] [-g <s>] [-s <semente>] [-v]
+ */
+
+#include "network.h"
+#include "commands.h"
+#include "objects.h"
+#include "debug_utils.h"
+#include "metrics.h"
+#include "latency.h"
+#include "workload.h"
+
+#define SIM_MAX_FDS 64                      /* Descritores virtuais por nó */
+#define SIM_FIRST_FD 3                      /* 0 a 2 ficam reservados */
+#define SIM_PORT "58000"                    /* Porto TCP de todos os nós simulados */
+#define SIM_EPOCH_NS 1000000000ull          /* Início do relógio virtual (0 significa "sem pedido") */
+#define SIM_TICK_NS 1000000000ull           /* Período da verificação de timeouts */
+#define SIM_MAX_CHILDREN (MAX_INTERFACE - 3) /* Filhos por nó: o pai e a interface local ocupam o resto */
+#define SIM_TOP_LINKS 5                     /* Ligações mais carregadas mostradas no fim */
+#define SIM_MAX_REMOVALS 64                 /* Remoções em -e */
+
+/**
+ * @brief Tipos de evento da simulação.
+ */
+typedef enum {
+    EV_DELIVER = 0,     /* Chegada de uma mensagem */
+    EV_ACCEPT,          /* Chegada de uma nova ligação */
+    EV_CLOSE,           /* Fecho da ligação pelo outro extremo */
+    EV_JOIN,            /* Entrada de um nó na árvore */
+    EV_RETRIEVE,        /* Pedido "retrieve" num nó */
+    EV_FAIL,            /* Falha abrupta de um nó */
+    EV_TICK,            /* Verificação periódica de timeouts */
+    EV_REMOVE,          /* Remoção planeada de um nó (-e) */
+    EV_MARK             /* Início de uma janela de medição (-e) */
+} SimEventType;
+
+/**
+ * @brief Evento, ordenado por instante e, em caso de empate, por ordem de criação.
+ */
+typedef struct sim_event {
+    uint64_t time_ns;
+    uint64_t seq;
+    SimEventType type;
+    int node;           /* Nó destinatário */
+    int fd;             /* Descritor virtual no nó destinatário */
+    int link;           /* Ligação, ou argumento (pai, objeto) */
+    size_t len;
+    char *data;         /* Mensagem (EV_DELIVER) */
+} SimEvent;
+
+/**
+ * @brief Ligação entre dois nós.
+ */
+typedef struct sim_link {
+    int end_node[2];
+    int end_fd[2];
+    int open[2];                    /* Extremo ainda não fechado */
+    unsigned long messages[2];      /* Mensagens enviadas por cada extremo */
+    unsigned long long bytes[2];
+} SimLink;
+
+/**
+ * @brief Nó simulado.
+ */
+typedef struct sim_node {
+    Node state;                     /* Estado do nó quando não está em execução */
+    int alive;
+    int children;                   /* Filhos na árvore inicial */
+    int fd_link[SIM_MAX_FDS];       /* Ligação de cada descritor virtual, -1 se livre */
+} SimNode;
+
+/**
+ * @brief Remoção planeada de um nó (-e) e o nó efetivamente removido.
+ */
+typedef struct sim_removal {
+    int leave;                      /* 1 = saída com leave, 0 = falha abrupta */
+    enum { PICK_INDEX, PICK_ROOT, PICK_LEAF, PICK_INNER, PICK_RANDOM } pick;
+    int index;                      /* Nó indicado (PICK_INDEX) */
+    int victim;                     /* Nó removido, -1 se não havia candidato */
+    int degree;                     /* Vizinhos do nó removido */
+} SimRemoval;
+
+/**
+ * @brief Estado no início de uma janela de medição.
+ */
+typedef struct sim_window {
+    uint64_t start_ns;
+    uint64_t topology_ns;           /* Último evento de topologia antes da janela */
+    MetricsSnapshot metrics;
+    unsigned long messages[MSG_TYPE_COUNT];
+    int components;
+} SimWindow;
+
+/* Configuração */
+static int node_count = 100;
+static enum { TOPO_RANDOM, TOPO_KARY, TOPO_LINE } topology = TOPO_RANDOM;
+static int fanout = 3;
+static uint64_t link_latency_ns = 1000000;
+static int cache_size = MAX_CACHE_SIZE;
+static int object_count = 1000;
+static int request_count = 10000;
+static double request_rate = 1000.0;
+static double zipf_alpha = 0.8;
+static const char *workload_spec = "zipf";   /* -D: gerador dos pedidos (workload.h) */
+static int failure_count = 0;
+static double failure_at_s = -1.0;
+static SimRemoval removals[SIM_MAX_REMOVALS];
+static int removal_count = 0;
+static double window_s = 15.0;          /* Maior do que INTEREST_TIMEOUT: os timeouts caem na janela */
+static int verbose = 0;
+
+/* Estado */
+static SimNode *nodes;
+static int current = -1;            /* Nó cujo estado está na variável global node */
+static SimLink *links;
+static int link_count = 0, link_capacity = 0;
+static SimEvent *heap;
+static size_t heap_len = 0, heap_capacity = 0;
+static uint64_t event_seq = 0;
+static uint64_t sim_now = SIM_EPOCH_NS;
+static const SimEvent *pending_read = NULL;   /* Evento a devolver por sim_recv */
+static Workload workload;
+static int *object_home;
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+static FILE *out;                   /* Relatório (stdout original) */
+
+/* Contadores */
+static unsigned long events_processed = 0;
+static unsigned long messages_by_type[MSG_TYPE_COUNT];
+static uint64_t last_topology_ns = 0;   /* Último evento de topologia (ligação, fecho, ENTRY, SAFE) */
+static SimWindow windows[SIM_MAX_REMOVALS + 2];
+
+static uint64_t next_random() {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+static uint64_t sim_clock() {
+    return sim_now;
+}
+
+/**
+ * @brief Obtém o endereço IP de um nó (10.x.y.z a partir do índice).
+ */
+static void node_ip(int index, char *ip) {
+    unsigned value = (unsigned)index + 1;
+    snprintf(ip, INET_ADDRSTRLEN, "10.%u.%u.%u", (value >> 16) & 255, (value >> 8) & 255, value & 255);
+}
+
+/**
+ * @brief Obtém o índice de um nó a partir do seu endereço IP.
+ *
+ * @return Índice, ou -1 se o endereço não for de um nó simulado
+ */
+static int ip_node(const char *ip) {
+    struct in_addr addr;
+    if (inet_pton(AF_INET, ip, &addr) != 1) {
+        return -1;
+    }
+    uint32_t value = ntohl(addr.s_addr);
+    if ((value >> 24) != 10) {
+        return -1;
+    }
+    long index = (long)(value & 0xffffff) - 1;
+    return index >= 0 && index < node_count ? (int)index : -1;
+}
+
+/**
+ * @brief Coloca o estado de um nó na variável global node.
+ */
+static void switch_to(int index) {
+    if (current == index) {
+        return;
+    }
+    if (current >= 0) {
+        nodes[current].state = node;
+    }
+    node = nodes[index].state;
+    current = index;
+}
+
+/**
+ * @brief Obtém o estado atual de um nó, esteja ou não em execução.
+ */
+static Node *node_state(int index) {
+    return index == current ? &node : &nodes[index].state;
+}
+
+/* ----- Fila de eventos (heap binário) ----- */
+
+static int event_before(const SimEvent *a, const SimEvent *b) {
+    return a->time_ns < b->time_ns || (a->time_ns == b->time_ns && a->seq < b->seq);
+}
+
+static void schedule(SimEvent ev) {
+    if (heap_len == heap_capacity) {
+        heap_capacity = heap_capacity ? heap_capacity * 2 : 1024;
+        heap = realloc(heap, heap_capacity * sizeof(SimEvent));
+        if (heap == NULL) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    ev.seq = event_seq++;
+    size_t i = heap_len++;
+    while (i > 0 && event_before(&ev, &heap[(i - 1) / 2])) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = ev;
+}
+
+static SimEvent pop_event() {
+    SimEvent top = heap[0];
+    SimEvent last = heap[--heap_len];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= heap_len) {
+            break;
+        }
+        if (child + 1 < heap_len && event_before(&heap[child + 1], &heap[child])) {
+            child++;
+        }
+        if (!event_before(&heap[child], &last)) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (heap_len > 0) {
+        heap[i] = last;
+    }
+    return top;
+}
+
+static void schedule_simple(uint64_t time_ns, SimEventType type, int node_index, int fd, int link) {
+    SimEvent ev = {time_ns, 0, type, node_index, fd, link, 0, NULL};
+    schedule(ev);
+}
+
+/* ----- Ligações e transporte em memória ----- */
+
+static int alloc_fd(int index) {
+    for (int fd = SIM_FIRST_FD; fd < SIM_MAX_FDS; fd++) {
+        if (nodes[index].fd_link[fd] < 0) {
+            return fd;
+        }
+    }
+    return -1;
+}
+
+static int new_link(int a, int fd_a, int b, int fd_b) {
+    if (link_count == link_capacity) {
+        link_capacity = link_capacity ? link_capacity * 2 : 1024;
+        links = realloc(links, (size_t)link_capacity * sizeof(SimLink));
+        if (links == NULL) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    SimLink *l = &links[link_count];
+    memset(l, 0, sizeof(*l));
+    l->end_node[0] = a;
+    l->end_fd[0] = fd_a;
+    l->end_node[1] = b;
+    l->end_fd[1] = fd_b;
+    l->open[0] = l->open[1] = 1;
+    nodes[a].fd_link[fd_a] = link_count;
+    nodes[b].fd_link[fd_b] = link_count;
+    return link_count++;
+}
+
+/**
+ * @brief Fecha um extremo de uma ligação e avisa o outro extremo.
+ */
+static void close_end(int link, int side) {
+    SimLink *l = &links[link];
+    if (!l->open[side]) {
+        return;
+    }
+    l->open[side] = 0;
+    nodes[l->end_node[side]].fd_link[l->end_fd[side]] = -1;
+    last_topology_ns = sim_now;
+    if (l->open[!side]) {
+        schedule_simple(sim_now + link_latency_ns, EV_CLOSE, l->end_node[!side], l->end_fd[!side], link);
+    }
+}
+
+static int sim_connect(const char *ip, const char *port) {
+    int target = ip_node(ip);
+    if (target < 0 || target == current || !nodes[target].alive || strcmp(port, SIM_PORT) != 0) {
+        errno = ECONNREFUSED;
+        return -1;
+    }
+    int fd = alloc_fd(current);
+    int peer_fd = alloc_fd(target);
+    if (fd < 0 || peer_fd < 0) {
+        errno = EMFILE;
+        return -1;
+    }
+    int link = new_link(current, fd, target, peer_fd);
+    last_topology_ns = sim_now;
+    schedule_simple(sim_now + link_latency_ns, EV_ACCEPT, target, peer_fd, link);
+    return fd;
+}
+
+static ssize_t sim_send(int fd, const char *message, size_t len) {
+    int link = fd >= 0 && fd < SIM_MAX_FDS ? nodes[current].fd_link[fd] : -1;
+    if (link < 0) {
+        errno = EBADF;
+        return -1;
+    }
+    SimLink *l = &links[link];
+    int side = l->end_node[0] == current ? 0 : 1;
+    if (!l->open[!side]) {
+        errno = EPIPE;
+        return -1;
+    }
+
+    l->messages[side]++;
+    l->bytes[side] += len;
+    messages_by_type[metrics_classify(message)]++;
+
+    SimEvent ev = {sim_now + link_latency_ns, 0, EV_DELIVER, l->end_node[!side], l->end_fd[!side], link, len, NULL};
+    ev.data = malloc(len);
+    if (ev.data == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(ev.data, message, len);
+    schedule(ev);
+    return (ssize_t)len;
+}
+
+static ssize_t sim_recv(int fd, char *buffer, size_t len) {
+    if (pending_read == NULL || pending_read->node != current || pending_read->fd != fd) {
+        errno = EAGAIN;
+        return -1;
+    }
+    const SimEvent *ev = pending_read;
+    pending_read = NULL;
+    if (ev->type == EV_CLOSE) {
+        return 0;
+    }
+    size_t n = ev->len < len ? ev->len : len;
+    memcpy(buffer, ev->data, n);
+    return (ssize_t)n;
+}
+
+static void sim_close(int fd) {
+    int link = fd >= 0 && fd < SIM_MAX_FDS ? nodes[current].fd_link[fd] : -1;
+    if (link >= 0) {
+        close_end(link, links[link].end_node[0] == current ? 0 : 1);
+    }
+}
+
+static const NodeTransport sim_transport = {sim_connect, sim_send, sim_recv, sim_close};
+
+/* ----- Tratamento dos eventos ----- */
+
+/**
+ * @brief Entrega uma mensagem ou um fecho ao nó, pelo ciclo de rede normal.
+ */
+static void deliver(const SimEvent *ev) {
+    switch_to(ev->node);
+    FD_ZERO(&node.read_fds);
+    FD_SET(ev->fd, &node.read_fds);
+    pending_read = ev;
+    handle_network_events();
+    pending_read = NULL;
+}
+
+/**
+ * @brief Falha abrupta de um nó: todas as suas ligações fecham.
+ */
+static void fail_node(int index) {
+    SimNode *target = &nodes[index];
+    target->alive = 0;
+    for (int fd = SIM_FIRST_FD; fd < SIM_MAX_FDS; fd++) {
+        int link = target->fd_link[fd];
+        if (link >= 0) {
+            close_end(link, links[link].end_node[0] == index ? 0 : 1);
+        }
+    }
+}
+
+static int neighbor_count(int index) {
+    int count = 0;
+    for (Neighbor *n = node_state(index)->neighbors; n != NULL; n = n->next) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Escolhe o nó a remover segundo o papel que tem na topologia atual.
+ *
+ * @return Índice do nó, ou -1 se nenhum nó vivo tiver esse papel
+ */
+static int pick_victim(const SimRemoval *r) {
+    if (r->pick == PICK_INDEX || r->pick == PICK_ROOT) {
+        int index = r->pick == PICK_ROOT ? 0 : r->index;
+        return index < node_count && nodes[index].alive && node_state(index)->in_network ? index : -1;
+    }
+    int victim = -1, seen = 0;
+    for (int i = 0; i < node_count; i++) {
+        if (!nodes[i].alive || !node_state(i)->in_network) {
+            continue;
+        }
+        int degree = neighbor_count(i);
+        if ((r->pick == PICK_LEAF && degree != 1) || (r->pick == PICK_INNER && (degree < 2 || i == 0))) {
+            continue;
+        }
+        /* Amostragem de reservatório: escolha uniforme numa só passagem */
+        if (next_random() % (uint64_t)++seen == 0) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+/**
+ * @brief Remove um nó planeado com -e, por falha abrupta ou com leave.
+ */
+static void remove_node(SimRemoval *r) {
+    r->victim = pick_victim(r);
+    if (r->victim < 0) {
+        return;
+    }
+    r->degree = neighbor_count(r->victim);
+    if (r->leave) {
+        switch_to(r->victim);
+        cmd_leave_no_UI();
+    }
+    /* Depois de leave só restam ligações ainda não aceites pelo nó */
+    fail_node(r->victim);
+}
+
+static int count_components(int *alive_count);
+
+/**
+ * @brief Guarda o estado no início da janela de medição k.
+ */
+static void mark_window(int k) {
+    int alive;
+    windows[k].start_ns = sim_now;
+    windows[k].topology_ns = last_topology_ns;
+    metrics_snapshot(&windows[k].metrics);
+    memcpy(windows[k].messages, messages_by_type, sizeof(messages_by_type));
+    windows[k].components = count_components(&alive);
+}
+
+static void handle_event(const SimEvent *ev) {
+    SimNode *target = &nodes[ev->node];
+    char ip[INET_ADDRSTRLEN];
+
+    switch (ev->type) {
+        case EV_DELIVER:
+            if (!target->alive || target->fd_link[ev->fd] != ev->link) {
+                break;
+            }
+            if (strncmp(ev->data, "ENTRY ", 6) == 0 || strncmp(ev->data, "SAFE ", 5) == 0) {
+                last_topology_ns = sim_now;
+            }
+            deliver(ev);
+            break;
+
+        case EV_CLOSE:
+            if (!target->alive || target->fd_link[ev->fd] != ev->link) {
+                break;
+            }
+            last_topology_ns = sim_now;
+            deliver(ev);
+            /* Ligação ainda não aceite pelo nó: fecha-a aqui */
+            if (target->fd_link[ev->fd] == ev->link) {
+                close_end(ev->link, links[ev->link].end_node[0] == ev->node ? 0 : 1);
+            }
+            break;
+
+        case EV_ACCEPT: {
+            SimLink *l = &links[ev->link];
+            if (!target->alive) {
+                close_end(ev->link, 1);
+                break;
+            }
+            if (target->fd_link[ev->fd] != ev->link) {
+                break;
+            }
+            last_topology_ns = sim_now;
+            switch_to(ev->node);
+            char port[6];   /* Porto efémero, substituído pelo da mensagem ENTRY */
+            snprintf(port, sizeof(port), "%d", 32768 + ev->link % 28000);
+            node_ip(l->end_node[0], ip);
+            add_neighbor(ip, port, ev->fd, 0);
+            break;
+        }
+
+        case EV_JOIN:
+            switch_to(ev->node);
+            if (ev->link < 0) {
+                cmd_direct_join("0.0.0.0", "0");
+            } else {
+                node_ip(ev->link, ip);
+                cmd_direct_join(ip, SIM_PORT);
+            }
+            break;
+
+        case EV_RETRIEVE:
+            if (target->alive) {
+                char name[MAX_OBJECT_NAME + 1];
+                snprintf(name, sizeof(name), "o%d", ev->link);
+                switch_to(ev->node);
+                cmd_retrieve(name, 0);
+            }
+            break;
+
+        case EV_FAIL:
+            fail_node(ev->node);
+            break;
+
+        case EV_REMOVE:
+            remove_node(&removals[ev->link]);
+            break;
+
+        case EV_MARK:
+            mark_window(ev->link);
+            break;
+
+        case EV_TICK:
+            for (int i = 0; i < node_count; i++) {
+                if (nodes[i].alive && node_state(i)->interest_table != NULL) {
+                    switch_to(i);
+                    check_interest_timeouts();
+                }
+            }
+            if (sim_now < (uint64_t)ev->link * SIM_TICK_NS) {
+                schedule_simple(sim_now + SIM_TICK_NS, EV_TICK, 0, 0, ev->link);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Processa eventos até a fila ficar vazia.
+ */
+static void run() {
+    while (heap_len > 0) {
+        SimEvent ev = pop_event();
+        sim_now = ev.time_ns;
+        handle_event(&ev);
+        free(ev.data);
+        events_processed++;
+    }
+}
+
+/* ----- Construção e relatório ----- */
+
+/**
+ * @brief Inicializa o estado de um nó sem sockets (em vez de initialize_node).
+ */
+static void init_node(int index) {
+    SimNode *n = &nodes[index];
+    memset(&n->state, 0, sizeof(Node));
+    node_ip(index, n->state.ip);
+    strcpy(n->state.port, SIM_PORT);
+    n->state.cache_size = cache_size;
+    n->alive = 1;
+    for (int fd = 0; fd < SIM_MAX_FDS; fd++) {
+        n->fd_link[fd] = -1;
+    }
+}
+
+/**
+ * @brief Escolhe o pai de cada nó e agenda as entradas na árvore.
+ */
+static void build_tree() {
+    int *open_parents = malloc((size_t)node_count * sizeof(int));   /* Nós com espaço para filhos */
+    int open_count = 0;
+    if (open_parents == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    schedule_simple(sim_now, EV_JOIN, 0, 0, -1);
+    open_parents[open_count++] = 0;
+    for (int i = 1; i < node_count; i++) {
+        int parent;
+        if (topology == TOPO_LINE) {
+            parent = i - 1;
+        } else if (topology == TOPO_KARY) {
+            parent = (i - 1) / fanout;
+        } else {
+            int pick = (int)(next_random() % (uint64_t)open_count);
+            parent = open_parents[pick];
+            if (++nodes[parent].children == fanout) {
+                open_parents[pick] = open_parents[--open_count];
+            }
+            open_parents[open_count++] = i;
+        }
+        schedule_simple(sim_now, EV_JOIN, i, 0, parent);
+    }
+    free(open_parents);
+}
+
+static int find_root(int *parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/**
+ * @brief Conta as componentes ligadas entre os nós vivos.
+ */
+static int count_components(int *alive_count) {
+    int *parent = malloc((size_t)node_count * sizeof(int));
+    if (parent == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < node_count; i++) {
+        parent[i] = i;
+    }
+    for (int l = 0; l < link_count; l++) {
+        if (links[l].open[0] && links[l].open[1]) {
+            parent[find_root(parent, links[l].end_node[0])] = find_root(parent, links[l].end_node[1]);
+        }
+    }
+    int components = 0;
+    *alive_count = 0;
+    for (int i = 0; i < node_count; i++) {
+        if (nodes[i].alive) {
+            (*alive_count)++;
+            components += find_root(parent, i) == i;
+        }
+    }
+    free(parent);
+    return components;
+}
+
+static unsigned long total_messages() {
+    unsigned long total = 0;
+    for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+        total += messages_by_type[t];
+    }
+    return total;
+}
+
+static void print_messages(const char *label) {
+    fprintf(out, "%-10s %lu messages:", label, total_messages());
+    for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+        if (messages_by_type[t] > 0) {
+            fprintf(out, " %s %lu", metrics_type_name(t), messages_by_type[t]);
+        }
+    }
+    fprintf(out, "\n");
+}
+
+static unsigned long link_load(int link) {
+    return links[link].messages[0] + links[link].messages[1];
+}
+
+/**
+ * @brief Mostra a carga das ligações: média, máximo e as mais carregadas.
+ */
+static void print_links() {
+    int top[SIM_TOP_LINKS];
+    int top_count = 0;
+    unsigned long long sum = 0;
+
+    for (int l = 0; l < link_count; l++) {
+        unsigned long total = links[l].messages[0] + links[l].messages[1];
+        sum += total;
+        int pos = top_count;
+        if (top_count < SIM_TOP_LINKS) {
+            top_count++;
+        } else if (total <= link_load(top[SIM_TOP_LINKS - 1])) {
+            continue;
+        } else {
+            pos = SIM_TOP_LINKS - 1;
+        }
+        while (pos > 0 && link_load(top[pos - 1]) < total) {
+            top[pos] = top[pos - 1];
+            pos--;
+        }
+        top[pos] = l;
+    }
+
+    fprintf(out, "Links      %d opened, %.1f messages per link on average\n",
+            link_count, link_count > 0 ? (double)sum / link_count : 0.0);
+    for (int i = 0; i < top_count; i++) {
+        SimLink *l = &links[top[i]];
+        char a[INET_ADDRSTRLEN], b[INET_ADDRSTRLEN];
+        node_ip(l->end_node[0], a);
+        node_ip(l->end_node[1], b);
+        fprintf(out, "  %-15s -> %-15s %9lu   %-15s -> %-15s %9lu%s\n", a, b, l->messages[0],
+                b, a, l->messages[1], (l->open[0] && l->open[1]) ? "" : "  (closed)");
+    }
+}
+
+static const char *pick_names[] = {"index", "root", "leaf", "inner", "random"};
+
+/**
+ * @brief Mostra, para cada janela de -e, o efeito da remoção face à janela de referência.
+ */
+static void print_removals() {
+    unsigned long base_messages = 0;
+    for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+        base_messages += windows[1].messages[t] - windows[0].messages[t];
+    }
+
+    fprintf(out, "Removals   one every %.1f s virtual; window 0 is the baseline without removals\n", window_s);
+    fprintf(out, "  %-6s %-6s %-15s %-6s %6s %13s %5s %9s %7s %9s %6s %6s %9s\n", "window", "action",
+            "node", "role", "degree", "reconverge ms", "comps", "retrieves", "failed", "messages",
+            "ENTRY", "SAFE", "overhead");
+    for (int k = 0; k <= removal_count; k++) {
+        const SimWindow *w = &windows[k], *next = &windows[k + 1];
+        unsigned long messages = 0;
+        for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+            messages += next->messages[t] - w->messages[t];
+        }
+        char ip[INET_ADDRSTRLEN] = "-", reconverge[16] = "-", degree[8] = "-";
+        const char *action = "-", *role = "-";
+        if (k > 0) {
+            const SimRemoval *r = &removals[k - 1];
+            action = r->leave ? "leave" : "kill";
+            role = pick_names[r->pick];
+            if (r->victim < 0) {
+                snprintf(ip, sizeof(ip), "no candidate");
+            } else {
+                node_ip(r->victim, ip);
+                snprintf(degree, sizeof(degree), "%d", r->degree);
+            }
+            if (next->topology_ns > w->start_ns) {
+                snprintf(reconverge, sizeof(reconverge), "%.3f", (next->topology_ns - w->start_ns) / 1e6);
+            }
+        }
+        fprintf(out, "  %-6d %-6s %-15s %-6s %6s %13s %5d %9lu %7lu %9lu %6lu %6lu %+9ld\n", k, action, ip,
+                role, degree, reconverge, next->components,
+                next->metrics.counters[MET_RETRIEVE_REQUESTS] - w->metrics.counters[MET_RETRIEVE_REQUESTS],
+                next->metrics.counters[MET_RETRIEVE_FAILED] - w->metrics.counters[MET_RETRIEVE_FAILED],
+                messages, next->messages[MSG_ENTRY] - w->messages[MSG_ENTRY],
+                next->messages[MSG_SAFE] - w->messages[MSG_SAFE], (long)messages - (long)base_messages);
+    }
+}
+
+/**
+ * @brief Lê a lista de remoções de -e: "<kill|leave>:<root|leaf|inner|random|índice>,...".
+ *
+ * @return 0 em caso de sucesso, -1 se a lista for inválida
+ */
+static int parse_removals(char *list) {
+    removal_count = 0;
+    for (char *tok = strtok(list, ","); tok != NULL; tok = strtok(NULL, ",")) {
+        char *target = strchr(tok, ':');
+        if (target == NULL || removal_count == SIM_MAX_REMOVALS) {
+            return -1;
+        }
+        *target++ = '\0';
+        SimRemoval *r = &removals[removal_count];
+        memset(r, 0, sizeof(*r));
+        r->victim = -1;
+        if (strcmp(tok, "kill") == 0) {
+            r->leave = 0;
+        } else if (strcmp(tok, "leave") == 0) {
+            r->leave = 1;
+        } else {
+            return -1;
+        }
+        if (strcmp(target, "root") == 0) {
+            r->pick = PICK_ROOT;
+        } else if (strcmp(target, "leaf") == 0) {
+            r->pick = PICK_LEAF;
+        } else if (strcmp(target, "inner") == 0) {
+            r->pick = PICK_INNER;
+        } else if (strcmp(target, "random") == 0) {
+            r->pick = PICK_RANDOM;
+        } else if (isdigit((unsigned char)target[0])) {
+            r->pick = PICK_INDEX;
+            r->index = atoi(target);
+        } else {
+            return -1;
+        }
+        removal_count++;
+    }
+    return removal_count > 0 ? 0 : -1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n  number of nodes (default 100)\n"
+            "  -t  tree shape: random, kary or line (default random)\n"
+            "  -b  children per node in random and kary trees, 1 to %d (default 3)\n"
+            "  -l  link latency in ms (default 1)\n"
+            "  -c  cache size of each node (default %d)\n"
+            "  -o  number of objects, placed on random nodes (default 1000)\n"
+            "  -r  number of retrieves from random nodes (default 10000)\n"
+            "  -q  retrieves per virtual second (default 1000)\n"
+            "  -a  Zipf exponent of object popularity, 0 for uniform (default 0.8)\n"
+            "  -D  request workload: uniform, zipf, shift, scan, segments, seq or trace:file=F,\n"
+            "      with options as in ndn-workload; its names set the objects (default zipf)\n"
+            "  -f  nodes that fail abruptly during the workload (default 0)\n"
+            "  -F  virtual second of the workload at which they fail (default: middle)\n"
+            "  -e  removals, one per window: kill|leave:root|leaf|inner|random|<node index>,...\n"
+            "      (the workload lasts a warm-up window, a baseline window and one window per\n"
+            "      removal; -r is ignored)\n"
+            "  -g  window length in virtual seconds for -e (default 15)\n"
+            "  -s  random seed\n"
+            "  -v  show the output of the nodes\n",
+            prog, SIM_MAX_CHILDREN, MAX_CACHE_SIZE);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:t:b:l:c:o:r:q:a:D:f:F:e:g:s:vh")) != -1) {
+        switch (opt) {
+            case 'n': node_count = atoi(optarg); break;
+            case 't':
+                if (strcmp(optarg, "random") == 0) {
+                    topology = TOPO_RANDOM;
+                } else if (strcmp(optarg, "kary") == 0) {
+                    topology = TOPO_KARY;
+                } else if (strcmp(optarg, "line") == 0) {
+                    topology = TOPO_LINE;
+                } else {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'b': fanout = atoi(optarg); break;
+            case 'l': link_latency_ns = (uint64_t)(atof(optarg) * 1e6); break;
+            case 'c': cache_size = atoi(optarg); break;
+            case 'o': object_count = atoi(optarg); break;
+            case 'r': request_count = atoi(optarg); break;
+            case 'q': request_rate = atof(optarg); break;
+            case 'a': zipf_alpha = atof(optarg); break;
+            case 'D': workload_spec = optarg; break;
+            case 'f': failure_count = atoi(optarg); break;
+            case 'F': failure_at_s = atof(optarg); break;
+            case 'e':
+                if (parse_removals(optarg) < 0) {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'g': window_s = atof(optarg); break;
+            case 's': rng_state ^= strtoull(optarg, NULL, 10) * 0x2545f4914f6cdd1dull; break;
+            case 'v': verbose = 1; break;
+            default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (optind != argc || node_count < 1 || node_count > 0xfffffe || fanout < 1 ||
+        fanout > SIM_MAX_CHILDREN || cache_size < 0 || object_count < 1 || request_count < 0 ||
+        request_rate <= 0 || zipf_alpha < 0 || failure_count < 0 || failure_count >= node_count ||
+        (removal_count > 0 && (failure_count > 0 || window_s <= 0))) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Os objetos são os nomes do gerador (num ficheiro, os nomes distintos) */
+    if (workload_init(&workload, workload_spec, (unsigned long)object_count, zipf_alpha) < 0) {
+        return EXIT_FAILURE;
+    }
+    if (workload.names > 0x7fffffff) {
+        fprintf(stderr, "Too many objects: %lu\n", workload.names);
+        return EXIT_FAILURE;
+    }
+    object_count = (int)workload.names;
+
+    nodes = calloc((size_t)node_count, sizeof(SimNode));
+    object_home = malloc((size_t)object_count * sizeof(int));
+    if (nodes == NULL || object_home == NULL) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+
+    /* O relatório vai para o stdout original; a saída dos nós só com -v */
+    out = fdopen(dup(STDOUT_FILENO), "w");
+    if (!verbose) {
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            dup2(devnull, STDOUT_FILENO);
+            close(devnull);
+        }
+    }
+    log_init();
+    current_log_level = verbose ? LOG_INFO : LOG_ERROR;
+    latency_set_clock(sim_clock);
+    node_transport = &sim_transport;
+
+    uint64_t wall_start = 0;
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        wall_start = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+
+    const char *shape = topology == TOPO_LINE ? "line" : topology == TOPO_KARY ? "k-ary" : "random";
+    fprintf(out, "ndn-sim: %d nodes, %s tree", node_count, shape);
+    if (topology != TOPO_LINE) {
+        fprintf(out, " (%d children per node)", fanout);
+    }
+    fprintf(out, ", link latency %.3f ms, cache %d\n", link_latency_ns / 1e6, cache_size);
+
+    /* Construção da árvore */
+    for (int i = 0; i < node_count; i++) {
+        init_node(i);
+    }
+    build_tree();
+    run();
+    fprintf(out, "Build      converged in %.3f ms virtual\n", (last_topology_ns - SIM_EPOCH_NS) / 1e6);
+    print_messages("");
+    memset(messages_by_type, 0, sizeof(messages_by_type));
+
+    /* Objetos em nós aleatórios */
+    for (int k = 0; k < object_count; k++) {
+        char name[MAX_OBJECT_NAME + 1];
+        snprintf(name, sizeof(name), "o%d", k);
+        object_home[k] = (int)(next_random() % (uint64_t)node_count);
+        switch_to(object_home[k]);
+        add_object(name);
+    }
+
+    /* Pedidos e falhas */
+    uint64_t workload_start = sim_now + SIM_TICK_NS;
+    if (removal_count > 0) {
+        /* Uma janela de aquecimento, a de referência e uma por remoção */
+        request_count = (int)(request_rate * window_s * (removal_count + 2));
+        for (int k = 0; k <= removal_count; k++) {
+            uint64_t t = workload_start + (uint64_t)((k + 1) * window_s * 1e9);
+            schedule_simple(t, EV_MARK, 0, 0, k);
+            if (k > 0) {
+                schedule_simple(t, EV_REMOVE, 0, 0, k - 1);
+            }
+        }
+    }
+    uint64_t interval = (uint64_t)(1e9 / request_rate);
+    for (int r = 0; r < request_count; r++) {
+        int object = (int)workload_next(&workload);
+        int requester = (int)(next_random() % (uint64_t)node_count);
+        schedule_simple(workload_start + (uint64_t)r * interval, EV_RETRIEVE, requester, 0, object);
+    }
+    uint64_t workload_end = workload_start + (uint64_t)request_count * interval;
+
+    uint64_t failure_ns = 0;
+    if (failure_count > 0) {
+        failure_ns = failure_at_s >= 0 ? workload_start + (uint64_t)(failure_at_s * 1e9)
+                                        : workload_start + (workload_end - workload_start) / 2;
+        for (int f = 0; f < failure_count; f++) {
+            int victim;
+            do {
+                victim = (int)(next_random() % (uint64_t)node_count);
+            } while (victim == 0 && node_count > 1);   /* Mantém a raiz para comparar execuções */
+            schedule_simple(failure_ns, EV_FAIL, victim, 0, 0);
+        }
+    }
+
+    /* Verificação de timeouts até todos os pedidos terem terminado */
+    uint64_t tick_end_s = (workload_end + (INTEREST_TIMEOUT + 2) * SIM_TICK_NS) / SIM_TICK_NS;
+    schedule_simple(workload_start, EV_TICK, 0, 0, (int)tick_end_s);
+
+    MetricsSnapshot before, after;
+    metrics_snapshot(&before);
+    latency_reset();
+    uint64_t topology_before = last_topology_ns;
+    run();
+    metrics_snapshot(&after);
+    if (removal_count > 0) {
+        mark_window(removal_count + 1);
+    }
+
+#define DELTA(id) (after.counters[(id)] - before.counters[(id)])
+    unsigned long remote = DELTA(MET_RETRIEVE_REQUESTS);
+    unsigned long hits = DELTA(MET_CACHE_HITS);
+    unsigned long misses = DELTA(MET_CACHE_MISSES);
+
+    char description[512];
+    workload_describe(&workload, description, sizeof(description));
+    fprintf(out, "Workload   %d retrieves, %s, %.0f per second over %.3f s virtual\n",
+            request_count, description, request_rate, (workload_end - workload_start) / 1e9);
+    fprintf(out, "Retrieves  %lu answered locally, %lu sent to the network: %lu ok, %lu failed\n",
+            request_count - remote, remote, DELTA(MET_RETRIEVE_OK), DELTA(MET_RETRIEVE_FAILED));
+    fprintf(out, "Caches     hit ratio %.1f%% (%lu hits, %lu misses), %lu evictions\n",
+            hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0, hits, misses,
+            DELTA(MET_CACHE_EVICTIONS));
+    fprintf(out, "PIT        %lu inserted, %lu aggregated, %lu expired, %lu no route\n",
+            DELTA(MET_PIT_INSERTS), DELTA(MET_PIT_AGGREGATED), DELTA(MET_PIT_EXPIRED), DELTA(MET_NO_ROUTE));
+#undef DELTA
+    print_messages("Workload");
+
+    int alive = 0;
+    int components = count_components(&alive);
+    if (failure_count > 0) {
+        fprintf(out, "Failures   %d node(s) at %.3f s, topology settled after %.3f ms virtual\n",
+                failure_count, (failure_ns - workload_start) / 1e9,
+                last_topology_ns > failure_ns && last_topology_ns > topology_before
+                    ? (last_topology_ns - failure_ns) / 1e6 : 0.0);
+    }
+    fprintf(out, "Topology   %d live node(s) in %d component(s)\n", alive, components);
+    if (removal_count > 0) {
+        print_removals();
+    }
+    print_links();
+
+    fprintf(out, "Retrieve latency (virtual):\n");
+    fflush(out);
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(fileno(out), STDOUT_FILENO);
+    latency_print_header();
+    latency_print_row("retrieve", &node_latency.retrieve);
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double wall = ((uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec - wall_start) / 1e9;
+    fprintf(out, "Simulated %lu events in %.3f s wall time (%.0f events/s)\n",
+            events_processed, wall, wall > 0 ? events_processed / wall : 0.0);
+    fclose(out);
+
+    log_shutdown();
+    return EXIT_SUCCESS;
+}
@@ -16,8 +16,9 @@ NDN_EXE="./ndn"
 NODE_IP="127.0.0.1"
 NODE_PORT="58001"
 CACHE_SIZE="10"
-REG_SERVER_IP="193.136.138.142"
-REG_SERVER_UDP="59000"
+# Para testar sem acesso ao servidor da UC: ./ndn-regserver & REG_IP=127.0.0.1 ./ndn_test.sh
+REG_SERVER_IP="${REG_IP:-193.136.138.142}"
+REG_SERVER_UDP="${REG_UDP:-59000}"
 TEJO_IP="tejo.tecnico.ulisboa.pt"
 TEJO_PORT="59011"
 ACCESS_CODE=""
@@ -0,0 +1,260 @@
+/**
+ * @file ndn_top.c
+ * @brief Monitor ao vivo das métricas de nós NDN locais (ndn-top)
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a ferramenta ndn-top, que mapeia em modo de
+ * leitura os segmentos "/ndn-<porto>" publicados pelos nós e mostra, a
+ * cada intervalo, as taxas por segundo de mensagens, a profundidade da
+ * tabela de interesses e a taxa de acertos da cache. Não comunica com os
+ * nós, pelo que não tem impacto no seu ciclo principal.
+ *
+ * Utilização: ndn-top [-i <ms>] [-n <iterações>] [porto ...]
+ * Sem portos, monitoriza todos os segmentos encontrados em /dev/shm.
+ */
+
+#include "stats_shm.h"
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TOP_MAX_NODES 64            /* Número máximo de nós monitorizados */
+#define TOP_DEFAULT_INTERVAL_MS 1000
+
+/**
+ * @brief Estado de um nó monitorizado.
+ */
+typedef struct top_node {
+    char port[8];                   /* Porto TCP (nome do segmento) */
+    const NdnStatsShm *shm;         /* Segmento mapeado, NULL se indisponível */
+    NdnStatsShm prev;               /* Amostra anterior */
+    NdnStatsShm cur;                /* Amostra atual */
+    int has_prev;                   /* 1 se já existe amostra anterior */
+} TopNode;
+
+static TopNode nodes[TOP_MAX_NODES];
+static int node_count = 0;
+
+/**
+ * @brief Mapeia o segmento de um nó em modo de leitura.
+ *
+ * @param port Porto TCP do nó
+ * @return Segmento mapeado, NULL se não existir ou for incompatível
+ */
+static const NdnStatsShm *attach(const char *port) {
+    char name[32];
+    snprintf(name, sizeof(name), "%s%.7s", NDN_SHM_PREFIX, port);
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(NdnStatsShm)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *mem = mmap(NULL, sizeof(NdnStatsShm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        return NULL;
+    }
+
+    const NdnStatsShm *shm = mem;
+    if (shm->magic != NDN_SHM_MAGIC || shm->version != NDN_SHM_VERSION) {
+        munmap(mem, sizeof(NdnStatsShm));
+        return NULL;
+    }
+    return shm;
+}
+
+/**
+ * @brief Acrescenta um nó à lista de nós monitorizados.
+ *
+ * @param port Porto TCP do nó
+ */
+static void add_node(const char *port) {
+    for (int i = 0; i < node_count; i++) {
+        if (strcmp(nodes[i].port, port) == 0) {
+            return;
+        }
+    }
+    if (node_count >= TOP_MAX_NODES) {
+        return;
+    }
+    TopNode *n = &nodes[node_count++];
+    memset(n, 0, sizeof(*n));
+    strncpy(n->port, port, sizeof(n->port) - 1);
+}
+
+/**
+ * @brief Procura segmentos de nós em /dev/shm.
+ */
+static void discover_nodes() {
+    DIR *dir = opendir("/dev/shm");
+    if (dir == NULL) {
+        return;
+    }
+
+    struct dirent *ent;
+    size_t prefix_len = strlen(NDN_SHM_PREFIX) - 1;  /* Sem a barra inicial */
+    while ((ent = readdir(dir)) != NULL) {
+        if (strncmp(ent->d_name, NDN_SHM_PREFIX + 1, prefix_len) == 0) {
+            add_node(ent->d_name + prefix_len);
+        }
+    }
+    closedir(dir);
+}
+
+/**
+ * @brief Soma um array por interface e tipo para um conjunto de tipos.
+ */
+static uint64_t sum_faces(const uint64_t values[NDN_SHM_MAX_FACES][NDN_SHM_MAX_TYPES],
+                          const NdnStatsShm *s, int type) {
+    uint64_t total = 0;
+    for (uint32_t f = 0; f < s->face_slots; f++) {
+        if (type >= 0) {
+            total += values[f][type];
+        } else {
+            for (uint32_t t = 0; t < s->type_count; t++) {
+                total += values[f][t];
+            }
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Calcula uma taxa por segundo entre duas amostras.
+ */
+static double rate(uint64_t cur, uint64_t prev, double seconds) {
+    return seconds > 0 && cur >= prev ? (cur - prev) / seconds : 0.0;
+}
+
+/**
+ * @brief Imprime uma linha com o estado de um nó.
+ */
+static void print_node(TopNode *n) {
+    const NdnStatsShm *c = &n->cur;
+    const char *state = (kill(c->pid, 0) == 0 || errno == EPERM) ? "" : " (dead)";
+    char net[8] = "-";
+    char cache[16];
+
+    if (c->in_network) {
+        snprintf(net, sizeof(net), "%03d", c->network_id);
+    }
+    snprintf(cache, sizeof(cache), "%d/%d", c->cache_entries, c->cache_capacity);
+
+    printf("%-6s %7d %4s %3d %5d %11s", n->port, c->pid, net, c->neighbors, c->pit_entries, cache);
+
+    if (!n->has_prev) {
+        printf(" %6s %8s %8s %8s %8s %8s %8s %6s%s\n", "-", "-", "-", "-", "-", "-", "-", "-", state);
+        return;
+    }
+
+    const NdnStatsShm *p = &n->prev;
+    double secs = (double)(c->published_ns - p->published_ns) / 1e9;
+
+    uint64_t hits = (c->counters[MET_CACHE_HITS] + c->counters[MET_LOCAL_HITS])
+                  - (p->counters[MET_CACHE_HITS] + p->counters[MET_LOCAL_HITS]);
+    uint64_t misses = c->counters[MET_CACHE_MISSES] - p->counters[MET_CACHE_MISSES];
+
+    if (hits + misses > 0) {
+        printf(" %5.1f%%", 100.0 * hits / (hits + misses));
+    } else {
+        printf(" %6s", "-");
+    }
+
+    printf(" %8.0f %8.0f %8.0f %8.0f %8.0f %8.0f %6.0f%s\n",
+           rate(sum_faces(c->packets_in, c, -1), sum_faces(p->packets_in, p, -1), secs),
+           rate(sum_faces(c->packets_out, c, -1), sum_faces(p->packets_out, p, -1), secs),
+           rate(sum_faces(c->packets_in, c, MSG_INTEREST), sum_faces(p->packets_in, p, MSG_INTEREST), secs),
+           rate(sum_faces(c->packets_in, c, MSG_OBJECT), sum_faces(p->packets_in, p, MSG_OBJECT), secs),
+           rate(sum_faces(c->packets_out, c, MSG_NOOBJECT), sum_faces(p->packets_out, p, MSG_NOOBJECT), secs),
+           rate(sum_faces(c->bytes_in, c, -1) + sum_faces(c->bytes_out, c, -1),
+                sum_faces(p->bytes_in, p, -1) + sum_faces(p->bytes_out, p, -1), secs),
+           rate(c->counters[MET_PIT_EXPIRED], p->counters[MET_PIT_EXPIRED], secs),
+           state);
+}
+
+/**
+ * @brief Mostra a forma de utilização.
+ */
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-i <interval ms>] [-n <iterations>] [port ...]\n", prog);
+    fprintf(stderr, "Without ports, monitors every node segment found in /dev/shm.\n");
+}
+
+int main(int argc, char *argv[]) {
+    int interval_ms = TOP_DEFAULT_INTERVAL_MS;
+    int iterations = 0;  /* 0 = sem limite */
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:n:h")) != -1) {
+        switch (opt) {
+            case 'i': interval_ms = atoi(optarg); break;
+            case 'n': iterations = atoi(optarg); break;
+            default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (interval_ms <= 0) {
+        interval_ms = TOP_DEFAULT_INTERVAL_MS;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        add_node(argv[i]);
+    }
+    int discover = (node_count == 0);
+
+    int interactive = isatty(STDOUT_FILENO);
+    for (int iter = 0; iterations == 0 || iter < iterations; iter++) {
+        if (discover) {
+            discover_nodes();
+        }
+
+        if (interactive) {
+            printf("\x1B[H\x1B[2J");
+        }
+
+        time_t now = time(NULL);
+        char when[16];
+        strftime(when, sizeof(when), "%H:%M:%S", localtime(&now));
+        printf("%sndn-top%s  %d node(s), interval %d ms  %s\n\n", COLOR_BOLD, COLOR_RESET,
+               node_count, interval_ms, when);
+        printf("%s%-6s %7s %4s %3s %5s %11s %6s %8s %8s %8s %8s %8s %8s %6s%s\n", COLOR_BOLD,
+               "PORT", "PID", "NET", "NBR", "PIT", "CACHE", "HIT%", "RX/s", "TX/s",
+               "INT/s", "OBJ/s", "NOOBJ/s", "BYTES/s", "EXP/s", COLOR_RESET);
+
+        for (int i = 0; i < node_count; i++) {
+            TopNode *n = &nodes[i];
+            if (n->shm == NULL) {
+                n->shm = attach(n->port);
+                n->has_prev = 0;
+            }
+            if (n->shm == NULL || stats_shm_read(n->shm, &n->cur) != 0) {
+                printf("%-6s %s(not available)%s\n", n->port, COLOR_YELLOW, COLOR_RESET);
+                continue;
+            }
+            print_node(n);
+            n->prev = n->cur;
+            n->has_prev = 1;
+
+            /* Um nó terminado pode ser reiniciado no mesmo porto com um novo segmento */
+            if (kill(n->cur.pid, 0) == -1 && errno == ESRCH) {
+                munmap((void *)n->shm, sizeof(NdnStatsShm));
+                n->shm = NULL;
+            }
+        }
+        fflush(stdout);
+
+        if (iterations == 0 || iter + 1 < iterations) {
+            struct timespec ts = {interval_ms / 1000, (interval_ms % 1000) * 1000000L};
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file ndn_workload.c
+ * @brief Gerador de sequências de pedidos e simulação da cache (ndn-workload)
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a ferramenta ndn-workload, que escreve no stdout a
+ * sequência de nomes de um gerador de workload.c, um nome por linha. O
+ * ficheiro resultante pode ser dado de novo ao ndn-loadgen e ao ndn-sim
+ * com "trace:file=<ficheiro>", para as duas ferramentas receberem
+ * exatamente os mesmos pedidos.
+ *
+ * Com -S mostra, em vez da sequência, um resumo (nomes distintos, nomes
+ * pedidos uma só vez, concentração nos mais populares) e, com -C, a taxa
+ * de acertos da cache do nó (add_to_cache e find_in_cache de objects.c)
+ * para cada tamanho indicado, como se todos os pedidos chegassem a um nó
+ * sem os objetos.
+ *
+ * Utilização:
+ *   ndn-workload [-c <pedidos>] [-x <prefixo>] [-n <nomes>] [-a <alfa>] [-i]
+ *                [-S] [-C <t1,t2,...>] <descrição>
+ */
+
+#include "workload.h"
+#include "objects.h"
+#include "debug_utils.h"
+
+#define WL_MAX_CACHE_SIZES 16
+
+/* Configuração */
+static unsigned long request_count = 0;     /* 0 = 10000, ou o tamanho do ficheiro em trace */
+static const char *prefix = "obj";
+static unsigned long default_names = 1000;
+static double default_alpha = 1.0;
+static int ids_only = 0;
+static int summary = 0;
+static int cache_sizes[WL_MAX_CACHE_SIZES];
+static int cache_size_count = 0;
+
+static int compare_desc(const void *a, const void *b) {
+    unsigned long x = *(const unsigned long *)a, y = *(const unsigned long *)b;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+/**
+ * @brief Esvazia a cache do nó.
+ */
+static void clear_cache() {
+    while (node.cache != NULL) {
+        Object *next = node.cache->next;
+        free(node.cache);
+        node.cache = next;
+    }
+    node.current_cache_size = 0;
+}
+
+/**
+ * @brief Mostra o resumo da sequência e a taxa de acertos da cache do nó.
+ */
+static int print_summary(Workload *wl) {
+    unsigned long *counts = calloc(wl->names, sizeof(unsigned long));
+    if (counts == NULL) {
+        perror("calloc");
+        return -1;
+    }
+    workload_rewind(wl);
+    for (unsigned long r = 0; r < request_count; r++) {
+        counts[workload_next(wl)]++;
+    }
+
+    unsigned long distinct = 0, once = 0;
+    for (unsigned long k = 0; k < wl->names; k++) {
+        distinct += counts[k] > 0;
+        once += counts[k] == 1;
+    }
+    qsort(counts, wl->names, sizeof(unsigned long), compare_desc);
+    unsigned long top1 = 0, top10 = 0;
+    for (unsigned long k = 0; k < wl->names; k++) {
+        if (k < (wl->names + 99) / 100) {
+            top1 += counts[k];
+        }
+        if (k < (wl->names + 9) / 10) {
+            top10 += counts[k];
+        }
+    }
+    free(counts);
+
+    char description[512];
+    workload_describe(wl, description, sizeof(description));
+    printf("workload  %s, %lu requests\n", description, request_count);
+    printf("distinct  %lu names requested, %lu only once (%.1f%%)\n",
+           distinct, once, distinct ? 100.0 * once / distinct : 0.0);
+    printf("popular   top 1%% of names get %.1f%% of requests, top 10%% get %.1f%%\n",
+           100.0 * top1 / request_count, 100.0 * top10 / request_count);
+
+    if (cache_size_count == 0) {
+        return 0;
+    }
+    printf("node cache (objects.c, oldest evicted first):\n%10s %12s %10s\n",
+           "size", "hits", "hit ratio");
+    for (int i = 0; i < cache_size_count; i++) {
+        unsigned long hits = 0;
+        char name[MAX_OBJECT_NAME + 1];
+        clear_cache();
+        node.cache_size = cache_sizes[i];
+        workload_rewind(wl);
+        for (unsigned long r = 0; r < request_count; r++) {
+            snprintf(name, sizeof(name), "%s%lu", prefix, workload_next(wl));
+            if (find_in_cache(name) == 0) {
+                hits++;
+            } else {
+                add_to_cache(name);
+            }
+        }
+        printf("%10d %12lu %9.2f%%\n", cache_sizes[i], hits, 100.0 * hits / request_count);
+    }
+    clear_cache();
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] <workload>\n"
+            "  -c  number of requests (default 10000, or the file length for trace)\n"
+            "  -x  name prefix (default \"obj\")\n"
+            "  -n  number of names if the workload has no n= (default 1000)\n"
+            "  -a  Zipf exponent if the workload has no a= (default 1.0)\n"
+            "  -i  print name numbers instead of names\n"
+            "  -S  print a summary instead of the sequence\n"
+            "  -C  with -S, node cache sizes to simulate (comma separated)\n"
+            "workloads:\n"
+            "  uniform:n=N  zipf:n=N,a=A  shift:n=N,a=A,every=R,by=B  scan:n=N,a=A,p=P,len=L\n"
+            "  segments:n=N,a=A,len=L  seq:n=N  trace:file=F   (all accept s=<seed>)\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "c:x:n:a:iSC:h")) != -1) {
+        switch (opt) {
+            case 'c': request_count = strtoul(optarg, NULL, 10); break;
+            case 'x': prefix = optarg; break;
+            case 'n': default_names = strtoul(optarg, NULL, 10); break;
+            case 'a': default_alpha = atof(optarg); break;
+            case 'i': ids_only = 1; break;
+            case 'S': summary = 1; break;
+            case 'C': {
+                char *list = strdup(optarg);
+                for (char *tok = strtok(list, ","); tok != NULL && cache_size_count < WL_MAX_CACHE_SIZES;
+                     tok = strtok(NULL, ",")) {
+                    if (atoi(tok) > 0) {
+                        cache_sizes[cache_size_count++] = atoi(tok);
+                    }
+                }
+                free(list);
+                summary = 1;
+                break;
+            }
+            default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (argc - optind != 1 || strlen(prefix) > MAX_OBJECT_NAME - 20) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Workload wl;
+    if (workload_init(&wl, argv[optind], default_names, default_alpha) < 0) {
+        return EXIT_FAILURE;
+    }
+    if (request_count == 0) {
+        request_count = wl.kind == WL_TRACE ? wl.trace_len : 10000;
+    }
+
+    int rc = EXIT_SUCCESS;
+    if (summary) {
+        /* A cache do nó sem sockets; os registos ficam só para erros */
+        log_init();
+        current_log_level = LOG_ERROR;
+        memset(&node, 0, sizeof(node));
+        if (print_summary(&wl) < 0) {
+            rc = EXIT_FAILURE;
+        }
+    } else {
+        for (unsigned long r = 0; r < request_count; r++) {
+            unsigned long id = workload_next(&wl);
+            if (ids_only) {
+                printf("%lu\n", id);
+            } else {
+                printf("%s%lu\n", prefix, id);
+            }
+        }
+    }
+    workload_free(&wl);
+    return rc;
+}
@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+"""Mede o comportamento dos nós sobre ligações degradadas pelo ndn-netem.
+
+Lança nós ndn locais, coloca relés ndn-netem entre eles (ou entre o
+ndn-loadgen e o nó) e mostra uma tabela por cenário:
+
+- latency:   atraso e variação em todas as ligações do ndn-loadgen; débito
+             e percentis da latência de OBJECT
+- loss:      perda de mensagens; pedidos sem resposta no ndn-loadgen e, com
+             --node-timeouts, entradas da tabela de interesses do nó que
+             expiram (ndn_pit_expired_total, após INTEREST_TIMEOUT)
+- bandwidth: limite de débito; latência com a fila de serialização
+- stall:     paragens da ligação sem a fechar; o nó não deteta a falha
+- recovery:  A <- B (direto) e A <- C (pelo relé); o relé quebra a ligação
+             C-A (SIGUSR1) e mede-se o tempo até C se ligar ao nó de
+             salvaguarda B (remove_neighbor) e voltar a obter um objeto de B
+
+Os contadores dos nós são lidos do porto de métricas ("stats listen").
+O nó só encaminha interesses por inundação, por isso não há estratégias
+de encaminhamento alternativas a comparar.
+
+Uso:
+    ./netem_scenarios.py                        (todos os cenários)
+    ./netem_scenarios.py --scenario recovery --repeat 10
+    ./netem_scenarios.py --scenario loss --node-timeouts
+"""
+
+import argparse
+import json
+import os
+import re
+import signal
+import statistics
+import subprocess
+import sys
+import time
+import urllib.request
+
+INTEREST_TIMEOUT = 10       # ndn.h
+METRIC_RE = re.compile(r"^(\w+) (\S+)$")
+
+
+class Node:
+    """Um nó ndn local controlado pelo stdin."""
+
+    def __init__(self, args, port, metrics_port=None):
+        self.port = port
+        self.metrics_port = metrics_port
+        self.proc = subprocess.Popen(
+            [os.path.join(args.bin_dir, "ndn"), "100", "127.0.0.1", str(port), "127.0.0.1", "59999"],
+            stdin=subprocess.PIPE, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, text=True)
+        if metrics_port is not None:
+            self.cmd("stats listen %d" % metrics_port)
+
+    def cmd(self, line, wait=0.2):
+        self.proc.stdin.write(line + "\n")
+        self.proc.stdin.flush()
+        time.sleep(wait)
+
+    def metrics(self):
+        url = "http://127.0.0.1:%d/metrics" % self.metrics_port
+        text = urllib.request.urlopen(url, timeout=5).read().decode()
+        values = {}
+        for line in text.splitlines():
+            m = METRIC_RE.match(line)
+            if m:
+                values[m.group(1)] = float(m.group(2))
+        return values
+
+    def stop(self):
+        # Sem "exit": o nó tentaria anular o registo num servidor que não existe
+        self.proc.kill()
+        self.proc.wait()
+
+
+class Relay:
+    def __init__(self, args, listen_port, target_port, options):
+        self.proc = subprocess.Popen(
+            [os.path.join(args.bin_dir, "ndn-netem"), "-q", "-r", str(args.seed)] + options +
+            [str(listen_port), "127.0.0.1", str(target_port)],
+            stdout=subprocess.DEVNULL)
+        time.sleep(0.2)
+
+    def break_links(self):
+        self.proc.send_signal(signal.SIGUSR1)
+
+    def stop(self):
+        self.proc.terminate()
+        self.proc.wait()
+
+
+def loadgen(args, port, extra=()):
+    cmd = [os.path.join(args.bin_dir, "ndn-loadgen"), "-j", "-f", "3", "-c", "8",
+           "-d", str(args.duration), "-T", "1500"] + list(extra) + ["127.0.0.1", str(port)]
+    r = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True,
+                       timeout=args.duration + 60)
+    return json.loads(r.stdout)
+
+
+def ms(ns):
+    return "%.1f" % (ns / 1e6)
+
+
+def run_loadgen_sweep(args, title, variants, node_timeouts=False):
+    """Corre o ndn-loadgen através do relé para cada conjunto de opções do ndn-netem."""
+    print("== %s" % title)
+    header = "%-28s %10s %8s %9s %9s %9s" % ("netem options", "int/s", "timeout", "p50 ms", "p99 ms", "max ms")
+    if node_timeouts:
+        header += " %11s" % "pit expired"
+    print(header)
+    for options in variants:
+        node = Node(args, args.base_port, args.base_port + 20)
+        node.cmd("dj 0.0.0.0 0")
+        relay = Relay(args, args.base_port + 10, args.base_port, options)
+        try:
+            res = loadgen(args, args.base_port + 10)
+            lat = res["object_latency_ns"]
+            line = "%-28s %10.1f %8d %9s %9s %9s" % (" ".join(options) or "(none)", res["throughput"],
+                                                     res["timeout"], ms(lat["p50"]), ms(lat["p99"]),
+                                                     ms(lat["max"]))
+            if node_timeouts:
+                time.sleep(INTEREST_TIMEOUT + 1)
+                line += " %11d" % node.metrics().get("ndn_pit_expired_total", 0)
+            print(line)
+            sys.stdout.flush()
+        finally:
+            relay.stop()
+            node.stop()
+    print()
+
+
+def wait_for(predicate, timeout):
+    """Espera até predicate() ser verdadeiro; devolve o tempo em ms ou None."""
+    start = time.monotonic()
+    while time.monotonic() - start < timeout:
+        if predicate():
+            return (time.monotonic() - start) * 1000.0
+        time.sleep(0.005)
+    return None
+
+
+def run_recovery(args):
+    print("== recovery: C loses its external neighbor A (relay broken), reconnects to safe node B")
+    print("%-4s %14s %16s" % ("run", "reconnect ms", "retrieve ok ms"))
+    reconnect, retrieve = [], []
+    port_a, port_b, port_c = args.base_port, args.base_port + 1, args.base_port + 2
+    for run in range(args.repeat):
+        a = Node(args, port_a)
+        b = Node(args, port_b)
+        c = Node(args, port_c, args.base_port + 20)
+        relay = Relay(args, args.base_port + 10, port_a, [])
+        try:
+            a.cmd("dj 0.0.0.0 0")
+            b.cmd("dj 127.0.0.1 %d" % port_a)
+            c.cmd("dj 127.0.0.1 %d" % (args.base_port + 10))
+            b.cmd("c before-break")
+            b.cmd("c after-break")
+            c.cmd("r before-break", wait=0.5)
+            before = c.metrics()
+            if before.get("ndn_retrieve_ok_total", 0) < 1:
+                print("%-4d setup failed: C could not retrieve the object before the break" % run)
+                continue
+
+            relay.break_links()
+            up = before.get("ndn_topology_neighbor_up_total", 0)
+            t_reconnect = wait_for(lambda: c.metrics().get("ndn_topology_neighbor_up_total", 0) > up, 5)
+
+            ok = before.get("ndn_retrieve_ok_total", 0)
+            # Um objeto diferente: o primeiro já está na cache de C
+            c.cmd("r after-break", wait=0)
+            t_retrieve = wait_for(lambda: c.metrics().get("ndn_retrieve_ok_total", 0) > ok, 5)
+            if t_reconnect is not None and t_retrieve is not None:
+                t_retrieve += t_reconnect
+                reconnect.append(t_reconnect)
+                retrieve.append(t_retrieve)
+            print("%-4d %14s %16s" % (run, "%.1f" % t_reconnect if t_reconnect is not None else "none",
+                                      "%.1f" % t_retrieve if t_retrieve is not None else "none"))
+        finally:
+            relay.stop()
+            for node in (a, b, c):
+                node.stop()
+    if reconnect:
+        print("median reconnect %.1f ms, median retrieve ok %.1f ms (%d/%d runs recovered)" %
+              (statistics.median(reconnect), statistics.median(retrieve), len(reconnect), args.repeat))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Node behaviour over links impaired by ndn-netem")
+    parser.add_argument("--scenario", choices=("all", "latency", "loss", "bandwidth", "stall", "recovery"),
+                        default="all", help="scenario to run (default: all)")
+    parser.add_argument("--duration", type=float, default=3, help="ndn-loadgen seconds per variant (default: 3)")
+    parser.add_argument("--repeat", type=int, default=5, help="recovery runs (default: 5)")
+    parser.add_argument("--node-timeouts", action="store_true",
+                        help="in the loss scenario, wait for the node's own interest timeouts")
+    parser.add_argument("--seed", type=int, default=1, help="ndn-netem random seed (default: 1)")
+    parser.add_argument("--base-port", type=int, default=58600, help="first TCP port used (default: 58600)")
+    parser.add_argument("--bin-dir", default=".", help="directory with the executables (default: .)")
+    args = parser.parse_args()
+
+    run = lambda name: args.scenario in ("all", name)
+    if run("latency"):
+        run_loadgen_sweep(args, "latency: delay and jitter on every loadgen link",
+                          [[], ["-d", "5", "-j", "1"], ["-d", "20", "-j", "5"], ["-d", "50", "-j", "10"]])
+    if run("loss"):
+        run_loadgen_sweep(args, "loss: dropped protocol lines",
+                          [[], ["-l", "0.01"], ["-l", "0.05"], ["-l", "0.1"]], args.node_timeouts)
+    if run("bandwidth"):
+        run_loadgen_sweep(args, "bandwidth: per-direction cap",
+                          [[], ["-B", "1000"], ["-B", "100"], ["-B", "20"]])
+    if run("stall"):
+        run_loadgen_sweep(args, "stall: link stops delivering without closing",
+                          [[], ["-s", "200", "-S", "1"], ["-s", "1000", "-S", "1"], ["-s", "2000", "-S", "2"]])
+    if run("recovery"):
+        run_recovery(args)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
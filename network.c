@@ -8,38 +8,118 @@
 #include "network.h"
 #include "objects.h"
 #include "debug_utils.h"
-#include "commands.h"  /* For cmd_show_interest_table() function */
+#include "commands.h"
+#include "events.h"
+#include "metrics.h"
+#include "latency.h"
+#include "capture.h"
+#include "trace.h"
+#include "probes.h"
+#include "cost.h"
+#include "listing.h"
+#include "wire.h"
+#include "caps.h"
+
+/* Transporte das ligações a vizinhos (NULL = sockets TCP) */
+const NodeTransport *node_transport = NULL;
+
+#define WIRE_DICT_RESYNC_NS 1000000000ULL   /* Intervalo mínimo entre pedidos DICT a um vizinho */
 
 /**
- * Enhanced display_interest_table_update with detailed information
+ * Define quantos slots da tabela de nomes se podem usar nas tramas enviadas
+ * a um vizinho. Se o número mudar, a tabela é esvaziada.
+ *
+ * @param n Vizinho
+ * @param slots Slots anunciados pelo vizinho (0 = nomes sempre completos)
  */
-void display_interest_table_update(const char* action, const char* name) {
-    // Determine color based on action type
-    const char* action_color = COLOR_MAGENTA;
-    if (strstr(action, "Not Found") || 
-        strstr(action, "Error") || 
-        strstr(action, "Failed") || 
-        strstr(action, "Removed") || 
-        strstr(action, "TIMEOUT") || 
-        strstr(action, "No Entry") ||
-        strstr(action, "All Paths Closed")) {
-        action_color = COLOR_RED;
-    } else if (strstr(action, "Found") || 
-               strstr(action, "OBJECT")) {
-        action_color = COLOR_GREEN;
-    } else if (strstr(action, "INTEREST")) {
-        action_color = COLOR_CYAN;
+static void wire_set_dict_slots(Neighbor *n, unsigned slots)
+{
+    if (slots > WIRE_DICT_SLOTS)
+    {
+        slots = WIRE_DICT_SLOTS;
     }
-    
-    printf("\n%s%s┌───────────────────────────────────────────────────┐%s\n", COLOR_BOLD, action_color, COLOR_RESET);
-    printf("%s%s│ INTEREST TABLE UPDATE: %-30s │%s\n", COLOR_BOLD, action_color, action, COLOR_RESET);
-    printf("%s%s└───────────────────────────────────────────────────┘%s\n", COLOR_BOLD, action_color, COLOR_RESET);
-    
-    if (name != NULL) {
-        printf("Object: %s%s%s\n\n", COLOR_CYAN, name, COLOR_RESET);
+    if (slots != n->caps.value[CAP_NAME_DICT] && n->dict_tx != NULL)
+    {
+        wire_dict_reset(n->dict_tx, slots);
+    }
+    n->caps.value[CAP_NAME_DICT] = slots;
+    if (slots > 0)
+    {
+        n->caps.bits |= CAP_BIT(CAP_NAME_DICT);
+    }
+    else
+    {
+        n->caps.bits &= ~CAP_BIT(CAP_NAME_DICT);
+    }
+}
+
+/**
+ * Regista as capacidades anunciadas por um vizinho numa mensagem ENTRY ou SAFE.
+ *
+ * @param n Vizinho que enviou a mensagem
+ * @param message Mensagem (terminada em '\0')
+ */
+static void apply_caps(Neighbor *n, const char *message)
+{
+    CapSet caps;
+    caps_parse(message, &caps);
+    unsigned slots = caps.value[CAP_NAME_DICT];
+    caps.value[CAP_NAME_DICT] = n->caps.value[CAP_NAME_DICT];
+    n->caps = caps;
+    wire_set_dict_slots(n, slots);
+
+    char offered[CAPS_OFFER_SIZE];
+    log_message(LOG_DEBUG, "Capabilities of %s:%s: %s", n->ip, n->port,
+                *caps_format(n->caps.bits, &n->caps, offered, sizeof(offered)) ? offered : "none");
+}
+
+/**
+ * Obtém uma tabela de nomes de um vizinho, alocando-a no primeiro uso.
+ *
+ * @param dict Campo dict_tx ou dict_rx do vizinho
+ * @param slots Slots que o emissor pode usar
+ * @return Tabela, ou NULL se não houver memória
+ */
+static WireDict *wire_dict_get(struct wire_dict **dict, unsigned slots)
+{
+    if (*dict == NULL)
+    {
+        *dict = cost_malloc(sizeof(WireDict));
+        if (*dict == NULL)
+        {
+            return NULL;
+        }
+        wire_dict_reset(*dict, slots);
+    }
+    return *dict;
+}
+
+/**
+ * Pede a um vizinho que recomece a tabela de nomes das tramas que envia,
+ * depois de uma trama referir um slot que não corresponde ao da tabela
+ * local (por exemplo porque o ndn-netem descartou a trama que o guardou).
+ * Os pedidos são limitados a um por WIRE_DICT_RESYNC_NS, para as tramas
+ * ainda em trânsito não gerarem um pedido cada.
+ *
+ * @param n Vizinho
+ */
+static void wire_dict_resync(Neighbor *n)
+{
+    uint64_t now = monotonic_ns();
+    if (n->dict_rx == NULL || (n->dict_resync_ns != 0 && now - n->dict_resync_ns < WIRE_DICT_RESYNC_NS))
+    {
+        return;
     }
-    cmd_show_interest_table();
+    n->dict_resync_ns = now;
+    wire_dict_reset(n->dict_rx, WIRE_DICT_SLOTS);
+
+    char message[32];
+    snprintf(message, sizeof(message), "%s %d\n", WIRE_DICT_RESET, WIRE_DICT_SLOTS);
+    log_message(LOG_WARN, "Name table out of sync with %s:%s, asking for a reset", n->ip, n->port);
+    METRIC_INC(MET_NAMES_RESYNC);
+    send_message(n->fd, message, strlen(message));
 }
+
 /**
  * Reinicia o interesse para um objeto, removendo a sua entrada.
  *
@@ -57,11 +137,11 @@ void reset_interest_for_object(char *name)
             /* Encontrou a entrada - verifica se já está a ser removida */
             if (entry->marked_for_removal)
             {
-                printf("WARNING: Interest entry for %s is already marked for removal\n", name);
+                log_message(LOG_WARN, "WARNING: Interest entry for %s is already marked for removal", name);
                 return;
             }
 
-            printf("INTEREST RESET: Removing interest entry for %s\n", name);
+            log_message(LOG_DEBUG, "INTEREST RESET: Removing interest entry for %s", name);
 
             /* Marca-a para que outras funções saibam que não a devem usar */
             entry->marked_for_removal = 1;
@@ -78,7 +158,10 @@ void reset_interest_for_object(char *name)
 
             InterestEntry *to_free = entry;
             entry = entry->next;
+            NDN_PROBE1(pit_remove, to_free->name);
+            listing_forget(to_free, entry);
             free(to_free);
+            node.interest_count--;
             return;
         }
 
@@ -86,7 +169,7 @@ void reset_interest_for_object(char *name)
         entry = entry->next;
     }
 
-    printf("INTEREST RESET: No entry found for %s\n", name);
+    log_message(LOG_DEBUG, "INTEREST RESET: No entry found for %s", name);
 }
 
 /**
@@ -112,8 +195,8 @@ int update_neighbor_info(int fd, char *ip, char *port)
             /* Atualiza o porto para o que foi especificado na mensagem ENTRY */
             if (strcmp(curr->port, port) != 0)
             {
-                printf("Updating neighbor port from %s to %s for connection fd %d\n",
-                       curr->port, port, fd);
+                log_message(LOG_DEBUG, "Updating neighbor port from %s to %s for connection fd %d",
+                            curr->port, port, fd);
                 strcpy(curr->port, port);
             }
 
@@ -138,13 +221,13 @@ int update_neighbor_info(int fd, char *ip, char *port)
             if (!already_internal)
             {
                 /* Adiciona à lista de vizinhos internos */
-                Neighbor *internal_copy = malloc(sizeof(Neighbor));
+                Neighbor *internal_copy = cost_malloc(sizeof(Neighbor));
                 if (internal_copy != NULL)
                 {
                     memcpy(internal_copy, curr, sizeof(Neighbor));
                     internal_copy->next = node.internal_neighbors;
                     node.internal_neighbors = internal_copy;
-                    printf("Added %s:%s as internal neighbor\n", ip, port);
+                    log_message(LOG_INFO, "Added %s:%s as internal neighbor", ip, port);
                 }
             }
 
@@ -156,7 +239,7 @@ int update_neighbor_info(int fd, char *ip, char *port)
 
     if (!found)
     {
-        printf("Error: Could not find neighbor with fd %d to update\n", fd);
+        log_message(LOG_ERROR, "Error: Could not find neighbor with fd %d to update", fd);
         return -1;
     }
 
@@ -177,9 +260,14 @@ void initialize_interest_entry(InterestEntry *entry, char *name)
     for (int i = 0; i < MAX_INTERFACE; i++)
     {
         entry->interface_states[i] = 0;
+        entry->waiting_since_ns[i] = 0;
     }
 
-    entry->timestamp = time(NULL);
+    entry->local_request_ns = 0;
+    entry->local_expires_ns = 0;
+    entry->trace_id = 0;
+    entry->timestamp = monotonic_seconds();
+    entry->expires_ns = monotonic_ns() + (uint64_t)INTEREST_TIMEOUT * 1000000000ull;
     entry->next = NULL;
 }
 
@@ -189,9 +277,10 @@ void initialize_interest_entry(InterestEntry *entry, char *name)
  */
 void update_and_propagate_safety_node()
 {
-    printf("SAFETY: Updating and propagating safety node information\n");
-    printf("SAFETY: Current external neighbor: %s:%s\n", node.ext_neighbor_ip, node.ext_neighbor_port);
-    printf("SAFETY: Current safety node: %s:%s\n", node.safe_node_ip, node.safe_node_port);
+    log_message(LOG_DEBUG, "SAFETY: Updating and propagating safety node information");
+    log_message(LOG_DEBUG, "SAFETY: Current external neighbor: %s:%s",
+                node.ext_neighbor_ip, node.ext_neighbor_port);
+    log_message(LOG_DEBUG, "SAFETY: Current safety node: %s:%s", node.safe_node_ip, node.safe_node_port);
 
     /* First, ensure all internal neighbors have updated safety information */
     int sent_count = 0;
@@ -201,33 +290,152 @@ void update_and_propagate_safety_node()
         /* REMOVED interface ID check to ensure ALL internal neighbors get the update */
         /* Create SAFE message with EXTERNAL NEIGHBOR as safety node for our internal neighbors */
         char safe_msg[MAX_BUFFER];
-        snprintf(safe_msg, MAX_BUFFER, "SAFE %s %s\n",
-                 node.ext_neighbor_ip, node.ext_neighbor_port);
+        snprintf(safe_msg, MAX_BUFFER, "SAFE %s %s%s\n",
+                 node.ext_neighbor_ip, node.ext_neighbor_port, caps_offer());
 
-        printf("SAFETY: Sending updated SAFE message to %s:%s (fd: %d, interface: %d): %s",
-               n->ip, n->port, n->fd, n->interface_id, safe_msg);
+        log_message(LOG_DEBUG, "SAFETY: Sending updated SAFE message to %s:%s (fd: %d, interface: %d): %s",
+                    n->ip, n->port, n->fd, n->interface_id, safe_msg);
 
         /* Send message and handle errors */
-        if (write(n->fd, safe_msg, strlen(safe_msg)) < 0)
+        if (send_message(n->fd, safe_msg, strlen(safe_msg)) < 0)
         {
             perror("write");
-            printf("SAFETY: Failed to send SAFE message to %s:%s (fd: %d, interface: %d)\n",
-                   n->ip, n->port, n->fd, n->interface_id);
+            log_message(LOG_ERROR, "SAFETY: Failed to send SAFE message to %s:%s (fd: %d, interface: %d)",
+                        n->ip, n->port, n->fd, n->interface_id);
             /* Continue with other neighbors even if one fails */
         }
         else
         {
-            printf("SAFETY: Successfully sent SAFE message to %s:%s (fd: %d, interface: %d)\n",
-                   n->ip, n->port, n->fd, n->interface_id);
+            log_message(LOG_DEBUG, "SAFETY: Successfully sent SAFE message to %s:%s (fd: %d, interface: %d)",
+                        n->ip, n->port, n->fd, n->interface_id);
             sent_count++;
         }
 
         n = n->next;
     }
 
-    printf("SAFETY: Finished propagating safety node information to %d internal neighbors\n", sent_count);
+    log_message(LOG_DEBUG, "SAFETY: Finished propagating safety node information to %d internal neighbors",
+                sent_count);
+}
+
+/**
+ * Obtém o tempo de vida de uma mensagem INTEREST de texto.
+ *
+ * @param message Mensagem (terminada em '\0')
+ * @return Tempo de vida em ms, ou 0 se a mensagem não tiver o campo lifetime
+ */
+static uint32_t lifetime_parse(const char *message)
+{
+    const char *field = strstr(message, " lifetime=");
+    if (field == NULL)
+    {
+        return 0;
+    }
+    unsigned long lifetime = strtoul(field + 10, NULL, 10);
+    return lifetime > UINT32_MAX ? UINT32_MAX : (uint32_t)lifetime;
 }
 
+/**
+ * Processa uma trama binária (wire.h) recebida de um vizinho.
+ *
+ * @param curr Vizinho que enviou a trama
+ * @param data Início da trama no buffer do vizinho
+ * @param len Bytes disponíveis a partir de data
+ * @return Bytes da trama, 0 se estiver incompleta, -1 se os dados não formarem uma trama
+ */
+static ssize_t receive_frame(Neighbor *curr, char *data, size_t len)
+{
+    ssize_t frame_len = wire_frame_size(data, len, MAX_BUFFER - 1);
+    if (frame_len <= 0 || (size_t)frame_len > len)
+    {
+        return frame_len < 0 ? -1 : 0;
+    }
+
+    capture_frame(curr->interface_id, CAPTURE_IN, data, (size_t)frame_len);
+    NDN_PROBE3(message_receive, curr->interface_id, data, frame_len);
+    uint64_t processing_start = monotonic_ns();
+    MsgType msg_type = MSG_UNKNOWN;
+    cost_message_begin();
+
+    static WireBatch batch;
+    WireFrame frame;
+    WireDict *dict = wire_dict_get(&curr->dict_rx, WIRE_DICT_SLOTS);
+    int is_batch = wire_is_batch((unsigned char)data[0]);
+    ssize_t rc = is_batch ? wire_decode_batch(data, (size_t)frame_len, MAX_BUFFER - 1, &batch, dict)
+                          : wire_decode(data, (size_t)frame_len, MAX_BUFFER - 1, &frame, dict);
+    if (!is_batch && rc > 0)
+    {
+        /* Uma trama simples é um lote de um nome */
+        batch.type = frame.type;
+        batch.trace_id = frame.trace_id;
+        batch.lifetime_ms = frame.lifetime_ms;
+        batch.count = 1;
+        if (frame.name_len > MAX_OBJECT_NAME)
+        {
+            rc = -1;
+        }
+        else
+        {
+            memcpy(batch.names[0], frame.name, frame.name_len);
+            batch.names[0][frame.name_len] = '\0';
+        }
+    }
+    for (size_t i = 0; rc > 0 && i < batch.count; i++)
+    {
+        if (strlen(batch.names[i]) > MAX_OBJECT_NAME)
+        {
+            rc = -1;
+        }
+    }
+
+    if (rc <= 0)
+    {
+        /* Tipo desconhecido ou valor inválido: o comprimento permite saltar a trama */
+        log_message(LOG_WARN, "Malformed binary frame (type 0x%02x, %zd bytes) from %s:%s",
+                    (unsigned char)data[0], frame_len, curr->ip, curr->port);
+        metrics_count_in(curr->interface_id, MSG_UNKNOWN, (size_t)frame_len);
+        METRIC_INC(MET_MALFORMED);
+        if (rc == WIRE_DICT_MISMATCH)
+        {
+            wire_dict_resync(curr);
+        }
+    }
+    else
+    {
+        log_message(LOG_TRACE, "Processing binary frame: %s %s (%zu name(s))",
+                    wire_type_name(batch.type), batch.names[0], batch.count);
+
+        msg_type = batch.type == WIRE_INTEREST ? MSG_INTEREST
+                 : batch.type == WIRE_OBJECT ? MSG_OBJECT : MSG_NOOBJECT;
+        metrics_count_in(curr->interface_id, msg_type, (size_t)frame_len);
+        if (is_batch)
+        {
+            METRIC_INC(MET_BATCH_FRAMES_IN);
+            metrics_add(&metrics_local()->counters[MET_BATCH_NAMES_IN], batch.count);
+        }
+        cost_message_parsed();
+
+        /* Cada nome tem a sua entrada na tabela de interesses, como numa trama simples */
+        for (size_t i = 0; i < batch.count; i++)
+        {
+            switch (batch.type)
+            {
+            case WIRE_INTEREST:
+                handle_interest_message(curr->fd, batch.names[i], batch.trace_id, batch.lifetime_ms);
+                break;
+            case WIRE_OBJECT:
+                handle_object_message(curr->fd, batch.names[i], batch.trace_id);
+                break;
+            default:
+                handle_noobject_message(curr->fd, batch.names[i], batch.trace_id);
+                break;
+            }
+        }
+    }
+    cost_message_end(msg_type);
+    latency_record(&node_latency.processing[msg_type], monotonic_ns() - processing_start);
+    return frame_len;
+}
 
 void handle_network_events()
 {
@@ -253,7 +461,7 @@ void handle_network_events()
             char client_port[6];
             snprintf(client_port, 6, "%d", ntohs(client_addr.sin_port));
 
-            printf("New connection from %s:%s\n", client_ip, client_port);
+            log_message(LOG_INFO, "New connection from %s:%s", client_ip, client_port);
 
             /* Armazena temporariamente esta ligação com o seu porto de origem
                até recebermos uma mensagem ENTRY com o porto de escuta real */
@@ -276,15 +484,29 @@ void handle_network_events()
 
         if (FD_ISSET(curr->fd, &node.read_fds))
         {
-            char buffer[MAX_BUFFER];
-            int bytes_received = read(curr->fd, buffer, MAX_BUFFER - 1);
+            /* Lê apenas o espaço livre: o resto fica no socket para a próxima leitura */
+            int space = MAX_BUFFER - 1 - curr->buffer_len;
+            if (space <= 0)
+            {
+                /* Um buffer cheio sem uma mensagem completa já não pode vir a ter uma */
+                log_message(LOG_WARN, "Message from %s:%s exceeds %d bytes, closing connection",
+                            curr->ip, curr->port, MAX_BUFFER - 1);
+                METRIC_INC(MET_MALFORMED);
+                remove_neighbor(curr->fd);
+                curr = next;
+                continue;
+            }
+            char *buffer = curr->buffer + curr->buffer_len;
+            int bytes_received = node_transport != NULL
+                                 ? (int)node_transport->recv(curr->fd, buffer, space)
+                                 : read(curr->fd, buffer, space);
 
             if (bytes_received <= 0)
             {
                 /* Ligação fechada ou erro */
                 if (bytes_received == 0)
                 {
-                    printf("Connection closed by %s:%s\n", curr->ip, curr->port);
+                    log_message(LOG_INFO, "Connection closed by %s:%s", curr->ip, curr->port);
                 }
                 else
                 {
@@ -296,66 +518,96 @@ void handle_network_events()
             }
             else
             {
-                /* Append new data to existing buffer */
-                if (curr->buffer_len + bytes_received < MAX_BUFFER) {
-                    memcpy(curr->buffer + curr->buffer_len, buffer, bytes_received);
-                    curr->buffer_len += bytes_received;
-                    curr->buffer[curr->buffer_len] = '\0';
-                } else {
-                    /* Buffer overflow scenario - discard oldest data */
-                    printf("Warning: Buffer overflow, discarding oldest data\n");
-                    int space_needed = (curr->buffer_len + bytes_received) - (MAX_BUFFER - 1);
-                    if (space_needed > 0 && space_needed < curr->buffer_len) {
-                        memmove(curr->buffer, curr->buffer + space_needed, curr->buffer_len - space_needed);
-                        curr->buffer_len -= space_needed;
-                        memcpy(curr->buffer + curr->buffer_len, buffer, bytes_received);
-                        curr->buffer_len += bytes_received;
-                    } else {
-                        /* If can't make enough space, just use new data */
-                        memcpy(curr->buffer, buffer, bytes_received);
-                        curr->buffer_len = bytes_received;
-                    }
-                    curr->buffer[curr->buffer_len] = '\0';
-                }
+                curr->buffer_len += bytes_received;
+                curr->buffer[curr->buffer_len] = '\0';
                 
-                printf("Received %d bytes from %s:%s, buffer now: %s\n", bytes_received, curr->ip, curr->port, curr->buffer);
+                log_message(LOG_TRACE, "Received %d bytes from %s:%s, buffer now: %s",
+                            bytes_received, curr->ip, curr->port, curr->buffer);
 
-                /* Process each complete message in the buffer */
+                /* Process each complete message in the buffer (text lines or binary frames).
+                   As respostas geradas por uma leitura seguem agrupadas por interface. */
                 char *message_start = curr->buffer;
                 char *message_end;
+                char *buffer_end = curr->buffer + curr->buffer_len;
+                int invalid_frame = 0;
+                send_batch_begin();
                 
-                while ((message_end = strchr(message_start, '\n')) != NULL) {
+                while (message_start < buffer_end) {
+                    if (wire_is_frame((unsigned char)*message_start)) {
+                        ssize_t frame_len = receive_frame(curr, message_start, buffer_end - message_start);
+                        if (frame_len < 0) {
+                            /* Sem forma de voltar a sincronizar: a ligação deixa de ser utilizável */
+                            log_message(LOG_WARN, "Invalid binary frame header from %s:%s, closing connection",
+                                        curr->ip, curr->port);
+                            METRIC_INC(MET_MALFORMED);
+                            invalid_frame = 1;
+                            break;
+                        }
+                        if (frame_len == 0) {
+                            break;
+                        }
+                        message_start += frame_len;
+                        continue;
+                    }
+                    if ((message_end = memchr(message_start, '\n', buffer_end - message_start)) == NULL) {
+                        break;
+                    }
+
                     /* Extract the current message */
+                    capture_frame(curr->interface_id, CAPTURE_IN, message_start, message_end - message_start + 1);
                     *message_end = '\0';  /* Temporarily replace newline with null */
+                    NDN_PROBE3(message_receive, curr->interface_id, message_start, message_end - message_start);
                     
                     /* Process this single message */
-                    printf("Processing message: %s\n", message_start);
+                    log_message(LOG_TRACE, "Processing message: %s", message_start);
+                    size_t message_len = message_end - message_start + 1;
+                    uint64_t processing_start = monotonic_ns();
+                    MsgType msg_type = MSG_UNKNOWN;
+                    cost_message_begin();
                     
                     /* Determine message type and process it */
                     if (strncmp(message_start, "INTEREST ", 9) == 0) {
                         char name[MAX_OBJECT_NAME + 1] = {0};
+                        metrics_count_in(curr->interface_id, MSG_INTEREST, message_len);
+                        msg_type = MSG_INTEREST;
                         if (sscanf(message_start, "INTEREST %100s", name) == 1) {
-                            handle_interest_message(curr->fd, name);
+                            uint64_t trace_id = trace_parse(message_start);
+                            uint32_t lifetime_ms = lifetime_parse(message_start);
+                            cost_message_parsed();
+                            handle_interest_message(curr->fd, name, trace_id, lifetime_ms);
                         }
                     }
                     else if (strncmp(message_start, "OBJECT ", 7) == 0) {
                         char name[MAX_OBJECT_NAME + 1] = {0};
+                        metrics_count_in(curr->interface_id, MSG_OBJECT, message_len);
+                        msg_type = MSG_OBJECT;
                         if (sscanf(message_start, "OBJECT %100s", name) == 1) {
-                            handle_object_message(curr->fd, name);
+                            uint64_t trace_id = trace_parse(message_start);
+                            cost_message_parsed();
+                            handle_object_message(curr->fd, name, trace_id);
                         }
                     }
                     else if (strncmp(message_start, "NOOBJECT ", 9) == 0) {
                         char name[MAX_OBJECT_NAME + 1] = {0};
+                        metrics_count_in(curr->interface_id, MSG_NOOBJECT, message_len);
+                        msg_type = MSG_NOOBJECT;
                         if (sscanf(message_start, "NOOBJECT %100s", name) == 1) {
-                            handle_noobject_message(curr->fd, name);
+                            uint64_t trace_id = trace_parse(message_start);
+                            cost_message_parsed();
+                            handle_noobject_message(curr->fd, name, trace_id);
                         }
                     }
                     else if (strncmp(message_start, "ENTRY ", 6) == 0) {
                         char sender_ip[INET_ADDRSTRLEN] = {0};
                         char sender_port[6] = {0};
+                        metrics_count_in(curr->interface_id, MSG_ENTRY, message_len);
+                        msg_type = MSG_ENTRY;
 
                         if (sscanf(message_start, "ENTRY %s %s", sender_ip, sender_port) == 2) {
-                            printf("Received ENTRY message from %s:%s\n", sender_ip, sender_port);
+                            cost_message_parsed();
+                            log_message(LOG_DEBUG, "Received ENTRY message from %s:%s",
+                                        sender_ip, sender_port);
+                            apply_caps(curr, message_start);
 
                             /* Update the neighbor info with correct listening port */
                             int port_updated = 0;
@@ -363,8 +615,8 @@ void handle_network_events()
                             for (Neighbor *n = node.neighbors; n != NULL; n = n->next) {
                                 if (n->fd == curr->fd) {
                                     if (strcmp(n->port, sender_port) != 0) {
-                                        printf("Updating neighbor port from %s to %s for fd %d\n",
-                                               n->port, sender_port, curr->fd);
+                                        log_message(LOG_DEBUG, "Updating neighbor port from %s to %s for fd %d",
+                                                    n->port, sender_port, curr->fd);
                                         strcpy(n->port, sender_port);
                                         port_updated = 1;
                                     }
@@ -393,9 +645,8 @@ void handle_network_events()
                                 while (internal != NULL) {
                                     if (strcmp(internal->ip, sender_ip) == 0) {
                                         /* Update the port */
-                                        printf("Updating internal neighbor from %s:%s to %s:%s\n", 
-                                               internal->ip, internal->port, 
-                                               sender_ip, sender_port);
+                                        log_message(LOG_DEBUG, "Updating internal neighbor from %s:%s to %s:%s",
+                                                    internal->ip, internal->port, sender_ip, sender_port);
                                         strcpy(internal->port, sender_port);
                                         updated_existing = 1;
                                         break;
@@ -405,7 +656,7 @@ void handle_network_events()
                                 
                                 /* If no existing entry found, add new one */
                                 if (!updated_existing) {
-                                    Neighbor *internal_copy = malloc(sizeof(Neighbor));
+                                    Neighbor *internal_copy = cost_malloc(sizeof(Neighbor));
                                     if (internal_copy != NULL) {
                                         strcpy(internal_copy->ip, sender_ip);
                                         strcpy(internal_copy->port, sender_port);
@@ -413,7 +664,8 @@ void handle_network_events()
                                         internal_copy->interface_id = curr->interface_id;
                                         internal_copy->next = node.internal_neighbors;
                                         node.internal_neighbors = internal_copy;
-                                        printf("Added %s:%s as internal neighbor\n", sender_ip, sender_port);
+                                        log_message(LOG_INFO, "Added %s:%s as internal neighbor",
+                                                    sender_ip, sender_port);
                                     }
                                 }
                             }
@@ -421,26 +673,27 @@ void handle_network_events()
                             /* If we don't have an external neighbor yet, set this node as our external neighbor */
                             int need_to_send_entry = 0;
                             if (strlen(node.ext_neighbor_ip) == 0) {
-                                printf("Setting external neighbor to %s:%s\n", sender_ip, sender_port);
+                                log_message(LOG_INFO, "Setting external neighbor to %s:%s",
+                                            sender_ip, sender_port);
                                 strcpy(node.ext_neighbor_ip, sender_ip);
                                 strcpy(node.ext_neighbor_port, sender_port);
                                 
                                 /* Only send an ENTRY back if we don't have an external neighbor */
                                 /* (special case for the first two nodes in network) */
                                 need_to_send_entry = 1;
-                                printf("First/second node special case: Will send ENTRY response\n");
+                                log_message(LOG_DEBUG, "First/second node special case: Will send ENTRY response");
                             } else {
-                                printf("Already have external neighbor, not sending ENTRY response\n");
+                                log_message(LOG_DEBUG, "Already have external neighbor, not sending ENTRY response");
                             }
 
                             /* Only send ENTRY if this is a special case (first two nodes) */
                             if (need_to_send_entry) {
                                 /* Send our ENTRY message */
                                 char entry_msg[MAX_BUFFER];
-                                snprintf(entry_msg, MAX_BUFFER, "ENTRY %s %s\n", node.ip, node.port);
+                                snprintf(entry_msg, MAX_BUFFER, "ENTRY %s %s%s\n", node.ip, node.port, caps_offer());
                                 
-                                printf("Sending ENTRY message: %s", entry_msg);
-                                if (write(curr->fd, entry_msg, strlen(entry_msg)) < 0) {
+                                log_message(LOG_DEBUG, "Sending ENTRY message: %s", entry_msg);
+                                if (send_message(curr->fd, entry_msg, strlen(entry_msg)) < 0) {
                                     perror("write");
                                 }
                             }
@@ -449,53 +702,81 @@ void handle_network_events()
                             char safe_msg[MAX_BUFFER];
                             /* If we don't have an external neighbor yet, use self as safety node */
                             if (strlen(node.ext_neighbor_ip) == 0) {
-                                snprintf(safe_msg, MAX_BUFFER, "SAFE %s %s\n", node.ip, node.port);
+                                snprintf(safe_msg, MAX_BUFFER, "SAFE %s %s%s\n", node.ip, node.port, caps_offer());
                             } else {
-                                snprintf(safe_msg, MAX_BUFFER, "SAFE %s %s\n", 
-                                         node.ext_neighbor_ip, node.ext_neighbor_port);
+                                snprintf(safe_msg, MAX_BUFFER, "SAFE %s %s%s\n",
+                                         node.ext_neighbor_ip, node.ext_neighbor_port, caps_offer());
                             }
                             
-                            printf("Sending SAFE message: %s", safe_msg);
-                            if (write(curr->fd, safe_msg, strlen(safe_msg)) < 0) {
+                            log_message(LOG_DEBUG, "Sending SAFE message: %s", safe_msg);
+                            if (send_message(curr->fd, safe_msg, strlen(safe_msg)) < 0) {
                                 perror("write");
                             }
                         }
                         else {
-                            printf("Malformed ENTRY message: %s\n", message_start);
+                            log_message(LOG_ERROR, "Malformed ENTRY message: %s", message_start);
+                            METRIC_INC(MET_MALFORMED);
                         }
                     }
                     else if (strncmp(message_start, "SAFE ", 5) == 0) {
                         char safe_ip[INET_ADDRSTRLEN] = {0};
                         char safe_port[6] = {0};
+                        metrics_count_in(curr->interface_id, MSG_SAFE, message_len);
+                        msg_type = MSG_SAFE;
 
                         if (sscanf(message_start, "SAFE %s %s", safe_ip, safe_port) == 2) {
-                            printf("Received SAFE message, safety node info: %s:%s\n", safe_ip, safe_port);
+                            cost_message_parsed();
+                            log_message(LOG_DEBUG, "Received SAFE message, safety node info: %s:%s",
+                                        safe_ip, safe_port);
+                            apply_caps(curr, message_start);
 
                             /* Always update safety node info exactly as received */
                             strcpy(node.safe_node_ip, safe_ip);
                             strcpy(node.safe_node_port, safe_port);
-                            printf("Updated safety node to: %s:%s\n", safe_ip, safe_port);
+                            log_message(LOG_INFO, "Updated safety node to: %s:%s", safe_ip, safe_port);
+                            METRIC_INC(MET_TOPO_SAFE_UPDATES);
                         }
                         else {
-                            printf("Malformed SAFE message: %s\n", message_start);
+                            log_message(LOG_ERROR, "Malformed SAFE message: %s", message_start);
+                            METRIC_INC(MET_MALFORMED);
                         }
                     }
+                    else if (strncmp(message_start, WIRE_DICT_RESET " ", strlen(WIRE_DICT_RESET) + 1) == 0) {
+                        /* O vizinho esvaziou a tabela dos nomes que lhe enviamos */
+                        metrics_count_in(curr->interface_id, MSG_UNKNOWN, message_len);
+                        cost_message_parsed();
+                        log_message(LOG_INFO, "Name table reset requested by %s:%s", curr->ip, curr->port);
+                        unsigned slots = (unsigned)strtoul(message_start + strlen(WIRE_DICT_RESET) + 1, NULL, 10);
+                        if (curr->dict_tx != NULL)
+                        {
+                            wire_dict_reset(curr->dict_tx, slots);
+                        }
+                        wire_set_dict_slots(curr, slots);
+                    }
                     else {
-                        printf("Unknown message type: %s\n", message_start);
+                        log_message(LOG_WARN, "Unknown message type: %s", message_start);
+                        metrics_count_in(curr->interface_id, MSG_UNKNOWN, message_len);
+                        METRIC_INC(MET_MALFORMED);
                     }
+                    cost_message_end(msg_type);
+                    latency_record(&node_latency.processing[msg_type], monotonic_ns() - processing_start);
                     
                     /* Restore newline for logs, but advance past it for next message */
                     *message_end = '\n';
                     message_start = message_end + 1;
                 }
-                
+                send_batch_end();
+
+                if (invalid_frame) {
+                    remove_neighbor(curr->fd);
+                }
                 /* Save any remaining partial message for next time */
-                if (message_start < curr->buffer + curr->buffer_len) {
+                else if (message_start < curr->buffer + curr->buffer_len) {
                     int remaining_len = curr->buffer_len - (message_start - curr->buffer);
                     memmove(curr->buffer, message_start, remaining_len);
                     curr->buffer_len = remaining_len;
                     curr->buffer[curr->buffer_len] = '\0';
-                    printf("Saved partial message for next read: %s\n", curr->buffer);
+                    log_message(LOG_TRACE, "Saved partial message for next read: %s", curr->buffer);
                 } else {
                     /* No remaining partial message */
                     curr->buffer_len = 0;
@@ -526,14 +807,15 @@ int send_reg_message(char *net, char *ip, char *port)
     // Garante que a conversão do endereço IP seja bem-sucedida
     if (inet_pton(AF_INET, node.reg_server_ip, &server_addr.sin_addr) != 1)
     {
-        printf("Invalid registration server IP address: %s\n", node.reg_server_ip);
+        log_message(LOG_ERROR, "Invalid registration server IP address: %s", node.reg_server_ip);
         return -1;
     }
 
     char message[MAX_BUFFER];
     snprintf(message, MAX_BUFFER, "REG %s %s %s", net, ip, port);
 
-    printf("Sending registration to %s:%s: %s\n", node.reg_server_ip, node.reg_server_port, message);
+    log_message(LOG_DEBUG, "Sending registration to %s:%s: %s",
+                node.reg_server_ip, node.reg_server_port, message);
 
     // Define um timeout para a operação de receção
     struct timeval timeout;
@@ -565,7 +847,7 @@ int send_reg_message(char *net, char *ip, char *port)
         {
             if (errno == EAGAIN || errno == EWOULDBLOCK)
             {
-                printf("Timeout waiting for response from registration server\n");
+                log_message(LOG_WARN, "Timeout waiting for response from registration server");
             }
             else
             {
@@ -574,7 +856,7 @@ int send_reg_message(char *net, char *ip, char *port)
         }
         else
         {
-            printf("Empty response from registration server\n");
+            log_message(LOG_WARN, "Empty response from registration server");
         }
         return -1;
     }
@@ -583,10 +865,11 @@ int send_reg_message(char *net, char *ip, char *port)
 
     if (strcmp(buffer, "OKREG") != 0)
     {
-        printf("Unexpected response from registration server: %s\n", buffer);
+        log_message(LOG_WARN, "Unexpected response from registration server: %s", buffer);
         return -1;
     }
 
+    node.registered = 1;
     return 0;
 }
 
@@ -608,14 +891,15 @@ int send_unreg_message(char *net, char *ip, char *port)
     // Garante que a conversão do endereço IP seja bem-sucedida
     if (inet_pton(AF_INET, node.reg_server_ip, &server_addr.sin_addr) != 1)
     {
-        printf("Invalid registration server IP address: %s\n", node.reg_server_ip);
+        log_message(LOG_ERROR, "Invalid registration server IP address: %s", node.reg_server_ip);
         return -1;
     }
 
     char message[MAX_BUFFER];
     snprintf(message, MAX_BUFFER, "UNREG %s %s %s", net, ip, port);
 
-    printf("Sending unregistration to %s:%s: %s\n", node.reg_server_ip, node.reg_server_port, message);
+    log_message(LOG_DEBUG, "Sending unregistration to %s:%s: %s",
+                node.reg_server_ip, node.reg_server_port, message);
 
     // Define um timeout para a operação de receção
     struct timeval timeout;
@@ -647,7 +931,7 @@ int send_unreg_message(char *net, char *ip, char *port)
         {
             if (errno == EAGAIN || errno == EWOULDBLOCK)
             {
-                printf("Timeout waiting for response from registration server\n");
+                log_message(LOG_WARN, "Timeout waiting for response from registration server");
             }
             else
             {
@@ -656,7 +940,7 @@ int send_unreg_message(char *net, char *ip, char *port)
         }
         else
         {
-            printf("Empty response from registration server\n");
+            log_message(LOG_WARN, "Empty response from registration server");
         }
         return -1;
     }
@@ -665,7 +949,7 @@ int send_unreg_message(char *net, char *ip, char *port)
 
     if (strcmp(buffer, "OKUNREG") != 0)
     {
-        printf("Unexpected response from registration server: %s\n", buffer);
+        log_message(LOG_WARN, "Unexpected response from registration server: %s", buffer);
         return -1;
     }
 
@@ -684,7 +968,7 @@ int send_nodes_request(char *net)
     // Valida o formato do ID de rede
     if (strlen(net) != 3 || !isdigit(net[0]) || !isdigit(net[1]) || !isdigit(net[2]))
     {
-        printf("Invalid network ID format: %s. Must be exactly 3 digits.\n", net);
+        log_message(LOG_ERROR, "Invalid network ID format: %s. Must be exactly 3 digits.", net);
         return -1;
     }
 
@@ -696,7 +980,7 @@ int send_nodes_request(char *net)
     // Garante que a conversão do endereço IP seja bem-sucedida
     if (inet_pton(AF_INET, node.reg_server_ip, &server_addr.sin_addr) != 1)
     {
-        printf("Invalid registration server IP address: %s\n", node.reg_server_ip);
+        log_message(LOG_ERROR, "Invalid registration server IP address: %s", node.reg_server_ip);
         return -1;
     }
 
@@ -704,8 +988,8 @@ int send_nodes_request(char *net)
     char message[MAX_BUFFER];
     snprintf(message, MAX_BUFFER, "NODES %s", net);
 
-    printf("Sending request: %s to registration server %s:%s\n",
-           message, node.reg_server_ip, node.reg_server_port);
+    log_message(LOG_DEBUG, "Sending request: %s to registration server %s:%s",
+                message, node.reg_server_ip, node.reg_server_port);
 
     // Define um timeout para a operação
     struct timeval timeout;
@@ -743,14 +1027,14 @@ int process_nodeslist_response(char *buffer)
     char *line = strtok(buffer, "\n");
     if (line == NULL)
     {
-        printf("Invalid NODESLIST response: empty\n");
+        log_message(LOG_ERROR, "Invalid NODESLIST response: empty");
         return -1;
     }
 
     char requested_net[4] = {0};
     if (sscanf(line, "NODESLIST %3s", requested_net) != 1)
     {
-        printf("Invalid NODESLIST response: %s\n", line);
+        log_message(LOG_ERROR, "Invalid NODESLIST response: %s", line);
         return -1;
     }
 
@@ -758,11 +1042,11 @@ int process_nodeslist_response(char *buffer)
     if (strlen(requested_net) != 3 || !isdigit(requested_net[0]) ||
         !isdigit(requested_net[1]) || !isdigit(requested_net[2]))
     {
-        printf("Invalid network ID in response: %s\n", requested_net);
+        log_message(LOG_ERROR, "Invalid network ID in response: %s", requested_net);
         return -1;
     }
 
-    printf("Processing NODESLIST for network %s\n", requested_net);
+    log_message(LOG_DEBUG, "Processing NODESLIST for network %s", requested_net);
 
     /* Extrai a lista de nós */
     int node_count = 0;
@@ -777,8 +1061,8 @@ int process_nodeslist_response(char *buffer)
             /* Ignora entradas claramente inválidas */
             if (strcmp(node_ports[node_count], "0") == 0 || strcmp(node_ips[node_count], "0.0.0.0") == 0)
             {
-                printf("Skipping invalid node entry: %s %s\n",
-                       node_ips[node_count], node_ports[node_count]);
+                log_message(LOG_WARN, "Skipping invalid node entry: %s %s",
+                            node_ips[node_count], node_ports[node_count]);
                 continue;
             }
 
@@ -786,7 +1070,7 @@ int process_nodeslist_response(char *buffer)
             if (strcmp(node_ips[node_count], node.ip) == 0 &&
                 strcmp(node_ports[node_count], node.port) == 0)
             {
-                printf("Skipping self: %s %s\n", node_ips[node_count], node_ports[node_count]);
+                log_message(LOG_DEBUG, "Skipping self: %s %s", node_ips[node_count], node_ports[node_count]);
                 continue;
             }
 
@@ -795,29 +1079,30 @@ int process_nodeslist_response(char *buffer)
         else
         {
             // Trata entrada de nó mal formatada
-            printf("Malformed node entry in NODESLIST: %s\n", line);
+            log_message(LOG_ERROR, "Malformed node entry in NODESLIST: %s", line);
             // Continua o processamento em vez de falhar
         }
     }
 
-    printf("Received %d potential nodes from registration server\n", node_count);
+    log_message(LOG_DEBUG, "Received %d potential nodes from registration server", node_count);
 
     /* Se não houver nós, cria uma nova rede */
     if (node_count == 0)
     {
-        printf("%sNo valid nodes found in network %s, creating new network as standalone node%s\n", 
-               COLOR_GREEN, requested_net, COLOR_RESET);
+        log_message(LOG_INFO, "No valid nodes found in network %s, creating new network as standalone node",
+                    requested_net);
 
         /* Regista-se na rede */
         if (send_reg_message(requested_net, node.ip, node.port) < 0)
         {
-            printf("Failed to register with the network.\n");
+            log_message(LOG_ERROR, "Failed to register with the network.");
             return -1;
         }
 
         /* Define o ID da rede e marca como in_network */
         node.network_id = atoi(requested_net);
         node.in_network = 1;
+        METRIC_INC(MET_TOPO_JOINS);
 
         /* Initially, standalone node has no external neighbor */
         memset(node.ext_neighbor_ip, 0, INET_ADDRSTRLEN);
@@ -827,8 +1112,8 @@ int process_nodeslist_response(char *buffer)
         memset(node.safe_node_ip, 0, INET_ADDRSTRLEN);
         memset(node.safe_node_port, 0, 6);
 
-        printf("%sCreated and joined network %s as standalone node - waiting for connections%s\n", 
-               COLOR_GREEN, requested_net, COLOR_RESET);
+        log_message(LOG_INFO, "Created and joined network %s as standalone node - waiting for connections",
+                    requested_net);
         return 0;
     }
 
@@ -839,13 +1124,13 @@ int process_nodeslist_response(char *buffer)
     char *chosen_ip = node_ips[random_index];
     char *chosen_port = node_ports[random_index];
 
-    printf("Attempting to connect to node %s:%s\n", chosen_ip, chosen_port);
+    log_message(LOG_INFO, "Attempting to connect to node %s:%s", chosen_ip, chosen_port);
 
     /* Liga-se ao nó escolhido */
     int fd = connect_to_node(chosen_ip, chosen_port);
     if (fd < 0)
     {
-        printf("Failed to connect to %s:%s\n", chosen_ip, chosen_port);
+        log_message(LOG_ERROR, "Failed to connect to %s:%s", chosen_ip, chosen_port);
         return -1;
     }
 
@@ -859,31 +1144,276 @@ int process_nodeslist_response(char *buffer)
     /* Envia mensagem ENTRY com o nosso porto de escuta, não o porto da ligação */
     if (send_entry_message(fd, node.ip, node.port) < 0)
     {
-        printf("Failed to send ENTRY message.\n");
-        close(fd);
+        log_message(LOG_ERROR, "Failed to send ENTRY message.");
+        close_connection(fd);
         return -1;
     }
 
     /* Regista-se na rede */
     if (send_reg_message(requested_net, node.ip, node.port) < 0)
     {
-        printf("Failed to register with the network.\n");
-        close(fd);
+        log_message(LOG_ERROR, "Failed to register with the network.");
+        close_connection(fd);
         return -1;
     }
 
     /* Define o ID da rede e marca como in_network */
     node.network_id = atoi(requested_net);
     node.in_network = 1;
+    METRIC_INC(MET_TOPO_JOINS);
 
-    printf("Joined network %s through %s:%s\n", requested_net, chosen_ip, chosen_port);
+    log_message(LOG_INFO, "Joined network %s through %s:%s", requested_net, chosen_ip, chosen_port);
 
     /* Aguarda mensagem SAFE para definir o nó de salvaguarda */
-    printf("Waiting for SAFE message from external neighbor...\n");
+    log_message(LOG_INFO, "Waiting for SAFE message from external neighbor...");
 
     return 0;
 }
 
+/**
+ * Escreve uma mensagem de protocolo no socket de um vizinho e contabiliza-a.
+ *
+ * @param fd Descritor de ficheiro da ligação
+ * @param message Mensagem a enviar
+ * @param len Tamanho da mensagem em bytes
+ * @return Número de bytes escritos, ou -1 em caso de erro
+ */
+ssize_t send_message(int fd, const char *message, size_t len)
+{
+    COST_SCOPE(COST_SEND);
+
+    ssize_t bytes_sent = node_transport != NULL ? node_transport->send(fd, message, len)
+                                                : write(fd, message, len);
+
+    if (bytes_sent < 0)
+    {
+        METRIC_INC(MET_SEND_ERRORS);
+        return bytes_sent;
+    }
+
+    int interface_id = -1;
+    for (Neighbor *n = node.neighbors; n != NULL; n = n->next)
+    {
+        if (n->fd == fd)
+        {
+            interface_id = n->interface_id;
+            break;
+        }
+    }
+
+    metrics_count_out(interface_id, metrics_classify(message), (size_t)bytes_sent);
+    capture_frame(interface_id, CAPTURE_OUT, message, (size_t)bytes_sent);
+    return bytes_sent;
+}
+
+/**
+ * Formata uma mensagem INTEREST, OBJECT ou NOOBJECT para um vizinho, em
+ * trama binária se a capacidade CAP_WIRE_TLV estiver em uso na ligação
+ * (caps.h) e em texto caso contrário.
+ *
+ * @param fd Descritor de ficheiro da ligação
+ * @param type WIRE_INTEREST, WIRE_OBJECT ou WIRE_NOOBJECT
+ * @param name Nome do objeto
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
+ * @param lifetime_ms Tempo de vida de um INTEREST (0 = não indicado)
+ * @param message Buffer com pelo menos MAX_BUFFER bytes
+ * @return Tamanho da mensagem em bytes
+ */
+size_t format_name_message(int fd, unsigned type, const char *name, uint64_t trace_id, uint32_t lifetime_ms,
+                           char *message)
+{
+    for (Neighbor *n = node.neighbors; n != NULL; n = n->next)
+    {
+        if (n->fd != fd)
+        {
+            continue;
+        }
+        if (caps_use(&n->caps, CAP_WIRE_TLV))
+        {
+            WireDict *dict = caps_use(&n->caps, CAP_NAME_DICT)
+                           ? wire_dict_get(&n->dict_tx, n->caps.value[CAP_NAME_DICT]) : NULL;
+            WireNameForm form;
+            ssize_t len = wire_encode(message, MAX_BUFFER, type, name, trace_id,
+                                      caps_use(&n->caps, CAP_LIFETIME) ? lifetime_ms : 0, NULL, 0, dict, &form);
+            if (len > 0)
+            {
+                METRIC_INC(form == WIRE_NAME_INDEXED ? MET_NAMES_INDEXED
+                           : form == WIRE_NAME_PREFIX ? MET_NAMES_PREFIX : MET_NAMES_LITERAL);
+                return (size_t)len;
+            }
+        }
+        break;
+    }
+
+    char trace[TRACE_TOKEN_SIZE];
+    char lifetime[24] = "";
+    if (lifetime_ms != 0)
+    {
+        snprintf(lifetime, sizeof(lifetime), " lifetime=%u", lifetime_ms);
+    }
+    snprintf(message, MAX_BUFFER, "%s %s%s%s\n", wire_type_name(type), name, trace_token(trace_id, trace), lifetime);
+    return strlen(message);
+}
+
+/* Nomes à espera de seguir numa trama agrupada, por interface e tipo (WIRE_INTEREST - 1, ...) */
+typedef struct
+{
+    unsigned count;
+    uint32_t lifetime_ms;               /* Tempo de vida comum aos nomes à espera */
+    char names[WIRE_BATCH_MAX][MAX_OBJECT_NAME + 1];
+} PendingNames;
+
+static PendingNames pending_names[MAX_INTERFACE][3];
+static int batch_depth = 0;
+
+/**
+ * Envia os nomes à espera para uma interface, em tramas agrupadas com
+ * tantos nomes quantos couberem numa leitura do vizinho (MAX_BUFFER - 1).
+ *
+ * @param interface_id Interface
+ * @param type WIRE_INTEREST, WIRE_OBJECT ou WIRE_NOOBJECT
+ */
+static void flush_pending_names(int interface_id, unsigned type)
+{
+    PendingNames *pending = &pending_names[interface_id][type - 1];
+    Neighbor *n = node.neighbors;
+    while (n != NULL && n->interface_id != interface_id)
+    {
+        n = n->next;
+    }
+    if (pending->count == 0 || n == NULL)
+    {
+        pending->count = 0;
+        return;
+    }
+
+    char message[MAX_BUFFER];
+    const char *names[WIRE_BATCH_MAX];
+    for (unsigned i = 0; i < pending->count; i++)
+    {
+        names[i] = pending->names[i];
+    }
+    WireDict *dict = caps_use(&n->caps, CAP_NAME_DICT)
+                   ? wire_dict_get(&n->dict_tx, n->caps.value[CAP_NAME_DICT]) : NULL;
+    uint32_t lifetime_ms = caps_use(&n->caps, CAP_LIFETIME) ? pending->lifetime_ms : 0;
+
+    size_t done = 0;
+    while (done < pending->count)
+    {
+        unsigned forms[3] = {0};
+        size_t encoded = 0;
+        ssize_t len = pending->count - done > 1
+                    ? wire_encode_batch(message, MAX_BUFFER - 1, type, names + done, pending->count - done,
+                                        0, lifetime_ms, dict, &encoded, forms)
+                    : -1;
+        if (len < 0)
+        {
+            /* Um só nome, ou um nome que não pode seguir agrupado */
+            len = (ssize_t)format_name_message(n->fd, type, names[done], 0, pending->lifetime_ms, message);
+            encoded = 1;
+        }
+        else
+        {
+            metrics_add(&metrics_local()->counters[MET_NAMES_LITERAL], forms[WIRE_NAME_LITERAL]);
+            metrics_add(&metrics_local()->counters[MET_NAMES_INDEXED], forms[WIRE_NAME_INDEXED]);
+            metrics_add(&metrics_local()->counters[MET_NAMES_PREFIX], forms[WIRE_NAME_PREFIX]);
+            metrics_add(&metrics_local()->counters[MET_BATCH_NAMES_OUT], encoded);
+            METRIC_INC(MET_BATCH_FRAMES_OUT);
+            log_message(LOG_DEBUG, "Sending %zu %s names in one frame to interface %d",
+                        encoded, wire_type_name(type), interface_id);
+        }
+        send_message(n->fd, message, (size_t)len);
+        done += encoded;
+    }
+    pending->count = 0;
+}
+
+/**
+ * Guarda um nome para seguir numa trama agrupada, se houver um lote aberto
+ * (send_batch_begin) e o vizinho tiver a capacidade CAP_BATCH em uso.
+ * Os pedidos rastreados seguem sempre sozinhos, com o seu identificador.
+ *
+ * @param fd Descritor de ficheiro da ligação
+ * @param type WIRE_INTEREST, WIRE_OBJECT ou WIRE_NOOBJECT
+ * @param name Nome do objeto
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
+ * @param lifetime_ms Tempo de vida de um INTEREST (0 = não indicado)
+ * @return 1 se o nome ficou à espera, 0 se tem de ser enviado já
+ */
+int queue_name_message(int fd, unsigned type, const char *name, uint64_t trace_id, uint32_t lifetime_ms)
+{
+    if (batch_depth == 0 || trace_id != 0)
+    {
+        return 0;
+    }
+    for (Neighbor *n = node.neighbors; n != NULL; n = n->next)
+    {
+        if (n->fd != fd)
+        {
+            continue;
+        }
+        if (n->interface_id <= 0 || n->interface_id >= MAX_INTERFACE ||
+            !caps_use(&n->caps, CAP_WIRE_TLV) || !caps_use(&n->caps, CAP_BATCH))
+        {
+            return 0;
+        }
+        PendingNames *pending = &pending_names[n->interface_id][type - 1];
+        if (pending->count > 0 && pending->lifetime_ms != lifetime_ms)
+        {
+            flush_pending_names(n->interface_id, type);
+        }
+        pending->lifetime_ms = lifetime_ms;
+        snprintf(pending->names[pending->count], sizeof(pending->names[0]), "%s", name);
+        pending->count++;
+        if (pending->count >= n->caps.value[CAP_BATCH] || pending->count >= WIRE_BATCH_MAX)
+        {
+            flush_pending_names(n->interface_id, type);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+void send_batch_begin()
+{
+    batch_depth++;
+}
+
+void send_batch_end()
+{
+    if (batch_depth == 0 || --batch_depth > 0)
+    {
+        return;
+    }
+    for (int i = 1; i < MAX_INTERFACE; i++)
+    {
+        for (unsigned type = WIRE_INTEREST; type <= WIRE_NOOBJECT; type++)
+        {
+            if (pending_names[i][type - 1].count > 0)
+            {
+                flush_pending_names(i, type);
+            }
+        }
+    }
+}
+
+/**
+ * Fecha a ligação a um vizinho através do transporte em uso.
+ *
+ * @param fd Descritor de ficheiro da ligação
+ */
+void close_connection(int fd)
+{
+    if (node_transport != NULL)
+    {
+        node_transport->close(fd);
+    }
+    else if (close(fd) < 0)
+    {
+        perror("close");
+    }
+}
+
 /**
  * Envia uma mensagem ENTRY para um nó.
  *
@@ -895,9 +1425,9 @@ int process_nodeslist_response(char *buffer)
 int send_entry_message(int fd, char *ip, char *port)
 {
     char message[MAX_BUFFER];
-    snprintf(message, MAX_BUFFER, "ENTRY %s %s\n", ip, port);
+    snprintf(message, MAX_BUFFER, "ENTRY %s %s%s\n", ip, port, caps_offer());
 
-    if (write(fd, message, strlen(message)) < 0)
+    if (send_message(fd, message, strlen(message)) < 0)
     {
         perror("write");
         return -1;
@@ -911,46 +1441,52 @@ int send_entry_message(int fd, char *ip, char *port)
  *
  * @param fd Descritor de ficheiro da ligação
  * @param name Nome do objeto a enviar
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int send_object_message(int fd, char *name)
+int send_object_message(int fd, char *name, uint64_t trace_id)
 {
+    if (queue_name_message(fd, WIRE_OBJECT, name, trace_id, 0))
+    {
+        return 0;
+    }
+
     char message[MAX_BUFFER];
-    snprintf(message, MAX_BUFFER, "OBJECT %s\n", name);
+    size_t message_len = format_name_message(fd, WIRE_OBJECT, name, trace_id, 0, message);
 
     /* Garante que a ligação ainda é válida */
     int error = 0;
     socklen_t len = sizeof(error);
-    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0)
+    if (node_transport == NULL &&
+        (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0))
     {
-        printf("Socket error detected before sending object message: %s\n", strerror(error));
+        log_message(LOG_ERROR, "Socket error detected before sending object message: %s", strerror(error));
         return -1;
     }
 
     /* Envia a mensagem com tratamento de erros cuidadoso */
-    size_t message_len = strlen(message);
-    ssize_t bytes_sent = write(fd, message, message_len);
+    ssize_t bytes_sent = send_message(fd, message, message_len);
 
     if (bytes_sent < 0)
     {
         if (errno == EPIPE)
         {
-            printf("Connection closed when trying to send object message\n");
+            log_message(LOG_WARN, "Connection closed when trying to send object message");
         }
         else
         {
-            printf("Write error when sending object message: %s\n", strerror(errno));
+            log_message(LOG_ERROR, "Write error when sending object message: %s", strerror(errno));
         }
         return -1;
     }
     else if ((size_t)bytes_sent < message_len)
     {
-        printf("Partial write when sending object message: %zd of %zu bytes\n",
-               bytes_sent, message_len);
+        log_message(LOG_WARN, "Partial write when sending object message: %zd of %zu bytes",
+                    bytes_sent, message_len);
         return -1;
     }
 
-    printf("Successfully sent object %s to fd %d\n", name, fd);
+    log_message(LOG_DEBUG, "Successfully sent object %s to fd %d", name, fd);
     return 0;
 }
 
@@ -959,14 +1495,20 @@ int send_object_message(int fd, char *name)
  *
  * @param fd Descritor de ficheiro da ligação
  * @param name Nome do objeto não encontrado
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int send_noobject_message(int fd, char *name)
+int send_noobject_message(int fd, char *name, uint64_t trace_id)
 {
+    if (queue_name_message(fd, WIRE_NOOBJECT, name, trace_id, 0))
+    {
+        return 0;
+    }
+
     char message[MAX_BUFFER];
-    snprintf(message, MAX_BUFFER, "NOOBJECT %s\n", name);
+    size_t message_len = format_name_message(fd, WIRE_NOOBJECT, name, trace_id, 0, message);
 
-    if (write(fd, message, strlen(message)) < 0)
+    if (send_message(fd, message, message_len) < 0)
     {
         perror("write");
         return -1;
@@ -981,13 +1523,17 @@ int send_noobject_message(int fd, char *name)
  *
  * @param fd Descritor de ficheiro da ligação
  * @param name Nome do objeto pretendido
+ * @param trace_id Identificador de rastreio da mensagem (0 = sem rastreio)
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
 /**
  * Enhanced handle_interest_message function with better interface information
  */
-int handle_interest_message(int fd, char *name)
+int handle_interest_message(int fd, char *name, uint64_t trace_id, uint32_t lifetime_ms)
 {
+    /* O tempo de vida conta a partir da chegada */
+    uint64_t deadline_ns = interest_deadline(lifetime_ms);
+
     /* Obtém o ID de interface para este descritor de ficheiro */
     int interface_id = -1;
     Neighbor *curr = node.neighbors;
@@ -1007,36 +1553,43 @@ int handle_interest_message(int fd, char *name)
 
     if (interface_id < 0)
     {
-        printf("%sInterface ID not found for fd %d%s\n", COLOR_RED, fd, COLOR_RESET);
+        log_message(LOG_ERROR, "Interface ID not found for fd %d", fd);
         return -1;
     }
 
     /* Ignora processamento para ID de interface 0 (ligações de saída) */
     if (interface_id == 0)
     {
-        printf("%sIgnoring interest from outgoing connection (interface 0)%s\n", 
-               COLOR_YELLOW, COLOR_RESET);
+        log_message(LOG_DEBUG, "Ignoring interest from outgoing connection (interface 0)");
         return 0;
     }
 
-    printf("Received interest for %s on interface %d from %s\n", name, interface_id, neighbor_info);
+    log_message(LOG_DEBUG, "Received interest for %s on interface %d from %s",
+                name, interface_id, neighbor_info);
+    trace_span(trace_id, "arrival", name, interface_id);
 
     /* Verifica se temos o objeto localmente */
     if (find_object(name) >= 0)
     {
-        printf("%sFound object %s locally in objects list, sending back%s\n", 
-               COLOR_GREEN, name, COLOR_RESET);
-        display_interest_table_update("INTEREST - Object Found Locally", name);
-        return send_object_message(fd, name);
+        log_message(LOG_DEBUG, "Found object %s locally in objects list, sending back", name);
+        record_interest_event(PIT_EV_FOUND_LOCAL, name, interface_id, 0);
+        METRIC_INC(MET_LOCAL_HITS);
+        trace_span(trace_id, "hit", name, interface_id);
+        return send_object_message(fd, name, trace_id);
     }
     else if (find_in_cache(name) >= 0)
     {
-        printf("%sFound object %s locally in cache, sending back%s\n", 
-               COLOR_GREEN, name, COLOR_RESET);
-        display_interest_table_update("INTEREST - Object Found In Cache", name);
-        return send_object_message(fd, name);
+        log_message(LOG_DEBUG, "Found object %s locally in cache, sending back", name);
+        record_interest_event(PIT_EV_FOUND_CACHE, name, interface_id, 0);
+        METRIC_INC(MET_CACHE_HITS);
+        NDN_PROBE1(cache_hit, name);
+        trace_span(trace_id, "cache_hit", name, interface_id);
+        return send_object_message(fd, name, trace_id);
     }
 
+    METRIC_INC(MET_CACHE_MISSES);
+    NDN_PROBE1(cache_miss, name);
+
     /* Procura ou cria entrada de interesse */
     InterestEntry *entry = find_or_create_interest_entry(name);
     if (entry == NULL)
@@ -1046,14 +1599,10 @@ int handle_interest_message(int fd, char *name)
 
     /* Marca a interface de origem como RESPONSE */
     entry->interface_states[interface_id] = RESPONSE;
-    printf("Marked interface %d as RESPONSE for %s\n", interface_id, name);
-    
-    /* Create more informative display message */
-    char detailed_message[100];
-    snprintf(detailed_message, sizeof(detailed_message), 
-            "INTEREST - From %s", neighbor_info);
-            
-    display_interest_table_update(detailed_message, name);
+    if (entry->trace_id == 0)
+        entry->trace_id = trace_id;
+    log_message(LOG_DEBUG, "Marked interface %d as RESPONSE for %s", interface_id, name);
+    record_interest_event(PIT_EV_INTEREST, name, interface_id, 0);
 
     /* Verifica se já estamos a encaminhar este interesse */
     int has_waiting = 0;
@@ -1066,57 +1615,126 @@ int handle_interest_message(int fd, char *name)
         }
     }
 
+    /* Um pedido agregado fica com o prazo da entrada, que já seguiu a montante */
+    set_interest_deadline(entry, deadline_ns);
+
     /* Se já estamos a encaminhar este interesse, não encaminhamos novamente */
     if (has_waiting)
     {
-        printf("%sAlready forwarding interest for %s%s\n", 
-               COLOR_YELLOW, name, COLOR_RESET);
+        log_message(LOG_DEBUG, "Already forwarding interest for %s", name);
+        METRIC_INC(MET_PIT_AGGREGATED);
+        trace_span(trace_id, "aggregate", name, interface_id);
         return 0;
     }
 
-    /* Encaminha para todos os outros vizinhos com IDs de interface válidos */
+    trace_span(trace_id, "pit_insert", name, interface_id);
+
+    /* Segue a montante o tempo de vida que resta, descontado o tempo passado neste nó */
+    uint32_t forward_lifetime_ms = lifetime_ms != 0 ? interest_lifetime_left(entry) : 0;
+    int expired = lifetime_ms != 0 && forward_lifetime_ms == 0;
+
+    /* Encaminha para todos os outros vizinhos com IDs de interface válidos que possam responder a tempo */
     int forwarded = 0;
+    int too_slow = 0;
 
     curr = node.neighbors;
-    while (curr != NULL)
+    while (curr != NULL && !expired)
     {
-        if (curr->interface_id > 0 && curr->interface_id != interface_id)
+        if (curr->interface_id > 0 && curr->interface_id != interface_id &&
+            !interest_face_in_time(curr, forward_lifetime_ms))
+        {
+            too_slow++;
+        }
+        else if (curr->interface_id > 0 && curr->interface_id != interface_id)
         {
             char message[MAX_BUFFER];
-            snprintf(message, MAX_BUFFER, "INTEREST %s\n", name);
-
-            if (write(curr->fd, message, strlen(message)) > 0)
+            uint64_t sent_ns = monotonic_ns();
+            trace_span(entry->trace_id, "forward", name, curr->interface_id);
+            if (queue_name_message(curr->fd, WIRE_INTEREST, name, entry->trace_id, forward_lifetime_ms) ||
+                send_message(curr->fd, message,
+                             format_name_message(curr->fd, WIRE_INTEREST, name, entry->trace_id,
+                                                 forward_lifetime_ms, message)) > 0)
             {
                 entry->interface_states[curr->interface_id] = WAITING;
+                entry->waiting_since_ns[curr->interface_id] = sent_ns;
                 forwarded++;
-                printf("Forwarded interest for %s to interface %d (%s:%s)\n", 
-                       name, curr->interface_id, curr->ip, curr->port);
+                log_message(LOG_DEBUG, "Forwarded interest for %s to interface %d (%s:%s)",
+                            name, curr->interface_id, curr->ip, curr->port);
             }
         }
         curr = curr->next;
     }
 
-    if (forwarded == 0)
+    if (forwarded == 0 && (expired || too_slow > 0))
     {
-        printf("%sNo neighbors to forward interest to, sending NOOBJECT%s\n", 
-               COLOR_RED, COLOR_RESET);
-        return send_noobject_message(fd, name);
+        /* Nenhum vizinho pode responder antes do prazo: responde já em vez de esperar */
+        log_message(LOG_DEBUG, "No neighbor can answer %s within %u ms, sending NOOBJECT",
+                    name, forward_lifetime_ms);
+        METRIC_INC(MET_PIT_TOO_LATE);
+        record_interest_event(PIT_EV_TOO_LATE, name, interface_id, (int)forward_lifetime_ms);
+        trace_span(trace_id, "too_late", name, interface_id);
+        int rc = send_noobject_message(fd, name, trace_id);
+
+        /* Já respondida: a entrada não espera nada, a menos que haja um pedido local */
+        if (entry->local_request_ns == 0)
+        {
+            remove_interest_entry(name);
+        }
+        return rc;
     }
 
-    /* Adicionar a chamada para mostrar a tabela de interesses após encaminhar */
-    if (forwarded > 0) {
-        char forward_msg[100];
-        snprintf(forward_msg, sizeof(forward_msg), 
-                "INTEREST - From %s - Fwd: %d", neighbor_info, forwarded);
-        display_interest_table_update(forward_msg, name);
+    if (forwarded == 0)
+    {
+        log_message(LOG_DEBUG, "No neighbors to forward interest to, sending NOOBJECT");
+        METRIC_INC(MET_NO_ROUTE);
+        trace_span(trace_id, "no_route", name, interface_id);
+        int rc = send_noobject_message(fd, name, trace_id);
+
+        /* Como acima: sem nada a montante, a entrada ficaria até expirar */
+        if (entry->local_request_ns == 0)
+        {
+            remove_interest_entry(name);
+        }
+        return rc;
     }
 
-    /* Atualiza o timestamp para iniciar o temporizador de timeout */
-    entry->timestamp = time(NULL);
+    record_interest_event(PIT_EV_INTEREST_FORWARDED, name, interface_id, forwarded);
 
     return 0;
 }
 
+/**
+ * Regista o RTT de uma interface a montante que estava à espera de resposta.
+ *
+ * @param entry Entrada de interesse
+ * @param interface_id Interface por onde chegou a resposta
+ */
+static void record_face_rtt(InterestEntry *entry, int interface_id)
+{
+    if (interface_id <= 0 || interface_id >= MAX_INTERFACE)
+        return;
+
+    if (entry->interface_states[interface_id] == WAITING && entry->waiting_since_ns[interface_id] != 0)
+    {
+        uint64_t rtt_ns = monotonic_ns() - entry->waiting_since_ns[interface_id];
+        latency_record(&node_latency.face_rtt[interface_id], rtt_ns);
+        entry->waiting_since_ns[interface_id] = 0;
+
+        /* O mínimo usado no encaminhamento fica com o vizinho, não com o ID */
+        for (Neighbor *n = node.neighbors; n != NULL; n = n->next)
+        {
+            if (n->interface_id == interface_id)
+            {
+                if (n->min_rtt_ns == 0 || rtt_ns < n->min_rtt_ns)
+                {
+                    n->min_rtt_ns = rtt_ns != 0 ? rtt_ns : 1;
+                }
+                break;
+            }
+        }
+    }
+}
+
 /**
  * Processa uma mensagem de objeto recebida.
  *
@@ -1130,20 +1748,17 @@ int handle_interest_message(int fd, char *name)
 /**
  * Enhanced handle_object_message function with better interface information
  */
-int handle_object_message(int fd, char *name)
+int handle_object_message(int fd, char *name, uint64_t trace_id)
 {
     /* Obtém o ID de interface para este descritor de ficheiro */
     int interface_id = -1;
     Neighbor *curr = node.neighbors;
-    char neighbor_info[50] = "Unknown";
     
     while (curr != NULL)
     {
         if (curr->fd == fd)
         {
             interface_id = curr->interface_id;
-            snprintf(neighbor_info, sizeof(neighbor_info), "%s:%s (if:%d)", 
-                    curr->ip, curr->port, curr->interface_id);
             break;
         }
         curr = curr->next;
@@ -1151,46 +1766,45 @@ int handle_object_message(int fd, char *name)
 
     if (interface_id < 0)
     {
-        printf("%sInterface ID not found for fd %d%s\n", COLOR_RED, fd, COLOR_RESET);
+        log_message(LOG_ERROR, "Interface ID not found for fd %d", fd);
         return -1;
     }
 
     /* Ignora processamento para ID de interface 0 (ligações de saída) */
     if (interface_id == 0)
     {
-        printf("%sIgnoring object from outgoing connection (interface 0)%s\n", 
-               COLOR_YELLOW, COLOR_RESET);
+        log_message(LOG_DEBUG, "Ignoring object from outgoing connection (interface 0)");
         return 0;
     }
 
-    printf("%sReceived object %s from interface %d (fd %d)%s\n", 
-           COLOR_GREEN, name, interface_id, fd, COLOR_RESET);
+    log_message(LOG_DEBUG, "Received object %s from interface %d (fd %d)", name, interface_id, fd);
 
     /* Adiciona o objeto à cache */
     if (add_to_cache(name) < 0)
     {
-        printf("%sFailed to add object %s to cache%s\n", COLOR_RED, name, COLOR_RESET);
+        log_message(LOG_ERROR, "Failed to add object %s to cache", name);
     }
     else
     {
-        printf("%sAdded object %s to cache%s\n", COLOR_GREEN, name, COLOR_RESET);
+        log_message(LOG_DEBUG, "Added object %s to cache", name);
     }
 
     /* Procura a entrada de interesse */
     InterestEntry *entry = find_interest_entry(name);
     if (!entry)
     {
-        printf("%sNo interest entry found for %s%s\n", COLOR_RED, name, COLOR_RESET);
-        
-        /* Create more informative display message */
-        char detailed_message[100];
-        snprintf(detailed_message, sizeof(detailed_message), 
-                "OBJECT - No Entry - From %s", neighbor_info);
-                
-        display_interest_table_update(detailed_message, name);
+        log_message(LOG_DEBUG, "No interest entry found for %s", name);
+        record_interest_event(PIT_EV_OBJECT_NO_ENTRY, name, interface_id, 0);
+        METRIC_INC(MET_UNSOLICITED);
+        trace_span(trace_id, "unsolicited", name, interface_id);
         return 0;
     }
 
+    if (trace_id == 0)
+        trace_id = entry->trace_id;
+    trace_span(trace_id, "object", name, interface_id);
+    record_face_rtt(entry, interface_id);
+
     /* Create a temporary array to track which file descriptors we've already forwarded to */
     int forwarded_fds[FD_SETSIZE] = {0};
     forwarded_fds[fd] = 1; /* Mark the source fd as already processed */
@@ -1209,14 +1823,15 @@ int handle_object_message(int fd, char *name)
                     /* Skip if we've already forwarded to this fd */
                     if (forwarded_fds[n->fd])
                     {
-                        printf("%sSkipping forwarding of %s to fd %d (already processed)%s\n",
-                               COLOR_YELLOW, name, n->fd, COLOR_RESET);
+                        log_message(LOG_DEBUG, "Skipping forwarding of %s to fd %d (already processed)",
+                                    name, n->fd);
                     }
                     else
                     {
-                        printf("%sForwarding object %s to interface %d (fd %d)%s\n",
-                               COLOR_GREEN, name, i, n->fd, COLOR_RESET);
-                        send_object_message(n->fd, name);
+                        log_message(LOG_DEBUG, "Forwarding object %s to interface %d (fd %d)",
+                                    name, i, n->fd);
+                        send_object_message(n->fd, name, trace_id);
+                        trace_span(trace_id, "reply", name, i);
                         forwarded_fds[n->fd] = 1; /* Mark as forwarded */
                         forward_count++;
                     }
@@ -1227,29 +1842,26 @@ int handle_object_message(int fd, char *name)
     }
 
     /* Verifica se a UI local está à espera deste objeto */
-    if (entry->interface_states[MAX_INTERFACE - 1] == RESPONSE)
+    if (entry->interface_states[MAX_INTERFACE - 1] == RESPONSE && entry->local_request_ns != 0)
     {
-        printf("%sObject %s found for local request%s\n", 
-               COLOR_GREEN, name, COLOR_RESET);
+        log_message(LOG_INFO, "Object %s found for local request", name);
+        METRIC_INC(MET_RETRIEVE_OK);
+        latency_record(&node_latency.retrieve, monotonic_ns() - entry->local_request_ns);
+        trace_span(trace_id, "complete", name, MAX_INTERFACE - 1);
     }
 
-    /* Mostrar a tabela de interesses antes de remover a entrada */
-    char action_msg[100];
-    snprintf(action_msg, sizeof(action_msg), 
-            "OBJECT - From %s - Fwd: %d", neighbor_info, forward_count);
-    display_interest_table_update(action_msg, name);
+    record_interest_event(PIT_EV_OBJECT, name, interface_id, forward_count);
+    METRIC_INC(MET_PIT_SATISFIED);
 
     /* Remove a entrada de interesse com verificação adicional */
     int remove_result = remove_interest_entry(name);
     if (remove_result < 0)
     {
-        printf("%sWarning: Interest entry for %s was not found for removal%s\n", 
-               COLOR_RED, name, COLOR_RESET);
+        log_message(LOG_WARN, "Warning: Interest entry for %s was not found for removal", name);
     }
     else
     {
-        printf("%sSuccessfully removed interest entry for %s%s\n", 
-               COLOR_GREEN, name, COLOR_RESET);
+        log_message(LOG_DEBUG, "Successfully removed interest entry for %s", name);
     }
 
     return 0;
@@ -1269,20 +1881,17 @@ int handle_object_message(int fd, char *name)
 /**
  * Enhanced handle_noobject_message function with better interface information in display
  */
-int handle_noobject_message(int fd, char *name)
+int handle_noobject_message(int fd, char *name, uint64_t trace_id)
 {
     /* Obtém o ID de interface para este descritor de ficheiro */
     int interface_id = -1;
     Neighbor *curr = node.neighbors;
-    char neighbor_info[50] = "Unknown";
     
     while (curr != NULL)
     {
         if (curr->fd == fd)
         {
             interface_id = curr->interface_id;
-            snprintf(neighbor_info, sizeof(neighbor_info), "%s:%s (if:%d)", 
-                    curr->ip, curr->port, curr->interface_id);
             break;
         }
         curr = curr->next;
@@ -1290,45 +1899,39 @@ int handle_noobject_message(int fd, char *name)
 
     if (interface_id < 0)
     {
-        printf("%sInterface ID not found for fd %d%s\n", COLOR_RED, fd, COLOR_RESET);
+        log_message(LOG_ERROR, "Interface ID not found for fd %d", fd);
         return -1;
     }
 
     /* Ignora processamento para ID de interface 0 (ligações de saída) */
     if (interface_id == 0)
     {
-        printf("%sIgnoring NOOBJECT from outgoing connection (interface 0)%s\n", 
-               COLOR_YELLOW, COLOR_RESET);
+        log_message(LOG_DEBUG, "Ignoring NOOBJECT from outgoing connection (interface 0)");
         return 0;
     }
 
-    printf("Received NOOBJECT for %s from interface %d\n", name, interface_id);
+    log_message(LOG_DEBUG, "Received NOOBJECT for %s from interface %d", name, interface_id);
 
     /* Procura a entrada de interesse */
     InterestEntry *entry = find_interest_entry(name);
     if (!entry)
     {
-        printf("%sNo interest entry found for %s%s\n", COLOR_RED, name, COLOR_RESET);
-        
-        /* Create a more informative display message */
-        char detailed_message[100];
-        snprintf(detailed_message, sizeof(detailed_message), 
-                "NOOBJECT - No Entry - From %s", neighbor_info);
-                
-        display_interest_table_update(detailed_message, name);
+        log_message(LOG_DEBUG, "No interest entry found for %s", name);
+        record_interest_event(PIT_EV_NOOBJECT_NO_ENTRY, name, interface_id, 0);
+        METRIC_INC(MET_UNSOLICITED);
+        trace_span(trace_id, "unsolicited", name, interface_id);
         return 0;
     }
 
+    if (trace_id == 0)
+        trace_id = entry->trace_id;
+    trace_span(trace_id, "noobject", name, interface_id);
+
     /* Atualiza a entrada para marcar esta interface como CLOSED */
+    record_face_rtt(entry, interface_id);
     entry->interface_states[interface_id] = CLOSED;
-    printf("Marked interface %d as CLOSED for %s\n", interface_id, name);
-    
-    /* Create a more informative display message */
-    char detailed_message[100];
-    snprintf(detailed_message, sizeof(detailed_message), 
-            "NOOBJECT - From %s", neighbor_info);
-            
-    display_interest_table_update(detailed_message, name);
+    log_message(LOG_DEBUG, "Marked interface %d as CLOSED for %s", interface_id, name);
+    record_interest_event(PIT_EV_NOOBJECT, name, interface_id, 0);
 
     /* Verifica se há interfaces ainda em estado WAITING */
     int waiting_count = 0;
@@ -1355,8 +1958,7 @@ int handle_noobject_message(int fd, char *name)
             {
                 /* Interface inválida - marca como CLOSED */
                 entry->interface_states[i] = CLOSED;
-                printf("%sMarked invalid interface %d as CLOSED for %s%s\n", 
-                       COLOR_YELLOW, i, name, COLOR_RESET);
+                log_message(LOG_DEBUG, "Marked invalid interface %d as CLOSED for %s", i, name);
             }
         }
     }
@@ -1364,8 +1966,7 @@ int handle_noobject_message(int fd, char *name)
     if (waiting_count == 0)
     {
         /* Não há interfaces em estado WAITING, envia NOOBJECT para todas as interfaces RESPONSE */
-        printf("%sNo more waiting interfaces for %s, notifying requesters%s\n", 
-               COLOR_RED, name, COLOR_RESET);
+        log_message(LOG_DEBUG, "No more waiting interfaces for %s, notifying requesters", name);
 
         /* Notifica todas as interfaces RESPONSE */
         for (int i = 1; i < MAX_INTERFACE; i++)
@@ -1377,7 +1978,8 @@ int handle_noobject_message(int fd, char *name)
                 {
                     if (n->interface_id == i)
                     {
-                        send_noobject_message(n->fd, name);
+                        send_noobject_message(n->fd, name, trace_id);
+                        trace_span(trace_id, "reply", name, i);
                         break;
                     }
                 }
@@ -1385,14 +1987,15 @@ int handle_noobject_message(int fd, char *name)
         }
 
         /* Verifica se a UI local está à espera deste objeto */
-        if (entry->interface_states[MAX_INTERFACE - 1] == RESPONSE)
+        if (entry->interface_states[MAX_INTERFACE - 1] == RESPONSE && entry->local_request_ns != 0)
         {
-            printf("%sObject %s not found for local request%s\n", 
-                   COLOR_RED, name, COLOR_RESET);
+            log_message(LOG_WARN, "Object %s not found for local request", name);
+            METRIC_INC(MET_RETRIEVE_FAILED);
+            trace_span(trace_id, "failed", name, MAX_INTERFACE - 1);
         }
 
-        /* Mostrar a tabela de interesses antes de remover a entrada */
-        display_interest_table_update("All Paths Closed - Removing Entry", name);
+        record_interest_event(PIT_EV_ALL_CLOSED, name, interface_id, 0);
+        METRIC_INC(MET_PIT_CLOSED);
 
         /* Remove a entrada de interesse */
         remove_interest_entry(name);
@@ -1413,7 +2016,12 @@ int connect_to_node(char *ip, char *port)
     struct addrinfo hints, *res;
     int fd, errcode;
 
-    printf("Attempting to connect to %s:%s\n", ip, port);
+    log_message(LOG_DEBUG, "Attempting to connect to %s:%s", ip, port);
+
+    if (node_transport != NULL)
+    {
+        return node_transport->connect(ip, port);
+    }
 
     /* Cria socket */
     fd = socket(AF_INET, SOCK_STREAM, 0);
@@ -1463,7 +2071,7 @@ int connect_to_node(char *ip, char *port)
 
     if ((errcode = getaddrinfo(ip, port, &hints, &res)) != 0)
     {
-        fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(errcode));
+        log_message(LOG_ERROR, "getaddrinfo: %s", gai_strerror(errcode));
         close(fd);
         return -1;
     }
@@ -1496,7 +2104,7 @@ int connect_to_node(char *ip, char *port)
         {
             if (select_result == 0)
             {
-                printf("Connection to %s:%s timed out\n", ip, port);
+                log_message(LOG_WARN, "Connection to %s:%s timed out", ip, port);
             }
             else
             {
@@ -1520,7 +2128,7 @@ int connect_to_node(char *ip, char *port)
 
         if (so_error != 0)
         {
-            fprintf(stderr, "Connection error: %s\n", strerror(so_error));
+            log_message(LOG_ERROR, "Connection error: %s", strerror(so_error));
             freeaddrinfo(res);
             close(fd);
             return -1;
@@ -1544,7 +2152,7 @@ int connect_to_node(char *ip, char *port)
         node.max_fd = fd;
     }
 
-    printf("Successfully connected to %s:%s (fd: %d)\n", ip, port, fd);
+    log_message(LOG_INFO, "Successfully connected to %s:%s (fd: %d)", ip, port, fd);
     return fd;
 }
 
@@ -1559,8 +2167,31 @@ int connect_to_node(char *ip, char *port)
  */
 int add_neighbor(char *ip, char *port, int fd, int is_external)
 {
+    /* Encontra o menor ID de interface livre (MAX_INTERFACE - 1 é a interface local) */
+    int used[MAX_INTERFACE] = {0};
+    for (Neighbor *curr = node.neighbors; curr != NULL; curr = curr->next)
+    {
+        if (curr->interface_id > 0 && curr->interface_id < MAX_INTERFACE)
+        {
+            used[curr->interface_id] = 1;
+        }
+    }
+
+    int interface_id = 1;
+    while (interface_id < MAX_INTERFACE - 1 && used[interface_id])
+    {
+        interface_id++;
+    }
+    if (interface_id == MAX_INTERFACE - 1)
+    {
+        /* Os estados da tabela de interesses só têm lugar para MAX_INTERFACE interfaces */
+        log_message(LOG_WARN, "No free interface for %s:%s, closing connection", ip, port);
+        close_connection(fd);
+        return -1;
+    }
+
     /* Cria um novo vizinho */
-    Neighbor *new_neighbor = malloc(sizeof(Neighbor));
+    Neighbor *new_neighbor = cost_malloc(sizeof(Neighbor));
     if (new_neighbor == NULL)
     {
         perror("malloc");
@@ -1571,23 +2202,15 @@ int add_neighbor(char *ip, char *port, int fd, int is_external)
     strcpy(new_neighbor->port, port);
     new_neighbor->fd = fd;
     new_neighbor->buffer_len = 0; /* Initialize the buffer length */
-
-    /* Encontra o próximo ID de interface disponível */
-    int interface_id = 1;
-    Neighbor *curr = node.neighbors;
-    while (curr != NULL)
-    {
-        /* Garante que não reutilizamos um ID de interface existente */
-        if (curr->interface_id >= interface_id)
-        {
-            interface_id = curr->interface_id + 1;
-        }
-        curr = curr->next;
-    }
-
+    memset(&new_neighbor->caps, 0, sizeof(new_neighbor->caps)); /* Nada até ao ENTRY ou SAFE */
+    new_neighbor->dict_tx = NULL; /* Tabelas de nomes alocadas no primeiro uso */
+    new_neighbor->dict_rx = NULL;
+    new_neighbor->dict_resync_ns = 0;
+    new_neighbor->min_rtt_ns = 0; /* Sem amostras de RTT */
     new_neighbor->interface_id = interface_id;
-    printf("Assigned interface ID %d to neighbor %s:%s (fd %d)\n",
-           interface_id, ip, port, fd);
+    METRIC_INC(MET_TOPO_NEIGHBOR_UP);
+    NDN_PROBE2(face_up, interface_id, fd);
+    log_message(LOG_DEBUG, "Assigned interface ID %d to neighbor %s:%s (fd %d)", interface_id, ip, port, fd);
 
     /* Adiciona à lista de vizinhos */
     new_neighbor->next = node.neighbors;
@@ -1597,7 +2220,7 @@ int add_neighbor(char *ip, char *port, int fd, int is_external)
     if (!is_external)
     {
         /* Cria uma cópia para a lista de vizinhos internos */
-        Neighbor *internal_copy = malloc(sizeof(Neighbor));
+        Neighbor *internal_copy = cost_malloc(sizeof(Neighbor));
         if (internal_copy == NULL)
         {
             perror("malloc");
@@ -1608,17 +2231,48 @@ int add_neighbor(char *ip, char *port, int fd, int is_external)
             memcpy(internal_copy, new_neighbor, sizeof(Neighbor));
             internal_copy->next = node.internal_neighbors;
             node.internal_neighbors = internal_copy;
-            printf("Added %s:%s as internal neighbor\n", ip, port);
+            log_message(LOG_INFO, "Added %s:%s as internal neighbor", ip, port);
         }
     }
     else
     {
-        printf("Added %s:%s as external neighbor\n", ip, port);
+        log_message(LOG_INFO, "Added %s:%s as external neighbor", ip, port);
     }
 
     return 0;
 }
 
+/**
+ * Esquece o estado associado a um ID de interface cujo vizinho saiu.
+ *
+ * O ID é reutilizado pelo próximo vizinho; sem isto herdaria os nomes por
+ * enviar, os estados na tabela de interesses, os contadores e o RTT.
+ *
+ * @param interface_id ID de interface do vizinho removido
+ */
+void release_interface(int interface_id)
+{
+    if (interface_id <= 0 || interface_id >= MAX_INTERFACE - 1)
+    {
+        return;
+    }
+
+    for (int t = 0; t < 3; t++)
+    {
+        pending_names[interface_id][t].count = 0;
+    }
+
+    /* Volta ao estado com que as entradas são criadas */
+    for (InterestEntry *entry = node.interest_table; entry != NULL; entry = entry->next)
+    {
+        entry->interface_states[interface_id] = RESPONSE;
+        entry->waiting_since_ns[interface_id] = 0;
+    }
+
+    metrics_retire_face(interface_id);
+    memset(&node_latency.face_rtt[interface_id], 0, sizeof(node_latency.face_rtt[interface_id]));
+}
+
 /**
  * Remove um vizinho da lista de vizinhos.
  *
@@ -1685,14 +2339,19 @@ int remove_neighbor(int fd)
             }
 
             /* Close the socket and free the memory */
-            close(curr->fd);
+            release_interface(curr->interface_id);
+            NDN_PROBE2(face_down, curr->interface_id, curr->fd);
+            close_connection(curr->fd);
+            free(curr->dict_tx);
+            free(curr->dict_rx);
             free(curr);
+            METRIC_INC(MET_TOPO_NEIGHBOR_DOWN);
 
             /* Handle the departure of the node based on the protocol */
             if (is_external)
             {
-                printf("%sExternal neighbor %s:%s disconnected%s\n", 
-                       COLOR_YELLOW, removed_ip, removed_port, COLOR_RESET);
+                log_message(LOG_WARN, "External neighbor %s:%s disconnected", removed_ip, removed_port);
+                METRIC_INC(MET_TOPO_EXTERNAL_LOST);
 
                 /* Check if the safety node was the node that disconnected */
                 int safety_node_disconnected = 0;
@@ -1700,8 +2359,7 @@ int remove_neighbor(int fd)
                     strcmp(node.safe_node_port, removed_port) == 0)
                 {
                     safety_node_disconnected = 1;
-                    printf("%sWARNING: Safety node has disconnected.%s\n", 
-                           COLOR_RED, COLOR_RESET);
+                    log_message(LOG_WARN, "WARNING: Safety node has disconnected.");
                 }
 
                 /* Check if node is its own salvage */
@@ -1711,14 +2369,14 @@ int remove_neighbor(int fd)
                 if (!self_is_safety && !safety_node_disconnected)
                 {
                     /* Not self-salvaged - connect to the salvage node */
-                    printf("%sConnecting to safety node %s:%s%s\n",
-                           COLOR_GREEN, node.safe_node_ip, node.safe_node_port, COLOR_RESET);
+                    log_message(LOG_INFO, "Connecting to safety node %s:%s",
+                                node.safe_node_ip, node.safe_node_port);
 
                     int new_fd = connect_to_node(node.safe_node_ip, node.safe_node_port);
                     if (new_fd < 0)
                     {
-                        printf("%sFailed to connect to safety node %s:%s%s\n",
-                               COLOR_RED, node.safe_node_ip, node.safe_node_port, COLOR_RESET);
+                        log_message(LOG_ERROR, "Failed to connect to safety node %s:%s",
+                                    node.safe_node_ip, node.safe_node_port);
                         return -1;
                     }
 
@@ -1731,9 +2389,9 @@ int remove_neighbor(int fd)
 
                     /* Send ENTRY message */
                     char message[MAX_BUFFER];
-                    snprintf(message, MAX_BUFFER, "ENTRY %s %s\n", node.ip, node.port);
+                    snprintf(message, MAX_BUFFER, "ENTRY %s %s%s\n", node.ip, node.port, caps_offer());
 
-                    if (write(new_fd, message, strlen(message)) < 0)
+                    if (send_message(new_fd, message, strlen(message)) < 0)
                     {
                         perror("write");
                         return -1;
@@ -1745,10 +2403,8 @@ int remove_neighbor(int fd)
                 else if (node.internal_neighbors != NULL)
                 {
                     /* Self-safety or safety node disconnected, and has internal neighbors */
-                    printf("%sExternal neighbor is disconnected, and node has internal neighbors%s\n",
-                           COLOR_YELLOW, COLOR_RESET);
-                    printf("%sChoosing new external neighbor from internal neighbors%s\n",
-                           COLOR_GREEN, COLOR_RESET);
+                    log_message(LOG_WARN, "External neighbor is disconnected, and node has internal neighbors");
+                    log_message(LOG_INFO, "Choosing new external neighbor from internal neighbors");
 
                     /* Choose first internal neighbor as new external neighbor */
                     Neighbor *chosen = node.internal_neighbors;
@@ -1760,17 +2416,16 @@ int remove_neighbor(int fd)
                     /* Always update safety node to self when reconfiguring */
                     strcpy(node.safe_node_ip, node.ip);
                     strcpy(node.safe_node_port, node.port);
-                    printf("%sUpdated safety node to self: %s:%s%s\n", 
-                           COLOR_GREEN, node.ip, node.port, COLOR_RESET);
+                    log_message(LOG_INFO, "Updated safety node to self: %s:%s", node.ip, node.port);
 
-                    printf("%sSelected %s:%s as new external neighbor%s\n",
-                           COLOR_GREEN, chosen->ip, chosen->port, COLOR_RESET);
+                    log_message(LOG_INFO, "Selected %s:%s as new external neighbor",
+                                chosen->ip, chosen->port);
 
                     /* Send ENTRY message */
                     char message[MAX_BUFFER];
-                    snprintf(message, MAX_BUFFER, "ENTRY %s %s\n", node.ip, node.port);
+                    snprintf(message, MAX_BUFFER, "ENTRY %s %s%s\n", node.ip, node.port, caps_offer());
 
-                    if (write(chosen->fd, message, strlen(message)) < 0)
+                    if (send_message(chosen->fd, message, strlen(message)) < 0)
                     {
                         perror("write");
                         return -1;
@@ -1782,8 +2437,7 @@ int remove_neighbor(int fd)
                 else
                 {
                     /* Self-safety with no internal neighbors - last node in network */
-                    printf("%sLast node remaining in network, becoming standalone%s\n",
-                           COLOR_YELLOW, COLOR_RESET);
+                    log_message(LOG_INFO, "Last node remaining in network, becoming standalone");
 
                     /* Clear external neighbor - ready for new connections */
                     memset(node.ext_neighbor_ip, 0, INET_ADDRSTRLEN);
@@ -1793,8 +2447,7 @@ int remove_neighbor(int fd)
                     memset(node.safe_node_ip, 0, INET_ADDRSTRLEN);
                     memset(node.safe_node_port, 0, 6);
 
-                    printf("%sCleared external neighbor and safety node - now standalone%s\n",
-                           COLOR_GREEN, COLOR_RESET);
+                    log_message(LOG_INFO, "Cleared external neighbor and safety node - now standalone");
                 }
             }
 
@@ -1808,6 +2461,99 @@ int remove_neighbor(int fd)
     return -1; /* Neighbor not found */
 }
 
+/* Prazo mais próximo na tabela de interesses (UINT64_MAX se não houver entradas) */
+static uint64_t next_interest_deadline_ns = UINT64_MAX;
+
+uint64_t interest_deadline(uint32_t lifetime_ms)
+{
+    uint64_t lifetime_ns = lifetime_ms != 0 ? (uint64_t)lifetime_ms * 1000000ull
+                                            : (uint64_t)INTEREST_TIMEOUT * 1000000000ull;
+    if (lifetime_ns > (uint64_t)INTEREST_LIFETIME_MAX * 1000000000ull)
+    {
+        lifetime_ns = (uint64_t)INTEREST_LIFETIME_MAX * 1000000000ull;
+    }
+    return monotonic_ns() + lifetime_ns;
+}
+
+void set_interest_deadline(InterestEntry *entry, uint64_t deadline_ns)
+{
+    int has_waiting = 0;
+    for (int i = 1; i < MAX_INTERFACE; i++)
+    {
+        if (entry->interface_states[i] == WAITING)
+        {
+            has_waiting = 1;
+            break;
+        }
+    }
+
+    /* Os vizinhos a montante já têm o prazo do primeiro pedido: prolongá-lo só aqui
+       deixaria a entrada à espera de respostas que a montante já não chegam */
+    if (!has_waiting)
+    {
+        entry->expires_ns = deadline_ns;
+    }
+    if (entry->expires_ns < next_interest_deadline_ns)
+    {
+        next_interest_deadline_ns = entry->expires_ns;
+    }
+}
+
+void set_local_deadline(InterestEntry *entry, uint64_t deadline_ns)
+{
+    entry->local_expires_ns = deadline_ns < entry->expires_ns ? deadline_ns : entry->expires_ns;
+    if (entry->local_expires_ns < next_interest_deadline_ns)
+    {
+        next_interest_deadline_ns = entry->local_expires_ns;
+    }
+}
+
+/* Milissegundos até um prazo, arredondados para cima */
+static uint32_t deadline_left_ms(uint64_t deadline_ns)
+{
+    uint64_t now = monotonic_ns();
+    if (deadline_ns <= now)
+    {
+        return 0;
+    }
+    uint64_t left_ms = (deadline_ns - now + 999999) / 1000000;
+    return left_ms > UINT32_MAX ? UINT32_MAX : (uint32_t)left_ms;
+}
+
+uint32_t interest_lifetime_left(const InterestEntry *entry)
+{
+    return deadline_left_ms(entry->expires_ns);
+}
+
+uint32_t interest_local_lifetime_left(const InterestEntry *entry)
+{
+    return deadline_left_ms(entry->local_expires_ns != 0 ? entry->local_expires_ns : entry->expires_ns);
+}
+
+int interest_face_in_time(const Neighbor *neighbor, uint32_t lifetime_ms)
+{
+    if (lifetime_ms == 0)
+    {
+        return 1;
+    }
+    return neighbor->min_rtt_ns == 0 || neighbor->min_rtt_ns <= (uint64_t)lifetime_ms * 1000000ull;
+}
+
+int interest_next_timeout_ms()
+{
+    if (node.interest_table == NULL || next_interest_deadline_ns == UINT64_MAX)
+    {
+        return -1;
+    }
+    uint64_t now = monotonic_ns();
+    if (next_interest_deadline_ns <= now)
+    {
+        return 0;
+    }
+    /* Os prazos estão no máximo INTEREST_LIFETIME_MAX segundos à frente */
+    return (int)((next_interest_deadline_ns - now + 999999) / 1000000);
+}
+
 /**
  * Verifica entradas de interesse que expiraram o tempo limite.
  * Versão melhorada com gestão adequada do ciclo de vida dos interesses.
@@ -1817,17 +2563,23 @@ int remove_neighbor(int fd)
  */
 void check_interest_timeouts()
 {
-    time_t current_time = time(NULL);
+    uint64_t now = monotonic_ns();
     InterestEntry *prev = NULL;
     InterestEntry *entry = node.interest_table;
 
+    /* O prazo mais próximo é recalculado a cada passagem pela tabela */
+    next_interest_deadline_ns = UINT64_MAX;
+
+    /* Os NOOBJECT de vários interesses expirados para a mesma interface seguem juntos */
+    send_batch_begin();
+
     while (entry != NULL)
     {
-        if (difftime(current_time, entry->timestamp) > INTEREST_TIMEOUT)
+        if (now >= entry->expires_ns)
         {
-            int timeout_seconds = (int)difftime(current_time, entry->timestamp);
-            printf("%sInterest for %s has timed out (after %d seconds)%s\n", 
-                   COLOR_RED, entry->name, timeout_seconds, COLOR_RESET);
+            int timeout_seconds = (int)difftime(monotonic_seconds(), entry->timestamp);
+            log_message(LOG_WARN, "Interest for %s has timed out (after %d seconds)",
+                        entry->name, timeout_seconds);
             
             /* Count waiting interfaces for better reporting */
             int waiting_count = 0;
@@ -1837,13 +2589,9 @@ void check_interest_timeouts()
                 }
             }
             
-            /* Create more detailed message */
-            char detailed_message[100];
-            snprintf(detailed_message, sizeof(detailed_message), 
-                    "INTEREST TIMEOUT - %d secs - %d waiting ifs", 
-                    timeout_seconds, waiting_count);
-                    
-            display_interest_table_update(detailed_message, entry->name);
+            record_interest_event(PIT_EV_TIMEOUT, entry->name, -1, waiting_count);
+            METRIC_INC(MET_PIT_EXPIRED);
+            trace_span(entry->trace_id, "expire", entry->name, -1);
 
             /* Envia NOOBJECT para todas as interfaces RESPONSE */
             int response_count = 0;
@@ -1857,9 +2605,9 @@ void check_interest_timeouts()
                     {
                         if (n->interface_id == i)
                         {
-                            printf("Sending NOOBJECT for %s to interface %d (%s:%s)\n", 
-                                   entry->name, i, n->ip, n->port);
-                            send_noobject_message(n->fd, entry->name);
+                            log_message(LOG_DEBUG, "Sending NOOBJECT for %s to interface %d (%s:%s)",
+                                        entry->name, i, n->ip, n->port);
+                            send_noobject_message(n->fd, entry->name, entry->trace_id);
                             break;
                         }
                     }
@@ -1867,10 +2615,10 @@ void check_interest_timeouts()
             }
 
             /* Verifica se a UI local está à espera deste objeto */
-            if (entry->interface_states[MAX_INTERFACE - 1] == RESPONSE)
+            if (entry->interface_states[MAX_INTERFACE - 1] == RESPONSE && entry->local_request_ns != 0)
             {
-                printf("%sObject %s not found for local request (timeout)%s\n", 
-                       COLOR_RED, entry->name, COLOR_RESET);
+                log_message(LOG_WARN, "Object %s not found for local request (timeout)", entry->name);
+                METRIC_INC(MET_RETRIEVE_FAILED);
             }
 
             /* Remove a entrada */
@@ -1885,14 +2633,38 @@ void check_interest_timeouts()
 
             InterestEntry *to_free = entry;
             entry = entry->next;
+            NDN_PROBE1(pit_remove, to_free->name);
+            listing_forget(to_free, entry);
             free(to_free);
+            node.interest_count--;
         }
         else
         {
+            /* O pedido local pode acabar antes da entrada, que continua para os outros pedidos */
+            if (entry->local_expires_ns != 0 && now >= entry->local_expires_ns)
+            {
+                if (entry->interface_states[MAX_INTERFACE - 1] == RESPONSE && entry->local_request_ns != 0)
+                {
+                    log_message(LOG_WARN, "Object %s not found for local request (lifetime)", entry->name);
+                    METRIC_INC(MET_RETRIEVE_FAILED);
+                }
+                entry->local_request_ns = 0;
+                entry->local_expires_ns = 0;
+            }
+
+            if (entry->expires_ns < next_interest_deadline_ns)
+            {
+                next_interest_deadline_ns = entry->expires_ns;
+            }
+            if (entry->local_expires_ns != 0 && entry->local_expires_ns < next_interest_deadline_ns)
+            {
+                next_interest_deadline_ns = entry->local_expires_ns;
+            }
             prev = entry;
             entry = entry->next;
         }
     }
+    send_batch_end();
 }
 
 /**
@@ -1922,7 +2694,7 @@ void handle_registration_response()
     }
 
     buffer[bytes_received] = '\0';
-    printf("Received from server: %s\n", buffer);
+    log_message(LOG_DEBUG, "Received from server: %s", buffer);
 
     /* Verifica o tipo de resposta */
     if (strncmp(buffer, "NODESLIST", 9) == 0)
@@ -1931,7 +2703,7 @@ void handle_registration_response()
         char response_net[4] = {0};
         if (sscanf(buffer, "NODESLIST %3s", response_net) == 1)
         {
-            printf("Processing NODESLIST for network %s\n", response_net);
+            log_message(LOG_DEBUG, "Processing NODESLIST for network %s", response_net);
 
             // Processa apenas se ainda não estiver numa rede
             if (!node.in_network)
@@ -1940,26 +2712,26 @@ void handle_registration_response()
             }
             else
             {
-                printf("Ignoring NODESLIST as already in network %03d\n", node.network_id);
+                log_message(LOG_WARN, "Ignoring NODESLIST as already in network %03d", node.network_id);
             }
         }
         else
         {
-            printf("Invalid NODESLIST response format\n");
+            log_message(LOG_ERROR, "Invalid NODESLIST response format");
         }
     }
     else if (strcmp(buffer, "OKREG") == 0)
     {
         /* Registo bem-sucedido */
-        printf("Registration successful\n");
+        log_message(LOG_INFO, "Registration successful");
     }
     else if (strcmp(buffer, "OKUNREG") == 0)
     {
         /* Cancelamento de registo bem-sucedido */
-        printf("Unregistration successful\n");
+        log_message(LOG_INFO, "Unregistration successful");
     }
     else
     {
-        printf("Unknown response from registration server: %s\n", buffer);
+        log_message(LOG_WARN, "Unknown response from registration server: %s", buffer);
     }
 }
\ No newline at end of file
@@ -25,17 +25,6 @@
 
 #include "ndn.h"
 
-/**
- * @brief Exibe atualizações da tabela de interesses de forma formatada.
- * 
- * Função de utilidade para mostrar atualizações na tabela de interesses
- * durante as operações de protocolo NDN.
- * 
- * @param action Descrição da ação realizada
- * @param name Nome do objeto relacionado à ação
- */
-void display_interest_table_update(const char* action, const char* name);
-
 /**
  * @brief Atualiza as informações de um vizinho com o porto de escuta correto.
  * 
@@ -60,6 +49,17 @@ int update_neighbor_info(int fd, char *ip, char *port);
  */
 int remove_neighbor(int fd);
 
+/**
+ * @brief Esquece o estado associado a um ID de interface cujo vizinho saiu.
+ * 
+ * Limpa os nomes por enviar, os estados da interface na tabela de
+ * interesses, os contadores por interface e o histograma de RTT, para que
+ * o vizinho que reutilizar o ID comece do zero.
+ * 
+ * @param interface_id ID de interface do vizinho removido
+ */
+void release_interface(int interface_id);
+
 /**
  * @brief Trata a desconexão de um vizinho externo.
  * 
@@ -120,6 +120,94 @@ int send_nodes_request(char *net);
  */
 int process_nodeslist_response(char *buffer);
 
+/**
+ * @brief Escreve uma mensagem de protocolo no socket de um vizinho.
+ * 
+ * Ponto único de escrita para vizinhos: contabiliza os pacotes e bytes
+ * enviados por interface e tipo de mensagem, e as falhas de escrita.
+ * 
+ * @param fd Descritor de ficheiro da ligação
+ * @param message Mensagem a enviar
+ * @param len Tamanho da mensagem em bytes
+ * @return Número de bytes escritos, ou -1 em caso de erro (como write())
+ */
+ssize_t send_message(int fd, const char *message, size_t len);
+
+/**
+ * @brief Transporte das ligações a vizinhos.
+ *
+ * Por omissão (node_transport == NULL) as ligações são sockets TCP. O
+ * simulador ndn-sim instala um transporte em memória para ligar milhares
+ * de nós no mesmo processo; os descritores passam então a ser números
+ * virtuais, próprios de cada nó.
+ */
+typedef struct node_transport {
+    int (*connect)(const char *ip, const char *port);          /* Como connect_to_node */
+    ssize_t (*send)(int fd, const char *message, size_t len);  /* Como write() */
+    ssize_t (*recv)(int fd, char *buffer, size_t len);         /* Como read() */
+    void (*close)(int fd);                                     /* Como close() */
+} NodeTransport;
+
+/**
+ * @brief Transporte em uso, ou NULL para sockets TCP.
+ */
+extern const NodeTransport *node_transport;
+
+/**
+ * @brief Formata uma mensagem INTEREST, OBJECT ou NOOBJECT para um vizinho.
+ *
+ * Usa uma trama binária se a ligação tiver a capacidade CAP_WIRE_TLV em
+ * uso (caps.h), e a mensagem de texto caso contrário. O tempo de vida só
+ * segue numa trama se a ligação tiver também a capacidade CAP_LIFETIME.
+ *
+ * @param fd Descritor de ficheiro da ligação
+ * @param type WIRE_INTEREST, WIRE_OBJECT ou WIRE_NOOBJECT
+ * @param name Nome do objeto
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
+ * @param lifetime_ms Tempo de vida de um INTEREST (0 = não indicado)
+ * @param message Buffer com pelo menos MAX_BUFFER bytes
+ * @return Tamanho da mensagem em bytes
+ */
+size_t format_name_message(int fd, unsigned type, const char *name, uint64_t trace_id, uint32_t lifetime_ms,
+                           char *message);
+
+/**
+ * @brief Guarda um nome para seguir numa trama agrupada (wire.h).
+ *
+ * Só guarda o nome se houver um lote aberto, o pedido não for rastreado e
+ * o vizinho tiver as capacidades CAP_WIRE_TLV e CAP_BATCH em uso. Uma
+ * trama agrupada tem um só tempo de vida: um nome com outro tempo de vida
+ * envia primeiro os que estão à espera.
+ *
+ * @param fd Descritor de ficheiro da ligação
+ * @param type WIRE_INTEREST, WIRE_OBJECT ou WIRE_NOOBJECT
+ * @param name Nome do objeto
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
+ * @param lifetime_ms Tempo de vida de um INTEREST (0 = não indicado)
+ * @return 1 se o nome ficou à espera, 0 se o chamador o tem de enviar já
+ */
+int queue_name_message(int fd, unsigned type, const char *name, uint64_t trace_id, uint32_t lifetime_ms);
+
+/**
+ * @brief Abre um lote: os nomes enviados até send_batch_end seguem agrupados por interface.
+ *
+ * Os lotes podem ser encaixados; os nomes só são enviados quando o mais
+ * exterior fecha.
+ */
+void send_batch_begin();
+
+/**
+ * @brief Fecha um lote e, se for o mais exterior, envia os nomes à espera.
+ */
+void send_batch_end();
+
+/**
+ * @brief Fecha a ligação a um vizinho através do transporte em uso.
+ *
+ * @param fd Descritor de ficheiro da ligação
+ */
+void close_connection(int fd);
+
 /**
  * @brief Envia uma mensagem ENTRY para um nó.
  * 
@@ -189,9 +277,10 @@ int send_interest_message(char *name);
  * 
  * @param fd Descritor de ficheiro da ligação
  * @param name Nome do objeto
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int send_object_message(int fd, char *name);
+int send_object_message(int fd, char *name, uint64_t trace_id);
 
 /**
  * @brief Envia uma mensagem NOOBJECT quando um objeto não é encontrado.
@@ -201,9 +290,10 @@ int send_object_message(int fd, char *name);
  * 
  * @param fd Descritor de ficheiro da ligação
  * @param name Nome do objeto não encontrado
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int send_noobject_message(int fd, char *name);
+int send_noobject_message(int fd, char *name, uint64_t trace_id);
 
 /**
  * @brief Processa uma mensagem de interesse recebida.
@@ -215,9 +305,11 @@ int send_noobject_message(int fd, char *name);
  * 
  * @param fd Descritor de ficheiro da ligação
  * @param name Nome do objeto pretendido
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
+ * @param lifetime_ms Tempo de vida indicado na mensagem (0 = INTEREST_TIMEOUT)
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int handle_interest_message(int fd, char *name);
+int handle_interest_message(int fd, char *name, uint64_t trace_id, uint32_t lifetime_ms);
 
 /**
  * @brief Processa uma mensagem de objeto recebida.
@@ -229,9 +321,10 @@ int handle_interest_message(int fd, char *name);
  * 
  * @param fd Descritor de ficheiro da ligação
  * @param name Nome do objeto recebido
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int handle_object_message(int fd, char *name);
+int handle_object_message(int fd, char *name, uint64_t trace_id);
 
 /**
  * @brief Processa uma mensagem NOOBJECT recebida.
@@ -243,18 +336,94 @@ int handle_object_message(int fd, char *name);
  * 
  * @param fd Descritor de ficheiro da ligação
  * @param name Nome do objeto não encontrado
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
-int handle_noobject_message(int fd, char *name);
+int handle_noobject_message(int fd, char *name, uint64_t trace_id);
 
 /**
  * @brief Verifica e processa interesses que excederam o tempo limite.
  * 
- * Verifica se há interesses com tempo limite excedido e envia
+ * Verifica se há interesses com o prazo (expires_ns) ultrapassado e envia
  * mensagens NOOBJECT para interfaces em estado RESPONSE.
  */
 void check_interest_timeouts();
 
+/**
+ * @brief Obtém o tempo até ao prazo mais próximo na tabela de interesses.
+ *
+ * Permite ao ciclo principal reduzir o timeout do select() para os
+ * interesses com tempos de vida curtos.
+ *
+ * @return Milissegundos até ao prazo mais próximo, -1 se não houver entradas
+ */
+int interest_next_timeout_ms();
+
+/**
+ * @brief Calcula o prazo de um pedido que chega agora.
+ *
+ * @param lifetime_ms Tempo de vida do pedido (0 = INTEREST_TIMEOUT; limitado a INTEREST_LIFETIME_MAX)
+ * @return Prazo em monotonic_ns
+ */
+uint64_t interest_deadline(uint32_t lifetime_ms);
+
+/**
+ * @brief Aplica o prazo de um novo pedido a uma entrada de interesse.
+ *
+ * Se a entrada ainda não aguarda respostas, passa a ter o prazo do pedido.
+ * Se já aguarda, o prazo não muda: foi esse o tempo de vida enviado aos
+ * vizinhos a montante, cujas entradas expiram ao mesmo tempo, e um pedido
+ * agregado com um tempo de vida mais longo recebe NOOBJECT nesse prazo.
+ *
+ * @param entry Entrada de interesse
+ * @param deadline_ns Prazo do pedido (interest_deadline)
+ */
+void set_interest_deadline(InterestEntry *entry, uint64_t deadline_ns);
+
+/**
+ * @brief Aplica o prazo de um pedido local (retrieve) a uma entrada de interesse.
+ *
+ * O pedido local tem o seu próprio prazo, limitado ao da entrada: um
+ * retrieve com um tempo de vida curto numa entrada que já aguarda com um
+ * prazo mais longo falha no seu prazo, e a entrada continua para os
+ * restantes pedidos (check_interest_timeouts).
+ *
+ * @param entry Entrada de interesse
+ * @param deadline_ns Prazo do pedido local (interest_deadline)
+ */
+void set_local_deadline(InterestEntry *entry, uint64_t deadline_ns);
+
+/**
+ * @brief Obtém o tempo de vida que resta a uma entrada, para o reencaminhar.
+ *
+ * @param entry Entrada de interesse
+ * @return Milissegundos até ao prazo (arredondados para cima), 0 se já passou
+ */
+uint32_t interest_lifetime_left(const InterestEntry *entry);
+
+/**
+ * @brief Obtém o tempo de vida que resta ao pedido local de uma entrada.
+ *
+ * @param entry Entrada de interesse
+ * @return Milissegundos até ao prazo do pedido local (ou da entrada, se não
+ *         houver pedido local), arredondados para cima; 0 se já passou
+ */
+uint32_t interest_local_lifetime_left(const InterestEntry *entry);
+
+/**
+ * @brief Indica se uma interface a montante pode responder dentro de um tempo de vida.
+ *
+ * Um vizinho cujo RTT mais curto já observado excede o tempo de vida
+ * não pode responder a tempo. O mínimo é guardado no próprio vizinho,
+ * pelo que um vizinho novo com um ID reutilizado começa sem amostras e
+ * "latency reset" não altera o encaminhamento.
+ *
+ * @param neighbor Vizinho a montante
+ * @param lifetime_ms Tempo de vida restante (0 = sem limite)
+ * @return 1 se pode responder a tempo, 0 caso contrário
+ */
+int interest_face_in_time(const Neighbor *neighbor, uint32_t lifetime_ms);
+
 /**
  * @brief Processa respostas recebidas do servidor de registo.
  * 
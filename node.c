@@ -0,0 +1,268 @@
+/**
+ * @file node.c
+ * @brief Estado global, inicialização e terminação do nó NDN
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Março de 2025
+ *
+ * Este ficheiro contém a variável global do nó e as funções que criam os
+ * seus sockets e libertam os seus recursos. Está separado de main.c para
+ * que ferramentas como o ndn-replay possam alojar um nó no seu próprio
+ * processo, sem o ciclo principal nem a interface de utilizador.
+ */
+
+#include "ndn.h"
+#include "commands.h"
+#include "network.h"
+#include "debug_utils.h"
+#include "metrics.h"
+#include "stats_shm.h"
+#include "capture.h"
+
+/**
+ * @brief Variável global que representa o estado do nó
+ */
+Node node;
+
+/**
+ * @brief Inicializa o nó.
+ * 
+ * Cria os sockets necessários, configura os endereços e portos, e prepara
+ * o nó para participar na rede NDN. Também apresenta uma interface de utilizador
+ * formatada com informações sobre o nó.
+ * 
+ * @param cache_size Tamanho máximo da cache
+ * @param ip Endereço IP do nó
+ * @param port Porto TCP do nó
+ * @param reg_ip Endereço IP do servidor de registo
+ * @param reg_udp Porto UDP do servidor de registo
+ */
+void initialize_node(int cache_size, char *ip, char *port, char *reg_ip, int reg_udp) {
+    struct addrinfo hints, *res;
+    int errcode;
+
+    /* Initialize the node structure */
+    memset(&node, 0, sizeof(Node));
+    node.cache_size = cache_size;
+    node.current_cache_size = 0;
+    
+    /* Store local node information */
+    strncpy(node.ip, ip, INET_ADDRSTRLEN-1);
+    node.ip[INET_ADDRSTRLEN-1] = '\0';
+    
+    strncpy(node.port, port, 5);
+    node.port[5] = '\0';
+    
+    /* Initially, no external neighbor */
+    node.ext_neighbor_ip[0] = '\0';
+    node.ext_neighbor_port[0] = '\0';
+    
+    /* Initially, no safety node */
+    node.safe_node_ip[0] = '\0';
+    node.safe_node_port[0] = '\0';
+    
+    /* Store registration server information */
+    strncpy(node.reg_server_ip, reg_ip, INET_ADDRSTRLEN-1);
+    node.reg_server_ip[INET_ADDRSTRLEN-1] = '\0';
+    
+    snprintf(node.reg_server_port, 6, "%d", reg_udp);
+    
+    node.in_network = 0; /* Not in a network initially */
+    node.max_fd = 0;
+
+    /* Create TCP listening socket */
+    node.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (node.listen_fd == -1) {
+        perror("socket");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Allow address reuse */
+    int reuse = 1;
+    if (setsockopt(node.listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == -1) {
+        perror("setsockopt");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Bind socket to specified IP and port */
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    if ((errcode = getaddrinfo(NULL, port, &hints, &res)) != 0) {
+        fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(errcode));
+        exit(EXIT_FAILURE);
+    }
+
+    if (bind(node.listen_fd, res->ai_addr, res->ai_addrlen) == -1) {
+        perror("bind");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Start listening for connections */
+    if (listen(node.listen_fd, 5) == -1) {
+        perror("listen");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Update max_fd */
+    node.max_fd = node.listen_fd;
+
+    /* Create UDP socket for registration server communication */
+    node.reg_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (node.reg_fd == -1) {
+        perror("socket");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Update max_fd if needed */
+    if (node.reg_fd > node.max_fd) {
+        node.max_fd = node.reg_fd;
+    }
+
+    freeaddrinfo(res);
+    
+    /* Enhanced user interface with colors */
+    printf("\n");
+    printf("%s%s╔══════════════════════════════════════════════════════════════╗%s\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s        %sRede de Dados Identificados por Nome (NDN)%s            %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_BOLD, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s                  %sVersão 1.0 - 2024/2025%s                      %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_YELLOW, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s╠══════════════════════════════════════════════════════════════╣%s\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s %sNó inicializado com:%s                                         %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_BOLD, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • Endereço IP: %s%-45s%s %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_GREEN, ip, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • Porto TCP: %s%-46s%s %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_GREEN, port, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • Tamanho da cache: %s%-42d%s %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_GREEN, cache_size, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • Servidor de registo: %s%s:%-37d%s %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_GREEN, reg_ip, reg_udp, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s╠══════════════════════════════════════════════════════════════╣%s\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s %sComandos Principais:%s                                         %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_BOLD, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • %sj <rede>%s        - Entrar numa rede                         %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_MAGENTA, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • %sdj <IP> <TCP>%s   - Entrar diretamente numa rede             %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_MAGENTA, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • %sc <nome>%s        - Criar objeto                             %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_MAGENTA, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • %sr <nome>%s        - Obter objeto                             %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_MAGENTA, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • %sst%s              - Mostrar topologia                        %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_MAGENTA, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • %ssi%s              - Mostrar tabela de interesses             %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_MAGENTA, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • %ssn%s              - Mostrar objetos                          %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_MAGENTA, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s║%s • %shelp%s            - Mostrar todos os comandos                %s%s║%s\n", 
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET, 
+           COLOR_MAGENTA, COLOR_RESET,
+           COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("%s%s╚══════════════════════════════════════════════════════════════╝%s\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+    printf("\n");
+}
+
+/**
+ * @brief Limpa recursos e sai do programa.
+ * 
+ * Fecha todos os sockets, liberta a memória alocada para objetos, cache, 
+ * tabela de interesses e vizinhos.
+ */
+void cleanup_and_exit()
+{
+    /* Se estiver numa rede, sai primeiro */
+    if (node.in_network)
+    {
+        cmd_leave_no_UI();
+    }
+
+    /* Fecha todos os sockets */
+    if (node.listen_fd > 0)
+    {
+        close(node.listen_fd);
+    }
+
+    if (node.reg_fd > 0)
+    {
+        close(node.reg_fd);
+    }
+
+    /* Fecha e liberta todas as ligações de vizinhos */
+    Neighbor *curr = node.neighbors;
+    while (curr != NULL)
+    {
+        Neighbor *next = curr->next;
+        close_connection(curr->fd);
+        free(curr->dict_tx);
+        free(curr->dict_rx);
+        free(curr);
+        curr = next;
+    }
+
+    /* Liberta todos os objetos */
+    Object *obj = node.objects;
+    while (obj != NULL)
+    {
+        Object *next = obj->next;
+        free(obj);
+        obj = next;
+    }
+
+    /* Liberta todos os objetos em cache */
+    obj = node.cache;
+    while (obj != NULL)
+    {
+        Object *next = obj->next;
+        free(obj);
+        obj = next;
+    }
+
+    /* Liberta todas as entradas da tabela de interesses */
+    InterestEntry *entry = node.interest_table;
+    while (entry != NULL)
+    {
+        InterestEntry *next = entry->next;
+        free(entry);
+        entry = next;
+    }
+
+    capture_stop();
+    metrics_close();
+    stats_shm_close();
+
+    /* Escreve os registos pendentes e termina a thread de registo */
+    log_shutdown();
+}
\ No newline at end of file
@@ -16,6 +16,11 @@
 #include "objects.h"
 #include "debug_utils.h"
 #include "network.h"
+#include "events.h"
+#include "metrics.h"
+#include "probes.h"
+#include "cost.h"
+#include "listing.h"
 
 
 /**
@@ -28,6 +33,8 @@
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
 int add_object(char *name) {
+    COST_SCOPE(COST_CACHE);
+
     /* Verifica se o objeto já existe */
     Object *curr = node.objects;
     while (curr != NULL) {
@@ -38,7 +45,7 @@ int add_object(char *name) {
     }
     
     /* Cria um novo objeto */
-    Object *new_object = malloc(sizeof(Object));
+    Object *new_object = cost_malloc(sizeof(Object));
     if (new_object == NULL) {
         perror("malloc");
         return -1;
@@ -62,6 +69,8 @@ int add_object(char *name) {
  * @return 0 em caso de sucesso, -1 se o objeto não for encontrado
  */
 int remove_object(char *name) {
+    COST_SCOPE(COST_CACHE);
+
     /* Procura o objeto */
     Object *prev = NULL;
     Object *curr = node.objects;
@@ -75,6 +84,7 @@ int remove_object(char *name) {
                 prev->next = curr->next;
             }
             
+            listing_forget(curr, curr->next);
             free(curr);
             return 0;
         }
@@ -96,9 +106,11 @@ int remove_object(char *name) {
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
 int add_to_cache(char *name) {
+    COST_SCOPE(COST_CACHE);
+
     /* Verifica validade da entrada */
     if (name == NULL || strlen(name) == 0) {
-        fprintf(stderr, "Error: Attempting to cache invalid object name\n");
+        log_message(LOG_ERROR, "Error: Attempting to cache invalid object name");
         return -1;
     }
 
@@ -118,7 +130,7 @@ int add_to_cache(char *name) {
     while (node.current_cache_size >= node.cache_size) {
         if (node.cache == NULL) {
             /* Estado inesperado - cache está marcada como cheia mas vazia */
-            fprintf(stderr, "Warning: Cache size inconsistency detected\n");
+            log_message(LOG_WARN, "Warning: Cache size inconsistency detected");
             node.current_cache_size = 0;
             break;
         }
@@ -127,15 +139,18 @@ int add_to_cache(char *name) {
         Object *oldest = node.cache;
         node.cache = oldest->next;
         
-        printf("Cache full. Removing oldest object: %s to make room for %s\n", 
-               oldest->name, name);
+        log_message(LOG_DEBUG, "Cache full. Removing oldest object: %s to make room for %s",
+                    oldest->name, name);
         
+        NDN_PROBE1(cache_evict, oldest->name);
+        listing_forget(oldest, oldest->next);
         free(oldest);
         node.current_cache_size--;
+        METRIC_INC(MET_CACHE_EVICTIONS);
     }
     
     /* Cria uma nova entrada na cache */
-    Object *new_object = malloc(sizeof(Object));
+    Object *new_object = cost_malloc(sizeof(Object));
     if (new_object == NULL) {
         perror("malloc");
         return -1;
@@ -161,13 +176,14 @@ int add_to_cache(char *name) {
     
     /* Incrementa o tamanho da cache */
     node.current_cache_size++;
+    METRIC_INC(MET_CACHE_INSERTS);
     
-    printf("Added object %s to cache (size: %d/%d)\n", 
-           name, node.current_cache_size, node.cache_size);
+    log_message(LOG_DEBUG, "Added object %s to cache (size: %d/%d)",
+                name, node.current_cache_size, node.cache_size);
     
     /* Verificação final para prevenir overflow do tamanho da cache */
     if (node.current_cache_size > node.cache_size) {
-        fprintf(stderr, "CRITICAL ERROR: Cache size exceeded maximum limit!\n");
+        log_message(LOG_ERROR, "CRITICAL ERROR: Cache size exceeded maximum limit!");
         /* Pode querer tratar isto de forma mais elegante dependendo da estratégia de tratamento de erros */
         exit(EXIT_FAILURE);
     }
@@ -184,6 +200,8 @@ int add_to_cache(char *name) {
  * @return Apontador para a entrada se encontrada, NULL caso contrário
  */
 InterestEntry* find_interest_entry(char *name) {
+    COST_SCOPE(COST_PIT);
+
     InterestEntry *entry = node.interest_table;
     
     while (entry != NULL) {
@@ -205,6 +223,8 @@ InterestEntry* find_interest_entry(char *name) {
  * @return 0 se o objeto for encontrado, -1 caso contrário
  */
 int find_object(char *name) {
+    COST_SCOPE(COST_CACHE);
+
     /* Procura na lista de objetos */
     Object *curr = node.objects;
     while (curr != NULL) {
@@ -226,6 +246,8 @@ int find_object(char *name) {
  * @return 0 se o objeto for encontrado, -1 caso contrário
  */
 int find_in_cache(char *name) {
+    COST_SCOPE(COST_CACHE);
+
     /* Procura na cache */
     Object *curr = node.cache;
     while (curr != NULL) {
@@ -250,6 +272,8 @@ int find_in_cache(char *name) {
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
 int add_interest_entry(char *name, int interface_id, enum interface_state state) {
+    COST_SCOPE(COST_PIT);
+
     /* Verifica se a entrada já existe */
     InterestEntry *curr = node.interest_table;
     while (curr != NULL) {
@@ -262,7 +286,7 @@ int add_interest_entry(char *name, int interface_id, enum interface_state state)
     }
     
     /* Cria uma nova entrada */
-    InterestEntry *new_entry = malloc(sizeof(InterestEntry));
+    InterestEntry *new_entry = cost_malloc(sizeof(InterestEntry));
     if (new_entry == NULL) {
         perror("malloc");
         return -1;
@@ -273,21 +297,29 @@ int add_interest_entry(char *name, int interface_id, enum interface_state state)
     /* Inicializa todas as interfaces para 0 (sem estado) */
     for (int i = 0; i < MAX_INTERFACE; i++) {
         new_entry->interface_states[i] = 0;
+        new_entry->waiting_since_ns[i] = 0;
     }
+    new_entry->local_request_ns = 0;
+    new_entry->local_expires_ns = 0;
+    new_entry->trace_id = 0;
     
     /* Define o estado para a interface especificada */
     new_entry->interface_states[interface_id] = state;
     
-    /* Regista o tempo atual */
-    new_entry->timestamp = time(NULL);
+    /* Regista o tempo atual e o prazo por omissão */
+    new_entry->timestamp = monotonic_seconds();
+    new_entry->expires_ns = monotonic_ns() + (uint64_t)INTEREST_TIMEOUT * 1000000000ull;
     
     /* Adiciona à lista de entradas de interesse */
     new_entry->next = node.interest_table;
     node.interest_table = new_entry;
+    node.interest_count++;
+    METRIC_INC(MET_PIT_INSERTS);
+    NDN_PROBE2(pit_insert, new_entry->name, interface_id);
     
-    printf("Added interest entry for %s with interface %d in state %d\n", 
-           name, interface_id, state);
-    display_interest_table_update("Entry Added", name);
+    log_message(LOG_DEBUG, "Added interest entry for %s with interface %d in state %d",
+                name, interface_id, state);
+    record_interest_event(PIT_EV_ENTRY_ADDED, name, interface_id, state);
     return 0;
 }
 
@@ -303,14 +335,15 @@ int add_interest_entry(char *name, int interface_id, enum interface_state state)
  * @return 0 em caso de sucesso, -1 em caso de erro
  */
 int update_interest_entry(char *name, int interface_id, enum interface_state state) {
+    COST_SCOPE(COST_PIT);
+
     /* Procura a entrada */
     InterestEntry *entry = find_interest_entry(name);
     
     if (entry != NULL) {
         if (entry->marked_for_removal) {
-            printf("%sWARNING: Updating interest entry for %s that is marked for removal%s\n", 
-                  COLOR_RED, name, COLOR_RESET);
-            display_interest_table_update("Update Error", name);
+            log_message(LOG_WARN, "WARNING: Updating interest entry for %s that is marked for removal", name);
+            record_interest_event(PIT_EV_UPDATE_ERROR, name, interface_id, state);
             return -1;
         }
         
@@ -318,20 +351,16 @@ int update_interest_entry(char *name, int interface_id, enum interface_state sta
         enum interface_state old_state = entry->interface_states[interface_id];
         entry->interface_states[interface_id] = state;
         
-        printf("INTEREST UPDATE: %s - interface %d: %s -> %s\n", 
-               name, interface_id, 
-               state_to_string(old_state), 
-               state_to_string(state));
+        log_message(LOG_DEBUG, "INTEREST UPDATE: %s - interface %d: %s -> %s",
+                    name, interface_id, state_to_string(old_state), state_to_string(state));
         
-        /* Display updated interest table */
-        display_interest_table_update("State Updated", name);
+        record_interest_event(PIT_EV_STATE_UPDATED, name, interface_id, state);
         
         return 0;
     }
     
     /* Entrada não encontrada, cria-a */
-    printf("%sInterest entry for %s not found, creating new entry%s\n", 
-          COLOR_YELLOW, name, COLOR_RESET);
+    log_message(LOG_DEBUG, "Interest entry for %s not found, creating new entry", name);
     return add_interest_entry(name, interface_id, state);
 }
 
@@ -344,6 +373,8 @@ int update_interest_entry(char *name, int interface_id, enum interface_state sta
  * @return 0 em caso de sucesso, -1 se a entrada não for encontrada
  */
 int remove_interest_entry(char *name) {
+    COST_SCOPE(COST_PIT);
+
     /* Procura a entrada */
     InterestEntry *prev = NULL;
     InterestEntry *curr = node.interest_table;
@@ -357,16 +388,19 @@ int remove_interest_entry(char *name) {
                 prev->next = curr->next;
             }
             
+            NDN_PROBE1(pit_remove, curr->name);
+            listing_forget(curr, curr->next);
             free(curr);
-            printf("Removed interest entry for %s\n", name);
-            display_interest_table_update("Entry Removed", name);
+            node.interest_count--;
+            log_message(LOG_DEBUG, "Removed interest entry for %s", name);
+            record_interest_event(PIT_EV_ENTRY_REMOVED, name, -1, 0);
             return 0;
         }
         
         prev = curr;
         curr = curr->next;
     }
-    display_interest_table_update("Entry Removed", name);
+    record_interest_event(PIT_EV_REMOVE_NOT_FOUND, name, -1, 0);
     return -1;  /* Entrada não encontrada */
 }
 
@@ -417,12 +451,15 @@ void trim(char *str) {
  * @return Apontador para a entrada existente ou nova, NULL em caso de erro
  */
 InterestEntry* find_or_create_interest_entry(char *name) {
+    COST_SCOPE(COST_PIT);
+
     /* Verifica se a entrada já está marcada para remoção */
     InterestEntry *entry = node.interest_table;
     while (entry != NULL) {
         if (strcmp(entry->name, name) == 0) {
             if (entry->marked_for_removal) {
-                printf("WARNING: Accessing interest entry for %s that is marked for removal\n", name);
+                log_message(LOG_WARN, "WARNING: Accessing interest entry for %s that is marked for removal",
+                            name);
             }
             return entry;
         }
@@ -430,7 +467,7 @@ InterestEntry* find_or_create_interest_entry(char *name) {
     }
     
     /* Cria nova entrada se não encontrada */
-    entry = malloc(sizeof(InterestEntry));
+    entry = cost_malloc(sizeof(InterestEntry));
     if (entry == NULL) {
         perror("malloc");
         return NULL;
@@ -441,17 +478,26 @@ InterestEntry* find_or_create_interest_entry(char *name) {
     /* Inicializa todas as interfaces para 0 (sem estado) */
     for (int i = 0; i < MAX_INTERFACE; i++) {
         entry->interface_states[i] = 0;
+        entry->waiting_since_ns[i] = 0;
     }
     
     /* Inicializa novos campos */
-    entry->timestamp = time(NULL);
+    entry->local_request_ns = 0;
+    entry->local_expires_ns = 0;
+    entry->trace_id = 0;
+    entry->timestamp = monotonic_seconds();
+    entry->expires_ns = monotonic_ns() + (uint64_t)INTEREST_TIMEOUT * 1000000000ull;
     entry->marked_for_removal = 0;
     
     /* Adiciona à lista de entradas de interesse */
     entry->next = node.interest_table;
     node.interest_table = entry;
+    node.interest_count++;
+    METRIC_INC(MET_PIT_INSERTS);
+    NDN_PROBE2(pit_insert, entry->name, -1);
     
-    printf("INTEREST CREATED: New interest entry for %s\n", name);
+    log_message(LOG_DEBUG, "INTEREST CREATED: New interest entry for %s", name);
+    record_interest_event(PIT_EV_ENTRY_ADDED, name, -1, 0);
     
     return entry;
 }
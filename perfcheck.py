@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+"""Compara o desempenho atual com uma baseline guardada no repositório.
+
+Executa várias vezes as duas suites de desempenho e compara cada métrica
+com os valores de perf_baseline.json:
+
+- microbenchmarks: ndn-bench (mediana de ns por operação, por caso e tamanho)
+- carga: um nó ndn local com dj e o ndn-loadgen em carga fechada (débito e
+  percentis p50/p99 da latência de OBJECT)
+
+Para cada métrica guarda-se a mediana das repetições e um intervalo de
+confiança da mediana obtido das estatísticas de ordem (sem assumir uma
+distribuição). Uma métrica só conta como regressão se piorar mais do que a
+tolerância da sua suite E o intervalo atual não se sobrepuser ao da
+baseline; o resto é ruído. O programa termina com código 1 se houver
+alguma regressão e 2 se uma das ferramentas falhar.
+
+Uso:
+    ./perfcheck.py                     (ou make perfcheck)
+    ./perfcheck.py --update            (mede e grava uma nova baseline)
+    ./perfcheck.py --suite bench --runs 9 --bench-tolerance 0.05
+
+As baselines dependem da máquina: grave uma com --update na máquina onde
+vai correr a verificação.
+"""
+
+import argparse
+import datetime
+import json
+import math
+import os
+import platform
+import subprocess
+import sys
+import time
+
+BENCH_ARGS = ["-s", "100,10000", "-b", "100", "-w", "10", "-r", "3"]
+LOADGEN_ARGS = ["-f", "4", "-c", "32", "-d", "2", "-W", "0.5", "-n", "1000", "-D", "zipf"]
+NODE_CACHE = "100"
+
+
+class RunError(Exception):
+    pass
+
+
+def cpu_model():
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    return platform.processor() or "unknown"
+
+
+def run_bench(bin_dir):
+    cmd = [os.path.join(bin_dir, "ndn-bench")] + BENCH_ARGS
+    r = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+    if r.returncode != 0:
+        raise RunError("ndn-bench exited with code %d" % r.returncode)
+    metrics = {}
+    for res in json.loads(r.stdout)["results"]:
+        key = "bench/%s/%d" % (res["name"], res["size"])
+        metrics[key] = res["ns_per_op"]["median"]
+    return metrics
+
+
+def start_node(bin_dir, port):
+    # O servidor de registo não é usado: o nó cria a rede com "dj 0.0.0.0 0"
+    node = subprocess.Popen(
+        [os.path.join(bin_dir, "ndn"), NODE_CACHE, "127.0.0.1", str(port), "127.0.0.1", "59999"],
+        stdin=subprocess.PIPE, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, text=True)
+    node.stdin.write("dj 0.0.0.0 0\n")
+    node.stdin.flush()
+    time.sleep(0.5)
+    if node.poll() is not None:
+        raise RunError("the ndn node exited on start-up (port %d in use?)" % port)
+    return node
+
+
+def stop_node(node):
+    # Sem "exit": o nó tentaria anular o registo num servidor que não existe
+    node.kill()
+    node.wait()
+
+
+def run_loadgen(bin_dir, port):
+    # Um nó novo em cada repetição, para não herdar a cache e a tabela anteriores
+    node = start_node(bin_dir, port)
+    try:
+        cmd = [os.path.join(bin_dir, "ndn-loadgen"), "-j"] + LOADGEN_ARGS + ["127.0.0.1", str(port)]
+        r = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True,
+                           timeout=60)
+    finally:
+        stop_node(node)
+    # Código 2 = houve timeouts; o resultado continua a ser válido
+    if r.returncode not in (0, 2):
+        raise RunError("ndn-loadgen exited with code %d" % r.returncode)
+    res = json.loads(r.stdout)
+    if res["object"] == 0:
+        raise RunError("ndn-loadgen received no OBJECT")
+    return {
+        "loadgen/throughput": res["throughput"],
+        "loadgen/object_p50_ns": res["object_latency_ns"]["p50"],
+        "loadgen/object_p99_ns": res["object_latency_ns"]["p99"],
+    }
+
+
+def higher_is_better(key):
+    return key == "loadgen/throughput"
+
+
+def median(values):
+    v = sorted(values)
+    n = len(v)
+    return v[n // 2] if n % 2 else (v[n // 2 - 1] + v[n // 2]) / 2.0
+
+
+def median_ci(values, confidence):
+    """Intervalo [x_(k), x_(n-k+1)] com o maior k cuja cobertura atinge a confiança.
+
+    A cobertura é 1 - 2 * P(Bin(n, 1/2) < k). Com poucas amostras não há k
+    suficiente e usa-se o mínimo e o máximo (k = 1), devolvendo a cobertura real.
+    """
+    v = sorted(values)
+    n = len(v)
+    best_k, best_cov = 1, 1.0 - 2.0 * 0.5 ** n
+    cdf = 0.0
+    for k in range(1, n // 2 + 1):
+        cdf += math.comb(n, k - 1) * 0.5 ** n    # P(Bin < k)
+        cov = 1.0 - 2.0 * cdf
+        if cov < confidence:
+            break
+        best_k, best_cov = k, cov
+    return v[best_k - 1], v[n - best_k], best_cov
+
+
+def collect(args):
+    samples = {}
+    suites = ["bench", "loadgen"] if args.suite == "all" else [args.suite]
+    for suite in suites:
+        for i in range(args.runs):
+            print("%s: run %d/%d" % (suite, i + 1, args.runs), file=sys.stderr)
+            if suite == "bench":
+                metrics = run_bench(args.bin_dir)
+            else:
+                metrics = run_loadgen(args.bin_dir, args.port)
+            for key, value in metrics.items():
+                samples.setdefault(key, []).append(value)
+
+    summary = {}
+    for key, values in sorted(samples.items()):
+        lo, hi, cov = median_ci(values, args.confidence)
+        summary[key] = {"median": median(values), "ci": [lo, hi], "coverage": round(cov, 4),
+                        "samples": values}
+    return summary
+
+
+def compare(baseline, current, args):
+    """Devolve o número de regressões e mostra uma tabela com todas as métricas."""
+    regressions = 0
+    print("%-36s %12s %12s %8s  %s" % ("metric", "baseline", "current", "change", "verdict"))
+    for key in sorted(set(baseline) | set(current)):
+        if key not in current:
+            print("%-36s %12s %12s %8s  %s" % (key, "", "", "", "not measured"))
+            continue
+        if key not in baseline:
+            print("%-36s %12s %12.1f %8s  %s" % (key, "", current[key]["median"], "", "new"))
+            continue
+        base, cur = baseline[key], current[key]
+        tolerance = args.bench_tolerance if key.startswith("bench/") else args.loadgen_tolerance
+        change = (cur["median"] - base["median"]) / base["median"] if base["median"] else 0.0
+        if higher_is_better(key):
+            worse = change < -tolerance and cur["ci"][1] < base["ci"][0]
+            better = change > tolerance and cur["ci"][0] > base["ci"][1]
+        else:
+            worse = change > tolerance and cur["ci"][0] > base["ci"][1]
+            better = change < -tolerance and cur["ci"][1] < base["ci"][0]
+        verdict = "REGRESSION" if worse else "improved" if better else "ok"
+        regressions += worse
+        print("%-36s %12.1f %12.1f %+7.1f%%  %s" % (key, base["median"], cur["median"],
+                                                   change * 100.0, verdict))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark regression check against a stored baseline")
+    parser.add_argument("--baseline", default="perf_baseline.json",
+                        help="baseline file (default: perf_baseline.json)")
+    parser.add_argument("--update", action="store_true",
+                        help="record the measurements as the new baseline instead of comparing")
+    parser.add_argument("--suite", choices=("all", "bench", "loadgen"), default="all",
+                        help="suites to run (default: all)")
+    parser.add_argument("--runs", type=int, default=5, help="runs per suite (default: 5)")
+    parser.add_argument("--confidence", type=float, default=0.95,
+                        help="confidence level of the median interval (default: 0.95)")
+    parser.add_argument("--bench-tolerance", type=float, default=0.10,
+                        help="relative slowdown tolerated in microbenchmarks (default: 0.10)")
+    parser.add_argument("--loadgen-tolerance", type=float, default=0.15,
+                        help="relative slowdown tolerated under load (default: 0.15)")
+    parser.add_argument("--port", type=int, default=58301, help="TCP port of the test node (default: 58301)")
+    parser.add_argument("--bin-dir", default=".", help="directory with the executables (default: .)")
+    args = parser.parse_args()
+    if args.runs < 3:
+        parser.error("--runs must be at least 3")
+
+    try:
+        current = collect(args)
+    except (RunError, OSError, ValueError, KeyError, subprocess.TimeoutExpired) as e:
+        print("perfcheck: %s" % e, file=sys.stderr)
+        return 2
+
+    if args.update:
+        data = {"meta": {"cpu": cpu_model(), "runs": args.runs,
+                         "date": datetime.date.today().isoformat(),
+                         "bench_args": " ".join(BENCH_ARGS),
+                         "loadgen_args": " ".join(LOADGEN_ARGS)},
+                "metrics": current}
+        with open(args.baseline, "w") as f:
+            json.dump(data, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("baseline written to %s (%d metrics)" % (args.baseline, len(current)))
+        return 0
+
+    try:
+        with open(args.baseline) as f:
+            data = json.load(f)
+    except (OSError, ValueError) as e:
+        print("perfcheck: cannot read the baseline: %s" % e, file=sys.stderr)
+        return 2
+    if data["meta"].get("cpu") != cpu_model():
+        print("perfcheck: warning: baseline was measured on a different CPU (%s)" % data["meta"].get("cpu"),
+              file=sys.stderr)
+
+    # Só se comparam as métricas das suites que correram
+    baseline = {k: v for k, v in data["metrics"].items()
+                if args.suite == "all" or k.startswith(args.suite + "/")}
+    regressions = compare(baseline, current, args)
+    if regressions:
+        print("%d significant regression(s)" % regressions)
+        return 1
+    print("no significant regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Treino da compilação guiada por perfil (make pgo).
+
+Corre o nó ndn instrumentado (-fprofile-generate) sob as cargas que se
+querem otimizar e termina-o de forma limpa, para o gcc gravar os
+contadores de execução. O ndn-loadgen usado não é instrumentado, para
+os seus contadores não se misturarem com os do nó nos ficheiros que
+partilham (latency.c, objects.c, ...).
+
+As cargas cobrem o caminho de encaminhamento habitual:
+
+- carga fechada com Zipf e nomes em falta (acertos na cache e NOOBJECT)
+- carga aberta uniforme sobre mais nomes do que a cache (substituições)
+- nomes sequenciais com religações de interfaces (entrada e saída de
+  vizinhos internos) e leituras do porto de métricas
+
+Uso:
+    ./pgo_train.py                    (chamado por make pgo)
+    ./pgo_train.py --duration 10
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Training run for the profile-guided build")
+    parser.add_argument("--duration", type=float, default=3, help="seconds per workload (default: 3)")
+    parser.add_argument("--port", type=int, default=58401, help="TCP port of the training node (default: 58401)")
+    parser.add_argument("--bin-dir", default=".", help="directory with the executables (default: .)")
+    args = parser.parse_args()
+
+    metrics_port = args.port + 20
+    node = subprocess.Popen(
+        [os.path.join(args.bin_dir, "ndn"), "100", "127.0.0.1", str(args.port), "127.0.0.1", "59999"],
+        stdin=subprocess.PIPE, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, text=True)
+
+    def cmd(line):
+        node.stdin.write(line + "\n")
+        node.stdin.flush()
+        time.sleep(0.2)
+
+    cmd("dj 0.0.0.0 0")
+    cmd("stats listen %d" % metrics_port)
+    for i in range(10):
+        cmd("c obj%d" % i)  # Objetos locais: acertos em objects.c antes da cache
+    if node.poll() is not None:
+        print("pgo_train: the ndn node exited on start-up (port %d in use?)" % args.port, file=sys.stderr)
+        return 2
+
+    workloads = [
+        ["-f", "4", "-c", "32", "-D", "zipf", "-n", "1000", "-m", "0.05"],
+        ["-f", "6", "-P", "2", "-r", "5000", "-D", "uniform", "-n", "10000"],
+        ["-f", "4", "-c", "16", "-D", "seq", "-n", "500", "-C", "0.2", "-S", "1", "-M", str(metrics_port)],
+    ]
+    status = 0
+    for extra in workloads:
+        loadgen = [os.path.join(args.bin_dir, "ndn-loadgen"), "-d", str(args.duration)] + extra + \
+                  ["127.0.0.1", str(args.port)]
+        print("pgo_train: %s" % " ".join(loadgen[1:]), file=sys.stderr)
+        r = subprocess.run(loadgen, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        # Código 2 = houve timeouts; o treino continua a ser válido
+        if r.returncode not in (0, 2):
+            print("pgo_train: ndn-loadgen exited with code %d" % r.returncode, file=sys.stderr)
+            status = 2
+            break
+
+    # Fim do stdin: o nó sai com exit() e os contadores do perfil são gravados
+    node.stdin.close()
+    try:
+        node.wait(timeout=10)
+    except subprocess.TimeoutExpired:
+        node.kill()
+        print("pgo_train: the ndn node did not exit; no profile written", file=sys.stderr)
+        return 2
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
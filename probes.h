@@ -0,0 +1,47 @@
+/**
+ * @file probes.h
+ * @brief Pontos de instrumentação estática (USDT) do nó NDN
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro define as sondas USDT colocadas nos pontos importantes do
+ * processamento (receção de mensagens, tabela de interesses, cache e
+ * ligações a vizinhos). Quando <sys/sdt.h> existe (pacote systemtap-sdt-dev),
+ * cada sonda é uma única instrução nop e uma nota ELF: não tem custo
+ * enquanto nenhuma ferramenta (perf, bpftrace, SystemTap) se ligar a ela.
+ * Sem o cabeçalho, ou compilando com -DNDN_NO_PROBES, as macros não geram
+ * qualquer código.
+ *
+ * Sondas disponíveis (fornecedor "ndn"):
+ *
+ *   message_receive(face, mensagem, comprimento)
+ *   pit_insert(nome, face)              pit_remove(nome)
+ *   cache_hit(nome)    cache_miss(nome)    cache_evict(nome)
+ *   face_up(face, fd)                   face_down(face, fd)
+ *
+ * Exemplo: bpftrace -e 'usdt:./ndn:ndn:cache_miss { @[str(arg0)] = count(); }'
+ */
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#if !defined(NDN_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define NDN_HAVE_SDT 1
+#endif
+#endif
+
+#ifdef NDN_HAVE_SDT
+#define NDN_PROBE0(name)                  DTRACE_PROBE(ndn, name)
+#define NDN_PROBE1(name, a1)              DTRACE_PROBE1(ndn, name, a1)
+#define NDN_PROBE2(name, a1, a2)          DTRACE_PROBE2(ndn, name, a1, a2)
+#define NDN_PROBE3(name, a1, a2, a3)      DTRACE_PROBE3(ndn, name, a1, a2, a3)
+#else
+#define NDN_PROBE0(name)                  do { } while (0)
+#define NDN_PROBE1(name, a1)              do { (void)(a1); } while (0)
+#define NDN_PROBE2(name, a1, a2)          do { (void)(a1); (void)(a2); } while (0)
+#define NDN_PROBE3(name, a1, a2, a3)      do { (void)(a1); (void)(a2); (void)(a3); } while (0)
+#endif
+
+#endif /* PROBES_H */
@@ -0,0 +1,207 @@
+/**
+ * @file stats_shm.c
+ * @brief Publicação das métricas do nó em memória partilhada
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a criação do segmento "/ndn-<porto>" e a cópia
+ * periódica das métricas agregadas para esse segmento. Os leitores
+ * (ndn-top) nunca comunicam com o nó: o custo para o ciclo principal é
+ * uma agregação e uma cópia no máximo a cada STATS_SHM_INTERVAL_MS.
+ */
+
+#include "stats_shm.h"
+#include "debug_utils.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static NdnStatsShm *shm = NULL;
+static char shm_name[32];
+static long long last_publish_ms = 0;
+static int publish_pending = 0;
+
+/**
+ * @brief Obtém o tempo monotónico atual em nanossegundos.
+ */
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Indica se um segmento existente foi deixado por um nó que já terminou.
+ *
+ * Um segmento sem o magic, ou cujo processo já não existe, é obsoleto. Um
+ * segmento que não se consegue ler (de outro utilizador) é tratado como
+ * estando em uso.
+ */
+static int stats_shm_stale(const char *name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        return 0;
+    }
+
+    int stale = 0;
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+        if (st.st_size < (off_t)sizeof(NdnStatsShm)) {
+            stale = 1;
+        } else {
+            NdnStatsShm *old = mmap(NULL, sizeof(NdnStatsShm), PROT_READ, MAP_SHARED, fd, 0);
+            if (old != MAP_FAILED) {
+                stale = old->magic != NDN_SHM_MAGIC || (kill(old->pid, 0) == -1 && errno == ESRCH);
+                munmap(old, sizeof(NdnStatsShm));
+            }
+        }
+    }
+    close(fd);
+    return stale;
+}
+
+/**
+ * @brief Cria o segmento "/ndn-<porto>" do nó atual.
+ *
+ * O segmento de outro nó em execução com o mesmo porto (noutro IP ou de
+ * outro utilizador) nunca é substituído: nesse caso o nó não publica as
+ * métricas. Só um segmento obsoleto é removido e criado de novo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int stats_shm_open() {
+    snprintf(shm_name, sizeof(shm_name), "%s%s", NDN_SHM_PREFIX, node.port);
+
+    int fd = shm_open(shm_name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1 && errno == EEXIST) {
+        if (!stats_shm_stale(shm_name)) {
+            log_message(LOG_WARN, "Stats segment %s is in use by another node, not publishing stats", shm_name);
+            return -1;
+        }
+        log_message(LOG_DEBUG, "Removing stale stats segment %s", shm_name);
+        shm_unlink(shm_name);
+        fd = shm_open(shm_name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd == -1) {
+        log_message(LOG_WARN, "Could not create stats segment %s: %s", shm_name, strerror(errno));
+        return -1;
+    }
+
+    if (ftruncate(fd, sizeof(NdnStatsShm)) == -1) {
+        log_message(LOG_WARN, "Could not size stats segment %s: %s", shm_name, strerror(errno));
+        close(fd);
+        shm_unlink(shm_name);
+        return -1;
+    }
+
+    void *mem = mmap(NULL, sizeof(NdnStatsShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        log_message(LOG_WARN, "Could not map stats segment %s: %s", shm_name, strerror(errno));
+        shm_unlink(shm_name);
+        return -1;
+    }
+
+    shm = mem;
+    memset(shm, 0, sizeof(*shm));
+    shm->version = NDN_SHM_VERSION;
+    shm->size = sizeof(NdnStatsShm);
+    shm->counter_count = MET_COUNT;
+    shm->face_slots = METRICS_FACE_SLOTS;
+    shm->type_count = MSG_TYPE_COUNT;
+    shm->pid = getpid();
+    snprintf(shm->ip, sizeof(shm->ip), "%s", node.ip);
+    snprintf(shm->port, sizeof(shm->port), "%s", node.port);
+
+    /* O magic é escrito por último: só então o segmento é válido para leitores */
+    atomic_thread_fence(memory_order_release);
+    shm->magic = NDN_SHM_MAGIC;
+
+    publish_pending = 1;
+    log_message(LOG_INFO, "Publishing stats in shared memory segment %s", shm_name);
+    return 0;
+}
+
+/**
+ * @brief Copia as métricas atuais para o segmento.
+ */
+static void publish() {
+    MetricsSnapshot snap;
+    metrics_snapshot(&snap);
+
+    uint64_t seq = atomic_load_explicit(&shm->seq, memory_order_relaxed);
+    atomic_store_explicit(&shm->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    shm->published_ns = now_ns();
+    shm->publications++;
+    shm->network_id = node.network_id;
+    shm->in_network = snap.in_network;
+    shm->pit_entries = snap.pit_entries;
+    shm->cache_entries = snap.cache_entries;
+    shm->cache_capacity = snap.cache_capacity;
+    shm->neighbors = snap.neighbors;
+    shm->internal_neighbors = snap.internal_neighbors;
+
+    for (int i = 0; i < MET_COUNT; i++) {
+        shm->counters[i] = snap.counters[i];
+    }
+    for (int f = 0; f < METRICS_FACE_SLOTS; f++) {
+        for (int t = 0; t < MSG_TYPE_COUNT; t++) {
+            shm->packets_in[f][t] = snap.packets_in[f][t];
+            shm->bytes_in[f][t] = snap.bytes_in[f][t];
+            shm->packets_out[f][t] = snap.packets_out[f][t];
+            shm->bytes_out[f][t] = snap.bytes_out[f][t];
+        }
+    }
+
+    atomic_store_explicit(&shm->seq, seq + 2, memory_order_release);
+}
+
+/**
+ * @brief Publica as métricas se já passou STATS_SHM_INTERVAL_MS desde a última publicação.
+ *
+ * Quando o intervalo ainda não passou, a publicação fica pendente e o
+ * ciclo principal acorda a tempo de a fazer (stats_shm_next_timeout_ms).
+ */
+void stats_shm_tick() {
+    if (shm == NULL) {
+        return;
+    }
+
+    long long now_ms = (long long)(now_ns() / 1000000);
+    if (now_ms - last_publish_ms < STATS_SHM_INTERVAL_MS) {
+        publish_pending = 1;
+        return;
+    }
+
+    publish();
+    last_publish_ms = now_ms;
+    publish_pending = 0;
+}
+
+/**
+ * @brief Obtém o tempo até à próxima publicação pendente.
+ *
+ * @return Milissegundos até à próxima publicação, -1 se não houver nada por publicar
+ */
+int stats_shm_next_timeout_ms() {
+    if (shm == NULL || !publish_pending) {
+        return -1;
+    }
+
+    long long remaining = STATS_SHM_INTERVAL_MS - ((long long)(now_ns() / 1000000) - last_publish_ms);
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+/**
+ * @brief Remove o segmento partilhado do nó.
+ */
+void stats_shm_close() {
+    if (shm == NULL) {
+        return;
+    }
+
+    munmap(shm, sizeof(NdnStatsShm));
+    shm_unlink(shm_name);
+    shm = NULL;
+}
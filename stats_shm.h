@@ -0,0 +1,126 @@
+/**
+ * @file stats_shm.h
+ * @brief Segmento de memória partilhada com as métricas de um nó
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro define o formato do segmento POSIX "/ndn-<porto>" onde
+ * cada nó publica periodicamente os seus contadores e medidas, e as
+ * funções usadas pelo nó para o manter. O formato é partilhado com a
+ * ferramenta ndn-top, que apenas lê o segmento.
+ *
+ * Consistência: o nó incrementa seq antes e depois de cada publicação
+ * (seqlock). Um leitor copia o segmento e repete a cópia se seq era
+ * ímpar ou mudou entre o início e o fim da leitura.
+ *
+ * Compatibilidade: os leitores devem verificar magic e version; campos
+ * novos só são acrescentados no fim, aumentando size e version.
+ */
+
+#ifndef STATS_SHM_H
+#define STATS_SHM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "metrics.h"
+
+#define NDN_SHM_MAGIC 0x534e444eu       /* "NDNS" */
+#define NDN_SHM_VERSION 1
+#define NDN_SHM_PREFIX "/ndn-"          /* Nome do segmento: NDN_SHM_PREFIX seguido do porto TCP */
+#define NDN_SHM_MAX_COUNTERS 64         /* Espaço reservado para contadores globais */
+#define NDN_SHM_MAX_FACES 16            /* Espaço reservado para interfaces */
+#define NDN_SHM_MAX_TYPES 8             /* Espaço reservado para tipos de mensagem */
+#define STATS_SHM_INTERVAL_MS 100       /* Intervalo mínimo entre publicações */
+
+_Static_assert(MET_COUNT <= NDN_SHM_MAX_COUNTERS, "aumentar NDN_SHM_MAX_COUNTERS");
+_Static_assert(METRICS_FACE_SLOTS <= NDN_SHM_MAX_FACES, "aumentar NDN_SHM_MAX_FACES");
+_Static_assert(MSG_TYPE_COUNT <= NDN_SHM_MAX_TYPES, "aumentar NDN_SHM_MAX_TYPES");
+
+/**
+ * @brief Conteúdo do segmento partilhado (versão 1).
+ *
+ * Os índices dos arrays são os de MetricId, do ID de interface e de
+ * MsgType; counter_count, face_slots e type_count indicam quantas
+ * entradas estão em uso.
+ */
+typedef struct ndn_stats_shm {
+    uint32_t magic;                     /* NDN_SHM_MAGIC */
+    uint32_t version;                   /* NDN_SHM_VERSION */
+    uint32_t size;                      /* sizeof(NdnStatsShm) do escritor */
+    uint32_t counter_count;             /* Contadores globais em uso */
+    uint32_t face_slots;                /* Interfaces em uso */
+    uint32_t type_count;                /* Tipos de mensagem em uso */
+    int32_t pid;                        /* Processo do nó */
+    int32_t reserved0;
+    _Atomic uint64_t seq;               /* Sequência do seqlock (ímpar durante a escrita) */
+    uint64_t published_ns;              /* Momento da publicação (CLOCK_MONOTONIC) */
+    uint64_t publications;              /* Número de publicações */
+    char ip[16];                        /* Endereço IP do nó */
+    char port[8];                       /* Porto TCP do nó */
+    int32_t network_id;                 /* Rede atual */
+    int32_t in_network;                 /* 1 se o nó está numa rede */
+    int32_t pit_entries;                /* Entradas na tabela de interesses */
+    int32_t cache_entries;              /* Objetos em cache */
+    int32_t cache_capacity;             /* Capacidade da cache */
+    int32_t neighbors;                  /* Vizinhos ligados */
+    int32_t internal_neighbors;         /* Vizinhos internos */
+    int32_t reserved1;
+    uint64_t counters[NDN_SHM_MAX_COUNTERS];
+    uint64_t packets_in[NDN_SHM_MAX_FACES][NDN_SHM_MAX_TYPES];
+    uint64_t bytes_in[NDN_SHM_MAX_FACES][NDN_SHM_MAX_TYPES];
+    uint64_t packets_out[NDN_SHM_MAX_FACES][NDN_SHM_MAX_TYPES];
+    uint64_t bytes_out[NDN_SHM_MAX_FACES][NDN_SHM_MAX_TYPES];
+} NdnStatsShm;
+
+/**
+ * @brief Lê uma cópia consistente de um segmento publicado por um nó.
+ *
+ * @param shm Segmento mapeado
+ * @param out Cópia de destino
+ * @return 0 em caso de sucesso, -1 se não foi possível obter uma cópia consistente
+ */
+static inline int stats_shm_read(const NdnStatsShm *shm, NdnStatsShm *out) {
+    for (int attempt = 0; attempt < 1000; attempt++) {
+        uint64_t before = atomic_load_explicit(&((NdnStatsShm *)shm)->seq, memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        memcpy(out, shm, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t after = atomic_load_explicit(&((NdnStatsShm *)shm)->seq, memory_order_relaxed);
+        if (before == after) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Cria o segmento "/ndn-<porto>" do nó atual.
+ *
+ * Em caso de falha o nó continua a funcionar sem publicar métricas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int stats_shm_open();
+
+/**
+ * @brief Publica as métricas se já passou STATS_SHM_INTERVAL_MS desde a última publicação.
+ *
+ * Chamada uma vez por iteração do ciclo principal.
+ */
+void stats_shm_tick();
+
+/**
+ * @brief Obtém o tempo até à próxima publicação pendente.
+ *
+ * @return Milissegundos até à próxima publicação, -1 se não houver nada por publicar
+ */
+int stats_shm_next_timeout_ms();
+
+/**
+ * @brief Remove o segmento partilhado do nó.
+ */
+void stats_shm_close();
+
+#endif /* STATS_SHM_H */
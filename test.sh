@@ -53,8 +53,8 @@ start_node() {
     local cache=$2
     local ip=$3
     local port=$4
-    local reg_ip=${5:-"193.136.138.142"}
-    local reg_udp=${6:-"59000"}
+    local reg_ip=${5:-${REG_IP:-"193.136.138.142"}}
+    local reg_udp=${6:-${REG_UDP:-"59000"}}
     
     print_step "Starting $name (IP: $ip, Port: $port)"
     
@@ -0,0 +1,140 @@
+/**
+ * @file trace.c
+ * @brief Implementação do rastreio de interesses entre nós
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a amostragem dos pedidos rastreados, a leitura e
+ * escrita do campo trace nas mensagens, o registo dos spans e o comando
+ * "trace".
+ */
+
+#include "trace.h"
+#include "debug_utils.h"
+
+double trace_sample_rate = 0.0;
+
+static uint64_t rng_state = 0;
+
+/**
+ * @brief Gera um número pseudoaleatório de 64 bits (xorshift64*).
+ */
+static uint64_t next_random() {
+    if (rng_state == 0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        rng_state = ((uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec) ^ ((uint64_t)getpid() << 32);
+        if (rng_state == 0) {
+            rng_state = 0x9e3779b97f4a7c15ull;
+        }
+    }
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+/**
+ * @brief Decide se um novo pedido local é rastreado.
+ *
+ * @return Novo identificador de rastreio, ou 0 se o pedido não for amostrado
+ */
+uint64_t trace_sample() {
+    if (trace_sample_rate <= 0.0) {
+        return 0;
+    }
+    if (trace_sample_rate < 1.0 && (next_random() >> 11) * (1.0 / 9007199254740992.0) >= trace_sample_rate) {
+        return 0;
+    }
+
+    uint64_t id;
+    do {
+        id = next_random();
+    } while (id == 0);
+    return id;
+}
+
+/**
+ * @brief Obtém o identificador de rastreio de uma mensagem recebida.
+ *
+ * @param message Mensagem (terminada em '\0')
+ * @return Identificador, ou 0 se a mensagem não tiver o campo trace
+ */
+uint64_t trace_parse(const char *message) {
+    const char *field = strstr(message, " trace=");
+    if (field == NULL) {
+        return 0;
+    }
+    return strtoull(field + 7, NULL, 16);
+}
+
+/**
+ * @brief Formata o campo opcional de rastreio para acrescentar a uma mensagem.
+ *
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
+ * @param buffer Buffer com pelo menos TRACE_TOKEN_SIZE bytes
+ * @return " trace=<id>", ou "" se trace_id for 0
+ */
+const char *trace_token(uint64_t trace_id, char *buffer) {
+    if (trace_id == 0) {
+        buffer[0] = '\0';
+    } else {
+        snprintf(buffer, TRACE_TOKEN_SIZE, " trace=%016llx", (unsigned long long)trace_id);
+    }
+    return buffer;
+}
+
+/**
+ * @brief Regista um span de um pedido rastreado.
+ *
+ * O instante é obtido com CLOCK_REALTIME para poder ser comparado entre
+ * processos (na mesma máquina, ou em máquinas sincronizadas por NTP).
+ *
+ * @param trace_id Identificador de rastreio
+ * @param event Passo do pedido (arrival, pit_insert, forward, reply, ...)
+ * @param name Nome do objeto
+ * @param face Interface envolvida (-1 se nenhuma)
+ */
+void trace_span_write(uint64_t trace_id, const char *event, const char *name, int face) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    log_write_always(LOG_INFO, "SPAN trace=%016llx node=%s:%s event=%s name=%s face=%d ts=%llu",
+                     (unsigned long long)trace_id, node.ip, node.port, event, name, face,
+                     (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec);
+}
+
+/**
+ * @brief Processa o comando "trace" para consultar ou alterar a taxa de amostragem.
+ *
+ * @param arg Nova taxa (0 a 1, ou percentagem terminada em '%'), ou NULL para mostrar a atual
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_trace(char *arg) {
+    if (arg == NULL) {
+        printf("Trace sampling rate: %g (%g%% of retrieves)\n", trace_sample_rate, trace_sample_rate * 100.0);
+        return 0;
+    }
+
+    char *end;
+    double rate = strtod(arg, &end);
+    if (end != arg && *end == '%') {
+        rate /= 100.0;
+        end++;
+    } else if (strcmp(arg, "on") == 0) {
+        rate = 1.0;
+        end = arg + 2;
+    } else if (strcmp(arg, "off") == 0) {
+        rate = 0.0;
+        end = arg + 3;
+    }
+
+    if (end == arg || *end != '\0' || rate < 0.0 || rate > 1.0) {
+        printf("%sUsage: trace [<rate 0-1>|<percent>%%|on|off]%s\n", COLOR_RED, COLOR_RESET);
+        return -1;
+    }
+
+    trace_sample_rate = rate;
+    printf("Trace sampling rate set to %g (%g%% of retrieves)\n", rate, rate * 100.0);
+    return 0;
+}
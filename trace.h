@@ -0,0 +1,89 @@
+/**
+ * @file trace.h
+ * @brief Rastreio de interesses entre nós com identificadores amostrados
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém as declarações do rastreio de pedidos ao longo da
+ * árvore. Uma fração dos pedidos locais (retrieve) recebe um
+ * identificador de 64 bits, que segue como campo opcional nas mensagens:
+ *
+ *   INTEREST <nome> trace=<16 dígitos hexadecimais>
+ *   OBJECT <nome> trace=<...>
+ *   NOOBJECT <nome> trace=<...>
+ *
+ * Nós que não conhecem o campo ignoram-no (a leitura do nome termina no
+ * primeiro espaço). Cada nó regista um span por cada passo do pedido
+ * (chegada, inserção na tabela, encaminhamento, resposta...) no registo
+ * assíncrono, com o instante em CLOCK_REALTIME; o script
+ * trace_collect.py junta os registos de vários nós e reconstrói o
+ * caminho e a latência de cada salto.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "ndn.h"
+
+#define TRACE_TOKEN_SIZE 24     /* " trace=" + 16 dígitos + '\0' */
+
+/**
+ * @brief Fração dos pedidos locais que são rastreados (0 a 1).
+ */
+extern double trace_sample_rate;
+
+/**
+ * @brief Decide se um novo pedido local é rastreado.
+ *
+ * @return Novo identificador de rastreio, ou 0 se o pedido não for amostrado
+ */
+uint64_t trace_sample();
+
+/**
+ * @brief Obtém o identificador de rastreio de uma mensagem recebida.
+ *
+ * @param message Mensagem (terminada em '\0')
+ * @return Identificador, ou 0 se a mensagem não tiver o campo trace
+ */
+uint64_t trace_parse(const char *message);
+
+/**
+ * @brief Formata o campo opcional de rastreio para acrescentar a uma mensagem.
+ *
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
+ * @param buffer Buffer com pelo menos TRACE_TOKEN_SIZE bytes
+ * @return " trace=<id>", ou "" se trace_id for 0
+ */
+const char *trace_token(uint64_t trace_id, char *buffer);
+
+/**
+ * @brief Regista um span de um pedido rastreado.
+ *
+ * @param trace_id Identificador de rastreio
+ * @param event Passo do pedido (arrival, pit_insert, forward, reply, ...)
+ * @param name Nome do objeto
+ * @param face Interface envolvida (-1 se nenhuma)
+ */
+void trace_span_write(uint64_t trace_id, const char *event, const char *name, int face);
+
+/**
+ * @brief Regista um span se o pedido for rastreado.
+ *
+ * Sem rastreio, o custo é apenas uma comparação.
+ */
+static inline void trace_span(uint64_t trace_id, const char *event, const char *name, int face) {
+    if (trace_id != 0) {
+        trace_span_write(trace_id, event, name, face);
+    }
+}
+
+/**
+ * @brief Processa o comando "trace" para consultar ou alterar a taxa de amostragem.
+ *
+ * @param arg Nova taxa (0 a 1, ou percentagem terminada em '%'), ou NULL para mostrar a atual
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int cmd_trace(char *arg);
+
+#endif /* TRACE_H */
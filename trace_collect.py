@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Reconstrói o caminho e a latência por salto de pedidos NDN rastreados.
+
+Lê os registos (stderr) de um ou mais nós, junta as linhas SPAN com o
+mesmo identificador de rastreio e mostra, para cada pedido:
+
+- a sequência de spans de todos os nós, ordenada no tempo
+- o caminho entre o nó que fez o pedido e o nó que respondeu
+- para cada salto, o tempo na ligação (forward -> arrival), o tempo
+  dentro do nó (arrival -> forward/hit) e o tempo de espera pela
+  resposta vinda de montante (forward -> object)
+
+Uso:
+    ./trace_collect.py no1.log no2.log ...        (ou registos em stdin)
+    ./trace_collect.py --trace 1a2b... *.log      (apenas um pedido)
+    ./trace_collect.py --summary *.log            (apenas o resumo por salto)
+
+Os instantes vêm de CLOCK_REALTIME: os nós devem correr na mesma
+máquina ou em máquinas com relógios sincronizados.
+"""
+
+import argparse
+import re
+import sys
+from collections import defaultdict
+
+SPAN_RE = re.compile(
+    r"SPAN trace=(?P<trace>[0-9a-f]+) node=(?P<node>\S+) event=(?P<event>\S+) "
+    r"name=(?P<name>\S+) face=(?P<face>-?\d+) ts=(?P<ts>\d+)")
+
+# Eventos que marcam a saída do interesse de um nó (para montante)
+FORWARD_EVENTS = {"forward"}
+# Eventos que marcam a chegada do interesse a um nó
+ARRIVAL_EVENTS = {"arrival"}
+# Eventos onde um nó encontrou o objeto
+HIT_EVENTS = {"hit", "cache_hit"}
+
+
+def read_spans(files):
+    traces = defaultdict(list)
+    streams = [open(f, errors="replace") for f in files] if files else [sys.stdin]
+    for stream in streams:
+        for line in stream:
+            m = SPAN_RE.search(line)
+            if m:
+                span = m.groupdict()
+                span["face"] = int(span["face"])
+                span["ts"] = int(span["ts"])
+                traces[span["trace"]].append(span)
+    for spans in traces.values():
+        spans.sort(key=lambda s: s["ts"])
+    return traces
+
+
+def first(spans, node, events, after=0):
+    for s in spans:
+        if s["node"] == node and s["event"] in events and s["ts"] >= after:
+            return s
+    return None
+
+
+def build_tree(spans):
+    """Associa cada chegada de interesse ao nó que o encaminhou mais recentemente."""
+    parent = {}
+    origin = next((s["node"] for s in spans if s["event"] == "retrieve"), None)
+    for s in spans:
+        if s["event"] not in ARRIVAL_EVENTS or s["node"] in parent:
+            continue
+        candidates = [f for f in spans if f["event"] in FORWARD_EVENTS
+                      and f["node"] != s["node"] and f["ts"] <= s["ts"]
+                      and (f["node"] == origin or f["node"] in parent)]
+        if candidates:
+            parent[s["node"]] = candidates[-1]["node"]
+    return origin, parent
+
+
+def analyse(spans):
+    origin, parent = build_tree(spans)
+    # Caminho até ao nó que respondeu (ou, sem resposta, até ao primeiro sem rota)
+    hit = (next((s for s in spans if s["event"] in HIT_EVENTS), None)
+           or next((s for s in spans if s["event"] == "no_route"), None))
+
+    path = []
+    if hit is not None:
+        n = hit["node"]
+        path.append(n)
+        while n in parent and n != origin and len(path) <= len(parent) + 1:
+            n = parent[n]
+            path.append(n)
+        path.reverse()
+
+    hops = []
+    for down, up in zip(path, path[1:]):
+        fwd = first(spans, down, FORWARD_EVENTS)
+        arr = first(spans, up, ARRIVAL_EVENTS)
+        leave = first(spans, up, FORWARD_EVENTS | HIT_EVENTS | {"no_route"}, arr["ts"] if arr else 0)
+        back = first(spans, down, {"object", "noobject"}, fwd["ts"] if fwd else 0)
+        hops.append({
+            "from": down,
+            "to": up,
+            "link_ms": (arr["ts"] - fwd["ts"]) / 1e6 if fwd and arr else None,
+            "residence_ms": (leave["ts"] - arr["ts"]) / 1e6 if arr and leave else None,
+            "wait_ms": (back["ts"] - fwd["ts"]) / 1e6 if fwd and back else None,
+        })
+
+    end = next((s for s in spans if s["event"] in ("complete", "failed") and s["node"] == origin), None)
+    start = next((s for s in spans if s["event"] == "retrieve"), None)
+    total = (end["ts"] - start["ts"]) / 1e6 if start and end else None
+    outcome = end["event"] if end else "incomplete"
+    return {"origin": origin, "path": path, "hops": hops, "total_ms": total, "outcome": outcome}
+
+
+def fmt(ms):
+    return "      -" if ms is None else "%7.3f" % ms
+
+
+def print_trace(trace_id, spans, result):
+    t0 = spans[0]["ts"]
+    name = spans[0]["name"]
+    print("trace %s  name=%s  %s  total %s ms" % (trace_id, name, result["outcome"], fmt(result["total_ms"]).strip()))
+    for s in spans:
+        print("  +%9.3f ms  %-21s %-12s face=%d" % ((s["ts"] - t0) / 1e6, s["node"], s["event"], s["face"]))
+    if result["path"]:
+        print("  path: %s" % " -> ".join(result["path"]))
+        print("  %-21s %-21s %9s %9s %9s" % ("from", "to", "link ms", "node ms", "wait ms"))
+        for h in result["hops"]:
+            print("  %-21s %-21s %9s %9s %9s" % (h["from"], h["to"], fmt(h["link_ms"]),
+                                                fmt(h["residence_ms"]), fmt(h["wait_ms"])))
+    print()
+
+
+def print_summary(results):
+    per_hop = defaultdict(lambda: defaultdict(list))
+    for r in results:
+        for h in r["hops"]:
+            for key in ("link_ms", "residence_ms", "wait_ms"):
+                if h[key] is not None:
+                    per_hop[(h["from"], h["to"])][key].append(h[key])
+
+    def median(values):
+        values = sorted(values)
+        return values[len(values) // 2] if values else None
+
+    totals = [r["total_ms"] for r in results if r["total_ms"] is not None]
+    print("%d trace(s), %d complete, median total %s ms" %
+          (len(results), sum(r["outcome"] == "complete" for r in results), fmt(median(totals)).strip()))
+    print("%-21s %-21s %5s %9s %9s %9s" % ("from", "to", "n", "link ms", "node ms", "wait ms"))
+    for (down, up), values in sorted(per_hop.items()):
+        print("%-21s %-21s %5d %9s %9s %9s" % (down, up, len(values["wait_ms"]) or len(values["link_ms"]),
+                                              fmt(median(values["link_ms"])),
+                                              fmt(median(values["residence_ms"])),
+                                              fmt(median(values["wait_ms"]))))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Reconstruct traced NDN requests from node logs.")
+    parser.add_argument("files", nargs="*", help="log files (default: stdin)")
+    parser.add_argument("--trace", help="show only this trace id")
+    parser.add_argument("--summary", action="store_true", help="print only the per-hop summary")
+    args = parser.parse_args()
+
+    traces = read_spans(args.files)
+    if args.trace:
+        traces = {k: v for k, v in traces.items() if k == args.trace.lower().zfill(16)}
+    if not traces:
+        print("No SPAN records found (enable sampling on the requesting node with 'trace <rate>')")
+        return 1
+
+    results = []
+    for trace_id, spans in sorted(traces.items(), key=lambda kv: kv[1][0]["ts"]):
+        result = analyse(spans)
+        results.append(result)
+        if not args.summary:
+            print_trace(trace_id, spans, result)
+    print_summary(results)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,547 @@
+/**
+ * @file wire.c
+ * @brief Implementação do formato binário (TLV) das mensagens com nome
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a codificação e descodificação dos varints, das
+ * tramas INTEREST, OBJECT e NOOBJECT (simples e agrupadas) e das tabelas de
+ * nomes descritas em wire.h.
+ */
+
+#include "wire.h"
+#include <string.h>
+
+/**
+ * @brief Indica se um nome pode seguir numa trama.
+ *
+ * Os nomes não podem ter espaços nem caracteres de controlo, para poderem
+ * ser reencaminhados em texto a vizinhos que não aceitam o formato binário.
+ */
+static int valid_name(const char *name, size_t len) {
+    if (len == 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if ((unsigned char)name[i] <= ' ' || name[i] == 0x7f) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+size_t wire_put_varint(unsigned char *out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+int wire_get_varint(const unsigned char *data, size_t len, uint64_t *value) {
+    uint64_t result = 0;
+    for (size_t i = 0; i < WIRE_VARINT_MAX; i++) {
+        if (i == len) {
+            return 0;
+        }
+        result |= (uint64_t)(data[i] & 0x7f) << (7 * i);
+        if ((data[i] & 0x80) == 0) {
+            *value = result;
+            return (int)i + 1;
+        }
+    }
+    return -1;
+}
+
+ssize_t wire_frame_size(const char *data, size_t len, size_t max_frame) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t type, value_len;
+
+    int n = wire_get_varint(p, len, &type);
+    if (n <= 0) {
+        return n;
+    }
+    if (type >= WIRE_TYPE_LIMIT || !wire_is_frame((unsigned char)type)) {
+        return -1;
+    }
+    int m = wire_get_varint(p + n, len - (size_t)n, &value_len);
+    if (m <= 0) {
+        return m;
+    }
+    if (value_len > max_frame || (size_t)(n + m) + value_len > max_frame) {
+        return -1;
+    }
+    return (ssize_t)((size_t)(n + m) + value_len);
+}
+
+/**
+ * @brief Hash FNV-1a de um nome, guardado em cada slot da tabela.
+ */
+static uint32_t name_hash(const char *name, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Procura um nome na tabela.
+ *
+ * @return Slot do nome, ou -1 se não estiver na tabela
+ */
+static int dict_find(const WireDict *dict, const char *name, size_t len, uint32_t hash) {
+    for (unsigned i = 0; i < dict->slots; i++) {
+        if (dict->hash[i] == hash && dict->len[i] == len && memcmp(dict->names[i], name, len) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static void dict_store(WireDict *dict, unsigned slot, const char *name, size_t len, uint32_t hash) {
+    memmove(dict->names[slot], name, len);
+    dict->len[slot] = (uint8_t)len;
+    dict->hash[slot] = hash;
+}
+
+void wire_dict_reset(WireDict *dict, unsigned slots) {
+    memset(dict, 0, sizeof(*dict));
+    dict->slots = slots < WIRE_DICT_SLOTS ? slots : WIRE_DICT_SLOTS;
+}
+
+/**
+ * @brief Forma escolhida para um nome, antes de ser escrita.
+ *
+ * A tabela só é alterada em name_commit, depois de se saber que o nome
+ * cabe na trama.
+ */
+typedef struct {
+    unsigned char head[4 * WIRE_VARINT_MAX + 1];    /* Slot a guardar e referência ou comprimento */
+    size_t head_len;
+    uint8_t flags;                      /* WIRE_FLAG_NAME_* */
+    const char *literal;                /* Parte do nome que segue por extenso */
+    size_t literal_len;
+    WireNameForm form;
+    int store;                          /* Slot onde o recetor guarda o nome, -1 se nenhum */
+    uint32_t hash;
+} NameCode;
+
+/**
+ * @brief Escolhe a forma de um nome: referência, prefixo mais sufixo ou por extenso.
+ */
+static void name_encode(const WireDict *dict, const char *name, size_t name_len, NameCode *code) {
+    code->head_len = 0;
+    code->flags = 0;
+    code->literal = name;
+    code->literal_len = name_len;
+    code->form = WIRE_NAME_LITERAL;
+    code->store = -1;
+    code->hash = 0;
+
+    if (dict == NULL || dict->slots == 0 || name_len >= WIRE_DICT_NAME) {
+        code->head_len = wire_put_varint(code->head, name_len);
+        return;
+    }
+
+    code->hash = name_hash(name, name_len);
+    int slot = dict_find(dict, name, name_len, code->hash);
+    if (slot >= 0) {
+        code->flags = WIRE_FLAG_NAME_INDEXED;
+        code->head_len = wire_put_varint(code->head, (uint64_t)slot);
+        code->head[code->head_len++] = (unsigned char)code->hash;
+        code->literal_len = 0;
+        code->form = WIRE_NAME_INDEXED;
+        return;
+    }
+
+    code->store = (int)dict->next;
+    code->flags = WIRE_FLAG_NAME_STORE;
+    code->head_len = wire_put_varint(code->head, (uint64_t)code->store);
+
+    /* Prefixo comum com os nomes guardados mais recentemente (segmentos do mesmo conteúdo) */
+    size_t prefix = 0;
+    int ref = -1;
+    for (unsigned k = 1; k <= WIRE_DICT_CANDIDATES && k < dict->slots; k++) {
+        unsigned c = (dict->next + dict->slots - k) % dict->slots;
+        size_t common = 0;
+        while (common < dict->len[c] && common < name_len && dict->names[c][common] == name[common]) {
+            common++;
+        }
+        if (common > prefix) {
+            prefix = common;
+            ref = (int)c;
+        }
+    }
+    if (prefix >= WIRE_DICT_MIN_PREFIX) {
+        code->flags |= WIRE_FLAG_NAME_PREFIX;
+        code->head_len += wire_put_varint(code->head + code->head_len, (uint64_t)ref);
+        code->head[code->head_len++] = (unsigned char)dict->hash[ref];
+        code->head_len += wire_put_varint(code->head + code->head_len, prefix);
+        code->head_len += wire_put_varint(code->head + code->head_len, name_len - prefix);
+        code->literal = name + prefix;
+        code->literal_len = name_len - prefix;
+        code->form = WIRE_NAME_PREFIX;
+    } else {
+        code->head_len += wire_put_varint(code->head + code->head_len, name_len);
+    }
+}
+
+/**
+ * @brief Atualiza a tabela do emissor depois de o nome ter sido escrito.
+ */
+static void name_commit(WireDict *dict, const NameCode *code, const char *name, size_t name_len) {
+    if (code->store >= 0) {
+        dict_store(dict, (unsigned)code->store, name, name_len, code->hash);
+        dict->next = (dict->next + 1) % dict->slots;
+    }
+}
+
+/**
+ * @brief Escreve um nome já codificado.
+ *
+ * @return Posição seguinte em out
+ */
+static char *name_write(char *out, const NameCode *code) {
+    memcpy(out, code->head, code->head_len);
+    out += code->head_len;
+    memcpy(out, code->literal, code->literal_len);
+    return out + code->literal_len;
+}
+
+/**
+ * @brief Escreve o cabeçalho de uma trama com tipo e comprimento do valor.
+ *
+ * @return Bytes do cabeçalho, ou 0 se a trama não couber em size
+ */
+static size_t frame_header(unsigned char *header, unsigned type, size_t value_len, size_t size) {
+    size_t len = wire_put_varint(header, type);
+    len += wire_put_varint(header + len, value_len);
+    return len + value_len > size ? 0 : len;
+}
+
+#define VALUE_START_MAX (1 + 8 + WIRE_VARINT_MAX)    /* Flags, rastreio e tempo de vida */
+
+/**
+ * @brief Escreve as flags, o identificador de rastreio e o tempo de vida no início do valor.
+ *
+ * @param out Destino, com pelo menos VALUE_START_MAX bytes
+ * @return Bytes escritos
+ */
+static size_t value_start(unsigned char *out, uint8_t flags, uint64_t trace_id, uint32_t lifetime_ms) {
+    size_t len = 0;
+    out[len++] = flags | (trace_id != 0 ? WIRE_FLAG_TRACE : 0) | (lifetime_ms != 0 ? WIRE_FLAG_LIFETIME : 0);
+    if (trace_id != 0) {
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            out[len++] = (unsigned char)(trace_id >> shift);
+        }
+    }
+    if (lifetime_ms != 0) {
+        len += wire_put_varint(out + len, lifetime_ms);
+    }
+    return len;
+}
+
+ssize_t wire_encode(char *out, size_t size, unsigned type, const char *name, uint64_t trace_id,
+                    uint32_t lifetime_ms, const char *payload, size_t payload_len, WireDict *dict,
+                    WireNameForm *form) {
+    size_t name_len = strlen(name);
+    if (!valid_name(name, name_len) || wire_type_name(type) == NULL) {
+        return -1;
+    }
+
+    NameCode code;
+    name_encode(dict, name, name_len, &code);
+    unsigned char start[VALUE_START_MAX];
+    size_t start_len = value_start(start, code.flags, trace_id, lifetime_ms);
+    size_t value_len = start_len + code.head_len + code.literal_len + payload_len;
+
+    unsigned char header[2 * WIRE_VARINT_MAX];
+    size_t header_len = frame_header(header, type, value_len, size);
+    if (header_len == 0) {
+        return -1;
+    }
+
+    char *p = out;
+    memcpy(p, header, header_len);
+    p += header_len;
+    memcpy(p, start, start_len);
+    p += start_len;
+    p = name_write(p, &code);
+    if (payload_len > 0) {
+        memcpy(p, payload, payload_len);
+        p += payload_len;
+    }
+
+    /* Só depois de a trama estar completa, para a tabela acompanhar a do recetor */
+    name_commit(dict, &code, name, name_len);
+    if (form != NULL) {
+        *form = code.form;
+    }
+    return p - out;
+}
+
+ssize_t wire_encode_batch(char *out, size_t size, unsigned type, const char *const *names, size_t count,
+                          uint64_t trace_id, uint32_t lifetime_ms, WireDict *dict, size_t *encoded,
+                          unsigned *forms) {
+    if (wire_type_name(type) == NULL || count == 0) {
+        return -1;
+    }
+    if (count > WIRE_BATCH_MAX) {
+        count = WIRE_BATCH_MAX;
+    }
+
+    /* O valor é escrito depois do maior cabeçalho possível e deslocado no fim */
+    unsigned char header[2 * WIRE_VARINT_MAX];
+    size_t header_max = wire_put_varint(header, WIRE_BATCH_TYPE(type)) + wire_put_varint(header, size);
+    if (size <= header_max + VALUE_START_MAX + WIRE_VARINT_MAX) {
+        return -1;
+    }
+    char *value = out + header_max;
+    size_t room = size - header_max;
+    size_t len = value_start((unsigned char *)value, 0, trace_id, lifetime_ms);
+    unsigned char count_field[WIRE_VARINT_MAX];
+    size_t count_len = wire_put_varint(count_field, count);
+    size_t count_at = len;
+    len += count_len;
+
+    size_t done = 0;
+    for (; done < count; done++) {
+        size_t name_len = strlen(names[done]);
+        if (!valid_name(names[done], name_len)) {
+            break;
+        }
+        NameCode code;
+        name_encode(dict, names[done], name_len, &code);
+        if (len + 1 + code.head_len + code.literal_len > room) {
+            break;
+        }
+        value[len++] = (char)code.flags;
+        len = (size_t)(name_write(value + len, &code) - value);
+        name_commit(dict, &code, names[done], name_len);
+        if (forms != NULL) {
+            forms[code.form]++;
+        }
+    }
+    if (done == 0) {
+        return -1;
+    }
+
+    /* O número de nomes escritos tem o mesmo tamanho que o pedido (ou menos) */
+    size_t done_len = wire_put_varint(count_field, done);
+    memmove(value + count_at + done_len, value + count_at + count_len, len - count_at - count_len);
+    memcpy(value + count_at, count_field, done_len);
+    len -= count_len - done_len;
+
+    size_t header_len = frame_header(header, WIRE_BATCH_TYPE(type), len, size);
+    memmove(out + header_len, value, len);
+    memcpy(out, header, header_len);
+    *encoded = done;
+    return (ssize_t)(header_len + len);
+}
+
+/**
+ * @brief Lê o cabeçalho de uma trama completa e as flags, o rastreio e o tempo de vida do valor.
+ *
+ * @return Bytes da trama, 0 se estiver incompleta, -1 se for inválida
+ */
+static ssize_t frame_open(const char *data, size_t len, size_t max_frame, unsigned *type, uint8_t *flags,
+                          uint64_t *trace_id, uint32_t *lifetime_ms, const unsigned char **value,
+                          const unsigned char **end) {
+    ssize_t frame_len = wire_frame_size(data, len, max_frame);
+    if (frame_len <= 0 || (size_t)frame_len > len) {
+        return frame_len < 0 ? -1 : 0;
+    }
+
+    /* O cabeçalho já foi validado: tipo e comprimento ocupam os primeiros bytes */
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t t = 0, value_len = 0;
+    int n = wire_get_varint(p, len, &t);
+    n += wire_get_varint(p + n, len - (size_t)n, &value_len);
+    *value = p + n;
+    *end = *value + value_len;
+    if (*value == *end) {
+        return -1;
+    }
+    *type = (unsigned)t;
+    *flags = *(*value)++;
+    *trace_id = 0;
+    if (*flags & WIRE_FLAG_TRACE) {
+        if (*end - *value < 8) {
+            return -1;
+        }
+        for (int i = 0; i < 8; i++) {
+            *trace_id = (*trace_id << 8) | (*value)[i];
+        }
+        *value += 8;
+    }
+    *lifetime_ms = 0;
+    if (*flags & WIRE_FLAG_LIFETIME) {
+        uint64_t lifetime;
+        int m = wire_get_varint(*value, (size_t)(*end - *value), &lifetime);
+        if (m <= 0 || lifetime == 0 || lifetime > UINT32_MAX) {
+            return -1;
+        }
+        *lifetime_ms = (uint32_t)lifetime;
+        *value += m;
+    }
+    return frame_len;
+}
+
+/**
+ * @brief Lê um nome codificado com as flags WIRE_FLAG_NAME_* e guarda-o na tabela se pedido.
+ *
+ * @param flags Flags do nome
+ * @param value Posição do nome, avançada para depois dele
+ * @param end Fim do valor
+ * @param dict Tabela de nomes (NULL: nomes comprimidos são inválidos)
+ * @param name Nome lido (em dict, em buffer ou nos dados)
+ * @param name_len Comprimento do nome
+ * @param buffer Buffer para nomes reconstruídos a partir de um prefixo
+ * @return 0, -1 se o nome for inválido, WIRE_DICT_MISMATCH se a tabela não corresponder
+ */
+static int name_decode(uint8_t flags, const unsigned char **value, const unsigned char *end, WireDict *dict,
+                       const char **name, size_t *name_len, char *buffer, WireNameForm *form) {
+    const unsigned char *v = *value;
+    uint64_t slot, len;
+    int m;
+    int store = -1;
+
+    if (flags & WIRE_FLAG_NAME_STORE) {
+        m = wire_get_varint(v, (size_t)(end - v), &slot);
+        if (dict == NULL || m <= 0 || slot >= WIRE_DICT_SLOTS) {
+            return -1;
+        }
+        v += m;
+        store = (int)slot;
+    }
+
+    if (flags & (WIRE_FLAG_NAME_INDEXED | WIRE_FLAG_NAME_PREFIX)) {
+        m = wire_get_varint(v, (size_t)(end - v), &slot);
+        if (dict == NULL || m <= 0 || slot >= WIRE_DICT_SLOTS || end - v - m < 1) {
+            return -1;
+        }
+        if (dict->len[slot] == 0 || (unsigned char)dict->hash[slot] != v[m]) {
+            return WIRE_DICT_MISMATCH;
+        }
+        v += m + 1;
+
+        if (flags & WIRE_FLAG_NAME_INDEXED) {
+            *name = dict->names[slot];
+            *name_len = dict->len[slot];
+            *form = WIRE_NAME_INDEXED;
+        } else {
+            uint64_t prefix, suffix;
+            m = wire_get_varint(v, (size_t)(end - v), &prefix);
+            if (m <= 0) {
+                return -1;
+            }
+            v += m;
+            m = wire_get_varint(v, (size_t)(end - v), &suffix);
+            if (m <= 0 || prefix > dict->len[slot] || prefix + suffix >= WIRE_DICT_NAME ||
+                suffix > (uint64_t)(end - v - m)) {
+                return -1;
+            }
+            v += m;
+            memcpy(buffer, dict->names[slot], (size_t)prefix);
+            memcpy(buffer + prefix, v, (size_t)suffix);
+            v += suffix;
+            *name = buffer;
+            *name_len = (size_t)(prefix + suffix);
+            *form = WIRE_NAME_PREFIX;
+        }
+    } else {
+        m = wire_get_varint(v, (size_t)(end - v), &len);
+        if (m <= 0 || len > (uint64_t)(end - v - m)) {
+            return -1;
+        }
+        v += m;
+        *name = (const char *)v;
+        *name_len = (size_t)len;
+        *form = WIRE_NAME_LITERAL;
+        v += len;
+    }
+
+    if (!valid_name(*name, *name_len) || (store >= 0 && *name_len >= WIRE_DICT_NAME)) {
+        return -1;
+    }
+    if (store >= 0) {
+        dict_store(dict, (unsigned)store, *name, *name_len, name_hash(*name, *name_len));
+    }
+    *value = v;
+    return 0;
+}
+
+ssize_t wire_decode(const char *data, size_t len, size_t max_frame, WireFrame *frame, WireDict *dict) {
+    const unsigned char *value, *end;
+    ssize_t frame_len = frame_open(data, len, max_frame, &frame->type, &frame->flags, &frame->trace_id,
+                                   &frame->lifetime_ms, &value, &end);
+    if (frame_len <= 0) {
+        return frame_len;
+    }
+    if (wire_type_name(frame->type) == NULL) {
+        return -1;
+    }
+
+    int rc = name_decode(frame->flags, &value, end, dict, &frame->name, &frame->name_len,
+                         frame->name_buffer, &frame->name_form);
+    if (rc < 0) {
+        return rc;
+    }
+    frame->payload = (const char *)value;
+    frame->payload_len = (size_t)(end - value);
+    return frame_len;
+}
+
+ssize_t wire_decode_batch(const char *data, size_t len, size_t max_frame, WireBatch *batch, WireDict *dict) {
+    const unsigned char *value, *end;
+    uint64_t count;
+    ssize_t frame_len = frame_open(data, len, max_frame, &batch->type, &batch->flags, &batch->trace_id,
+                                   &batch->lifetime_ms, &value, &end);
+    if (frame_len <= 0) {
+        return frame_len;
+    }
+    if (!wire_is_batch(batch->type)) {
+        return -1;
+    }
+    batch->type = WIRE_BATCH_SINGLE(batch->type);
+
+    int m = wire_get_varint(value, (size_t)(end - value), &count);
+    if (m <= 0 || count == 0 || count > WIRE_BATCH_MAX) {
+        return -1;
+    }
+    value += m;
+
+    /* Os nomes são copiados: um nome seguinte pode substituir o slot de um anterior */
+    char prefixed[WIRE_DICT_NAME];
+    for (batch->count = 0; batch->count < count; batch->count++) {
+        const char *name;
+        size_t name_len;
+        WireNameForm form;
+        if (value == end) {
+            return -1;
+        }
+        uint8_t flags = *value++;
+        int rc = name_decode(flags, &value, end, dict, &name, &name_len, prefixed, &form);
+        if (rc < 0) {
+            return rc;
+        }
+        if (name_len >= WIRE_DICT_NAME) {
+            return -1;
+        }
+        memcpy(batch->names[batch->count], name, name_len);
+        batch->names[batch->count][name_len] = '\0';
+    }
+    return value == end ? frame_len : -1;
+}
+
+const char *wire_type_name(unsigned type) {
+    switch (type) {
+        case WIRE_INTEREST: return "INTEREST";
+        case WIRE_OBJECT: return "OBJECT";
+        case WIRE_NOOBJECT: return "NOOBJECT";
+        default: return NULL;
+    }
+}
@@ -0,0 +1,277 @@
+/**
+ * @file wire.h
+ * @brief Formato binário (TLV) das mensagens INTEREST, OBJECT e NOOBJECT
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro define a alternativa binária às mensagens de texto
+ * terminadas em '\n'. Cada trama é:
+ *
+ *   tipo (varint) | comprimento do valor (varint) | valor
+ *
+ * e o valor das mensagens com nome é:
+ *
+ *   flags (1 byte) | [trace id, 8 bytes big-endian, se WIRE_FLAG_TRACE]
+ *   | [tempo de vida em ms (varint), se WIRE_FLAG_LIFETIME]
+ *   | comprimento do nome (varint) | nome | carga (o resto do valor)
+ *
+ * Os varints usam 7 bits por byte, do menos para o mais significativo,
+ * com o bit 0x80 a indicar que há mais bytes. Os tipos são menores do que
+ * 0x20 e diferentes de '\n' e '\r', pelo que o primeiro byte de uma trama
+ * nunca começa uma mensagem de texto: o recetor distingue os dois formatos
+ * mensagem a mensagem, e uma ligação pode misturá-los.
+ *
+ * O formato é negociado no ENTRY e no SAFE como a capacidade "wire=tlv"
+ * (caps.h). Um nó só envia tramas binárias a um vizinho que a anunciou;
+ * aos restantes continua a enviar texto. O tempo de vida de um INTEREST só
+ * segue numa trama para vizinhos com a capacidade "lifetime=ms"; em texto
+ * segue no campo opcional " lifetime=<ms>", que os nós antigos ignoram.
+ *
+ * Compressão de nomes: cada sentido de uma ligação pode ter uma tabela de
+ * WIRE_DICT_SLOTS nomes recentes, mantida igual nos dois extremos (como a
+ * tabela dinâmica do HPACK). Em vez de "comprimento | nome", o nome pode
+ * seguir como:
+ *
+ *   WIRE_FLAG_NAME_INDEXED: slot (varint) | verificação (1 byte)
+ *   WIRE_FLAG_NAME_PREFIX:  slot | verificação | comprimento do prefixo (varint)
+ *                           | comprimento do sufixo (varint) | sufixo
+ *
+ * em que o nome é o do slot, ou o início dele seguido do sufixo. Com
+ * WIRE_FLAG_NAME_STORE, o valor tem antes do nome o slot (varint) onde o
+ * recetor o guarda; o emissor escolhe os slots por ordem (FIFO). O byte de
+ * verificação (os 8 bits baixos do hash do nome) deteta tabelas
+ * dessincronizadas, por exemplo quando o ndn-netem descarta uma trama.
+ * Um nó anuncia a sua tabela com a capacidade "dict=<slots>", e só recebe
+ * nomes comprimidos de vizinhos a quem a anunciou. Quando deteta
+ * uma tabela dessincronizada, esvazia-a e envia a linha de texto
+ * "DICT <slots>" (WIRE_DICT_RESET), e o emissor recomeça a sua.
+ *
+ * Tramas agrupadas: os tipos WIRE_BATCH_TYPE(t) levam vários nomes do mesmo
+ * tipo t numa só trama, para quem pede ou devolve muitos objetos pequenos:
+ *
+ *   flags | [trace] | [tempo de vida] | número de nomes (varint) | nomes
+ *
+ * em que cada nome é "flags do nome (1 byte) | nome", com as flags
+ * WIRE_FLAG_NAME_* e a mesma codificação das tramas simples. Os nomes são
+ * lidos por ordem, pelo que um nome pode referir o slot guardado por um
+ * nome anterior da mesma trama. Só se enviam tramas agrupadas a vizinhos
+ * que anunciaram a capacidade "batch=<nomes>".
+ *
+ * Este módulo não depende do estado do nó, para poder ser usado também
+ * pelas ferramentas (ndn-netem, ndn-replay, ...).
+ */
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#define WIRE_INTEREST 0x01
+#define WIRE_OBJECT 0x02
+#define WIRE_NOOBJECT 0x03
+#define WIRE_INTEREST_BATCH 0x04
+#define WIRE_OBJECT_BATCH 0x05
+#define WIRE_NOOBJECT_BATCH 0x06
+#define WIRE_TYPE_LIMIT 0x20            /* Tipos válidos: 1 a 0x1f, exceto '\n' e '\r' */
+
+#define WIRE_BATCH_TYPE(type) ((type) + 3)      /* Tipo agrupado de um tipo simples */
+#define WIRE_BATCH_SINGLE(type) ((type) - 3)    /* Tipo simples de um tipo agrupado */
+#define WIRE_BATCH_MAX 32               /* Nomes numa trama agrupada */
+
+#define WIRE_FLAG_TRACE 0x01            /* O valor inclui o identificador de rastreio */
+#define WIRE_FLAG_NAME_STORE 0x02       /* O recetor guarda o nome no slot indicado */
+#define WIRE_FLAG_NAME_INDEXED 0x04     /* O nome é o de um slot da tabela */
+#define WIRE_FLAG_NAME_PREFIX 0x08      /* O nome é o início do nome de um slot mais um sufixo */
+#define WIRE_FLAG_LIFETIME 0x10         /* O valor inclui o tempo de vida do interesse */
+
+#define WIRE_DICT_RESET "DICT"          /* Mensagem que pede ao emissor para recomeçar a tabela */
+#define WIRE_VARINT_MAX 10              /* Bytes de um varint de 64 bits */
+
+#define WIRE_DICT_SLOTS 64              /* Nomes guardados por sentido de uma ligação */
+#define WIRE_DICT_NAME 128              /* Nomes maiores não são guardados */
+#define WIRE_DICT_CANDIDATES 4          /* Nomes mais recentes onde se procura um prefixo comum */
+#define WIRE_DICT_MIN_PREFIX 4          /* Menor prefixo que compensa uma referência */
+#define WIRE_DICT_MISMATCH -2           /* wire_decode: referência a um slot que não corresponde */
+
+/**
+ * @brief Forma como o nome seguiu numa trama.
+ */
+typedef enum {
+    WIRE_NAME_LITERAL = 0,              /* Nome completo */
+    WIRE_NAME_INDEXED,                  /* Referência a um slot */
+    WIRE_NAME_PREFIX                    /* Referência a um slot mais um sufixo */
+} WireNameForm;
+
+/**
+ * @brief Tabela de nomes de um sentido de uma ligação.
+ *
+ * Uma tabela a zeros está vazia; slots indica quantos slots o emissor
+ * pode usar (o número anunciado pelo recetor, até WIRE_DICT_SLOTS).
+ */
+typedef struct wire_dict {
+    unsigned slots;
+    unsigned next;                      /* Próximo slot a substituir */
+    uint32_t hash[WIRE_DICT_SLOTS];
+    uint8_t len[WIRE_DICT_SLOTS];       /* 0 = slot vazio */
+    char names[WIRE_DICT_SLOTS][WIRE_DICT_NAME];
+} WireDict;
+
+/**
+ * @brief Uma trama descodificada. name e payload apontam para o buffer de origem.
+ */
+typedef struct wire_frame {
+    unsigned type;                      /* WIRE_INTEREST, WIRE_OBJECT ou WIRE_NOOBJECT */
+    uint8_t flags;
+    uint64_t trace_id;                  /* 0 se a trama não tiver WIRE_FLAG_TRACE */
+    uint32_t lifetime_ms;               /* 0 se a trama não tiver WIRE_FLAG_LIFETIME */
+    const char *name;                   /* Sem '\0' final */
+    size_t name_len;
+    WireNameForm name_form;
+    const char *payload;                /* Conteúdo do objeto (vazio nas mensagens atuais) */
+    size_t payload_len;
+    char name_buffer[WIRE_DICT_NAME];   /* Nome reconstruído a partir de um prefixo */
+} WireFrame;
+
+/**
+ * @brief Uma trama agrupada descodificada. Os nomes são copiados e terminados em '\0'.
+ */
+typedef struct wire_batch {
+    unsigned type;                      /* Tipo simples: WIRE_INTEREST, WIRE_OBJECT ou WIRE_NOOBJECT */
+    uint8_t flags;
+    uint64_t trace_id;
+    uint32_t lifetime_ms;               /* Tempo de vida de todos os nomes (0 = não indicado) */
+    size_t count;
+    char names[WIRE_BATCH_MAX][WIRE_DICT_NAME];
+} WireBatch;
+
+/**
+ * @brief Indica se um byte pode começar uma trama binária.
+ *
+ * @param first Primeiro byte da mensagem
+ * @return 1 se for uma trama binária, 0 se for (ou puder ser) texto
+ */
+static inline int wire_is_frame(unsigned char first) {
+    return first != 0 && first < WIRE_TYPE_LIMIT && first != '\n' && first != '\r';
+}
+
+/**
+ * @brief Indica se um tipo de trama é agrupado.
+ */
+static inline int wire_is_batch(unsigned type) {
+    return type >= WIRE_INTEREST_BATCH && type <= WIRE_NOOBJECT_BATCH;
+}
+
+/**
+ * @brief Escreve um varint.
+ *
+ * @param out Destino, com pelo menos WIRE_VARINT_MAX bytes
+ * @param value Valor
+ * @return Número de bytes escritos
+ */
+size_t wire_put_varint(unsigned char *out, uint64_t value);
+
+/**
+ * @brief Lê um varint.
+ *
+ * @param data Dados
+ * @param len Bytes disponíveis
+ * @param value Valor lido
+ * @return Bytes consumidos, 0 se o varint estiver incompleto, -1 se for inválido
+ */
+int wire_get_varint(const unsigned char *data, size_t len, uint64_t *value);
+
+/**
+ * @brief Obtém o tamanho total da trama que começa em data.
+ *
+ * Só lê o tipo e o comprimento, pelo que serve para separar tramas sem as
+ * descodificar (por exemplo no ndn-netem).
+ *
+ * @param data Dados, a começar numa trama
+ * @param len Bytes disponíveis
+ * @param max_frame Maior trama aceite
+ * @return Bytes da trama, 0 se o cabeçalho ainda estiver incompleto, -1 se for inválido
+ */
+ssize_t wire_frame_size(const char *data, size_t len, size_t max_frame);
+
+/**
+ * @brief Codifica uma mensagem com nome numa trama.
+ *
+ * @param out Destino
+ * @param size Tamanho do destino
+ * @param type WIRE_INTEREST, WIRE_OBJECT ou WIRE_NOOBJECT
+ * @param name Nome do objeto
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
+ * @param lifetime_ms Tempo de vida do interesse (0 = não indicado)
+ * @param payload Carga (NULL se não houver)
+ * @param payload_len Bytes da carga
+ * @param dict Tabela de nomes deste sentido da ligação (NULL ou sem slots = nome completo)
+ * @param form Forma usada para o nome (pode ser NULL)
+ * @return Bytes da trama, ou -1 se não couber em size ou o nome for inválido
+ */
+ssize_t wire_encode(char *out, size_t size, unsigned type, const char *name, uint64_t trace_id,
+                    uint32_t lifetime_ms, const char *payload, size_t payload_len, WireDict *dict,
+                    WireNameForm *form);
+
+/**
+ * @brief Descodifica a trama que começa em data.
+ *
+ * @param data Dados, a começar numa trama
+ * @param len Bytes disponíveis
+ * @param max_frame Maior trama aceite
+ * @param frame Trama descodificada
+ * @param dict Tabela de nomes deste sentido da ligação (NULL: nomes comprimidos são inválidos)
+ * @return Bytes da trama, 0 se estiver incompleta, -1 se for inválida,
+ *         WIRE_DICT_MISMATCH se referir um slot que não corresponde ao da tabela
+ */
+ssize_t wire_decode(const char *data, size_t len, size_t max_frame, WireFrame *frame, WireDict *dict);
+
+/**
+ * @brief Codifica numa trama agrupada tantos nomes quantos couberem.
+ *
+ * @param out Destino
+ * @param size Tamanho do destino (maior trama a produzir)
+ * @param type Tipo simples: WIRE_INTEREST, WIRE_OBJECT ou WIRE_NOOBJECT
+ * @param names Nomes
+ * @param count Número de nomes (só se usam os primeiros WIRE_BATCH_MAX)
+ * @param trace_id Identificador de rastreio (0 = sem rastreio)
+ * @param lifetime_ms Tempo de vida de todos os nomes (0 = não indicado)
+ * @param dict Tabela de nomes deste sentido da ligação (pode ser NULL)
+ * @param encoded Número de nomes escritos, a partir do primeiro
+ * @param forms Contadores por WireNameForm a incrementar (pode ser NULL)
+ * @return Bytes da trama, ou -1 se nem o primeiro nome couber ou for inválido
+ */
+ssize_t wire_encode_batch(char *out, size_t size, unsigned type, const char *const *names, size_t count,
+                          uint64_t trace_id, uint32_t lifetime_ms, WireDict *dict, size_t *encoded,
+                          unsigned *forms);
+
+/**
+ * @brief Descodifica a trama agrupada que começa em data.
+ *
+ * @param data Dados, a começar numa trama
+ * @param len Bytes disponíveis
+ * @param max_frame Maior trama aceite
+ * @param batch Trama descodificada
+ * @param dict Tabela de nomes deste sentido da ligação (NULL: nomes comprimidos são inválidos)
+ * @return Como wire_decode
+ */
+ssize_t wire_decode_batch(const char *data, size_t len, size_t max_frame, WireBatch *batch, WireDict *dict);
+
+/**
+ * @brief Esvazia uma tabela de nomes e define os slots que o emissor pode usar.
+ *
+ * @param dict Tabela
+ * @param slots Slots anunciados pelo recetor (limitados a WIRE_DICT_SLOTS)
+ */
+void wire_dict_reset(WireDict *dict, unsigned slots);
+
+/**
+ * @brief Obtém o nome em texto de um tipo de trama simples.
+ *
+ * @param type Tipo de trama
+ * @return "INTEREST", "OBJECT", "NOOBJECT" ou NULL se o tipo for desconhecido
+ */
+const char *wire_type_name(unsigned type);
+
+#endif /* WIRE_H */
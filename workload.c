@@ -0,0 +1,535 @@
+/**
+ * @file workload.c
+ * @brief Implementação dos geradores de sequências de pedidos
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro contém a leitura das descrições dos geradores, a geração
+ * dos números de nome (Zipf por pesquisa binária na distribuição
+ * acumulada, com um xorshift64* por gerador) e a leitura de ficheiros de
+ * pedidos, de captura ou de texto.
+ */
+
+#include "workload.h"
+#include "capture.h"
+#include "wire.h"
+#include <math.h>
+
+#define WORKLOAD_MAX_KEY 16
+#define WL_DICT_FACES 16                /* Interfaces com tabela de nomes numa captura (ID + 1) */
+
+static const char *kind_names[] = {
+    [WL_UNIFORM] = "uniform",
+    [WL_ZIPF] = "zipf",
+    [WL_SHIFT] = "shift",
+    [WL_SCAN] = "scan",
+    [WL_SEGMENTS] = "segments",
+    [WL_SEQUENTIAL] = "seq",
+    [WL_TRACE] = "trace"
+};
+
+/**
+ * @brief Gera um número pseudoaleatório de 64 bits (xorshift64*).
+ */
+static uint64_t next_random(Workload *wl) {
+    wl->rng ^= wl->rng >> 12;
+    wl->rng ^= wl->rng << 25;
+    wl->rng ^= wl->rng >> 27;
+    return wl->rng * 0x2545f4914f6cdd1dull;
+}
+
+/**
+ * @brief Gera um número uniforme em [0, 1).
+ */
+static double next_uniform(Workload *wl) {
+    return (next_random(wl) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Escolhe uma posição de popularidade com a distribuição Zipf.
+ */
+static unsigned long zipf_rank(Workload *wl) {
+    double u = next_uniform(wl);
+    unsigned long lo = 0, hi = wl->cdf_size - 1;
+    while (lo < hi) {
+        unsigned long mid = (lo + hi) / 2;
+        if (wl->cdf[mid] < u) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Prepara a função de distribuição acumulada de Zipf com size posições.
+ */
+static int init_zipf(Workload *wl, unsigned long size) {
+    wl->cdf = malloc(size * sizeof(double));
+    if (wl->cdf == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    wl->cdf_size = size;
+    double sum = 0.0;
+    for (unsigned long k = 0; k < size; k++) {
+        sum += 1.0 / pow((double)(k + 1), wl->alpha);
+        wl->cdf[k] = sum;
+    }
+    for (unsigned long k = 0; k < size; k++) {
+        wl->cdf[k] /= sum;
+    }
+    return 0;
+}
+
+/**
+ * @brief Tabela de dispersão usada para numerar os nomes de um ficheiro.
+ */
+typedef struct name_table {
+    char **names;
+    unsigned long *ids;
+    size_t size;                    /* Potência de 2 */
+    size_t count;
+} NameTable;
+
+static uint64_t hash_name(const char *name) {
+    uint64_t h = 0xcbf29ce484222325ull;    /* FNV-1a */
+    for (; *name; name++) {
+        h = (h ^ (unsigned char)*name) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+/**
+ * @brief Devolve o número de um nome, atribuindo o seguinte se for novo.
+ *
+ * @return Número do nome, ou -1 se faltar memória
+ */
+static long intern_name(NameTable *table, const char *name) {
+    if ((table->count + 1) * 2 > table->size) {
+        size_t size = table->size ? table->size * 2 : 1024;
+        char **names = calloc(size, sizeof(char *));
+        unsigned long *ids = calloc(size, sizeof(unsigned long));
+        if (names == NULL || ids == NULL) {
+            free(names);
+            free(ids);
+            return -1;
+        }
+        for (size_t i = 0; i < table->size; i++) {
+            if (table->names[i] != NULL) {
+                size_t slot = hash_name(table->names[i]) & (size - 1);
+                while (names[slot] != NULL) {
+                    slot = (slot + 1) & (size - 1);
+                }
+                names[slot] = table->names[i];
+                ids[slot] = table->ids[i];
+            }
+        }
+        free(table->names);
+        free(table->ids);
+        table->names = names;
+        table->ids = ids;
+        table->size = size;
+    }
+
+    size_t slot = hash_name(name) & (table->size - 1);
+    while (table->names[slot] != NULL) {
+        if (strcmp(table->names[slot], name) == 0) {
+            return (long)table->ids[slot];
+        }
+        slot = (slot + 1) & (table->size - 1);
+    }
+    table->names[slot] = strdup(name);
+    if (table->names[slot] == NULL) {
+        return -1;
+    }
+    table->ids[slot] = table->count;
+    return (long)table->count++;
+}
+
+static void free_table(NameTable *table) {
+    for (size_t i = 0; i < table->size; i++) {
+        free(table->names[i]);
+    }
+    free(table->names);
+    free(table->ids);
+}
+
+/**
+ * @brief Acrescenta um nome à sequência lida de um ficheiro.
+ */
+static int append_trace(Workload *wl, NameTable *table, size_t *capacity, const char *name) {
+    long id = intern_name(table, name);
+    if (id < 0) {
+        return -1;
+    }
+    if (wl->trace_len == *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 4096;
+        unsigned long *trace = realloc(wl->trace, new_capacity * sizeof(unsigned long));
+        if (trace == NULL) {
+            return -1;
+        }
+        wl->trace = trace;
+        *capacity = new_capacity;
+    }
+    wl->trace[wl->trace_len++] = (unsigned long)id;
+    return 0;
+}
+
+/**
+ * @brief Lê a sequência de pedidos de um ficheiro.
+ *
+ * Um ficheiro de captura do nó (começa por CAPTURE_MAGIC) contribui com os
+ * INTEREST recebidos, em texto ou em trama binária simples ou agrupada; qualquer outro ficheiro é lido como texto, com um
+ * nome por linha ("INTEREST <nome>" também é aceite). As linhas vazias e
+ * as começadas por '#' são ignoradas.
+ */
+static int load_trace(Workload *wl) {
+    FILE *file = fopen(wl->trace_file, "rb");
+    if (file == NULL) {
+        perror(wl->trace_file);
+        return -1;
+    }
+    char magic[sizeof(((CaptureFileHeader *)0)->magic)] = {0};
+    int is_capture = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                     memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+
+    NameTable table = {0};
+    size_t capacity = 0;
+    int rc = 0;
+    char name[MAX_OBJECT_NAME + 1];
+
+    if (is_capture) {
+        static char data[CAPTURE_MAX_FRAME + 1];
+        CaptureReader reader;
+        CaptureRecord rec;
+        if (capture_open(&reader, wl->trace_file) < 0) {
+            return -1;
+        }
+        /* Tabelas de nomes das tramas recebidas, por interface */
+        static WireDict tables[WL_DICT_FACES];
+        for (int f = 0; f < WL_DICT_FACES; f++) {
+            wire_dict_reset(&tables[f], WIRE_DICT_SLOTS);
+        }
+        while ((rc = capture_next(&reader, &rec, data)) == 1) {
+            WireFrame frame;
+            WireDict *dict = rec.face + 1 >= 0 && rec.face + 1 < WL_DICT_FACES ? &tables[rec.face + 1] : NULL;
+            if (rec.direction != CAPTURE_IN) {
+                if (dict != NULL && rec.length > strlen(WIRE_DICT_RESET) && strncmp(data, WIRE_DICT_RESET " ", strlen(WIRE_DICT_RESET) + 1) == 0) {
+                    wire_dict_reset(dict, WIRE_DICT_SLOTS);
+                }
+                continue;
+            }
+            if (rec.length > 0 && wire_is_batch((unsigned char)data[0])) {
+                /* Trama agrupada: um pedido por nome */
+                static WireBatch batch;
+                if (wire_decode_batch(data, rec.length, CAPTURE_MAX_FRAME, &batch, dict) <= 0 ||
+                    batch.type != WIRE_INTEREST) {
+                    continue;
+                }
+                for (size_t i = 0; i < batch.count && rc >= 0; i++) {
+                    if (strlen(batch.names[i]) <= MAX_OBJECT_NAME &&
+                        append_trace(wl, &table, &capacity, batch.names[i]) < 0) {
+                        rc = -1;
+                    }
+                }
+                if (rc < 0) {
+                    break;
+                }
+                continue;
+            } else if (rec.length > 0 && wire_is_frame((unsigned char)data[0])) {
+                /* Trama binária (wire.h) */
+                if (wire_decode(data, rec.length, CAPTURE_MAX_FRAME, &frame, dict) <= 0 ||
+                    frame.type != WIRE_INTEREST || frame.name_len > MAX_OBJECT_NAME) {
+                    continue;
+                }
+                memcpy(name, frame.name, frame.name_len);
+                name[frame.name_len] = '\0';
+            } else if (sscanf(data, "INTEREST %100s", name) != 1) {
+                continue;
+            }
+            if (append_trace(wl, &table, &capacity, name) < 0) {
+                rc = -1;
+                break;
+            }
+        }
+        capture_close(&reader);
+    } else {
+        char line[512];
+        file = fopen(wl->trace_file, "r");
+        if (file == NULL) {
+            perror(wl->trace_file);
+            return -1;
+        }
+        while (fgets(line, sizeof(line), file) != NULL) {
+            char first[MAX_OBJECT_NAME + 1];
+            int fields = sscanf(line, "%100s %100s", first, name);
+            if (fields < 1 || first[0] == '#') {
+                continue;
+            }
+            const char *chosen = fields == 2 && strcmp(first, "INTEREST") == 0 ? name : first;
+            if (append_trace(wl, &table, &capacity, chosen) < 0) {
+                rc = -1;
+                break;
+            }
+        }
+        fclose(file);
+    }
+
+    wl->names = table.count;
+    free_table(&table);
+    if (rc < 0) {
+        fprintf(stderr, "%s: cannot read the request sequence\n", wl->trace_file);
+        return -1;
+    }
+    if (wl->trace_len == 0) {
+        fprintf(stderr, "%s: no requests found\n", wl->trace_file);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Lê um par "chave=valor" da descrição de um gerador.
+ */
+static int parse_option(Workload *wl, const char *key, const char *value) {
+    char *end;
+    if (strcmp(key, "file") == 0) {
+        if (strlen(value) >= sizeof(wl->trace_file)) {
+            return -1;
+        }
+        strcpy(wl->trace_file, value);
+        return 0;
+    }
+    double v = strtod(value, &end);
+    if (end == value || *end != '\0' || v < 0) {
+        return -1;
+    }
+    if (strcmp(key, "n") == 0) {
+        wl->names = (unsigned long)v;
+    } else if (strcmp(key, "a") == 0) {
+        wl->alpha = v;
+    } else if (strcmp(key, "every") == 0) {
+        wl->shift_every = (unsigned long)v;
+    } else if (strcmp(key, "by") == 0) {
+        wl->shift_by = (unsigned long)v;
+    } else if (strcmp(key, "p") == 0 && v <= 1.0) {
+        wl->scan_probability = v;
+    } else if (strcmp(key, "len") == 0) {
+        wl->run_length = (unsigned long)v;
+    } else if (strcmp(key, "s") == 0) {
+        wl->seed = (uint64_t)strtoull(value, NULL, 10);
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Prepara um gerador a partir da sua descrição.
+ *
+ * @param wl Gerador a inicializar
+ * @param spec Descrição ("zipf:n=1000,a=0.9", ...)
+ * @param default_names Número de nomes se a descrição não tiver n=
+ * @param default_alpha Expoente de Zipf se a descrição não tiver a=
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int workload_init(Workload *wl, const char *spec, unsigned long default_names, double default_alpha) {
+    memset(wl, 0, sizeof(*wl));
+    wl->names = default_names;
+    wl->alpha = default_alpha;
+    wl->shift_every = 10000;
+    wl->shift_by = 1;
+    wl->scan_probability = 0.001;
+    wl->run_length = 100;
+    wl->seed = WORKLOAD_DEFAULT_SEED;
+
+    size_t kind_len = strcspn(spec, ":");
+    int found = 0;
+    for (size_t k = 0; k < sizeof(kind_names) / sizeof(kind_names[0]); k++) {
+        if (strlen(kind_names[k]) == kind_len && strncmp(spec, kind_names[k], kind_len) == 0) {
+            wl->kind = (WorkloadKind)k;
+            found = 1;
+        }
+    }
+    if (!found) {
+        fprintf(stderr, "Unknown workload \"%.*s\" (uniform, zipf, shift, scan, segments, seq or trace)\n",
+                (int)kind_len, spec);
+        return -1;
+    }
+
+    const char *p = spec + kind_len;
+    while (*p == ':' || *p == ',') {
+        p++;
+        size_t len = strcspn(p, ",");
+        char option[sizeof(wl->trace_file) + WORKLOAD_MAX_KEY];
+        if (len >= sizeof(option)) {
+            fprintf(stderr, "Workload option too long: %.*s\n", (int)len, p);
+            return -1;
+        }
+        memcpy(option, p, len);
+        option[len] = '\0';
+        char *value = strchr(option, '=');
+        if (value != NULL) {
+            *value++ = '\0';
+        }
+        if (value == NULL || parse_option(wl, option, value) < 0) {
+            fprintf(stderr, "Invalid workload option: %s\n", option);
+            return -1;
+        }
+        p += len;
+    }
+
+    if (wl->kind == WL_TRACE) {
+        if (wl->trace_file[0] == '\0') {
+            fprintf(stderr, "The trace workload needs file=<path>\n");
+            return -1;
+        }
+        if (load_trace(wl) < 0) {
+            workload_free(wl);
+            return -1;
+        }
+    } else if (wl->names == 0 || wl->run_length == 0 ||
+               (wl->kind == WL_SEGMENTS && wl->names < wl->run_length)) {
+        fprintf(stderr, "Invalid workload: n must be at least 1 (and at least len for segments)\n");
+        return -1;
+    }
+
+    int rc = 0;
+    switch (wl->kind) {
+        case WL_ZIPF:
+        case WL_SHIFT:
+        case WL_SCAN:
+            rc = init_zipf(wl, wl->names);
+            break;
+        case WL_SEGMENTS:
+            /* Só conteúdos completos: names passa a múltiplo de len */
+            rc = init_zipf(wl, wl->names / wl->run_length);
+            wl->names = wl->cdf_size * wl->run_length;
+            break;
+        default:
+            break;
+    }
+    workload_rewind(wl);
+    return rc;
+}
+
+/**
+ * @brief Devolve o número do próximo nome da sequência.
+ *
+ * @param wl Gerador
+ * @return Número entre 0 e wl->names - 1
+ */
+unsigned long workload_next(Workload *wl) {
+    unsigned long id;
+    switch (wl->kind) {
+        case WL_ZIPF:
+            id = zipf_rank(wl);
+            break;
+        case WL_SHIFT:
+            if (wl->issued > 0 && wl->shift_every > 0 && wl->issued % wl->shift_every == 0) {
+                wl->offset = (wl->offset + wl->shift_by) % wl->names;
+            }
+            id = (zipf_rank(wl) + wl->offset) % wl->names;
+            break;
+        case WL_SCAN:
+            if (wl->run_left == 0 && next_uniform(wl) < wl->scan_probability) {
+                wl->run_next = next_random(wl) % wl->names;
+                wl->run_left = wl->run_length;
+            }
+            if (wl->run_left > 0) {
+                id = wl->run_next;
+                wl->run_next = (wl->run_next + 1) % wl->names;
+                wl->run_left--;
+            } else {
+                id = zipf_rank(wl);
+            }
+            break;
+        case WL_SEGMENTS:
+            if (wl->run_left == 0) {
+                wl->run_next = zipf_rank(wl) * wl->run_length;
+                wl->run_left = wl->run_length;
+            }
+            id = wl->run_next++;
+            wl->run_left--;
+            break;
+        case WL_SEQUENTIAL:
+            id = wl->issued % wl->names;
+            break;
+        case WL_TRACE:
+            id = wl->trace[wl->issued % wl->trace_len];
+            break;
+        default:
+            id = next_random(wl) % wl->names;
+            break;
+    }
+    wl->issued++;
+    return id;
+}
+
+/**
+ * @brief Recomeça a sequência do início (mesma semente).
+ *
+ * @param wl Gerador
+ */
+void workload_rewind(Workload *wl) {
+    wl->rng = (wl->seed + 1) * 0x9e3779b97f4a7c15ull;
+    if (wl->rng == 0) {
+        wl->rng = 0x2545f4914f6cdd1dull;
+    }
+    wl->issued = 0;
+    wl->offset = 0;
+    wl->run_next = 0;
+    wl->run_left = 0;
+}
+
+/**
+ * @brief Escreve uma descrição legível do gerador.
+ *
+ * @param wl Gerador
+ * @param buffer Buffer de destino
+ * @param size Tamanho do buffer
+ */
+void workload_describe(const Workload *wl, char *buffer, size_t size) {
+    switch (wl->kind) {
+        case WL_ZIPF:
+            snprintf(buffer, size, "zipf(%.2f) over %lu names", wl->alpha, wl->names);
+            break;
+        case WL_SHIFT:
+            snprintf(buffer, size, "zipf(%.2f) over %lu names, popularity shifted by %lu every %lu requests",
+                     wl->alpha, wl->names, wl->shift_by, wl->shift_every);
+            break;
+        case WL_SCAN:
+            snprintf(buffer, size, "zipf(%.2f) over %lu names with scans of %lu names (p=%g)",
+                     wl->alpha, wl->names, wl->run_length, wl->scan_probability);
+            break;
+        case WL_SEGMENTS:
+            snprintf(buffer, size, "zipf(%.2f) over %lu contents of %lu segments", wl->alpha,
+                     wl->cdf_size, wl->run_length);
+            break;
+        case WL_SEQUENTIAL:
+            snprintf(buffer, size, "seq over %lu names", wl->names);
+            break;
+        case WL_TRACE:
+            snprintf(buffer, size, "trace %s (%zu requests, %lu names)", wl->trace_file,
+                     wl->trace_len, wl->names);
+            break;
+        default:
+            snprintf(buffer, size, "uniform over %lu names", wl->names);
+            break;
+    }
+}
+
+/**
+ * @brief Liberta a memória de um gerador.
+ *
+ * @param wl Gerador
+ */
+void workload_free(Workload *wl) {
+    free(wl->cdf);
+    free(wl->trace);
+    wl->cdf = NULL;
+    wl->trace = NULL;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file workload.h
+ * @brief Geradores de sequências de pedidos para avaliar caches
+ * @author Bárbara Gonçalves Modesto e António Pedro Lima Loureiro Alves
+ * @date Outubro de 2026
+ *
+ * Este ficheiro define os geradores de sequências de nomes usados pelo
+ * ndn-loadgen, pelo ndn-sim e pelo ndn-workload. Um gerador devolve
+ * números de nome entre 0 e names - 1; cada ferramenta transforma-os no
+ * nome que pede (por exemplo "obj<k>" ou "o<k>"). Com a mesma descrição e
+ * a mesma semente, todas as ferramentas recebem a mesma sequência, o que
+ * permite comparar caches e topologias com exatamente os mesmos pedidos.
+ *
+ * Um gerador é descrito por "<tipo>[:chave=valor,...]":
+ *
+ * - uniform:n=N                        nomes equiprováveis
+ * - zipf:n=N,a=A                       Zipf com expoente A (k = 0 é o mais popular)
+ * - shift:n=N,a=A,every=R,by=B         Zipf cuja popularidade roda B posições a cada R pedidos
+ * - scan:n=N,a=A,p=P,len=L             Zipf interrompido, com probabilidade P por pedido,
+ *                                      por um varrimento de L nomes consecutivos
+ * - segments:n=N,a=A,len=L             conteúdos de L segmentos consecutivos; o conteúdo
+ *                                      é escolhido com Zipf e pedido do início ao fim
+ * - seq:n=N                            0, 1, ..., N - 1, 0, 1, ...
+ * - trace:file=F                       repetição de um ficheiro: captura do nó (INTEREST
+ *                                      recebidos) ou texto com um nome por linha
+ *
+ * Todos os tipos aceitam s=<semente>. Os nomes de um ficheiro são numerados
+ * pela ordem da primeira ocorrência; no fim do ficheiro a sequência recomeça.
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define WORKLOAD_DEFAULT_SEED 1
+
+/**
+ * @brief Tipos de gerador.
+ */
+typedef enum {
+    WL_UNIFORM = 0,
+    WL_ZIPF,
+    WL_SHIFT,
+    WL_SCAN,
+    WL_SEGMENTS,
+    WL_SEQUENTIAL,
+    WL_TRACE
+} WorkloadKind;
+
+/**
+ * @brief Um gerador de sequências de nomes.
+ */
+typedef struct workload {
+    WorkloadKind kind;
+    unsigned long names;            /* Nomes distintos (números 0 a names - 1) */
+    double alpha;                   /* Expoente da distribuição Zipf */
+    unsigned long shift_every;      /* shift: pedidos entre rotações da popularidade */
+    unsigned long shift_by;         /* shift: posições por rotação */
+    double scan_probability;        /* scan: probabilidade de começar um varrimento */
+    unsigned long run_length;       /* scan e segments: nomes consecutivos por varrimento ou conteúdo */
+    uint64_t seed;
+
+    /* Estado */
+    double *cdf;                    /* Distribuição acumulada de Zipf (NULL se não for usada) */
+    unsigned long cdf_size;
+    uint64_t rng;
+    unsigned long issued;           /* Pedidos gerados */
+    unsigned long offset;           /* shift: rotação atual */
+    unsigned long run_next;         /* scan e segments: próximo nome do varrimento ou conteúdo */
+    unsigned long run_left;         /* scan e segments: nomes por pedir no varrimento ou conteúdo */
+    unsigned long *trace;           /* trace: sequência lida do ficheiro */
+    size_t trace_len;
+    char trace_file[256];
+} Workload;
+
+/**
+ * @brief Prepara um gerador a partir da sua descrição.
+ *
+ * Os erros são mostrados no stderr.
+ *
+ * @param wl Gerador a inicializar
+ * @param spec Descrição ("zipf:n=1000,a=0.9", ...)
+ * @param default_names Número de nomes se a descrição não tiver n=
+ * @param default_alpha Expoente de Zipf se a descrição não tiver a=
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int workload_init(Workload *wl, const char *spec, unsigned long default_names, double default_alpha);
+
+/**
+ * @brief Devolve o número do próximo nome da sequência.
+ *
+ * @param wl Gerador
+ * @return Número entre 0 e wl->names - 1
+ */
+unsigned long workload_next(Workload *wl);
+
+/**
+ * @brief Recomeça a sequência do início (mesma semente).
+ *
+ * @param wl Gerador
+ */
+void workload_rewind(Workload *wl);
+
+/**
+ * @brief Escreve uma descrição legível do gerador.
+ *
+ * @param wl Gerador
+ * @param buffer Buffer de destino
+ * @param size Tamanho do buffer
+ */
+void workload_describe(const Workload *wl, char *buffer, size_t size);
+
+/**
+ * @brief Liberta a memória de um gerador.
+ *
+ * @param wl Gerador
+ */
+void workload_free(Workload *wl);
+
+#endif /* WORKLOAD_H */